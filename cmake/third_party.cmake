@@ -27,6 +27,10 @@ if (WITH_TENSORRT)
   include(tensorrt)
 endif()
 
+if (WITH_XRT_NATIVE AND NOT WITH_XLA AND NOT WITH_TENSORRT)
+  include(absl)
+endif()
+
 if (BUILD_CUDA)
   set(CUDA_SEPARABLE_COMPILATION ON)
   find_package(CUDA REQUIRED)
@@ -216,6 +220,10 @@ if(WITH_TENSORRT)
   list(APPEND oneflow_third_party_libs ${TENSORRT_LIBRARIES})
 endif()
 
+if (WITH_XRT_NATIVE AND NOT WITH_XLA AND NOT WITH_TENSORRT)
+  list(APPEND oneflow_third_party_libs ${ABSL_LIBRARIES})
+endif()
+
 message(STATUS "oneflow_third_party_libs: " ${oneflow_third_party_libs})
 
 add_definitions(-DHALF_ENABLE_CPP11_USER_LITERALS=0)
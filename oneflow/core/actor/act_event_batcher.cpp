@@ -0,0 +1,119 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/actor/act_event_batcher.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include <cmath>
+#include <iterator>
+
+namespace oneflow {
+
+namespace {
+
+std::atomic<int64_t> g_act_event_batcher_generation(0);
+
+}  // namespace
+
+ActEventBatcher::ActEventBatcher(bool is_experiment_phase)
+    : generation_(++g_act_event_batcher_generation),
+      flush_requested_(false),
+      stopped_(false) {
+  const ProfilerConf& profiler_conf = *Global<const ProfilerConf>::Get();
+  // the improver needs every act of the experiment run
+  const double sample_rate = is_experiment_phase ? 1.0 : profiler_conf.act_event_sample_rate();
+  CHECK_GT(sample_rate, 0.0);
+  CHECK_LE(sample_rate, 1.0);
+  sample_period_ = std::max<int64_t>(std::llround(1.0 / sample_rate), 1);
+  batch_size_ = profiler_conf.act_event_batch_size();
+  CHECK_GT(batch_size_, 0);
+  flush_interval_ = std::chrono::milliseconds(profiler_conf.act_event_flush_interval_ms());
+  poll_thread_ = std::thread(&ActEventBatcher::PollLoop, this);
+}
+
+ActEventBatcher::~ActEventBatcher() {
+  {
+    std::unique_lock<std::mutex> lck(flush_mutex_);
+    stopped_ = true;
+  }
+  flush_cond_.notify_one();
+  poll_thread_.join();
+}
+
+ActEventBatcher::Buffer* ActEventBatcher::ThisThreadBuffer() {
+  // a thread keeps its buffer across calls until a new batcher replaces this one
+  static thread_local int64_t cached_generation = 0;
+  static thread_local Buffer* cached_buffer = nullptr;
+  if (cached_generation != generation_) {
+    std::unique_lock<std::mutex> lck(buffers_mutex_);
+    buffers_.emplace_back(new Buffer());
+    cached_buffer = buffers_.back().get();
+    cached_generation = generation_;
+  }
+  return cached_buffer;
+}
+
+void ActEventBatcher::Add(const ActEvent& act_event) {
+  Buffer* buffer = ThisThreadBuffer();
+  size_t buffered_cnt = 0;
+  {
+    std::unique_lock<std::mutex> lck(buffer->mutex);
+    buffer->act_events.push_back(act_event);
+    buffered_cnt = buffer->act_events.size();
+  }
+  if (buffered_cnt == batch_size_) {
+    {
+      std::unique_lock<std::mutex> lck(flush_mutex_);
+      flush_requested_ = true;
+    }
+    flush_cond_.notify_one();
+  }
+}
+
+void ActEventBatcher::Flush() {
+  std::vector<ActEvent> act_events;
+  {
+    std::unique_lock<std::mutex> buffers_lck(buffers_mutex_);
+    for (const auto& buffer : buffers_) {
+      std::vector<ActEvent> buffered;
+      {
+        std::unique_lock<std::mutex> lck(buffer->mutex);
+        buffered.swap(buffer->act_events);
+      }
+      std::move(buffered.begin(), buffered.end(), std::back_inserter(act_events));
+    }
+  }
+  if (act_events.empty()) { return; }
+  ActEventBatch act_event_batch;
+  act_event_batch.mutable_act_event()->Reserve(act_events.size());
+  for (ActEvent& act_event : act_events) { act_event_batch.add_act_event()->Swap(&act_event); }
+  Global<CtrlClient>::Get()->PushActEventBatch(act_event_batch);
+}
+
+void ActEventBatcher::PollLoop() {
+  while (true) {
+    bool stopped = false;
+    {
+      std::unique_lock<std::mutex> lck(flush_mutex_);
+      flush_cond_.wait_for(lck, flush_interval_, [this]() { return flush_requested_ || stopped_; });
+      flush_requested_ = false;
+      stopped = stopped_;
+    }
+    Flush();
+    if (stopped) { break; }
+  }
+}
+
+}  // namespace oneflow
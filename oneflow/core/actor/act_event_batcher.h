@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_ACTOR_ACT_EVENT_BATCHER_H_
+#define ONEFLOW_CORE_ACTOR_ACT_EVENT_BATCHER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/actor/act_event.pb.h"
+
+namespace oneflow {
+
+// Collects act events into per-thread buffers and ships them to the master in compressed batches,
+// either every flush interval or as soon as one buffer reaches the batch size.
+class ActEventBatcher final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ActEventBatcher);
+  ~ActEventBatcher();
+
+  bool IsSampled(int64_t act_id) const { return act_id % sample_period_ == 0; }
+  void Add(const ActEvent& act_event);
+
+ private:
+  friend class Global<ActEventBatcher>;
+  ActEventBatcher(bool is_experiment_phase);
+
+  struct Buffer {
+    std::mutex mutex;
+    std::vector<ActEvent> act_events;
+  };
+  Buffer* ThisThreadBuffer();
+  void Flush();
+  void PollLoop();
+
+  const int64_t generation_;
+  int64_t sample_period_;
+  size_t batch_size_;
+  std::chrono::milliseconds flush_interval_;
+
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+
+  std::mutex flush_mutex_;
+  std::condition_variable flush_cond_;
+  bool flush_requested_;
+  bool stopped_;
+  std::thread poll_thread_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_ACTOR_ACT_EVENT_BATCHER_H_
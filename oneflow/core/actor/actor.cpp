@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/actor/actor.h"
+#include "oneflow/core/actor/act_event_batcher.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/job/runtime_job_descs.h"
 #include "oneflow/core/job/machine_context.h"
@@ -352,7 +353,7 @@ int Actor::HandlerZombie(const ActorMsg& msg) {
 }
 
 void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
-  if (Global<RuntimeCtx>::Get()->is_experiment_phase() || NeedCollectActEvent()) {
+  if (NeedCollectActEvent() && Global<ActEventBatcher>::Get()->IsSampled(act_id_)) {
     auto act_event = std::make_shared<ActEvent>();
     act_event->set_is_experiment_phase(Global<RuntimeCtx>::Get()->is_experiment_phase());
     act_event->set_actor_id(actor_id());
@@ -373,10 +374,8 @@ void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
 
     device_ctx_->AddCallBack([act_event]() {
       act_event->set_stop_time(GetCurTime());
-      // The stream poller thread is not allowed to perform blocking RPC call. Hence, the
-      // RPC call is forwarded to the thread pool and will be executed there.
-      Global<ThreadPool>::Get()->AddWork(
-          [act_event]() { Global<CtrlClient>::Get()->PushActEvent(*act_event); });
+      // only buffers the event, the stream poller thread never performs the RPC itself
+      Global<ActEventBatcher>::Get()->Add(*act_event);
     });
   } else {
     DoAct();
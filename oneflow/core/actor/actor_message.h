@@ -26,7 +26,8 @@ enum class ActorCmd {
   kSendInitialModel,  // MdUpdt Actor
   kStart,             // Source Actor
   kStopThread,
-  kConstructActor
+  kConstructActor,
+  kConstructActorDone  // Actor built on the construction pool
 };
 
 enum class ActorMsgType { kRegstMsg = 0, kEordMsg, kCmdMsg };
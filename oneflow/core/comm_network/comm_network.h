@@ -42,6 +42,11 @@ class CommNet {
   virtual void* RegisterMemory(void* ptr, size_t byte_size) = 0;
   virtual void UnRegisterMemory(void* token) = 0;
   virtual void RegisterMemoryDone() = 0;
+  // Host memory of registers used by the network may be provided by the comm net, nullptr means
+  // plain host memory
+  virtual void* AllocateRegisterMem(size_t byte_size) { return nullptr; }
+  // Returns false if ptr was not allocated by AllocateRegisterMem
+  virtual bool DeallocateRegisterMem(void* ptr) { return false; }
 
   // Stream
   void* NewActorReadId();
@@ -24,6 +24,10 @@ limitations under the License.
 
 #include <netinet/tcp.h>
 
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+
 namespace oneflow {
 
 namespace {
@@ -49,14 +53,38 @@ int SockListen(int listen_sockfd, uint16_t listen_port, int32_t total_machine_nu
   return bind_result;
 }
 
-int64_t GetMachineId(const sockaddr_in& sa) {
-  char addr[INET_ADDRSTRLEN];
-  memset(addr, '\0', sizeof(addr));
-  PCHECK(inet_ntop(AF_INET, &(sa.sin_addr), addr, INET_ADDRSTRLEN));
-  for (int64_t i = 0; i < Global<ResourceDesc, ForSession>::Get()->TotalMachineNum(); ++i) {
-    if (Global<ResourceDesc, ForSession>::Get()->machine(i).addr() == addr) { return i; }
+void WriteFully(int sockfd, const void* buf, size_t size) {
+  const char* ptr = static_cast<const char*>(buf);
+  while (size > 0) {
+    ssize_t n = write(sockfd, ptr, size);
+    PCHECK(n > 0);
+    ptr += n;
+    size -= n;
+  }
+}
+
+void ReadFully(int sockfd, void* buf, size_t size) {
+  char* ptr = static_cast<char*>(buf);
+  while (size > 0) {
+    ssize_t n = read(sockfd, ptr, size);
+    PCHECK(n > 0);
+    ptr += n;
+    size -= n;
   }
-  UNIMPLEMENTED();
+}
+
+// Sent by the connecting side on each new socket, a peer owns several sockets and several
+// machines may share one address, so the source address alone can not identify a socket
+struct SocketHandshake {
+  int64_t machine_id;
+  int64_t socket_id;
+};
+
+bool EnableZeroCopy(int sockfd) {
+  const int val = 1;
+  if (setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val)) == 0) { return true; }
+  PLOG(WARNING) << "CommNet:Epoll SO_ZEROCOPY unsupported, fd " << sockfd;
+  return false;
 }
 
 std::string GenPortKey(int64_t machine_id) { return "EpollPort/" + std::to_string(machine_id); }
@@ -78,24 +106,51 @@ EpollCommNet::~EpollCommNet() {
     LOG(INFO) << "CommNet Thread " << i << " finish";
     pollers_[i]->Stop();
   }
+  if (shm_transport_) { shm_transport_->Stop(); }
   OF_BARRIER();
   for (IOEventPoller* poller : pollers_) { delete poller; }
   for (auto& pair : sockfd2helper_) { delete pair.second; }
+  double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_)
+                         .count();
+  for (int64_t peer_id : peer_machine_id()) {
+    const SocketPeerStat& stat = *peer_stats_.at(peer_id);
+    const int64_t sent_byte = stat.sent_byte.load();
+    const int64_t recv_byte = stat.recv_byte.load();
+    LOG(INFO) << "CommNet:Epoll peer " << peer_id << " sent " << sent_byte / kMB << " MB ("
+              << sent_byte / elapsed_s / 1e9 << " GB/s), received " << recv_byte / kMB << " MB ("
+              << recv_byte / elapsed_s / 1e9 << " GB/s), msgs sent " << stat.sent_msg_num.load()
+              << " received " << stat.recv_msg_num.load() << ", write calls "
+              << stat.write_call_num.load() << ", msgs per batch "
+              << stat.sent_msg_num.load() / std::max<double>(stat.sent_batch_num.load(), 1)
+              << ", wakeups " << stat.wakeup_num.load() << " saved "
+              << stat.saved_wakeup_num.load() << ", credit waits " << stat.credit_wait_num.load();
+  }
 }
 
 void EpollCommNet::RegisterMemoryDone() {
-  // do nothing
+  if (shm_transport_) { shm_transport_->RegisterMemoryDone(mem_descs()); }
+}
+
+void* EpollCommNet::AllocateRegisterMem(size_t byte_size) {
+  return shm_transport_ ? shm_transport_->AllocateRegisterMem(byte_size) : nullptr;
+}
+
+bool EpollCommNet::DeallocateRegisterMem(void* ptr) {
+  return shm_transport_ ? shm_transport_->DeallocateRegisterMem(ptr) : false;
 }
 
 void EpollCommNet::SendActorMsg(int64_t dst_machine_id, const ActorMsg& actor_msg) {
+  // a peer always uses the same path, which keeps its actor msgs in order
+  if (shm_transport_ && shm_transport_->SendActorMsg(dst_machine_id, actor_msg)) { return; }
   SocketMsg msg;
   msg.msg_type = SocketMsgType::kActor;
   msg.actor_msg = actor_msg;
-  GetSocketHelper(dst_machine_id)->AsyncWrite(msg);
+  // actor msgs always go through socket 0 to keep their order
+  GetSocketHelper(dst_machine_id, 0)->AsyncWrite(msg);
 }
 
-void EpollCommNet::SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg) {
-  GetSocketHelper(dst_machine_id)->AsyncWrite(msg);
+void EpollCommNet::SendSocketMsg(int64_t dst_machine_id, int32_t socket_id, const SocketMsg& msg) {
+  GetSocketHelper(dst_machine_id, socket_id)->AsyncWrite(msg);
 }
 
 SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
@@ -105,37 +160,53 @@ SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
   return mem_desc;
 }
 
-EpollCommNet::EpollCommNet(const Plan& plan) : CommNetIf(plan) {
-  pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
+EpollCommNet::EpollCommNet(const Plan& plan) : CommNetIf(plan), next_socket_id_(0) {
+  const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
+  socket_num_per_peer_ = resource_desc->CommNetSocketNumPerPeer();
+  CHECK_GE(socket_num_per_peer_, 1);
+  stripe_min_byte_ = std::max<size_t>(resource_desc->comm_net_stripe_min_byte(), 1);
+  start_time_ = std::chrono::steady_clock::now();
+  pollers_.resize(resource_desc->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
   InitSockets();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
+  if (resource_desc->comm_net_shared_memory()) {
+    shm_transport_.reset(
+        new SharedMemTransport(peer_machine_id(), peer_stats_, resource_desc->CommNetWorkerNum()));
+  }
 }
 
 void EpollCommNet::InitSockets() {
   int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
   auto this_machine = Global<ResourceDesc, ForSession>::Get()->machine(this_machine_id);
   int64_t total_machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
-  machine_id2sockfd_.assign(total_machine_num, -1);
+  bool zero_copy = Global<ResourceDesc, ForSession>::Get()->comm_net_zero_copy();
+  machine_id2sockfds_.assign(total_machine_num, std::vector<int>(socket_num_per_peer_, -1));
   sockfd2helper_.clear();
+  peer_stats_.clear();
+  FOR_RANGE(int64_t, machine_id, 0, total_machine_num) {
+    peer_stats_.emplace_back(new SocketPeerStat);
+  }
   size_t poller_idx = 0;
-  auto NewSocketHelper = [&](int sockfd) {
+  auto NewSocketHelper = [&](int sockfd, int64_t peer_id) {
     IOEventPoller* poller = pollers_[poller_idx];
     poller_idx = (poller_idx + 1) % pollers_.size();
-    return new SocketHelper(sockfd, poller);
+    bool sock_zero_copy = zero_copy && EnableZeroCopy(sockfd);
+    return new SocketHelper(sockfd, poller, peer_stats_.at(peer_id).get(), sock_zero_copy);
   };
 
   // listen
   int listen_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  int32_t backlog = total_machine_num * socket_num_per_peer_;
   int32_t this_listen_port = Global<EnvDesc>::Get()->data_port();
   if (this_listen_port != -1) {
-    CHECK_EQ(SockListen(listen_sockfd, this_listen_port, total_machine_num), 0);
+    CHECK_EQ(SockListen(listen_sockfd, this_listen_port, backlog), 0);
     PushPort(this_machine_id,
              ((this_machine.data_port_agent() != -1) ? (this_machine.data_port_agent())
                                                      : (this_listen_port)));
   } else {
     for (this_listen_port = 1024; this_listen_port < GetMaxVal<uint16_t>(); ++this_listen_port) {
-      if (SockListen(listen_sockfd, this_listen_port, total_machine_num) == 0) {
+      if (SockListen(listen_sockfd, this_listen_port, backlog) == 0) {
         PushPort(this_machine_id, this_listen_port);
         break;
       }
@@ -153,47 +224,73 @@ void EpollCommNet::InitSockets() {
     uint16_t peer_port = PullPort(peer_id);
     auto peer_machine = Global<ResourceDesc, ForSession>::Get()->machine(peer_id);
     sockaddr_in peer_sockaddr = GetSockAddr(peer_machine.addr(), peer_port);
-    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    const int val = 1;
-    PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
-    PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
-           == 0);
-    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    machine_id2sockfd_[peer_id] = sockfd;
+    FOR_RANGE(int32_t, socket_id, 0, socket_num_per_peer_) {
+      int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+      const int val = 1;
+      PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
+      PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
+             == 0);
+      SocketHandshake handshake;
+      handshake.machine_id = this_machine_id;
+      handshake.socket_id = socket_id;
+      WriteFully(sockfd, &handshake, sizeof(handshake));
+      CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd, peer_id)).second);
+      machine_id2sockfds_[peer_id][socket_id] = sockfd;
+    }
   }
 
   // accept
-  FOR_RANGE(int32_t, idx, 0, src_machine_count) {
+  FOR_RANGE(int32_t, idx, 0, src_machine_count * socket_num_per_peer_) {
     sockaddr_in peer_sockaddr;
     socklen_t len = sizeof(peer_sockaddr);
     int sockfd = accept(listen_sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), &len);
     PCHECK(sockfd != -1);
-    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    int64_t peer_machine_id = GetMachineId(peer_sockaddr);
-    machine_id2sockfd_[peer_machine_id] = sockfd;
+    SocketHandshake handshake;
+    ReadFully(sockfd, &handshake, sizeof(handshake));
+    CHECK_GE(handshake.machine_id, 0);
+    CHECK_LT(handshake.machine_id, this_machine_id);
+    CHECK_GE(handshake.socket_id, 0);
+    CHECK_LT(handshake.socket_id, socket_num_per_peer_);
+    CHECK_EQ(machine_id2sockfds_[handshake.machine_id][handshake.socket_id], -1);
+    const int val = 1;
+    PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
+    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd, handshake.machine_id)).second);
+    machine_id2sockfds_[handshake.machine_id][handshake.socket_id] = sockfd;
   }
   PCHECK(close(listen_sockfd) == 0);
   ClearPort(this_machine_id);
 
   // useful log
   FOR_RANGE(int64_t, machine_id, 0, total_machine_num) {
-    LOG(INFO) << "machine " << machine_id << " sockfd " << machine_id2sockfd_[machine_id];
+    std::string sockfds;
+    for (int sockfd : machine_id2sockfds_[machine_id]) {
+      sockfds += (sockfds.empty() ? "" : ",") + std::to_string(sockfd);
+    }
+    LOG(INFO) << "machine " << machine_id << " sockfd " << sockfds;
   }
 }
 
-SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id) {
-  int sockfd = machine_id2sockfd_.at(machine_id);
+SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id, int32_t socket_id) {
+  int sockfd = machine_id2sockfds_.at(machine_id).at(socket_id);
   return sockfd2helper_.at(sockfd);
 }
 
 void EpollCommNet::DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) {
-  SocketMsg msg;
-  msg.msg_type = SocketMsgType::kRequestWrite;
-  msg.request_write_msg.src_token = src_token;
-  msg.request_write_msg.dst_machine_id = Global<MachineCtx>::Get()->this_machine_id();
-  msg.request_write_msg.dst_token = dst_token;
-  msg.request_write_msg.read_id = read_id;
-  GetSocketHelper(src_machine_id)->AsyncWrite(msg);
+  if (shm_transport_ && shm_transport_->Read(read_id, src_machine_id, src_token, dst_token)) {
+    return;
+  }
+  const int64_t byte_size = static_cast<const SocketMemDesc*>(dst_token)->byte_size;
+  // small reads are spread over the sockets too, so they do not queue behind each other
+  const int32_t first_socket_id = next_socket_id_++ % socket_num_per_peer_;
+  for (const RequestWriteMsg& stripe :
+       GenRequestWriteStripes(read_id, src_token, Global<MachineCtx>::Get()->this_machine_id(),
+                              dst_token, byte_size, socket_num_per_peer_, stripe_min_byte_,
+                              first_socket_id)) {
+    SocketMsg msg;
+    msg.msg_type = SocketMsgType::kRequestWrite;
+    msg.request_write_msg = stripe;
+    GetSocketHelper(src_machine_id, stripe.stripe_id)->AsyncWrite(msg);
+  }
 }
 
 }  // namespace oneflow
@@ -19,9 +19,12 @@ limitations under the License.
 #include "oneflow/core/comm_network/comm_network.h"
 #include "oneflow/core/comm_network/epoll/socket_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/comm_network/epoll/shared_memory_transport.h"
 
 #ifdef PLATFORM_POSIX
 
+#include <chrono>
+
 namespace oneflow {
 
 class EpollCommNet final : public CommNetIf<SocketMemDesc> {
@@ -32,21 +35,34 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   static void Init(const Plan& plan) { Global<CommNet>::SetAllocated(new EpollCommNet(plan)); }
 
   void RegisterMemoryDone() override;
+  void* AllocateRegisterMem(size_t byte_size) override;
+  bool DeallocateRegisterMem(void* ptr) override;
 
   void SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) override;
-  void SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg);
+  void SendSocketMsg(int64_t dst_machine_id, int32_t socket_id, const SocketMsg& msg);
+
+  const SocketPeerStat& peer_stat(int64_t machine_id) const {
+    return *peer_stats_.at(machine_id);
+  }
 
  private:
   SocketMemDesc* NewMemDesc(void* ptr, size_t byte_size) override;
 
   EpollCommNet(const Plan& plan);
   void InitSockets();
-  SocketHelper* GetSocketHelper(int64_t machine_id);
+  SocketHelper* GetSocketHelper(int64_t machine_id, int32_t socket_id);
   void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) override;
 
   std::vector<IOEventPoller*> pollers_;
-  std::vector<int> machine_id2sockfd_;
+  int32_t socket_num_per_peer_;
+  size_t stripe_min_byte_;
+  std::atomic<uint32_t> next_socket_id_;
+  std::vector<std::vector<int>> machine_id2sockfds_;
   HashMap<int, SocketHelper*> sockfd2helper_;
+  std::vector<std::unique_ptr<SocketPeerStat>> peer_stats_;
+  std::chrono::steady_clock::time_point start_time_;
+  // peers on the same host, nullptr unless comm_net_shared_memory is set
+  std::unique_ptr<SharedMemTransport> shm_transport_;
 };
 
 template<>
@@ -0,0 +1,390 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/shared_memory_transport.h"
+#include "oneflow/core/comm_network/epoll/shared_memory_transport.pb.h"
+#include "oneflow/core/actor/actor_message_bus.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+
+#ifdef PLATFORM_POSIX
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <climits>
+#include <fstream>
+#include <random>
+
+namespace oneflow {
+
+namespace {
+
+const size_t kShmMsgRingCapacity = 4096;
+const int32_t kInboxPollTimeoutMs = 100;
+
+std::string GenPeerInfoKey(int64_t machine_id) {
+  return "EpollShmPeerInfo/" + std::to_string(machine_id);
+}
+
+std::string GenTokensMsgKey(int64_t machine_id) {
+  return "EpollShmTokensMsg/" + std::to_string(machine_id);
+}
+
+std::string ShmPath(const std::string& name) { return "/dev/shm/" + name; }
+
+// Only narrows down the peers which may be on this host: the boot id belongs to the kernel and is
+// the same in every container of a host, which may share a hostname too. A peer counts as local
+// only after its inbox is opened by name and carries the nonce the peer published
+std::string GetHostId() {
+  char hostname[HOST_NAME_MAX + 1] = {0};
+  PCHECK(gethostname(hostname, HOST_NAME_MAX) == 0);
+  std::string host_id(hostname);
+  std::ifstream boot_id_file("/proc/sys/kernel/random/boot_id");
+  std::string boot_id;
+  if (boot_id_file >> boot_id) { host_id += "/" + boot_id; }
+  return host_id;
+}
+
+void FutexWait(std::atomic<uint32_t>* addr, uint32_t val, int32_t timeout_ms) {
+  timespec timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+  // not FUTEX_PRIVATE_FLAG, the word is shared with other processes
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, val, &timeout, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* addr) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+SharedMemSegment::~SharedMemSegment() {
+  PCHECK(munmap(ptr_, byte_size_) == 0);
+  Unlink();
+}
+
+uint64_t SharedMemSegment::ProcessNonce() {
+  static const uint64_t nonce = []() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  }();
+  return nonce;
+}
+
+std::unique_ptr<SharedMemSegment> SharedMemSegment::Create(size_t byte_size) {
+  static std::atomic<int64_t> segment_cnt(0);
+  if (byte_size == 0) { return nullptr; }
+  const std::string name = "oneflow." + std::to_string(getpid()) + "."
+                           + std::to_string(ProcessNonce()) + "." + std::to_string(segment_cnt++);
+  const std::string path = ShmPath(name);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd == -1) {
+    PLOG(WARNING) << "CommNet:Epoll can not create " << path;
+    return nullptr;
+  }
+  // reserve the pages now, touching a sparse tmpfs file fails with SIGBUS once it is full
+  const int err = posix_fallocate(fd, 0, byte_size);
+  if (err != 0) {
+    LOG(WARNING) << "CommNet:Epoll can not reserve " << byte_size << " bytes in " << path << ": "
+                 << strerror(err);
+    PCHECK(close(fd) == 0);
+    PCHECK(unlink(path.c_str()) == 0);
+    return nullptr;
+  }
+  void* ptr = mmap(nullptr, byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  PCHECK(close(fd) == 0);
+  if (ptr == MAP_FAILED) {
+    PLOG(WARNING) << "CommNet:Epoll can not map " << path;
+    PCHECK(unlink(path.c_str()) == 0);
+    return nullptr;
+  }
+  return std::unique_ptr<SharedMemSegment>(
+      new SharedMemSegment(name, static_cast<char*>(ptr), byte_size, true));
+}
+
+std::unique_ptr<SharedMemSegment> SharedMemSegment::Open(const std::string& name,
+                                                         size_t byte_size) {
+  const std::string path = ShmPath(name);
+  int fd = open(path.c_str(), O_RDWR);
+  if (fd == -1) { return nullptr; }
+  struct stat file_stat;
+  PCHECK(fstat(fd, &file_stat) == 0);
+  if (file_stat.st_size < static_cast<off_t>(byte_size)) {
+    PCHECK(close(fd) == 0);
+    return nullptr;
+  }
+  void* ptr = mmap(nullptr, byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  PCHECK(close(fd) == 0);
+  if (ptr == MAP_FAILED) { return nullptr; }
+  return std::unique_ptr<SharedMemSegment>(
+      new SharedMemSegment(name, static_cast<char*>(ptr), byte_size, false));
+}
+
+void SharedMemSegment::Unlink() {
+  if (!is_linked_) { return; }
+  PCHECK(unlink(ShmPath(name_).c_str()) == 0);
+  is_linked_ = false;
+}
+
+struct ShmInbox::Header {
+  std::atomic<uint32_t> doorbell;
+  std::atomic<uint32_t> is_waiting;
+  uint64_t owner_nonce;
+  char padding[48];
+};
+
+struct ShmInbox::Ring {
+  // head is written by the owner and tail by the peer, keep them on different cache lines
+  std::atomic<uint64_t> head;
+  char head_padding[56];
+  std::atomic<uint64_t> tail;
+  char tail_padding[56];
+  ActorMsg msgs[kShmMsgRingCapacity];
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain word");
+
+ShmInbox::ShmInbox(char* ptr, int64_t machine_num)
+    : header_(reinterpret_cast<Header*>(ptr)),
+      rings_(reinterpret_cast<Ring*>(ptr + sizeof(Header))),
+      machine_num_(machine_num) {}
+
+size_t ShmInbox::ByteSize(int64_t machine_num) {
+  return sizeof(Header) + machine_num * sizeof(Ring);
+}
+
+size_t ShmInbox::RingCapacity() { return kShmMsgRingCapacity; }
+
+void ShmInbox::InitRings(uint64_t owner_nonce) {
+  header_->owner_nonce = owner_nonce;
+  header_->doorbell.store(0);
+  header_->is_waiting.store(0);
+  FOR_RANGE(int64_t, i, 0, machine_num_) {
+    rings_[i].head.store(0);
+    rings_[i].tail.store(0);
+  }
+}
+
+uint64_t ShmInbox::owner_nonce() const { return header_->owner_nonce; }
+
+void ShmInbox::Push(int64_t src_machine_id, const ActorMsg& msg) {
+  Ring* ring = &rings_[src_machine_id];
+  const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+  while (tail - ring->head.load(std::memory_order_acquire) >= kShmMsgRingCapacity) {
+    std::this_thread::yield();
+  }
+  ring->msgs[tail % kShmMsgRingCapacity] = msg;
+  ring->tail.store(tail + 1);
+  // pairs with the is_waiting store and recheck in PopAll, so a wakeup is never lost
+  if (header_->is_waiting.load() != 0) { Wake(); }
+}
+
+size_t ShmInbox::PopAll(
+    int32_t timeout_ms,
+    const std::function<void(int64_t src_machine_id, const ActorMsg&)>& Handler) {
+  size_t msg_cnt = 0;
+  FOR_RANGE(int64_t, i, 0, machine_num_) {
+    Ring* ring = &rings_[i];
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    FOR_RANGE(uint64_t, pos, head, tail) { Handler(i, ring->msgs[pos % kShmMsgRingCapacity]); }
+    ring->head.store(tail, std::memory_order_release);
+    msg_cnt += tail - head;
+  }
+  if (msg_cnt > 0) { return msg_cnt; }
+  const uint32_t doorbell = header_->doorbell.load();
+  header_->is_waiting.store(1);
+  if (!HasPendingMsg()) { FutexWait(&header_->doorbell, doorbell, timeout_ms); }
+  header_->is_waiting.store(0);
+  return 0;
+}
+
+void ShmInbox::Wake() {
+  header_->doorbell.fetch_add(1);
+  FutexWakeAll(&header_->doorbell);
+}
+
+bool ShmInbox::HasPendingMsg() const {
+  FOR_RANGE(int64_t, i, 0, machine_num_) {
+    if (rings_[i].head.load(std::memory_order_relaxed) != rings_[i].tail.load()) { return true; }
+  }
+  return false;
+}
+
+SharedMemTransport::SharedMemTransport(
+    const HashSet<int64_t>& peer_machine_ids,
+    const std::vector<std::unique_ptr<SocketPeerStat>>& peer_stats, size_t copy_thread_num)
+    : this_machine_id_(Global<MachineCtx>::Get()->this_machine_id()),
+      peer_stats_(peer_stats),
+      local_peer_num_(0),
+      is_stopped_(false) {
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  peer_inbox_segments_.resize(machine_num);
+  peer_inboxes_.resize(machine_num);
+  peer_token2mem_ptr_.resize(machine_num);
+  FOR_RANGE(int64_t, machine_id, 0, machine_num) { peer_inbox_mtxs_.emplace_back(new std::mutex); }
+  ShmPeerInfo this_peer_info;
+  this_peer_info.set_host_id(GetHostId());
+  this_peer_info.set_inbox_byte_size(ShmInbox::ByteSize(machine_num));
+  inbox_segment_ = SharedMemSegment::Create(this_peer_info.inbox_byte_size());
+  if (inbox_segment_) {
+    inbox_.reset(new ShmInbox(inbox_segment_->ptr(), machine_num));
+    inbox_->InitRings(SharedMemSegment::ProcessNonce());
+    this_peer_info.set_inbox_name(inbox_segment_->name());
+  } else {
+    this_peer_info.set_inbox_name("");
+  }
+  this_peer_info.set_inbox_nonce(SharedMemSegment::ProcessNonce());
+  Global<CtrlClient>::Get()->PushKV(GenPeerInfoKey(this_machine_id_), this_peer_info);
+  for (int64_t peer_id : peer_machine_ids) {
+    ShmPeerInfo peer_info;
+    Global<CtrlClient>::Get()->PullKV(GenPeerInfoKey(peer_id), &peer_info);
+    if (peer_info.host_id() != this_peer_info.host_id()) { continue; }
+    if (peer_info.inbox_name().empty()) { continue; }
+    std::unique_ptr<SharedMemSegment> segment =
+        SharedMemSegment::Open(peer_info.inbox_name(), peer_info.inbox_byte_size());
+    if (!segment) { continue; }
+    std::unique_ptr<ShmInbox> peer_inbox(new ShmInbox(segment->ptr(), machine_num));
+    // a segment of the same name in another /dev/shm, it belongs to some other process
+    if (peer_inbox->owner_nonce() != peer_info.inbox_nonce()) { continue; }
+    peer_inboxes_.at(peer_id) = std::move(peer_inbox);
+    peer_inbox_segments_.at(peer_id) = std::move(segment);
+    local_peer_num_ += 1;
+  }
+  OF_BARRIER();
+  Global<CtrlClient>::Get()->ClearKV(GenPeerInfoKey(this_machine_id_));
+  if (inbox_segment_) { inbox_segment_->Unlink(); }
+  LOG(INFO) << "CommNet:Epoll " << local_peer_num_ << " peers reached through shared memory";
+  if (HasLocalPeer()) { copy_pool_.reset(new ThreadPool(std::max<size_t>(copy_thread_num, 1))); }
+  if (inbox_) { inbox_poller_ = std::thread(&SharedMemTransport::PollInbox, this); }
+}
+
+SharedMemTransport::~SharedMemTransport() { Stop(); }
+
+void* SharedMemTransport::AllocateRegisterMem(size_t byte_size) {
+  if (!HasLocalPeer()) { return nullptr; }
+  std::unique_ptr<SharedMemSegment> segment = SharedMemSegment::Create(byte_size);
+  if (!segment) { return nullptr; }
+  char* ptr = segment->ptr();
+  std::unique_lock<std::mutex> lck(register_mem_mtx_);
+  CHECK(ptr2register_mem_segment_.emplace(ptr, std::move(segment)).second);
+  return ptr;
+}
+
+bool SharedMemTransport::DeallocateRegisterMem(void* ptr) {
+  std::unique_lock<std::mutex> lck(register_mem_mtx_);
+  return ptr2register_mem_segment_.erase(static_cast<char*>(ptr)) == 1;
+}
+
+void SharedMemTransport::RegisterMemoryDone(const HashSet<SocketMemDesc*>& mem_descs) {
+  ShmTokensMsg this_tokens_msg;
+  {
+    std::unique_lock<std::mutex> lck(register_mem_mtx_);
+    for (SocketMemDesc* mem_desc : mem_descs) {
+      char* mem_ptr = static_cast<char*>(mem_desc->mem_ptr);
+      auto segment_it = ptr2register_mem_segment_.upper_bound(mem_ptr);
+      if (segment_it == ptr2register_mem_segment_.begin()) { continue; }
+      const SharedMemSegment* segment = std::prev(segment_it)->second.get();
+      if (mem_ptr + mem_desc->byte_size > segment->ptr() + segment->byte_size()) { continue; }
+      ShmMemDescProto mem_desc_proto;
+      mem_desc_proto.set_segment_name(segment->name());
+      mem_desc_proto.set_segment_byte_size(segment->byte_size());
+      mem_desc_proto.set_offset(mem_ptr - segment->ptr());
+      this_tokens_msg.mutable_token2mem_desc()->insert(
+          {reinterpret_cast<uint64_t>(mem_desc), mem_desc_proto});
+    }
+  }
+  Global<CtrlClient>::Get()->PushKV(GenTokensMsgKey(this_machine_id_), this_tokens_msg);
+  FOR_RANGE(int64_t, peer_id, 0, peer_inboxes_.size()) {
+    if (!IsLocalPeer(peer_id)) { continue; }
+    ShmTokensMsg peer_tokens_msg;
+    Global<CtrlClient>::Get()->PullKV(GenTokensMsgKey(peer_id), &peer_tokens_msg);
+    for (const auto& pair : peer_tokens_msg.token2mem_desc()) {
+      const ShmMemDescProto& mem_desc_proto = pair.second;
+      auto segment_it = name2peer_register_mem_segment_.find(mem_desc_proto.segment_name());
+      if (segment_it == name2peer_register_mem_segment_.end()) {
+        segment_it = name2peer_register_mem_segment_
+                         .emplace(mem_desc_proto.segment_name(),
+                                  SharedMemSegment::Open(mem_desc_proto.segment_name(),
+                                                         mem_desc_proto.segment_byte_size()))
+                         .first;
+      }
+      // reads of registers that can not be mapped fall back to sockets
+      if (!segment_it->second) { continue; }
+      CHECK(peer_token2mem_ptr_.at(peer_id)
+                .emplace(reinterpret_cast<void*>(pair.first),
+                         segment_it->second->ptr() + mem_desc_proto.offset())
+                .second);
+    }
+  }
+  OF_BARRIER();
+  Global<CtrlClient>::Get()->ClearKV(GenTokensMsgKey(this_machine_id_));
+  std::unique_lock<std::mutex> lck(register_mem_mtx_);
+  for (auto& pair : ptr2register_mem_segment_) { pair.second->Unlink(); }
+}
+
+bool SharedMemTransport::SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) {
+  ShmInbox* peer_inbox = peer_inboxes_.at(dst_machine_id).get();
+  if (peer_inbox == nullptr) { return false; }
+  {
+    std::unique_lock<std::mutex> lck(*peer_inbox_mtxs_.at(dst_machine_id));
+    peer_inbox->Push(this_machine_id_, msg);
+  }
+  peer_stats_.at(dst_machine_id)->sent_msg_num += 1;
+  return true;
+}
+
+bool SharedMemTransport::Read(void* read_id, int64_t src_machine_id, void* src_token,
+                              void* dst_token) {
+  const HashMap<void*, const char*>& token2mem_ptr = peer_token2mem_ptr_.at(src_machine_id);
+  auto mem_ptr_it = token2mem_ptr.find(src_token);
+  if (mem_ptr_it == token2mem_ptr.end()) { return false; }
+  const char* src_ptr = mem_ptr_it->second;
+  const SocketMemDesc* dst_mem_desc = static_cast<const SocketMemDesc*>(dst_token);
+  SocketPeerStat* peer_stat = peer_stats_.at(src_machine_id).get();
+  copy_pool_->AddWork([read_id, src_ptr, dst_mem_desc, peer_stat]() {
+    memcpy(dst_mem_desc->mem_ptr, src_ptr, dst_mem_desc->byte_size);
+    peer_stat->recv_byte += dst_mem_desc->byte_size;
+    Global<CommNet>::Get()->ReadDone(read_id);
+  });
+  return true;
+}
+
+void SharedMemTransport::Stop() {
+  if (is_stopped_.exchange(true)) { return; }
+  if (inbox_) {
+    inbox_->Wake();
+    inbox_poller_.join();
+  }
+  copy_pool_.reset();
+}
+
+void SharedMemTransport::PollInbox() {
+  while (!is_stopped_.load()) {
+    inbox_->PopAll(kInboxPollTimeoutMs, [this](int64_t src_machine_id, const ActorMsg& msg) {
+      peer_stats_.at(src_machine_id)->recv_msg_num += 1;
+      Global<ActorMsgBus>::Get()->SendMsgWithoutCommNet(msg);
+    });
+  }
+}
+
+}  // namespace oneflow
+
+#endif  // PLATFORM_POSIX
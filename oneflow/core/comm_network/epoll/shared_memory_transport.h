@@ -0,0 +1,139 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMM_NETWORK_EPOLL_SHARED_MEMORY_TRANSPORT_H_
+#define ONEFLOW_CORE_COMM_NETWORK_EPOLL_SHARED_MEMORY_TRANSPORT_H_
+
+#include "oneflow/core/comm_network/epoll/socket_message.h"
+#include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#ifdef PLATFORM_POSIX
+
+namespace oneflow {
+
+// A file in /dev/shm mapped into this process
+class SharedMemSegment final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SharedMemSegment);
+  ~SharedMemSegment();
+
+  // Random per process and part of every segment name, processes of different containers may
+  // have the same pid
+  static uint64_t ProcessNonce();
+  // Returns nullptr if the segment can not be backed, e.g. /dev/shm is too small
+  static std::unique_ptr<SharedMemSegment> Create(size_t byte_size);
+  // Returns nullptr if the segment is not visible, e.g. the owner is in another container
+  static std::unique_ptr<SharedMemSegment> Open(const std::string& name, size_t byte_size);
+
+  const std::string& name() const { return name_; }
+  char* ptr() const { return ptr_; }
+  size_t byte_size() const { return byte_size_; }
+  // Removes the name once every peer has mapped the segment, the memory lives until munmap
+  void Unlink();
+
+ private:
+  SharedMemSegment(const std::string& name, char* ptr, size_t byte_size, bool is_linked)
+      : name_(name), ptr_(ptr), byte_size_(byte_size), is_linked_(is_linked) {}
+
+  std::string name_;
+  char* ptr_;
+  size_t byte_size_;
+  bool is_linked_;
+};
+
+// Actor msgs of all peers on the same host, every peer pushes into its own single producer ring
+// and the owner pops from all of them, sleeping on a futex when they are empty
+class ShmInbox final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ShmInbox);
+  ShmInbox(char* ptr, int64_t machine_num);
+  ~ShmInbox() = default;
+
+  static size_t ByteSize(int64_t machine_num);
+  // Msgs a peer may push before it has to wait for the owner
+  static size_t RingCapacity();
+  // Constructs the rings in place, only called by the owner before publishing the inbox
+  void InitRings(uint64_t owner_nonce);
+  uint64_t owner_nonce() const;
+
+  // Callers must serialize pushes of the same src_machine_id
+  void Push(int64_t src_machine_id, const ActorMsg& msg);
+  // Pops every pending msg, returns 0 if none arrived within timeout_ms
+  size_t PopAll(int32_t timeout_ms,
+                const std::function<void(int64_t src_machine_id, const ActorMsg&)>& Handler);
+  void Wake();
+
+ private:
+  struct Header;
+  struct Ring;
+  bool HasPendingMsg() const;
+
+  Header* header_;
+  Ring* rings_;
+  int64_t machine_num_;
+};
+
+// Intra-host transport of EpollCommNet, peers on the same host exchange actor msgs through
+// ShmInbox and read registers allocated in shared segments with a plain memcpy
+class SharedMemTransport final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SharedMemTransport);
+  SharedMemTransport(const HashSet<int64_t>& peer_machine_ids,
+                     const std::vector<std::unique_ptr<SocketPeerStat>>& peer_stats,
+                     size_t copy_thread_num);
+  ~SharedMemTransport();
+
+  bool HasLocalPeer() const { return local_peer_num_ > 0; }
+  bool IsLocalPeer(int64_t machine_id) const { return peer_inboxes_.at(machine_id) != nullptr; }
+
+  // Returns nullptr if the memory can not be shared
+  void* AllocateRegisterMem(size_t byte_size);
+  bool DeallocateRegisterMem(void* ptr);
+  void RegisterMemoryDone(const HashSet<SocketMemDesc*>& mem_descs);
+
+  // Return false if the peer must be reached through sockets
+  bool SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg);
+  bool Read(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token);
+
+  void Stop();
+
+ private:
+  void PollInbox();
+
+  int64_t this_machine_id_;
+  const std::vector<std::unique_ptr<SocketPeerStat>>& peer_stats_;
+  std::unique_ptr<SharedMemSegment> inbox_segment_;
+  std::unique_ptr<ShmInbox> inbox_;
+  std::vector<std::unique_ptr<SharedMemSegment>> peer_inbox_segments_;
+  std::vector<std::unique_ptr<ShmInbox>> peer_inboxes_;
+  std::vector<std::unique_ptr<std::mutex>> peer_inbox_mtxs_;
+  int64_t local_peer_num_;
+
+  std::mutex register_mem_mtx_;
+  std::map<char*, std::unique_ptr<SharedMemSegment>> ptr2register_mem_segment_;
+  HashMap<std::string, std::unique_ptr<SharedMemSegment>> name2peer_register_mem_segment_;
+  std::vector<HashMap<void*, const char*>> peer_token2mem_ptr_;
+
+  std::unique_ptr<ThreadPool> copy_pool_;
+  std::thread inbox_poller_;
+  std::atomic<bool> is_stopped_;
+};
+
+}  // namespace oneflow
+
+#endif  // PLATFORM_POSIX
+
+#endif  // ONEFLOW_CORE_COMM_NETWORK_EPOLL_SHARED_MEMORY_TRANSPORT_H_
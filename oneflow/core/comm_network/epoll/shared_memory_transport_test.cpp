@@ -0,0 +1,135 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/shared_memory_transport.h"
+
+#ifdef PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+class ShmInboxTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    segment_ = SharedMemSegment::Create(ShmInbox::ByteSize(kMachineNum));
+    ASSERT_TRUE(segment_ != nullptr);
+    segment_->Unlink();
+    inbox_.reset(new ShmInbox(segment_->ptr(), kMachineNum));
+    inbox_->InitRings(SharedMemSegment::ProcessNonce());
+  }
+
+  static const int64_t kMachineNum = 3;
+  std::unique_ptr<SharedMemSegment> segment_;
+  std::unique_ptr<ShmInbox> inbox_;
+};
+
+// the dst actor id carries the sequence number of a msg
+ActorMsg GenMsg(int64_t seq) { return ActorMsg::BuildCommandMsg(seq, ActorCmd::kStart); }
+
+double ElapsedSec(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+TEST_F(ShmInboxTest, owner_nonce) {
+  ASSERT_EQ(inbox_->owner_nonce(), SharedMemSegment::ProcessNonce());
+  ShmInbox peer_view(segment_->ptr(), kMachineNum);
+  ASSERT_EQ(peer_view.owner_nonce(), SharedMemSegment::ProcessNonce());
+}
+
+TEST_F(ShmInboxTest, keep_order_of_each_peer) {
+  const int64_t msg_num = 100000;
+  std::vector<std::thread> producers;
+  FOR_RANGE(int64_t, src_machine_id, 0, kMachineNum) {
+    producers.emplace_back([this, src_machine_id, msg_num]() {
+      FOR_RANGE(int64_t, seq, 0, msg_num) { inbox_->Push(src_machine_id, GenMsg(seq)); }
+    });
+  }
+  std::vector<int64_t> next_seqs(kMachineNum, 0);
+  int64_t recv_num = 0;
+  while (recv_num < kMachineNum * msg_num) {
+    recv_num += inbox_->PopAll(100, [&](int64_t src_machine_id, const ActorMsg& msg) {
+      ASSERT_EQ(msg.dst_actor_id(), next_seqs.at(src_machine_id));
+      next_seqs.at(src_machine_id) += 1;
+    });
+  }
+  for (std::thread& producer : producers) { producer.join(); }
+  for (int64_t next_seq : next_seqs) { ASSERT_EQ(next_seq, msg_num); }
+}
+
+TEST_F(ShmInboxTest, wait_for_full_ring) {
+  const int64_t capacity = ShmInbox::RingCapacity();
+  FOR_RANGE(int64_t, seq, 0, capacity) { inbox_->Push(1, GenMsg(seq)); }
+  std::atomic<bool> is_pushed(false);
+  std::thread producer([&]() {
+    inbox_->Push(1, GenMsg(capacity));
+    is_pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_FALSE(is_pushed);
+  int64_t next_seq = 0;
+  auto Handler = [&](int64_t src_machine_id, const ActorMsg& msg) {
+    ASSERT_EQ(src_machine_id, 1);
+    ASSERT_EQ(msg.dst_actor_id(), next_seq);
+    next_seq += 1;
+  };
+  ASSERT_EQ(inbox_->PopAll(100, Handler), capacity);
+  producer.join();
+  ASSERT_TRUE(is_pushed);
+  ASSERT_EQ(inbox_->PopAll(100, Handler), 1);
+}
+
+TEST_F(ShmInboxTest, no_lost_wakeup) {
+  // a lost wakeup leaves the owner asleep for the whole timeout
+  const int32_t timeout_ms = 60000;
+  const int64_t msg_num = 2000;
+  std::atomic<int64_t> recv_num(0);
+  const auto start = std::chrono::steady_clock::now();
+  std::thread owner([&]() {
+    while (recv_num < msg_num) {
+      recv_num += inbox_->PopAll(timeout_ms, [](int64_t, const ActorMsg&) {});
+    }
+  });
+  FOR_RANGE(int64_t, seq, 0, msg_num) {
+    // let the owner drain the ring and go to sleep before every push
+    while (recv_num < seq) { std::this_thread::yield(); }
+    inbox_->Push(seq % kMachineNum, GenMsg(seq));
+  }
+  owner.join();
+  ASSERT_LT(ElapsedSec(start), timeout_ms / 1000 / 2);
+}
+
+TEST_F(ShmInboxTest, wake_stops_waiting) {
+  const int32_t timeout_ms = 60000;
+  size_t msg_cnt = 1;
+  const auto start = std::chrono::steady_clock::now();
+  std::thread owner(
+      [&]() { msg_cnt = inbox_->PopAll(timeout_ms, [](int64_t, const ActorMsg&) {}); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  inbox_->Wake();
+  owner.join();
+  ASSERT_EQ(msg_cnt, 0);
+  ASSERT_LT(ElapsedSec(start), timeout_ms / 1000 / 2);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // PLATFORM_POSIX
@@ -19,11 +19,13 @@ limitations under the License.
 
 namespace oneflow {
 
-SocketHelper::SocketHelper(int sockfd, IOEventPoller* poller) {
-  read_helper_ = new SocketReadHelper(sockfd);
-  write_helper_ = new SocketWriteHelper(sockfd, poller);
+SocketHelper::SocketHelper(int sockfd, IOEventPoller* poller, SocketPeerStat* peer_stat,
+                           bool zero_copy) {
+  read_helper_ = new SocketReadHelper(sockfd, peer_stat);
+  write_helper_ = new SocketWriteHelper(sockfd, poller, peer_stat, zero_copy);
   poller->AddFd(sockfd, [this]() { read_helper_->NotifyMeSocketReadable(); },
-                [this]() { write_helper_->NotifyMeSocketWriteable(); });
+                [this]() { write_helper_->NotifyMeSocketWriteable(); },
+                [this]() { write_helper_->NotifyMeSocketError(); });
 }
 
 SocketHelper::~SocketHelper() {
@@ -30,7 +30,7 @@ class SocketHelper final {
   SocketHelper() = delete;
   ~SocketHelper();
 
-  SocketHelper(int sockfd, IOEventPoller* poller);
+  SocketHelper(int sockfd, IOEventPoller* poller, SocketPeerStat* peer_stat, bool zero_copy);
 
   void AsyncWrite(const SocketMsg& msg);
 
@@ -0,0 +1,64 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/socket_message.h"
+#include "oneflow/core/common/balanced_splitter.h"
+
+#ifdef PLATFORM_POSIX
+
+namespace oneflow {
+
+std::vector<RequestWriteMsg> GenRequestWriteStripes(void* read_id, void* src_token,
+                                                    int64_t dst_machine_id, void* dst_token,
+                                                    int64_t byte_size, int32_t socket_num,
+                                                    size_t stripe_min_byte,
+                                                    int32_t first_socket_id) {
+  const int32_t stripe_num = static_cast<int32_t>(std::max<int64_t>(
+      std::min<int64_t>(socket_num, byte_size / std::max<size_t>(stripe_min_byte, 1)), 1));
+  void* stripe_read_id = read_id;
+  if (stripe_num > 1) {
+    SocketStripedRead* striped_read = new SocketStripedRead;
+    striped_read->read_id = read_id;
+    striped_read->remaining_stripe_num = stripe_num;
+    stripe_read_id = striped_read;
+  }
+  std::vector<RequestWriteMsg> stripes(stripe_num);
+  BalancedSplitter splitter(byte_size, stripe_num);
+  FOR_RANGE(int32_t, i, 0, stripe_num) {
+    RequestWriteMsg& stripe = stripes.at(i);
+    stripe.src_token = src_token;
+    stripe.dst_machine_id = dst_machine_id;
+    stripe.dst_token = dst_token;
+    stripe.read_id = stripe_read_id;
+    stripe.offset = splitter.At(i).begin();
+    stripe.byte_size = splitter.At(i).size();
+    stripe.stripe_id = (first_socket_id + i) % socket_num;
+    stripe.stripe_num = stripe_num;
+  }
+  return stripes;
+}
+
+void* FinishReadStripe(void* stripe_read_id, int32_t stripe_num) {
+  if (stripe_num == 1) { return stripe_read_id; }
+  auto striped_read = static_cast<SocketStripedRead*>(stripe_read_id);
+  if (--striped_read->remaining_stripe_num > 0) { return nullptr; }
+  void* read_id = striped_read->read_id;
+  delete striped_read;
+  return read_id;
+}
+
+}  // namespace oneflow
+
+#endif  // PLATFORM_POSIX
@@ -45,17 +45,26 @@ enum class SocketMsgType {
 #undef MAKE_ENTRY
 };
 
+// A read may be striped over several sockets of the same peer, each stripe moves
+// [offset, offset + byte_size) of the register and is sent on socket stripe_id
 struct RequestWriteMsg {
   void* src_token;
   int64_t dst_machine_id;
   void* dst_token;
   void* read_id;
+  int64_t offset;
+  int64_t byte_size;
+  int32_t stripe_id;
+  int32_t stripe_num;
 };
 
 struct RequestReadMsg {
   void* src_token;
   void* dst_token;
   void* read_id;
+  int64_t offset;
+  int64_t byte_size;
+  int32_t stripe_num;
 };
 
 struct SocketMsg {
@@ -67,6 +76,48 @@ struct SocketMsg {
   };
 };
 
+// read_id of a striped read, ReadDone is called when the last stripe arrives
+struct SocketStripedRead {
+  void* read_id;
+  std::atomic<int32_t> remaining_stripe_num;
+};
+
+// The RequestWrite msgs of a read. A read of at least twice stripe_min_byte is split into balanced
+// stripes over at most socket_num sockets, starting from first_socket_id, and shares a
+// SocketStripedRead as read_id
+std::vector<RequestWriteMsg> GenRequestWriteStripes(void* read_id, void* src_token,
+                                                    int64_t dst_machine_id, void* dst_token,
+                                                    int64_t byte_size, int32_t socket_num,
+                                                    size_t stripe_min_byte,
+                                                    int32_t first_socket_id);
+// Called once the body of a stripe has arrived, returns the read_id for ReadDone after the last
+// stripe of a read, nullptr before
+void* FinishReadStripe(void* stripe_read_id, int32_t stripe_num);
+
+struct SocketPeerStat {
+  SocketPeerStat()
+      : sent_byte(0),
+        recv_byte(0),
+        sent_msg_num(0),
+        recv_msg_num(0),
+        write_call_num(0),
+        sent_batch_num(0),
+        wakeup_num(0),
+        saved_wakeup_num(0),
+        credit_wait_num(0) {}
+  std::atomic<int64_t> sent_byte;
+  std::atomic<int64_t> recv_byte;
+  std::atomic<int64_t> sent_msg_num;
+  std::atomic<int64_t> recv_msg_num;
+  std::atomic<int64_t> write_call_num;
+  // msgs are written in batches, a sender wakes the poller only when it is idle
+  std::atomic<int64_t> sent_batch_num;
+  std::atomic<int64_t> wakeup_num;
+  std::atomic<int64_t> saved_wakeup_num;
+  // actor msgs blocked because the socket had no credit left
+  std::atomic<int64_t> credit_wait_num;
+};
+
 using CallBackList = std::list<std::function<void()>>;
 
 }  // namespace oneflow
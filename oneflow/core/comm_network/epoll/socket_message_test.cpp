@@ -0,0 +1,112 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/socket_message.h"
+#include <random>
+
+#ifdef PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+void WriteFully(int sockfd, const char* ptr, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(sockfd, ptr, size);
+    ASSERT_GT(n, 0);
+    ptr += n;
+    size -= n;
+  }
+}
+
+void ReadFully(int sockfd, char* ptr, size_t size) {
+  while (size > 0) {
+    ssize_t n = read(sockfd, ptr, size);
+    ASSERT_GT(n, 0);
+    ptr += n;
+    size -= n;
+  }
+}
+
+// Moves every stripe over a socket of its own, the stripes land concurrently and in any order
+void TestStripedRead(int64_t byte_size, int32_t socket_num, size_t stripe_min_byte,
+                     int32_t expected_stripe_num) {
+  std::vector<char> src(byte_size);
+  std::mt19937 gen(byte_size);
+  for (char& c : src) { c = static_cast<char>(gen()); }
+  std::vector<char> dst(byte_size, 0);
+  int read_ctx = 0;
+  void* read_id = &read_ctx;
+  const int32_t first_socket_id = socket_num - 1;
+  const std::vector<RequestWriteMsg> stripes = GenRequestWriteStripes(
+      read_id, src.data(), 0, dst.data(), byte_size, socket_num, stripe_min_byte, first_socket_id);
+  ASSERT_EQ(stripes.size(), expected_stripe_num);
+  int64_t offset = 0;
+  std::set<int32_t> stripe_ids;
+  FOR_RANGE(int32_t, i, 0, stripes.size()) {
+    const RequestWriteMsg& stripe = stripes.at(i);
+    ASSERT_EQ(stripe.offset, offset);
+    ASSERT_GT(stripe.byte_size, 0);
+    ASSERT_EQ(stripe.stripe_num, expected_stripe_num);
+    ASSERT_EQ(stripe.stripe_id, (first_socket_id + i) % socket_num);
+    ASSERT_TRUE(stripe_ids.insert(stripe.stripe_id).second);
+    if (expected_stripe_num == 1) { ASSERT_EQ(stripe.read_id, read_id); }
+    offset += stripe.byte_size;
+  }
+  ASSERT_EQ(offset, byte_size);
+
+  std::atomic<int32_t> read_done_num(0);
+  std::vector<std::thread> threads;
+  for (const RequestWriteMsg& stripe : stripes) {
+    int sockfds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockfds), 0);
+    threads.emplace_back([&src, stripe, sockfds]() {
+      WriteFully(sockfds[0], src.data() + stripe.offset, stripe.byte_size);
+      close(sockfds[0]);
+    });
+    threads.emplace_back([&dst, &read_done_num, read_id, stripe, sockfds]() {
+      ReadFully(sockfds[1], dst.data() + stripe.offset, stripe.byte_size);
+      close(sockfds[1]);
+      void* done_read_id = FinishReadStripe(stripe.read_id, stripe.stripe_num);
+      if (done_read_id != nullptr) {
+        ASSERT_EQ(done_read_id, read_id);
+        read_done_num += 1;
+      }
+    });
+  }
+  for (std::thread& thread : threads) { thread.join(); }
+  ASSERT_EQ(read_done_num, 1);
+  ASSERT_TRUE(src == dst);
+}
+
+}  // namespace
+
+TEST(SocketStripedRead, uneven_stripes) { TestStripedRead(1000003, 3, 1000, 3); }
+
+TEST(SocketStripedRead, fewer_stripes_than_sockets) { TestStripedRead(2500, 4, 1000, 2); }
+
+TEST(SocketStripedRead, small_read_is_not_striped) { TestStripedRead(1999, 4, 1000, 1); }
+
+TEST(SocketStripedRead, many_reads) {
+  FOR_RANGE(int32_t, i, 0, 20) { TestStripedRead(8 * 1024 + i * 977, 8, 1024, 8); }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // PLATFORM_POSIX
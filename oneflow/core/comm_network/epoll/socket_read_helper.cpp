@@ -27,8 +27,9 @@ SocketReadHelper::~SocketReadHelper() {
   // do nothing
 }
 
-SocketReadHelper::SocketReadHelper(int sockfd) {
+SocketReadHelper::SocketReadHelper(int sockfd, SocketPeerStat* peer_stat) {
   sockfd_ = sockfd;
+  peer_stat_ = peer_stat;
   SwitchToMsgHeadReadHandle();
 }
 
@@ -71,6 +72,7 @@ bool SocketReadHelper::DoCurRead(void (SocketReadHelper::*set_cur_read_done)())
 }
 
 void SocketReadHelper::SetStatusWhenMsgHeadDone() {
+  peer_stat_->recv_msg_num += 1;
   switch (cur_msg_.msg_type) {
 #define MAKE_ENTRY(x, y) \
   case SocketMsgType::k##x: SetStatusWhen##x##MsgHeadDone(); break;
@@ -82,7 +84,10 @@ void SocketReadHelper::SetStatusWhenMsgHeadDone() {
 
 void SocketReadHelper::SetStatusWhenMsgBodyDone() {
   if (cur_msg_.msg_type == SocketMsgType::kRequestRead) {
-    Global<EpollCommNet>::Get()->ReadDone(cur_msg_.request_read_msg.read_id);
+    const RequestReadMsg& read_msg = cur_msg_.request_read_msg;
+    peer_stat_->recv_byte += read_msg.byte_size;
+    void* read_id = FinishReadStripe(read_msg.read_id, read_msg.stripe_num);
+    if (read_id != nullptr) { Global<EpollCommNet>::Get()->ReadDone(read_id); }
   }
   SwitchToMsgHeadReadHandle();
 }
@@ -93,15 +98,18 @@ void SocketReadHelper::SetStatusWhenRequestWriteMsgHeadDone() {
   msg_to_send.request_read_msg.src_token = cur_msg_.request_write_msg.src_token;
   msg_to_send.request_read_msg.dst_token = cur_msg_.request_write_msg.dst_token;
   msg_to_send.request_read_msg.read_id = cur_msg_.request_write_msg.read_id;
+  msg_to_send.request_read_msg.offset = cur_msg_.request_write_msg.offset;
+  msg_to_send.request_read_msg.byte_size = cur_msg_.request_write_msg.byte_size;
+  msg_to_send.request_read_msg.stripe_num = cur_msg_.request_write_msg.stripe_num;
   Global<EpollCommNet>::Get()->SendSocketMsg(cur_msg_.request_write_msg.dst_machine_id,
-                                             msg_to_send);
+                                             cur_msg_.request_write_msg.stripe_id, msg_to_send);
   SwitchToMsgHeadReadHandle();
 }
 
 void SocketReadHelper::SetStatusWhenRequestReadMsgHeadDone() {
   auto mem_desc = static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token);
-  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr);
-  read_size_ = mem_desc->byte_size;
+  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr) + cur_msg_.request_read_msg.offset;
+  read_size_ = cur_msg_.request_read_msg.byte_size;
   cur_read_handle_ = &SocketReadHelper::MsgBodyReadHandle;
 }
 
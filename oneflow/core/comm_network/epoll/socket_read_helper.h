@@ -28,7 +28,7 @@ class SocketReadHelper final {
   SocketReadHelper() = delete;
   ~SocketReadHelper();
 
-  SocketReadHelper(int sockfd);
+  SocketReadHelper(int sockfd, SocketPeerStat* peer_stat);
 
   void NotifyMeSocketReadable();
 
@@ -48,6 +48,7 @@ class SocketReadHelper final {
 #undef MAKE_ENTRY
 
   int sockfd_;
+  SocketPeerStat* peer_stat_;
 
   SocketMsg cur_msg_;
   bool (SocketReadHelper::*cur_read_handle_)();
@@ -15,13 +15,35 @@ limitations under the License.
 */
 #include "oneflow/core/comm_network/epoll/socket_write_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
 
 #ifdef PLATFORM_POSIX
 
+#include <cstring>
+#include <linux/errqueue.h>
 #include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
 
 namespace oneflow {
 
+namespace {
+
+const size_t kMaxBatchMsgNum = 64;
+const size_t kZeroCopyMinByte = 64 * 1024;
+
+}  // namespace
+
 SocketWriteHelper::~SocketWriteHelper() {
   delete cur_msg_queue_;
   cur_msg_queue_ = nullptr;
@@ -30,114 +52,234 @@ SocketWriteHelper::~SocketWriteHelper() {
     delete pending_msg_queue_;
     pending_msg_queue_ = nullptr;
   }
+  PCHECK(close(queue_not_empty_fd_) == 0);
+  if (batch_timer_fd_ != -1) { PCHECK(close(batch_timer_fd_) == 0); }
 }
 
-SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller) {
+SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller, SocketPeerStat* peer_stat,
+                                     bool zero_copy) {
   sockfd_ = sockfd;
+  peer_stat_ = peer_stat;
+  zero_copy_ = zero_copy;
   queue_not_empty_fd_ = eventfd(0, 0);
   PCHECK(queue_not_empty_fd_ != -1);
   poller->AddFdWithOnlyReadHandler(queue_not_empty_fd_,
                                    std::bind(&SocketWriteHelper::ProcessQueueNotEmptyEvent, this));
+  const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
+  batch_delay_us_ = resource_desc->comm_net_actor_msg_batch_delay_us();
+  batch_timer_fd_ = -1;
+  if (batch_delay_us_ > 0) {
+    batch_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    PCHECK(batch_timer_fd_ != -1);
+    poller->AddFdWithOnlyReadHandler(batch_timer_fd_,
+                                     std::bind(&SocketWriteHelper::ProcessBatchTimerEvent, this));
+  }
+  write_state_ = kIdle;
+  actor_msg_credit_ = resource_desc->comm_net_max_pending_actor_msg_num();
+  CHECK_GT(actor_msg_credit_, 0);
   cur_msg_queue_ = new std::queue<SocketMsg>;
   pending_msg_queue_ = new std::queue<SocketMsg>;
+  batch_msgs_.reserve(kMaxBatchMsgNum);
   cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-  write_ptr_ = nullptr;
-  write_size_ = 0;
+  iov_begin_ = 0;
+  iov_end_ = 0;
+  cur_body_byte_ = 0;
 }
 
 void SocketWriteHelper::AsyncWrite(const SocketMsg& msg) {
-  pending_msg_queue_mtx_.lock();
-  bool need_send_event = pending_msg_queue_->empty();
-  pending_msg_queue_->push(msg);
-  pending_msg_queue_mtx_.unlock();
-  if (need_send_event) { SendQueueNotEmptyEvent(); }
+  const bool is_actor_msg = msg.msg_type == SocketMsgType::kActor;
+  size_t pending_msg_num = 0;
+  {
+    std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
+    // only actor threads wait for credits, the poller itself never blocks here
+    if (is_actor_msg) {
+      if (actor_msg_credit_ == 0) {
+        peer_stat_->credit_wait_num += 1;
+        actor_msg_credit_cv_.wait(lck, [this]() { return actor_msg_credit_ > 0; });
+      }
+      actor_msg_credit_ -= 1;
+    }
+    pending_msg_queue_->push(msg);
+    pending_msg_num = pending_msg_queue_->size();
+  }
+  // data requests and full batches go out at once, other actor msgs may wait for company
+  if (batch_delay_us_ > 0 && is_actor_msg && pending_msg_num < kMaxBatchMsgNum) {
+    int32_t idle = kIdle;
+    if (write_state_.compare_exchange_strong(idle, kTimerArmed)) {
+      ArmBatchTimer();
+    } else {
+      peer_stat_->saved_wakeup_num += 1;
+    }
+  } else if (write_state_.exchange(kScheduled) != kScheduled) {
+    SendQueueNotEmptyEvent();
+  } else {
+    peer_stat_->saved_wakeup_num += 1;
+  }
 }
 
 void SocketWriteHelper::NotifyMeSocketWriteable() { WriteUntilMsgQueueEmptyOrSocketNotWriteable(); }
 
+void SocketWriteHelper::NotifyMeSocketError() {
+  DrainZeroCopyCompletions();
+  int err = 0;
+  socklen_t len = sizeof(err);
+  PCHECK(getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &err, &len) == 0);
+  CHECK_EQ(err, 0) << "fd " << sockfd_ << ": " << strerror(err);
+}
+
 void SocketWriteHelper::SendQueueNotEmptyEvent() {
+  peer_stat_->wakeup_num += 1;
   uint64_t event_num = 1;
   PCHECK(write(queue_not_empty_fd_, &event_num, 8) == 8);
 }
 
+void SocketWriteHelper::ArmBatchTimer() {
+  peer_stat_->wakeup_num += 1;
+  itimerspec timer_spec;
+  memset(&timer_spec, 0, sizeof(timer_spec));
+  timer_spec.it_value.tv_sec = batch_delay_us_ / 1000000;
+  timer_spec.it_value.tv_nsec = (batch_delay_us_ % 1000000) * 1000;
+  PCHECK(timerfd_settime(batch_timer_fd_, 0, &timer_spec, nullptr) == 0);
+}
+
 void SocketWriteHelper::ProcessQueueNotEmptyEvent() {
   uint64_t event_num = 0;
   PCHECK(read(queue_not_empty_fd_, &event_num, 8) == 8);
   WriteUntilMsgQueueEmptyOrSocketNotWriteable();
 }
 
+void SocketWriteHelper::ProcessBatchTimerEvent() {
+  uint64_t expiration_num = 0;
+  if (read(batch_timer_fd_, &expiration_num, 8) == -1) {
+    PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+  write_state_ = kScheduled;
+  WriteUntilMsgQueueEmptyOrSocketNotWriteable();
+}
+
 void SocketWriteHelper::WriteUntilMsgQueueEmptyOrSocketNotWriteable() {
   while ((this->*cur_write_handle_)()) {}
 }
 
-bool SocketWriteHelper::InitMsgWriteHandle() {
+bool SocketWriteHelper::PopMsg(SocketMsg* msg) {
   if (cur_msg_queue_->empty()) {
-    {
-      std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
-      std::swap(cur_msg_queue_, pending_msg_queue_);
-    }
-    if (cur_msg_queue_->empty()) { return false; }
+    std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
+    std::swap(cur_msg_queue_, pending_msg_queue_);
   }
-  cur_msg_ = cur_msg_queue_->front();
+  if (cur_msg_queue_->empty()) { return false; }
+  *msg = cur_msg_queue_->front();
   cur_msg_queue_->pop();
-  write_ptr_ = reinterpret_cast<const char*>(&cur_msg_);
-  write_size_ = sizeof(cur_msg_);
-  cur_write_handle_ = &SocketWriteHelper::MsgHeadWriteHandle;
   return true;
 }
 
-bool SocketWriteHelper::MsgHeadWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgHeadDone);
-}
-
-bool SocketWriteHelper::MsgBodyWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgBodyDone);
+bool SocketWriteHelper::InitMsgWriteHandle() {
+  batch_msgs_.clear();
+  iov_begin_ = 0;
+  iov_end_ = 1;
+  cur_body_byte_ = 0;
+  SocketMsg msg;
+  while (batch_msgs_.size() < kMaxBatchMsgNum && PopMsg(&msg)) {
+    batch_msgs_.push_back(msg);
+    if (msg.msg_type == SocketMsgType::kRequestRead) {
+      auto src_mem_desc = static_cast<const SocketMemDesc*>(msg.request_read_msg.src_token);
+      iov_[1].iov_base = static_cast<char*>(src_mem_desc->mem_ptr) + msg.request_read_msg.offset;
+      iov_[1].iov_len = msg.request_read_msg.byte_size;
+      cur_body_byte_ = msg.request_read_msg.byte_size;
+      iov_end_ = 2;
+      break;
+    }
+  }
+  if (batch_msgs_.empty()) {
+    // senders wake the poller again from now on, unless a msg slipped in before the store
+    write_state_ = kIdle;
+    {
+      std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
+      if (pending_msg_queue_->empty()) { return false; }
+    }
+    int32_t idle = kIdle;
+    write_state_.compare_exchange_strong(idle, kScheduled);
+    return true;
+  }
+  iov_[0].iov_base = batch_msgs_.data();
+  iov_[0].iov_len = batch_msgs_.size() * sizeof(SocketMsg);
+  cur_write_handle_ = &SocketWriteHelper::MsgWriteHandle;
+  return true;
 }
 
-bool SocketWriteHelper::DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)()) {
-  ssize_t n = write(sockfd_, write_ptr_, write_size_);
-  if (n == write_size_) {
-    (this->*set_cur_write_done)();
-    return true;
-  } else if (n >= 0) {
-    write_ptr_ += n;
-    write_size_ -= n;
-    return true;
-  } else {
-    CHECK_EQ(n, -1);
+bool SocketWriteHelper::MsgWriteHandle() {
+  ssize_t n = WriteCurIov();
+  if (n == -1) {
     PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
     return false;
   }
-}
-
-void SocketWriteHelper::SetStatusWhenMsgHeadDone() {
-  switch (cur_msg_.msg_type) {
-#define MAKE_ENTRY(x, y) \
-  case SocketMsgType::k##x: return SetStatusWhen##x##MsgHeadDone();
-    OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
-#undef MAKE_ENTRY
-    default: UNIMPLEMENTED();
+  size_t remain = n;
+  while (iov_begin_ < iov_end_ && remain >= iov_[iov_begin_].iov_len) {
+    remain -= iov_[iov_begin_].iov_len;
+    iov_begin_ += 1;
   }
+  if (remain > 0) {
+    iov_[iov_begin_].iov_base = static_cast<char*>(iov_[iov_begin_].iov_base) + remain;
+    iov_[iov_begin_].iov_len -= remain;
+  }
+  if (iov_begin_ == iov_end_) {
+    peer_stat_->sent_byte += cur_body_byte_;
+    peer_stat_->sent_msg_num += batch_msgs_.size();
+    peer_stat_->sent_batch_num += 1;
+    const int64_t actor_msg_num =
+        std::count_if(batch_msgs_.cbegin(), batch_msgs_.cend(), [](const SocketMsg& msg) {
+          return msg.msg_type == SocketMsgType::kActor;
+        });
+    if (actor_msg_num > 0) {
+      std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
+      actor_msg_credit_ += actor_msg_num;
+      actor_msg_credit_cv_.notify_all();
+    }
+    cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+  }
+  return true;
 }
 
-void SocketWriteHelper::SetStatusWhenMsgBodyDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-}
-
-void SocketWriteHelper::SetStatusWhenRequestWriteMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-}
-
-void SocketWriteHelper::SetStatusWhenRequestReadMsgHeadDone() {
-  const void* src_token = cur_msg_.request_read_msg.src_token;
-  auto src_mem_desc = static_cast<const SocketMemDesc*>(src_token);
-  write_ptr_ = reinterpret_cast<const char*>(src_mem_desc->mem_ptr);
-  write_size_ = src_mem_desc->byte_size;
-  cur_write_handle_ = &SocketWriteHelper::MsgBodyWriteHandle;
+ssize_t SocketWriteHelper::WriteCurIov() {
+  peer_stat_->write_call_num += 1;
+  if (zero_copy_ && iov_begin_ == 1 && iov_[1].iov_len >= kZeroCopyMinByte) {
+    // The register is not reused before the peer has received the whole body and answered
+    // through the actor protocol, so pages still pinned by the kernel are never rewritten
+    // before they hit the wire
+    ssize_t n = send(sockfd_, iov_[1].iov_base, iov_[1].iov_len, MSG_ZEROCOPY);
+    if (n != -1 || errno != ENOBUFS) { return n; }
+    // too many outstanding notifications (optmem_max), reap them and fall back to a copy
+    DrainZeroCopyCompletions();
+  }
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov_ + iov_begin_;
+  msg.msg_iovlen = iov_end_ - iov_begin_;
+  return sendmsg(sockfd_, &msg, 0);
 }
 
-void SocketWriteHelper::SetStatusWhenActorMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+void SocketWriteHelper::DrainZeroCopyCompletions() {
+  char control[128];
+  while (true) {
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sockfd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+      PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      return;
+    }
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (cm->cmsg_level != SOL_IP || cm->cmsg_type != IP_RECVERR) { continue; }
+      auto* serr = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+      CHECK_EQ(serr->ee_origin, SO_EE_ORIGIN_ZEROCOPY);
+      CHECK_EQ(serr->ee_errno, 0);
+      if (zero_copy_ && (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)) {
+        // the kernel copied anyway (e.g. loopback), zero copy only adds notification cost
+        LOG(INFO) << "CommNet:Epoll fd " << sockfd_ << " falls back to copying send";
+        zero_copy_ = false;
+      }
+    }
+  }
 }
 
 }  // namespace oneflow
@@ -21,6 +21,8 @@ limitations under the License.
 
 #ifdef PLATFORM_POSIX
 
+#include <sys/uio.h>
+
 namespace oneflow {
 
 class SocketWriteHelper final {
@@ -29,41 +31,56 @@ class SocketWriteHelper final {
   SocketWriteHelper() = delete;
   ~SocketWriteHelper();
 
-  SocketWriteHelper(int sockfd, IOEventPoller* poller);
+  SocketWriteHelper(int sockfd, IOEventPoller* poller, SocketPeerStat* peer_stat, bool zero_copy);
 
+  // Blocks while the socket has no credit left for another actor msg
   void AsyncWrite(const SocketMsg& msg);
 
   void NotifyMeSocketWriteable();
+  void NotifyMeSocketError();
 
  private:
+  // kIdle: the poller drained the queue, kTimerArmed: a batch delay timer will wake it,
+  // kScheduled: it is or will be writing and needs no further wakeup
+  enum WriteState { kIdle = 0, kTimerArmed, kScheduled };
+
   void SendQueueNotEmptyEvent();
+  void ArmBatchTimer();
   void ProcessQueueNotEmptyEvent();
+  void ProcessBatchTimerEvent();
 
   void WriteUntilMsgQueueEmptyOrSocketNotWriteable();
   bool InitMsgWriteHandle();
-  bool MsgHeadWriteHandle();
-  bool MsgBodyWriteHandle();
-
-  bool DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)());
-  void SetStatusWhenMsgHeadDone();
-  void SetStatusWhenMsgBodyDone();
+  bool MsgWriteHandle();
 
-#define MAKE_ENTRY(x, y) void SetStatusWhen##x##MsgHeadDone();
-  OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
-#undef MAKE_ENTRY
+  bool PopMsg(SocketMsg* msg);
+  ssize_t WriteCurIov();
+  void DrainZeroCopyCompletions();
 
   int sockfd_;
   int queue_not_empty_fd_;
+  int batch_timer_fd_;
+  int32_t batch_delay_us_;
+  SocketPeerStat* peer_stat_;
+  bool zero_copy_;
+  std::atomic<int32_t> write_state_;
 
   std::queue<SocketMsg>* cur_msg_queue_;
 
   std::mutex pending_msg_queue_mtx_;
   std::queue<SocketMsg>* pending_msg_queue_;
+  // every queued actor msg takes a credit, it is given back once the msg is written
+  int64_t actor_msg_credit_;
+  std::condition_variable actor_msg_credit_cv_;
 
-  SocketMsg cur_msg_;
+  // header-only msgs are batched into one write, a RequestRead may close the batch and its
+  // body is sent in the same sendmsg as the headers
+  std::vector<SocketMsg> batch_msgs_;
   bool (SocketWriteHelper::*cur_write_handle_)();
-  const char* write_ptr_;
-  size_t write_size_;
+  iovec iov_[2];
+  int32_t iov_begin_;
+  int32_t iov_end_;
+  int64_t cur_body_byte_;
 };
 
 }  // namespace oneflow
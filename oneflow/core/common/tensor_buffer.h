@@ -19,7 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/shape.h"
 #include "oneflow/core/common/data_type.h"
 #include "oneflow/core/common/util.h"
-#include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/memory/host_staging_pool.h"
 
 namespace oneflow {
 
@@ -31,7 +31,7 @@ inline void CheckTensorBufferDataType(DataType val) {
 class TensorBuffer {
  public:
   struct Deleter {
-    void operator()(void* ptr) { MemoryAllocatorImpl::DeallocateUnPinnedHostMem(ptr); }
+    void operator()(void* ptr) { DeallocateStagingHostMem(ptr); }
   };
   typedef std::unique_ptr<void, Deleter> BufferType;
 
@@ -79,7 +79,7 @@ class TensorBuffer {
   void reserve(size_t new_num_bytes) {
     if (new_num_bytes <= num_bytes_) { return; }
     data_.reset();
-    data_.reset(MemoryAllocatorImpl::AllocateUnPinnedHostMem(new_num_bytes));
+    data_.reset(AllocateStagingHostMem(new_num_bytes));
     num_bytes_ = new_num_bytes;
   }
 
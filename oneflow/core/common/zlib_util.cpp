@@ -0,0 +1,41 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/zlib_util.h"
+#include "oneflow/core/common/util.h"
+#include <zlib.h>
+
+namespace oneflow {
+
+void ZlibCompress(const std::string& raw, std::string* compressed) {
+  uLongf compressed_size = compressBound(raw.size());
+  compressed->resize(compressed_size);
+  CHECK_EQ(compress2(reinterpret_cast<Bytef*>(&compressed->at(0)), &compressed_size,
+                     reinterpret_cast<const Bytef*>(raw.data()), raw.size(), Z_BEST_SPEED),
+           Z_OK);
+  compressed->resize(compressed_size);
+}
+
+void ZlibDecompress(const std::string& compressed, size_t raw_byte_size, std::string* raw) {
+  uLongf raw_size = raw_byte_size;
+  raw->resize(raw_size);
+  if (raw_size == 0) { return; }
+  CHECK_EQ(uncompress(reinterpret_cast<Bytef*>(&raw->at(0)), &raw_size,
+                      reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()),
+           Z_OK);
+  CHECK_EQ(raw_size, raw_byte_size);
+}
+
+}  // namespace oneflow
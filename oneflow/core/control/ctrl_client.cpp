@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/job/machine_context.h"
 #include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/common/zlib_util.h"
 
 namespace oneflow {
 
@@ -129,12 +130,51 @@ void CtrlClient::PullKV(const std::string& k, PbMessage* msg) {
   PullKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void CtrlClient::PushKVToMachine(int64_t machine_id, const std::string& k,
+                                 const std::string& v) {
+  ClientCall<CtrlMethod::kPushKV> call;
+  call.mut_request()->set_key(k);
+  call.mut_request()->set_val(v);
+  call(stubs_.at(machine_id).get());
+}
+
+void CtrlClient::PushKVToMachine(int64_t machine_id, const std::string& k,
+                                 const PbMessage& msg) {
+  ClientCall<CtrlMethod::kPushKV> call;
+  call.mut_request()->set_key(k);
+  msg.SerializeToString(call.mut_request()->mutable_val());
+  call(stubs_.at(machine_id).get());
+}
+
+void CtrlClient::PullLocalKV(const std::string& k, std::string* v) {
+  ClientCall<CtrlMethod::kPullKV> call;
+  call.mut_request()->set_key(k);
+  call(GetThisStub());
+  *v = call.response().val();
+}
+
+void CtrlClient::PullLocalKV(const std::string& k, PbMessage* msg) {
+  ClientCall<CtrlMethod::kPullKV> call;
+  call.mut_request()->set_key(k);
+  call(GetThisStub());
+  CHECK(msg->ParseFromString(call.response().val()));
+}
+
 void CtrlClient::PushActEvent(const ActEvent& act_event) {
   ClientCall<CtrlMethod::kPushActEvent> call;
   *(call.mut_request()->mutable_act_event()) = act_event;
   call(GetMasterStub());
 }
 
+void CtrlClient::PushActEventBatch(const ActEventBatch& act_event_batch) {
+  ClientCall<CtrlMethod::kPushActEventBatch> call;
+  std::string raw;
+  act_event_batch.SerializeToString(&raw);
+  call.mut_request()->set_raw_byte_size(raw.size());
+  ZlibCompress(raw, call.mut_request()->mutable_compressed_act_event_batch());
+  call(GetMasterStub());
+}
+
 void CtrlClient::Clear() {
   ClientCall<CtrlMethod::kClear> call;
   call(GetThisStub());
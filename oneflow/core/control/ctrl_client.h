@@ -54,7 +54,14 @@ class CtrlClient final {
     *v = oneflow_cast<T>(v_str);
   }
 
+  // bypass the key hashing and talk to the ctrl server of one machine directly
+  void PushKVToMachine(int64_t machine_id, const std::string& k, const std::string& v);
+  void PushKVToMachine(int64_t machine_id, const std::string& k, const PbMessage& msg);
+  void PullLocalKV(const std::string& k, std::string* v);
+  void PullLocalKV(const std::string& k, PbMessage* msg);
+
   void PushActEvent(const ActEvent&);
+  void PushActEventBatch(const ActEventBatch&);
   void Clear();
 
   int32_t IncreaseCount(const std::string& k, int32_t v);
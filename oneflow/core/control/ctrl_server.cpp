@@ -16,7 +16,9 @@ limitations under the License.
 #include "oneflow/core/control/ctrl_server.h"
 #include "oneflow/core/actor/act_event_logger.h"
 #include "oneflow/core/job/profiler.h"
+#include "oneflow/core/job/regst_num_tuner.h"
 #include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/common/zlib_util.h"
 #include "grpc/grpc_posix.h"
 
 namespace oneflow {
@@ -188,10 +190,33 @@ void CtrlServer::Init() {
   Add([this](CtrlCall<CtrlMethod::kPushActEvent>* call) {
     ActEvent act_event = call->request().act_event();
     call->SendResponse();
-    Global<ActEventLogger>::Get()->PrintActEventToLogDir(act_event);
+    if (Global<ActEventLogger>::Get() != nullptr) {
+      Global<ActEventLogger>::Get()->PrintActEventToLogDir(act_event);
+    }
+    if (Global<RegstNumTuner>::Get() != nullptr) {
+      Global<RegstNumTuner>::Get()->AddActEvent(act_event);
+    }
     EnqueueRequest<CtrlMethod::kPushActEvent>();
   });
 
+  Add([this](CtrlCall<CtrlMethod::kPushActEventBatch>* call) {
+    std::string raw;
+    ZlibDecompress(call->request().compressed_act_event_batch(), call->request().raw_byte_size(),
+                   &raw);
+    call->SendResponse();
+    ActEventBatch act_event_batch;
+    CHECK(act_event_batch.ParseFromString(raw));
+    for (const ActEvent& act_event : act_event_batch.act_event()) {
+      if (Global<ActEventLogger>::Get() != nullptr) {
+        Global<ActEventLogger>::Get()->PrintActEventToLogDir(act_event);
+      }
+      if (Global<RegstNumTuner>::Get() != nullptr) {
+        Global<RegstNumTuner>::Get()->AddActEvent(act_event);
+      }
+    }
+    EnqueueRequest<CtrlMethod::kPushActEventBatch>();
+  });
+
   Add([this](CtrlCall<CtrlMethod::kClear>* call) {
     name2lock_status_.clear();
     kv_.clear();
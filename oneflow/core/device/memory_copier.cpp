@@ -15,12 +15,15 @@ limitations under the License.
 */
 #include "oneflow/core/device/memory_copier.h"
 #include "oneflow/core/common/auto_registration_factory.h"
-#include "oneflow/core/common/nd_index_offset_helper.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
 namespace {
 
+// copies smaller than this stay on the calling thread
+const int64_t kHostCopyMinBytePerThread = 256 * 1024;
+
 int64_t MemoryCopyNdDescGetNumAxes(const MemoryCopyNdDesc& desc) { return desc.extent.NumAxes(); }
 
 void CheckPosExtent(const int64_t num_axes, const Shape& shape, const NdIndex& pos,
@@ -79,24 +82,53 @@ MemoryCopyNdDesc GetDescInBytes(const MemoryCopyNdDesc& desc) {
 
 template<int32_t NDIMS>
 void CopyNDCpuImpl(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyNdDesc& desc) {
-  NdIndexOffsetHelper<int64_t, NDIMS> src_helper(desc.src_shape.dim_vec().data());
-  NdIndexOffsetHelper<int64_t, NDIMS> dst_helper(desc.dst_shape.dim_vec().data());
-  NdIndexOffsetHelper<int64_t, NDIMS> copy_helper(desc.extent.dim_vec().data());
-  FOR_RANGE(int64_t, i, 0, desc.extent.elem_cnt()) {
-    int64_t copy_idx[NDIMS];
-    int64_t src_idx[NDIMS];
-    int64_t dst_idx[NDIMS];
-    copy_helper.OffsetToNdIndex(i, copy_idx);
-    FOR_RANGE(int64_t, j, 0, NDIMS) {
-      src_idx[j] = desc.src_pos.At(j) + copy_idx[j];
-      dst_idx[j] = desc.dst_pos.At(j) + copy_idx[j];
-    }
-    const int64_t src_offset = src_helper.NdIndexToOffset(src_idx);
-    const int64_t dst_offset = dst_helper.NdIndexToOffset(dst_idx);
-    unsigned char* dst_ptr = reinterpret_cast<unsigned char*>(dst) + dst_offset;
-    const unsigned char* src_ptr = reinterpret_cast<const unsigned char*>(src) + src_offset;
-    *dst_ptr = *src_ptr;
+  // The innermost axis is copied row by row with memcpy, the outer axes are walked like an
+  // odometer so only the first row of each thread needs divisions
+  int64_t extent[NDIMS];
+  int64_t src_stride[NDIMS];
+  int64_t dst_stride[NDIMS];
+  src_stride[NDIMS - 1] = 1;
+  dst_stride[NDIMS - 1] = 1;
+  for (int32_t i = NDIMS - 2; i >= 0; --i) {
+    src_stride[i] = src_stride[i + 1] * desc.src_shape.At(i + 1);
+    dst_stride[i] = dst_stride[i + 1] * desc.dst_shape.At(i + 1);
+  }
+  int64_t src_base_offset = 0;
+  int64_t dst_base_offset = 0;
+  FOR_RANGE(int32_t, i, 0, NDIMS) {
+    extent[i] = desc.extent.At(i);
+    src_base_offset += desc.src_pos.At(i) * src_stride[i];
+    dst_base_offset += desc.dst_pos.At(i) * dst_stride[i];
   }
+  const unsigned char* src_base = reinterpret_cast<const unsigned char*>(src) + src_base_offset;
+  unsigned char* dst_base = reinterpret_cast<unsigned char*>(dst) + dst_base_offset;
+  const int64_t row_size = extent[NDIMS - 1];
+  const int64_t row_num = desc.extent.elem_cnt() / row_size;
+  MultiThreadRangeLoop(
+      row_num, std::max<int64_t>(kHostCopyMinBytePerThread / row_size, 1),
+      [&](size_t begin, size_t end) {
+        int64_t idx[NDIMS];
+        int64_t src_offset = 0;
+        int64_t dst_offset = 0;
+        int64_t remaining = begin;
+        for (int32_t i = NDIMS - 2; i >= 0; --i) {
+          idx[i] = remaining % extent[i];
+          remaining /= extent[i];
+          src_offset += idx[i] * src_stride[i];
+          dst_offset += idx[i] * dst_stride[i];
+        }
+        FOR_RANGE(size_t, row, begin, end) {
+          memcpy(dst_base + dst_offset, src_base + src_offset, row_size);
+          for (int32_t i = NDIMS - 2; i >= 0; --i) {
+            src_offset += src_stride[i];
+            dst_offset += dst_stride[i];
+            if (++idx[i] < extent[i]) { break; }
+            src_offset -= extent[i] * src_stride[i];
+            dst_offset -= extent[i] * dst_stride[i];
+            idx[i] = 0;
+          }
+        }
+      });
 }
 
 MemoryCopyNdDesc MemoryCopyNdDesc::CreateDimReducedDesc() const {
@@ -194,24 +226,35 @@ void MemoryCopier::CopyND(DeviceCtx* ctx, void* dst, const void* src,
   UNIMPLEMENTED();
 }
 
-void HostMemoryCopier::Copy1D(DeviceCtx* ctx, void* dst, const void* src, size_t count) const {
-  memcpy(dst, src, count);
-}
-
-void HostMemoryCopier::CopyND(DeviceCtx* ctx, void* dst, const void* src,
-                              const MemoryCopyNdDesc& desc) const {
-  const int32_t num_axes = desc.src_shape.NumAxes();
-  if (num_axes == 4) {
-    CopyNDCpuImpl<4>(ctx, dst, src, desc);
+void HostMemoryCopier::Copy(DeviceCtx* ctx, void* dst, const void* src,
+                            const MemoryCopyNdDesc& desc) const {
+  CheckMemoryCopyNdDesc(desc);
+  const MemoryCopyNdDesc reduced = desc.CreateDimReducedDesc();
+  const int32_t num_axes = reduced.extent.NumAxes();
+  if (num_axes == 1) {
+    Copy1D(ctx, (unsigned char*)dst + reduced.dst_pos.At(0),
+           (const unsigned char*)src + reduced.src_pos.At(0), reduced.extent.At(0));
+  } else if (num_axes == 2) {
+    CopyNDCpuImpl<2>(ctx, dst, src, reduced);
+  } else if (num_axes == 3) {
+    CopyNDCpuImpl<3>(ctx, dst, src, reduced);
+  } else if (num_axes == 4) {
+    CopyNDCpuImpl<4>(ctx, dst, src, reduced);
   } else if (num_axes == 5) {
-    CopyNDCpuImpl<5>(ctx, dst, src, desc);
+    CopyNDCpuImpl<5>(ctx, dst, src, reduced);
   } else if (num_axes == 6) {
-    CopyNDCpuImpl<6>(ctx, dst, src, desc);
+    CopyNDCpuImpl<6>(ctx, dst, src, reduced);
   } else {
     UNIMPLEMENTED();
   }
 }
 
+void HostMemoryCopier::Copy1D(DeviceCtx* ctx, void* dst, const void* src, size_t count) const {
+  MultiThreadRangeLoop(count, kHostCopyMinBytePerThread, [&](size_t begin, size_t end) {
+    memcpy((unsigned char*)dst + begin, (const unsigned char*)src + begin, end - begin);
+  });
+}
+
 #ifdef WITH_CUDA
 
 void CudaAsyncMemoryCopier::Copy1D(DeviceCtx* ctx, void* dst, const void* src, size_t count) const {
@@ -252,6 +295,8 @@ void CudaAsyncMemoryCopier::CopyND(DeviceCtx* ctx, void* dst, const void* src,
   }
 }
 
+#endif
+
 REGISTER_DEFAULT_MEMORY_COPIER(DeviceType::kCPU, []() { return new HostMemoryCopier(); });
 
 #ifdef WITH_CUDA
@@ -266,8 +311,6 @@ MemoryCopier* NewDefaultMemoryCopier(DeviceType device_type) {
       ->Create();
 }
 
-#endif
-
 #define SPECIALIZE_COPY_ELEM(dtype)                                                        \
   template void MemoryCopier::CopyElem<dtype>(DeviceCtx * ctx, void* dst, const void* src, \
                                               const MemoryCopyNdDesc& desc) const;
@@ -281,6 +324,8 @@ SPECIALIZE_COPY_ELEM(int8_t)
 #define SPECIALIZE_COPY_ND_CPU_IMPL(NDIMS)                                        \
   template void CopyNDCpuImpl<NDIMS>(DeviceCtx * ctx, void* dst, const void* src, \
                                      const MemoryCopyNdDesc& desc);
+SPECIALIZE_COPY_ND_CPU_IMPL(2)
+SPECIALIZE_COPY_ND_CPU_IMPL(3)
 SPECIALIZE_COPY_ND_CPU_IMPL(4)
 SPECIALIZE_COPY_ND_CPU_IMPL(5)
 SPECIALIZE_COPY_ND_CPU_IMPL(6)
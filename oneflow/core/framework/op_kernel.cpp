@@ -19,6 +19,20 @@ namespace oneflow {
 
 namespace user_op {
 
+int32_t GetArgHandle(const std::vector<std::pair<std::string, int32_t>>& inputs,
+                     const std::vector<std::pair<std::string, int32_t>>& outputs,
+                     const std::string& arg_name, int32_t index) {
+  const auto arg = std::make_pair(arg_name, index);
+  FOR_RANGE(int32_t, i, 0, inputs.size()) {
+    if (inputs.at(i) == arg) { return i; }
+  }
+  FOR_RANGE(int32_t, i, 0, outputs.size()) {
+    if (outputs.at(i) == arg) { return inputs.size() + i; }
+  }
+  if (arg_name == "tmp_buffer" && index == 0) { return inputs.size() + outputs.size(); }
+  return -1;
+}
+
 void OpKernel::InferShape(KernelInferContext* ctx) const {
   InferContext* op_infer_ctx = ctx->MutOpInferContext();
   CHECK_NOTNULL(op_infer_ctx);
@@ -34,6 +34,13 @@ class JobDesc;
 
 namespace user_op {
 
+// An arg handle is the position of (arg_name, index) in inputs() followed by outputs() and then
+// the tmp buffer arg, or -1 if the arg does not exist. The init and compute contexts of a kernel
+// agree on it, so kernels can resolve handles once in CreateOpKernelState.
+int32_t GetArgHandle(const std::vector<std::pair<std::string, int32_t>>& inputs,
+                     const std::vector<std::pair<std::string, int32_t>>& outputs,
+                     const std::string& arg_name, int32_t index);
+
 class KernelInitContext {
  public:
   virtual ~KernelInitContext() = default;
@@ -50,8 +57,12 @@ class KernelInitContext {
   virtual const std::vector<std::pair<std::string, int32_t>>& inputs() const = 0;
   virtual const std::vector<std::pair<std::string, int32_t>>& outputs() const = 0;
 
+  int32_t ArgHandle4ArgNameAndIndex(const std::string& arg_name, int32_t index) const {
+    return GetArgHandle(inputs(), outputs(), arg_name, index);
+  }
+
   template<typename T>
-  T Attr(const std::string& attr_name) const {
+  const T& Attr(const std::string& attr_name) const {
     return user_op_conf_.attr<T>(attr_name);
   }
   const UserOpConfWrapper& user_op_conf() const { return user_op_conf_; }
@@ -107,6 +118,7 @@ class KernelComputeContext {
   virtual ~KernelComputeContext() = default;
 
   virtual Tensor* Tensor4ArgNameAndIndex(const std::string& arg_name, int32_t index) = 0;
+  virtual Tensor* Tensor4ArgHandle(int32_t arg_handle) = 0;
   virtual DeviceCtx* device_ctx() = 0;
 
   virtual const TensorDesc* TensorDesc4ArgNameAndIndex(const std::string& arg_name,
@@ -118,8 +130,12 @@ class KernelComputeContext {
   virtual const std::vector<std::pair<std::string, int32_t>>& inputs() const = 0;
   virtual const std::vector<std::pair<std::string, int32_t>>& outputs() const = 0;
 
+  int32_t ArgHandle4ArgNameAndIndex(const std::string& arg_name, int32_t index) const {
+    return GetArgHandle(inputs(), outputs(), arg_name, index);
+  }
+
   template<typename T>
-  T Attr(const std::string& attr_name) const {
+  const T& Attr(const std::string& attr_name) const {
     return user_op_conf_.attr<T>(attr_name);
   }
   const UserOpConfWrapper& user_op_conf() const { return user_op_conf_; }
@@ -14,16 +14,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/graph/node.h"
+#include <atomic>
 
 namespace oneflow {
 
 int64_t NewNodeId() {
-  static int64_t node_id = 0;
+  static std::atomic<int64_t> node_id(0);
   return node_id++;
 }
 
 int64_t NewEdgeId() {
-  static int64_t edge_id = 0;
+  static std::atomic<int64_t> edge_id(0);
   return edge_id++;
 }
 
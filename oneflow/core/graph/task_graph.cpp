@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/register/runtime_blob_desc.h"
 #include "oneflow/core/job/thrd_id_generator.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/operator/variable_op.h"
 #include "oneflow/core/operator/user_op_util.h"
 #include "oneflow/core/graph/op_graph.h"
@@ -275,6 +276,36 @@ void TaskGraph::MdUpdtDelayedTopoForEachNode(std::function<void(TaskNode* node)>
   ForEachNode([&](TaskNode* node) { CHECK(built_nodes.find(node) != built_nodes.end()); });
 }
 
+void TaskGraph::MdUpdtDelayedTopoForEachNodeParallel(
+    std::function<void(TaskNode* node)> Handler) const {
+  // a node is placed one level after every neighbor visited before it in the serial order, so
+  // nodes of the same level share no edge and hence no regst
+  std::vector<std::vector<TaskNode*>> levels;
+  HashMap<const TaskNode*, size_t> node2level;
+  size_t min_level = 0;
+  auto AssignLevel = [&](TaskNode* node) {
+    size_t level = min_level;
+    node->ForEachNodeOnInOutEdge([&](TaskNode* neighbor) {
+      auto it = node2level.find(neighbor);
+      if (it != node2level.end()) { level = std::max(level, it->second + 1); }
+    });
+    CHECK(node2level.emplace(node, level).second);
+    if (level >= levels.size()) { levels.resize(level + 1); }
+    levels.at(level).push_back(node);
+  };
+  AcyclicTopoForEachNode([](TaskNode* node) { return node->GetTaskType() != kNormalMdUpdt; },
+                         AssignLevel);
+  min_level = levels.size();
+  AcyclicTopoForEachNode([](TaskNode* node) { return node->GetTaskType() == kNormalMdUpdt; },
+                         AssignLevel);
+  ForEachNode([&](TaskNode* node) { CHECK(node2level.find(node) != node2level.end()); });
+  for (const std::vector<TaskNode*>& nodes : levels) {
+    MultiThreadRangeLoop(nodes.size(), 1, [&](size_t begin, size_t end) {
+      FOR_RANGE(size_t, i, begin, end) { Handler(nodes.at(i)); }
+    });
+  }
+}
+
 void TaskGraph::AcyclicTopoForEachNode(std::function<bool(TaskNode* node)> IsAllowedStartNode,
                                        std::function<void(TaskNode* node)> Handler) const {
   auto ForEachInNode = [&](TaskNode* node, const std::function<void(TaskNode*)>& Handler) {
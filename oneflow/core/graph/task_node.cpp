@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/graph/task_node.h"
+#include "oneflow/core/graph/copy_task_node.h"
 
 namespace oneflow {
 
@@ -385,6 +386,15 @@ void TaskNode::FixRegisterNumRange() {
         && GetTaskType() == TaskType::kCopyHd) {  // TODO: delete this hack
       if (produced_regst->max_register_num() >= 2) { produced_regst->UpdtMinRegstNumIfNeed(2); }
     }
+    // let the host producer fill the next piece while the previous one is copied to device
+    if (GetTaskType() != TaskType::kCopyHd && produced_regst->max_register_num() >= 2
+        && std::any_of(produced_regst->consumers().begin(), produced_regst->consumers().end(),
+                       [](const TaskNode* consumer) {
+                         const auto* copy_hd = dynamic_cast<const CopyHdTaskNode*>(consumer);
+                         return copy_hd != nullptr && copy_hd->copy_type() == CopyHdOpConf::H2D;
+                       })) {
+      produced_regst->UpdtMinRegstNumIfNeed(2);
+    }
   }
 }
 
@@ -18,9 +18,30 @@ limitations under the License.
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/graph/op_graph.h"
 #include "oneflow/core/job_rewriter/job_completer.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
+namespace {
+
+void ToProtoInParallel(const TaskGraph& task_gph, Plan* plan) {
+  std::vector<TaskNode*> task_nodes;
+  task_gph.ForEachNode([&](TaskNode* task_node) {
+    if (task_node->IsMeaningLess()) { return; }
+    task_nodes.push_back(task_node);
+  });
+  const int64_t task_num_before = plan->task_size();
+  plan->mutable_task()->Reserve(task_num_before + task_nodes.size());
+  FOR_RANGE(size_t, i, 0, task_nodes.size()) { plan->mutable_task()->Add(); }
+  MultiThreadRangeLoop(task_nodes.size(), 1, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, i, begin, end) {
+      task_nodes.at(i)->ToProto(plan->mutable_task(task_num_before + i));
+    }
+  });
+}
+
+}  // namespace
+
 void Compiler::GenNetTopo(Plan* plan) const {
   HashMap<int64_t, int64_t> rid2mid;
   HashMap<int64_t, int64_t> tid2mid;
@@ -71,13 +92,28 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
     Global<OpGraph>::Get()->ToDotWithFilePath("optimized_dlnet_" + std::to_string(job_desc.job_id())
                                               + "_op_graph.dot");
   }
+  const bool parallel = Global<ResourceDesc, ForSession>::Get()->enable_parallel_compile();
+  double pass_start = GetCurTime();
+  auto LogPassTime = [&](const std::string& pass_name) {
+    const double now = GetCurTime();
+    LOG(INFO) << "compile pass " << pass_name << " time: " << now - pass_start;
+    pass_start = now;
+  };
   auto logical_gph = std::make_unique<LogicalGraph>(*job);
   auto task_gph = std::make_unique<TaskGraph>(std::move(logical_gph));
+  LogPassTime("BuildTaskGraph");
   using std::placeholders::_1;
+  // regst desc ids and consumer lists are shared state, so these passes stay serial
   task_gph->ForEachNode(std::bind(&TaskNode::ProduceAllRegstsAndBindEdges, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::ConsumeAllRegsts, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::PinConsumedRegst, _1));
-  task_gph->MdUpdtDelayedTopoForEachNode(&TaskNode::Build);
+  LogPassTime("ProduceAndConsumeRegsts");
+  if (parallel) {
+    task_gph->MdUpdtDelayedTopoForEachNodeParallel(&TaskNode::Build);
+  } else {
+    task_gph->MdUpdtDelayedTopoForEachNode(&TaskNode::Build);
+  }
+  LogPassTime("BuildTaskNodes");
   task_gph->RemoveEmptyRegsts();
   task_gph->AddOrderingCtrlEdgeInSameChain();
   // TODO: update method for fw bw split
@@ -89,16 +125,27 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
     auto IsReachable = Global<OpGraph>::Get()->MakePredicatorIsOpNameDataOrCtrlReachable();
     task_gph->EnableInplaceMemSharing(IsReachable);
   }
+  LogPassTime("CtrlEdgeAndInplace");
   // TODO: update method for fw bw split
   // if (job_desc.IsTrain()) { task_gph->AddOrderCtrlEdgeBetweenCopyAndMdUpdt(); }
-  task_gph->MdUpdtDelayedTopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
+  if (parallel) {
+    task_gph->MdUpdtDelayedTopoForEachNodeParallel(&TaskNode::InferTimeShapeIfMeaningful);
+  } else {
+    task_gph->MdUpdtDelayedTopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
+  }
+  LogPassTime("InferTimeShape");
   // TODO: update method for fw bw split
   // if (job_desc.IsTrain()) { task_gph->AddReduceNoBwForwardNodeOverlapingCtrlEdges(); }
 
-  task_gph->ForEachNode([&](TaskNode* task_node) {
-    if (task_node->IsMeaningLess()) { return; }
-    task_node->ToProto(plan->mutable_task()->Add());
-  });
+  if (parallel) {
+    ToProtoInParallel(*task_gph, plan);
+  } else {
+    task_gph->ForEachNode([&](TaskNode* task_node) {
+      if (task_node->IsMeaningLess()) { return; }
+      task_node->ToProto(plan->mutable_task()->Add());
+    });
+  }
+  LogPassTime("ToProto");
   {
     auto* job_id2job_conf = plan->mutable_job_confs()->mutable_job_id2job_conf();
     (*job_id2job_conf)[GlobalJobDesc().job_id()] = GlobalJobDesc().job_conf();
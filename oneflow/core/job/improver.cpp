@@ -220,6 +220,26 @@ uint64_t CalcRegstNum(
   return regst_num;
 }
 
+double PredictII(
+    const Plan& plan, double base_ii,
+    const std::function<const HashMap<int64_t, double>&(int64_t)>& PathDurations4RegstDescId,
+    const std::function<const HashMap<int64_t, double>&(int64_t)>& PathIIScales4RegstDescId,
+    const std::function<uint64_t(int64_t)>& RegstNum4RegstDescId) {
+  double ii = base_ii;
+  for (const auto& task_proto : plan.task()) {
+    for (const auto& pair : task_proto.produced_regst_desc()) {
+      const int64_t regst_desc_id = pair.second.regst_desc_id();
+      const uint64_t regst_num = RegstNum4RegstDescId(regst_desc_id);
+      const auto& consumer_actor_id2ii_scale = PathIIScales4RegstDescId(regst_desc_id);
+      for (const auto& duration_pair : PathDurations4RegstDescId(regst_desc_id)) {
+        ii = std::max(ii, CalcII(duration_pair.second, regst_num,
+                                 consumer_actor_id2ii_scale.at(duration_pair.first)));
+      }
+    }
+  }
+  return ii;
+}
+
 uint64_t CalcMemoryConsumed(
     const std::list<const RegstDescProto*>& regst_descs,
     const std::function<const HashMap<int64_t, double>&(int64_t)>& PathDurations4RegstDescId,
@@ -702,14 +722,27 @@ Maybe<Plan> Improver::GenAndInferMemBlockIdOnly(const AvailableMemDesc& amd,
 
 Maybe<Plan> Improver::Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
                               const std::string& act_event_filepath) {
-  Init(amd, naive_plan);
   std::list<std::unique_ptr<ActEvent>> act_events;
   ParseActEvents(act_event_filepath, &act_events);
+  ImproveStat stat;
+  return Improve(amd, naive_plan, std::move(act_events), nullptr, &stat);
+}
+
+Maybe<Plan> Improver::Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
+                              std::list<std::unique_ptr<ActEvent>>&& act_events,
+                              const std::function<uint64_t(int64_t)>& RunningRegstNum4RegstDescId,
+                              ImproveStat* stat) {
+  Init(amd, naive_plan);
   ChainActGraph chain_act_graph(naive_plan, std::move(act_events));
 
   auto PathDurations4RegstDescId = MakeGetterPathDurations4RegstDescId(chain_act_graph);
   auto PathIIScales4RegstDescId = MakeGetterPathIIScales4RegstDescId(chain_act_graph);
   double base_ii = chain_act_graph.CalcBaseII();
+  stat->base_ii = base_ii;
+  if (RunningRegstNum4RegstDescId) {
+    stat->running_ii = PredictII(naive_plan, base_ii, PathDurations4RegstDescId,
+                                 PathIIScales4RegstDescId, RunningRegstNum4RegstDescId);
+  }
 
   Plan mem_unlimited_plan(naive_plan);
   ForEachImprovedRegstNum(naive_plan, false, base_ii, PathDurations4RegstDescId,
@@ -719,11 +752,23 @@ Maybe<Plan> Improver::Improve(const AvailableMemDesc& amd, const Plan& naive_pla
   JUST(ForEachImprovedRegstNum(complete_plan, true, base_ii, PathDurations4RegstDescId,
                                PathIIScales4RegstDescId, MakeSetterSetPlanRegstNum(&plan)));
   FixReliantCtrlRegstNum(plan, MakeGetterGetPlanRegstNum(&plan), MakeSetterSetPlanRegstNum(&plan));
+  stat->improved_ii = PredictII(plan, base_ii, PathDurations4RegstDescId, PathIIScales4RegstDescId,
+                                MakeGetterGetPlanRegstNum(&plan));
   SetUniqueMemBlockId4UnreusedMemRegst(&plan);
   GenMemBlockAndChunk4Plan(&plan);
   return plan;
 }
 
+Maybe<void> Improver::ForEachRegstNum4BaseII(
+    const Plan& naive_plan, std::list<std::unique_ptr<ActEvent>>&& act_events,
+    const std::function<void(int64_t, uint64_t)>& Handler) const {
+  ChainActGraph chain_act_graph(naive_plan, std::move(act_events));
+  auto PathDurations4RegstDescId = MakeGetterPathDurations4RegstDescId(chain_act_graph);
+  auto PathIIScales4RegstDescId = MakeGetterPathIIScales4RegstDescId(chain_act_graph);
+  return ForEachImprovedRegstNum(naive_plan, false, chain_act_graph.CalcBaseII(),
+                                 PathDurations4RegstDescId, PathIIScales4RegstDescId, Handler);
+}
+
 Plan Improver::GenAndInferMemBlockId(const Plan& naive_plan) const {
   Plan plan(naive_plan);
   PlanTaskGraph plan_task_graph(naive_plan);
@@ -24,6 +24,14 @@ limitations under the License.
 
 namespace oneflow {
 
+struct ImproveStat {
+  double base_ii = 0;
+  // initiation intervals predicted from the act events for the register nums of the running plan
+  // and for the improved register nums
+  double running_ii = 0;
+  double improved_ii = 0;
+};
+
 class Improver final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(Improver);
@@ -32,7 +40,15 @@ class Improver final {
 
   Maybe<Plan> Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
                       const std::string& act_event_filepath);
+  Maybe<Plan> Improve(const AvailableMemDesc& amd, const Plan& naive_plan,
+                      std::list<std::unique_ptr<ActEvent>>&& act_events,
+                      const std::function<uint64_t(int64_t)>& RunningRegstNum4RegstDescId,
+                      ImproveStat* stat);
   Maybe<Plan> GenAndInferMemBlockIdOnly(const AvailableMemDesc& amd, const Plan& naive_plan);
+  // the register nums reaching the base ii of the act events as if memory were unlimited
+  Maybe<void> ForEachRegstNum4BaseII(const Plan& naive_plan,
+                                     std::list<std::unique_ptr<ActEvent>>&& act_events,
+                                     const std::function<void(int64_t, uint64_t)>& Handler) const;
 
  private:
   Plan GenAndInferMemBlockId(const Plan& naive_plan) const;
@@ -17,7 +17,11 @@ limitations under the License.
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/shape.h"
+#include "oneflow/core/job/global_for.h"
 #include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/mem_plan_util.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/register/runtime_register_desc.h"
 #include "oneflow/core/thread/thread_pool.h"
 
@@ -27,6 +31,7 @@ enum MemAllocAlgoType {
   kMemSizeFirstAlgo = 0,
   kMutualExclusionFirstAlgo = 1,
   kTimeLineAlgo = 2,
+  kBestFitCoalescingAlgo = 3,
 };
 
 }  // namespace oneflow
@@ -584,6 +589,49 @@ void MemReusedAlgorithm_TimeLineAlgo(
   result->mem_block_size = bfc_allocator.buffer_size();
 }
 
+// Regsts in the order of their allocation, with the lifetime of each
+void GenRegstLifetimes(const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+                       const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+                       std::vector<RegstDescProto*>* regsts,
+                       std::vector<RegstLifetime>* lifetimes) {
+  CHECK_EQ(alloc_regsts_timeline.size(), free_regsts_timeline.size());
+  HashMap<RegstDescProto*, int64_t> regst2id;
+  for (int64_t i = 0; i < alloc_regsts_timeline.size(); ++i) {
+    std::vector<RegstDescProto*> alloc_regsts(alloc_regsts_timeline.at(i).begin(),
+                                              alloc_regsts_timeline.at(i).end());
+    std::sort(alloc_regsts.begin(), alloc_regsts.end(),
+              [](const RegstDescProto* lhs, const RegstDescProto* rhs) {
+                return lhs->regst_desc_id() < rhs->regst_desc_id();
+              });
+    for (RegstDescProto* regst : alloc_regsts) {
+      CHECK(regst2id.emplace(regst, regsts->size()).second);
+      regsts->push_back(regst);
+      RegstLifetime lifetime;
+      lifetime.size = RtRegstDesc(*regst).TotalMainByteSize4AllRegst();
+      lifetime.alloc_index = i;
+      lifetime.free_index = -1;
+      lifetimes->push_back(lifetime);
+    }
+    for (RegstDescProto* regst : free_regsts_timeline.at(i)) {
+      lifetimes->at(regst2id.at(regst)).free_index = i;
+    }
+  }
+  for (const RegstLifetime& lifetime : *lifetimes) { CHECK_GE(lifetime.free_index, 0); }
+}
+
+void MemReusedAlgorithm_BestFitCoalescingAlgo(
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline, MemBlockResultInfo* result) {
+  std::vector<RegstDescProto*> regsts;
+  std::vector<RegstLifetime> lifetimes;
+  GenRegstLifetimes(alloc_regsts_timeline, free_regsts_timeline, &regsts, &lifetimes);
+  std::vector<int64_t> offsets;
+  result->mem_block_size = MemPlanUtil::BestFitCoalescingPlan(lifetimes, &offsets);
+  FOR_RANGE(int64_t, i, 0, regsts.size()) {
+    CHECK(result->regst_desc2offset.emplace(regsts.at(i), offsets.at(i)).second);
+  }
+}
+
 void SelectAlgorithmGenMemBlockOffset4Regsts(
     MemAllocAlgoType algo_id, const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
     const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
@@ -601,6 +649,10 @@ void SelectAlgorithmGenMemBlockOffset4Regsts(
     case kTimeLineAlgo:
       MemReusedAlgorithm_TimeLineAlgo(alloc_regsts_timeline, free_regsts_timeline, result);
       break;
+    case kBestFitCoalescingAlgo:
+      MemReusedAlgorithm_BestFitCoalescingAlgo(alloc_regsts_timeline, free_regsts_timeline,
+                                               result);
+      break;
     default: UNIMPLEMENTED();
   }
   CHECK_GT(result->mem_block_size, 0);
@@ -614,6 +666,7 @@ int64_t CountMemAllocAlgoNum() {
   if (mem_alloc_algo_conf.use_mem_size_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_mutual_exclusion_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_time_line_algo()) { ++ret; }
+  if (mem_alloc_algo_conf.use_best_fit_coalescing_algo()) { ++ret; }
   CHECK_GE(ret, 0);
   return ret;
 }
@@ -631,6 +684,91 @@ void InitAlgo2Result(HashMap<MemAllocAlgoType, MemBlockResultInfo>* algo2result)
   if (mem_alloc_algo_conf.use_time_line_algo()) {
     CHECK(algo2result->emplace(kTimeLineAlgo, MemBlockResultInfo()).second);
   }
+  if (mem_alloc_algo_conf.use_best_fit_coalescing_algo()) {
+    CHECK(algo2result->emplace(kBestFitCoalescingAlgo, MemBlockResultInfo()).second);
+  }
+}
+
+std::string MemAllocAlgoName(MemAllocAlgoType algo_id) {
+  switch (algo_id) {
+    case kMemSizeFirstAlgo: return "mem_size_first";
+    case kMutualExclusionFirstAlgo: return "mutual_exclusion_first";
+    case kTimeLineAlgo: return "time_line";
+    case kBestFitCoalescingAlgo: return "best_fit_coalescing";
+    default: UNIMPLEMENTED();
+  }
+  return "";
+}
+
+bool IsMemPlanReportEnabled() {
+  return GlobalJobDesc().job_conf().memory_allocation_algorithm_conf().enable_mem_plan_report()
+         || Global<ResourceDesc, ForSession>::Get()->enable_debug_mode();
+}
+
+std::string ProducerOpName(const HashMap<int64_t, const TaskProto*>& task_id2task,
+                           const RegstDescProto* regst) {
+  const TaskProto* task = task_id2task.at(regst->producer_task_id());
+  if (task->exec_sequence().exec_node_size() == 0) { return "-"; }
+  return task->exec_sequence().exec_node(0).kernel_conf().op_attribute().op_conf().name();
+}
+
+// Writes peak usage and wasted bytes of each algorithm, the regsts live at the peak and the
+// lifetime and offset of every regst in the chosen plan.
+void WriteMemPlanReport(int64_t mem_block_id, const std::vector<TaskProto*>& sorted_tasks,
+                        const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+                        const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+                        const HashMap<MemAllocAlgoType, MemBlockResultInfo>& algo2result,
+                        MemAllocAlgoType best_algo,
+                        const HashMap<RegstDescProto*, RegstDescProto*>& consumer2inplaced_regst) {
+  std::vector<RegstDescProto*> regsts;
+  std::vector<RegstLifetime> lifetimes;
+  GenRegstLifetimes(alloc_regsts_timeline, free_regsts_timeline, &regsts, &lifetimes);
+  int64_t peak_index = 0;
+  const int64_t peak_size = MemPlanUtil::PeakLiveSize(lifetimes, &peak_index);
+  HashMap<int64_t, const TaskProto*> task_id2task;
+  for (const TaskProto* task : sorted_tasks) { task_id2task.emplace(task->task_id(), task); }
+  const MemBlockResultInfo& best_result = algo2result.at(best_algo);
+  std::ostringstream ss;
+  ss << "mem_block " << mem_block_id << ": " << regsts.size() << " regsts, "
+     << consumer2inplaced_regst.size() << " inplace regsts, " << sorted_tasks.size()
+     << " tasks\n";
+  ss << "peak live size: " << peak_size << " bytes at task " << peak_index << " ("
+     << sorted_tasks.at(peak_index)->task_id() << ")\n";
+  std::vector<MemAllocAlgoType> algos;
+  for (const auto& pair : algo2result) { algos.push_back(pair.first); }
+  std::sort(algos.begin(), algos.end());
+  for (MemAllocAlgoType algo_id : algos) {
+    const int64_t mem_block_size = algo2result.at(algo_id).mem_block_size;
+    ss << "algorithm " << MemAllocAlgoName(algo_id) << ": mem block size " << mem_block_size
+       << " bytes, wasted " << mem_block_size - peak_size << " bytes ("
+       << 100.0 * (mem_block_size - peak_size) / std::max<int64_t>(mem_block_size, 1) << "%)"
+       << (algo_id == best_algo ? " [chosen]" : "") << "\n";
+  }
+  std::vector<int64_t> peak_regst_ids;
+  FOR_RANGE(int64_t, i, 0, regsts.size()) {
+    if (lifetimes.at(i).alloc_index <= peak_index && peak_index <= lifetimes.at(i).free_index) {
+      peak_regst_ids.push_back(i);
+    }
+  }
+  std::sort(peak_regst_ids.begin(), peak_regst_ids.end(), [&](int64_t lhs, int64_t rhs) {
+    return lifetimes.at(lhs).size > lifetimes.at(rhs).size;
+  });
+  ss << "regsts live at peak, largest first:\n";
+  for (int64_t i : peak_regst_ids) {
+    ss << "  regst_desc " << regsts.at(i)->regst_desc_id() << " of "
+       << ProducerOpName(task_id2task, regsts.at(i)) << ": " << lifetimes.at(i).size
+       << " bytes\n";
+  }
+  ss << "timeline:\nregst_desc_id,producer_op,size,alloc_index,free_index,offset\n";
+  FOR_RANGE(int64_t, i, 0, regsts.size()) {
+    ss << regsts.at(i)->regst_desc_id() << "," << ProducerOpName(task_id2task, regsts.at(i))
+       << "," << lifetimes.at(i).size << "," << lifetimes.at(i).alloc_index << ","
+       << lifetimes.at(i).free_index << "," << best_result.regst_desc2offset.at(regsts.at(i))
+       << "\n";
+  }
+  TeePersistentLogStream::Create(StrCat("mem_plan/job", GlobalJobDesc().job_id(), "_mem_block",
+                                        mem_block_id))
+      ->Write(ss.str());
 }
 
 }  // namespace
@@ -693,13 +831,21 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(Plan* plan,
   // step 3: choose best one for each mem chain and set offset for inplace consumer regst
   for (const auto& pair : mem_chain2algo2result) {
     const MemBlockResultInfo* best_result = nullptr;
+    MemAllocAlgoType best_algo = kMemSizeFirstAlgo;
     for (const auto& algo_result_pair : pair.second) {
       if (!best_result || algo_result_pair.second.mem_block_size < best_result->mem_block_size) {
         best_result = &algo_result_pair.second;
+        best_algo = algo_result_pair.first;
       }
     }
     CHECK(best_result != nullptr);
     int64_t mem_block_id = Global<IDMgr>::Get()->NewMemBlockId();
+    if (IsMemPlanReportEnabled()) {
+      WriteMemPlanReport(mem_block_id, mem_chain2sorted_tasks.at(pair.first),
+                         mem_chain2task2alloc_regsts.at(pair.first),
+                         mem_chain2task2free_regsts.at(pair.first), pair.second, best_algo,
+                         mem_chain2consumer2inplaced_regst.at(pair.first));
+    }
     CHECK_EQ(mem_chain2mem_reused_regsts.at(pair.first).size(),
              (best_result->regst_desc2offset.size()
               + mem_chain2consumer2inplaced_regst.at(pair.first).size()));
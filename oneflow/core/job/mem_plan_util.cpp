@@ -0,0 +1,130 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/mem_plan_util.h"
+#include <limits>
+#include <numeric>
+
+namespace oneflow {
+
+namespace {
+
+int64_t PlaceByOrder(const std::vector<RegstLifetime>& lifetimes,
+                     const std::vector<int64_t>& order, std::vector<int64_t>* offsets) {
+  offsets->assign(lifetimes.size(), -1);
+  // placed regsts bucketed by alloc index, so only buckets within the longest lifetime before
+  // the current regst have to be scanned for overlapping lifetimes
+  int64_t task_num = 0;
+  int64_t max_duration = 0;
+  for (const RegstLifetime& lifetime : lifetimes) {
+    task_num = std::max(task_num, lifetime.free_index + 1);
+    max_duration = std::max(max_duration, lifetime.free_index - lifetime.alloc_index);
+  }
+  std::vector<std::vector<int64_t>> alloc_index2placed_ids(task_num);
+  std::vector<std::pair<int64_t, int64_t>> occupied;
+  int64_t mem_block_size = 0;
+  for (int64_t id : order) {
+    const RegstLifetime& cur = lifetimes.at(id);
+    occupied.clear();
+    FOR_RANGE(int64_t, alloc_index, std::max<int64_t>(cur.alloc_index - max_duration, 0),
+              cur.free_index + 1) {
+      for (int64_t placed_id : alloc_index2placed_ids.at(alloc_index)) {
+        const RegstLifetime& other = lifetimes.at(placed_id);
+        if (cur.alloc_index <= other.free_index) {
+          const int64_t offset = offsets->at(placed_id);
+          occupied.emplace_back(offset, offset + other.size);
+        }
+      }
+    }
+    std::sort(occupied.begin(), occupied.end());
+    // walk the coalesced occupied ranges and keep the smallest gap that fits
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t cursor = 0;
+    for (const auto& range : occupied) {
+      const int64_t gap = range.first - cursor;
+      if (gap >= cur.size && gap < best_gap) {
+        best_gap = gap;
+        best_offset = cursor;
+      }
+      cursor = std::max(cursor, range.second);
+    }
+    if (best_offset == -1) { best_offset = cursor; }
+    offsets->at(id) = best_offset;
+    mem_block_size = std::max(mem_block_size, best_offset + cur.size);
+    alloc_index2placed_ids.at(cur.alloc_index).push_back(id);
+  }
+  return mem_block_size;
+}
+
+}  // namespace
+
+int64_t MemPlanUtil::BestFitCoalescingPlan(const std::vector<RegstLifetime>& lifetimes,
+                                           std::vector<int64_t>* offsets) {
+  auto Size = [&](int64_t id) { return lifetimes.at(id).size; };
+  auto Duration = [&](int64_t id) {
+    return lifetimes.at(id).free_index - lifetimes.at(id).alloc_index + 1;
+  };
+  // large regsts, long-lived regsts and those with the largest size * lifetime first
+  const std::vector<std::function<std::pair<int64_t, int64_t>(int64_t)>> order_keys = {
+      [&](int64_t id) { return std::make_pair(Size(id), Duration(id)); },
+      [&](int64_t id) { return std::make_pair(Duration(id), Size(id)); },
+      [&](int64_t id) { return std::make_pair(Size(id) * Duration(id), Size(id)); },
+  };
+  int64_t best_mem_block_size = std::numeric_limits<int64_t>::max();
+  std::vector<int64_t> order(lifetimes.size());
+  std::vector<int64_t> cur_offsets;
+  for (const auto& Key : order_keys) {
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+      const auto lhs_key = Key(lhs);
+      const auto rhs_key = Key(rhs);
+      if (lhs_key != rhs_key) { return lhs_key > rhs_key; }
+      return lhs < rhs;
+    });
+    const int64_t mem_block_size = PlaceByOrder(lifetimes, order, &cur_offsets);
+    if (mem_block_size < best_mem_block_size) {
+      best_mem_block_size = mem_block_size;
+      offsets->swap(cur_offsets);
+    }
+  }
+  return best_mem_block_size;
+}
+
+int64_t MemPlanUtil::PeakLiveSize(const std::vector<RegstLifetime>& lifetimes,
+                                  int64_t* peak_index) {
+  // frees happen after the allocations of the same task index
+  std::vector<std::pair<int64_t, int64_t>> events;
+  events.reserve(lifetimes.size() * 2);
+  for (const RegstLifetime& lifetime : lifetimes) {
+    events.emplace_back(2 * lifetime.alloc_index, lifetime.size);
+    events.emplace_back(2 * lifetime.free_index + 1, -lifetime.size);
+  }
+  std::sort(events.begin(), events.end());
+  int64_t live_size = 0;
+  int64_t peak_size = 0;
+  int64_t peak_event = 0;
+  for (const auto& event : events) {
+    live_size += event.second;
+    if (live_size > peak_size) {
+      peak_size = live_size;
+      peak_event = event.first;
+    }
+  }
+  if (peak_index != nullptr) { *peak_index = peak_event / 2; }
+  return peak_size;
+}
+
+}  // namespace oneflow
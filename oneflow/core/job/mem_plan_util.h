@@ -0,0 +1,44 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_MEM_PLAN_UTIL_H_
+#define ONEFLOW_CORE_JOB_MEM_PLAN_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// A regst of a mem chain is allocated before the task at alloc_index runs and freed after the
+// task at free_index runs, so two regsts must not share memory iff their index ranges overlap.
+struct RegstLifetime {
+  int64_t size;
+  int64_t alloc_index;
+  int64_t free_index;
+};
+
+struct MemPlanUtil {
+  // Places regsts one by one into the tightest gap left by the coalesced ranges of placed regsts
+  // with overlapping lifetimes. Tries size-first, lifetime-first and size * lifetime first
+  // orders and returns the mem block size of the best one.
+  static int64_t BestFitCoalescingPlan(const std::vector<RegstLifetime>& lifetimes,
+                                       std::vector<int64_t>* offsets);
+  // Max total size of simultaneously live regsts, a lower bound of any plan's mem block size.
+  // The task index where it is reached is returned through peak_index if not null.
+  static int64_t PeakLiveSize(const std::vector<RegstLifetime>& lifetimes, int64_t* peak_index);
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_MEM_PLAN_UTIL_H_
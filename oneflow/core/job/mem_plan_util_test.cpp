@@ -0,0 +1,99 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/mem_plan_util.h"
+
+namespace oneflow {
+
+namespace {
+
+void CheckPlanValid(const std::vector<RegstLifetime>& lifetimes,
+                    const std::vector<int64_t>& offsets, int64_t mem_block_size) {
+  ASSERT_EQ(lifetimes.size(), offsets.size());
+  FOR_RANGE(size_t, i, 0, lifetimes.size()) {
+    ASSERT_GE(offsets.at(i), 0);
+    ASSERT_LE(offsets.at(i) + lifetimes.at(i).size, mem_block_size);
+    FOR_RANGE(size_t, j, i + 1, lifetimes.size()) {
+      const bool live_together = lifetimes.at(i).alloc_index <= lifetimes.at(j).free_index
+                                 && lifetimes.at(j).alloc_index <= lifetimes.at(i).free_index;
+      const bool share_memory = offsets.at(i) < offsets.at(j) + lifetimes.at(j).size
+                                && offsets.at(j) < offsets.at(i) + lifetimes.at(i).size;
+      ASSERT_FALSE(live_together && share_memory);
+    }
+  }
+}
+
+std::vector<RegstLifetime> GenRandomLifetimes(int64_t regst_num, int64_t task_num,
+                                              int64_t max_duration, int64_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int64_t> alloc_dis(0, task_num - 1);
+  std::uniform_int_distribution<int64_t> duration_dis(0, max_duration);
+  std::uniform_int_distribution<int64_t> size_shift_dis(10, 26);
+  std::vector<RegstLifetime> lifetimes(regst_num);
+  for (RegstLifetime& lifetime : lifetimes) {
+    lifetime.alloc_index = alloc_dis(gen);
+    lifetime.free_index = std::min(lifetime.alloc_index + duration_dis(gen), task_num - 1);
+    lifetime.size = (int64_t(1) << size_shift_dis(gen)) + 512 * alloc_dis(gen);
+  }
+  return lifetimes;
+}
+
+}  // namespace
+
+TEST(MemPlanUtil, peak_live_size) {
+  const std::vector<RegstLifetime> lifetimes = {{100, 0, 1}, {50, 1, 2}, {70, 2, 3}, {10, 3, 3}};
+  int64_t peak_index = -1;
+  ASSERT_EQ(MemPlanUtil::PeakLiveSize(lifetimes, &peak_index), 150);
+  ASSERT_EQ(peak_index, 1);
+}
+
+TEST(MemPlanUtil, best_fit_coalescing_reaches_peak_on_chain) {
+  // each regst is consumed by the next task, so two adjacent regsts are live at a time
+  std::vector<RegstLifetime> lifetimes;
+  FOR_RANGE(int64_t, i, 0, 100) { lifetimes.push_back({1024 * (1 + i % 2), i, i + 1}); }
+  std::vector<int64_t> offsets;
+  const int64_t mem_block_size = MemPlanUtil::BestFitCoalescingPlan(lifetimes, &offsets);
+  CheckPlanValid(lifetimes, offsets, mem_block_size);
+  ASSERT_EQ(mem_block_size, MemPlanUtil::PeakLiveSize(lifetimes, nullptr));
+}
+
+TEST(MemPlanUtil, best_fit_coalescing_random_plans) {
+  FOR_RANGE(int64_t, seed, 0, 10) {
+    const std::vector<RegstLifetime> lifetimes = GenRandomLifetimes(300, 200, 20, seed);
+    std::vector<int64_t> offsets;
+    const int64_t mem_block_size = MemPlanUtil::BestFitCoalescingPlan(lifetimes, &offsets);
+    CheckPlanValid(lifetimes, offsets, mem_block_size);
+    ASSERT_GE(mem_block_size, MemPlanUtil::PeakLiveSize(lifetimes, nullptr));
+  }
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(MemPlanUtil, DISABLED_benchmark) {
+  for (int64_t regst_num : {2000, 10000, 30000}) {
+    const std::vector<RegstLifetime> lifetimes =
+        GenRandomLifetimes(regst_num, regst_num / 2, 200, regst_num);
+    std::vector<int64_t> offsets;
+    auto start = std::chrono::steady_clock::now();
+    const int64_t mem_block_size = MemPlanUtil::BestFitCoalescingPlan(lifetimes, &offsets);
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const int64_t peak_size = MemPlanUtil::PeakLiveSize(lifetimes, nullptr);
+    LOG(INFO) << regst_num << " regsts: mem block size " << mem_block_size << ", peak live size "
+              << peak_size << ", wasted " << 100.0 * (mem_block_size - peak_size) / mem_block_size
+              << "%, planned in " << elapsed_s << " s";
+  }
+}
+
+}  // namespace oneflow
@@ -15,10 +15,12 @@ limitations under the License.
 */
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/common/zlib_util.h"
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/common/buffer_manager.h"
 #include "oneflow/core/job/compiler.h"
 #include "oneflow/core/job/improver.h"
+#include "oneflow/core/job/regst_num_tuner.h"
 #include "oneflow/core/job/job_desc.h"
 #include "oneflow/core/job/job_builder.h"
 #include "oneflow/core/job/job_set.pb.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "oneflow/core/vm/oneflow_vm.h"
 #include "oneflow/core/graph/plan_task_graph.h"
 #include "oneflow/core/graph/boxing/collective_boxing_util.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace std {
 
@@ -83,7 +86,88 @@ std::string block7chunk_key(const std::string& plan_name, int64_t machine_id) {
   return plan_name + "_" + std::to_string(machine_id) + "_block7chunk";
 }
 
+// smaller clusters keep pushing one kv per (machine, thrd) through the hashed ctrl servers
+const size_t kShardedPlanTransferMinMachineNum = 8;
+// stay well below the 64MB grpc message limit of the ctrl client
+const size_t kShardedPlanPartByteSize = 32 * 1024 * 1024;
+
+bool UseShardedPlanTransfer() {
+  return Global<ResourceDesc, ForSession>::Get()->TotalMachineNum()
+         >= kShardedPlanTransferMinMachineNum;
+}
+
+std::string sharded_plan_key(const std::string& plan_name, int64_t machine_id) {
+  return plan_name + "_" + std::to_string(machine_id) + "_sharded";
+}
+
+std::string sharded_plan_part_key(const std::string& plan_name, int64_t machine_id,
+                                  int64_t part_id) {
+  return sharded_plan_key(plan_name, machine_id) + "_" + std::to_string(part_id);
+}
+
+void PushShardedPlan(const std::string& plan_name, const Plan& plan) {
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  const int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  std::vector<Plan> machine_plans(machine_num);
+  for (const auto& task : plan.task()) { *machine_plans.at(task.machine_id()).add_task() = task; }
+  for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
+    *machine_plans.at(mem_block.machine_id()).mutable_block_chunk_list()->add_mem_block() =
+        mem_block;
+  }
+  for (const auto& chunk : plan.block_chunk_list().chunk()) {
+    *machine_plans.at(chunk.machine_id()).mutable_block_chunk_list()->add_chunk() = chunk;
+  }
+  MultiThreadLoop(machine_num, [&](size_t machine_id) {
+    if (static_cast<int64_t>(machine_id) == this_machine_id) { return; }
+    const double start = GetCurTime();
+    Plan* machine_plan = &machine_plans.at(machine_id);
+    *machine_plan->mutable_net_topo() = plan.net_topo();
+    *machine_plan->mutable_job_confs() = plan.job_confs();
+    *machine_plan->mutable_collective_boxing_plan() = plan.collective_boxing_plan();
+    std::string raw;
+    machine_plan->SerializeToString(&raw);
+    std::string compressed;
+    ZlibCompress(raw, &compressed);
+    CompressedPlanHeader header;
+    header.set_raw_byte_size(raw.size());
+    header.set_part_num(RoundUp(compressed.size(), kShardedPlanPartByteSize)
+                        / kShardedPlanPartByteSize);
+    FOR_RANGE(int64_t, part_id, 0, header.part_num()) {
+      Global<CtrlClient>::Get()->PushKVToMachine(
+          machine_id, sharded_plan_part_key(plan_name, machine_id, part_id),
+          compressed.substr(part_id * kShardedPlanPartByteSize, kShardedPlanPartByteSize));
+    }
+    Global<CtrlClient>::Get()->PushKVToMachine(machine_id, sharded_plan_key(plan_name, machine_id),
+                                               header);
+    LOG(INFO) << "push " << plan_name << " to machine " << machine_id << ": " << raw.size()
+              << " bytes compressed to " << compressed.size()
+              << " bytes, time: " << GetCurTime() - start;
+  });
+}
+
+void PullShardedPlan(const std::string& plan_name, Plan* plan) {
+  const double start = GetCurTime();
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  CompressedPlanHeader header;
+  Global<CtrlClient>::Get()->PullLocalKV(sharded_plan_key(plan_name, machine_id), &header);
+  std::string compressed;
+  FOR_RANGE(int64_t, part_id, 0, header.part_num()) {
+    std::string part;
+    Global<CtrlClient>::Get()->PullLocalKV(sharded_plan_part_key(plan_name, machine_id, part_id),
+                                           &part);
+    compressed.append(part);
+  }
+  std::string raw;
+  ZlibDecompress(compressed, header.raw_byte_size(), &raw);
+  Plan machine_plan;
+  CHECK(machine_plan.ParseFromString(raw));
+  plan->MergeFrom(machine_plan);
+  LOG(INFO) << "pull " << plan_name << " on machine " << machine_id << ": " << raw.size()
+            << " bytes, time: " << GetCurTime() - start;
+}
+
 void PushPlan(const std::string& plan_name, const Plan& plan) {
+  if (UseShardedPlanTransfer()) { return PushShardedPlan(plan_name, plan); }
   HashMap<int64_t, std::set<int64_t>> machine_id2thrd_id_set;
   HashMap<std::pair<int64_t, int64_t>, std::vector<TaskProto>> mchn_thrd_id2task_protos;
   HashMap<int64_t, MemBlockAndChunkList> machine_id2block7chunk;
@@ -128,6 +212,7 @@ void PushPlan(const std::string& plan_name, const Plan& plan) {
 }
 
 void PullPlan(const std::string& plan_name, Plan* plan) {
+  if (UseShardedPlanTransfer()) { return PullShardedPlan(plan_name, plan); }
   ClusterThrdIds cluster_thrd_ids;
   Global<CtrlClient>::Get()->PullKV(cluster_thrd_ids_key(plan_name), &cluster_thrd_ids);
   PrintProtoToTextFile(cluster_thrd_ids, JoinPath(FLAGS_log_dir, cluster_thrd_ids_key(plan_name)));
@@ -320,7 +405,16 @@ Maybe<void> CompileCurJobOnMaster(Job* job, Plan* improved_plan, bool need_job_c
       TeePersistentLogStream::Create("improved_plan")->Write(*improved_plan);
     }
   } else {
-    *improved_plan = complete_plan;
+    bool is_improved = false;
+    if (Global<RegstNumTuner>::Get() != nullptr) {
+      is_improved = JUST(Global<RegstNumTuner>::Get()->TryImproveWithRecordedActEvents(
+          job->job_conf().job_name(), *Global<AvailableMemDesc>::Get(), naive_plan, improved_plan));
+    }
+    if (!is_improved) { *improved_plan = complete_plan; }
+  }
+  if (Global<RegstNumTuner>::Get() != nullptr) {
+    Global<RegstNumTuner>::Get()->AddJobPlan(job->job_conf().job_name(), naive_plan,
+                                             *improved_plan);
   }
   GenCollectiveBoxingPlan(job, improved_plan);
   LOG(INFO) << "compile and improve time: " << GetCurTime() - start;
@@ -982,6 +1076,7 @@ Maybe<void> Oneflow::Init(const oneflow::JobSet& job_set) {
 Oneflow::~Oneflow() {
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) { runtime_buffers_scope_.reset(); }
   runtime_.reset();
+  if (Global<RegstNumTuner>::Get() != nullptr) { Global<RegstNumTuner>::Get()->ReportAndRecord(); }
   if (Global<Profiler>::Get() != nullptr) {
     Global<Profiler>::Get()->Profile(
         plan_, JoinPath(FLAGS_log_dir, ActEventLogger::act_event_bin_filename()));
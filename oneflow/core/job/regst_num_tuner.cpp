@@ -0,0 +1,252 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/regst_num_tuner.h"
+#include "oneflow/core/job/improver.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include "oneflow/core/actor/act_event_logger.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/user/summary/crc32c.h"
+
+namespace oneflow {
+
+namespace {
+
+// act events recorded for another version of the job must not be applied to this one. The
+// signature is a crc32c so that it stays the same across builds and toolchains.
+uint32_t PlanSignature(const Plan& naive_plan) {
+  std::stringstream ss;
+  for (const TaskProto& task : naive_plan.task()) {
+    ss << task.task_id() << ":" << task.task_type() << ":" << task.machine_id() << ":"
+       << task.thrd_id();
+    for (const auto& pair : task.produced_regst_desc()) {
+      ss << ":" << pair.first << "=" << pair.second.regst_desc_id() << "/"
+         << pair.second.min_register_num() << "/" << pair.second.max_register_num();
+    }
+    ss << ";";
+  }
+  const std::string str = ss.str();
+  return summary::GetCrc32(str.data(), str.size());
+}
+
+std::string RecordedActEventFilePath(const std::string& job_name, const Plan& naive_plan) {
+  return JoinPath(FLAGS_log_dir, "regst_num_tuner_" + job_name + "_"
+                                     + std::to_string(PlanSignature(naive_plan)) + "_act_event.bin");
+}
+
+std::list<std::unique_ptr<ActEvent>> ActEvents4Window(
+    const std::map<int64_t, std::vector<ActEvent>>& act_id2act_events) {
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  for (const auto& pair : act_id2act_events) {
+    for (const ActEvent& act_event : pair.second) {
+      act_events.emplace_back(new ActEvent(act_event));
+    }
+  }
+  return act_events;
+}
+
+// in the format of ParseActEvents. Only the master records, so the file is written directly
+// instead of with PersistentOutStream, which creates the directory once over the ctrl plane
+void RecordActEvents(const std::string& filepath,
+                     const std::map<int64_t, std::vector<ActEvent>>& act_id2act_events) {
+  LocalFS()->RecursivelyCreateDirIfNotExist(Dirname(filepath));
+  std::unique_ptr<fs::WritableFile> file;
+  LocalFS()->NewWritableFile(filepath, &file);
+  for (const auto& pair : act_id2act_events) {
+    for (const ActEvent& act_event : pair.second) {
+      std::string act_event_bin;
+      act_event.SerializeToString(&act_event_bin);
+      const int64_t act_event_size = act_event_bin.size();
+      file->Append(reinterpret_cast<const char*>(&act_event_size), sizeof(act_event_size));
+      file->Append(act_event_bin.data(), act_event_bin.size());
+    }
+  }
+  file->Close();
+}
+
+// the steady state interval between two acts of the slowest actor
+double ObservedII(const std::map<int64_t, std::vector<ActEvent>>& act_id2act_events) {
+  HashMap<int64_t, std::pair<const ActEvent*, const ActEvent*>> actor_id2first_and_last;
+  for (const auto& pair : act_id2act_events) {
+    for (const ActEvent& act_event : pair.second) {
+      auto it = actor_id2first_and_last.find(act_event.actor_id());
+      if (it == actor_id2first_and_last.end()) {
+        actor_id2first_and_last.emplace(act_event.actor_id(),
+                                        std::make_pair(&act_event, &act_event));
+      } else {
+        it->second.second = &act_event;
+      }
+    }
+  }
+  double ii = 0;
+  for (const auto& pair : actor_id2first_and_last) {
+    const ActEvent* first = pair.second.first;
+    const ActEvent* last = pair.second.second;
+    if (last->act_id() == first->act_id()) { continue; }
+    ii = std::max(ii, (last->start_time() - first->start_time())
+                          / (last->act_id() - first->act_id()));
+  }
+  return ii;
+}
+
+}  // namespace
+
+RegstNumTuner::RegstNumTuner()
+    : window_size_(Global<const ProfilerConf>::Get()->adaptive_regst_num_window_size()) {
+  CHECK_GT(window_size_, 1);
+}
+
+Maybe<bool> RegstNumTuner::TryImproveWithRecordedActEvents(const std::string& job_name,
+                                                           const AvailableMemDesc& amd,
+                                                           const Plan& naive_plan,
+                                                           Plan* improved_plan) const {
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  if (!LoadRecordedActEvents(job_name, naive_plan, &act_events)) { return false; }
+  LOG(INFO) << "improve register nums of " << job_name << " with "
+            << RecordedActEventFilePath(job_name, naive_plan);
+  ImproveStat stat;
+  *improved_plan =
+      *JUST(Improver().Improve(amd, naive_plan, std::move(act_events), nullptr, &stat));
+  return true;
+}
+
+bool RegstNumTuner::LoadRecordedActEvents(const std::string& job_name, const Plan& naive_plan,
+                                          std::list<std::unique_ptr<ActEvent>>* act_events) const {
+  const std::string act_event_filepath = RecordedActEventFilePath(job_name, naive_plan);
+  if (!LocalFS()->FileExists(act_event_filepath)) { return false; }
+  ParseActEvents(act_event_filepath, act_events);
+  return true;
+}
+
+void RegstNumTuner::AddJobPlan(const std::string& job_name, const Plan& naive_plan,
+                               const Plan& running_plan) {
+  std::unique_lock<std::mutex> lck(mutex_);
+  JobCtx* ctx = &job_name2ctx_[job_name];
+  ctx->naive_plan = naive_plan;
+  ctx->act_id2act_events.clear();
+  for (const TaskProto& task : running_plan.task()) {
+    actor_id2job_ctx_[task.task_id()] = ctx;
+    for (const auto& pair : task.produced_regst_desc()) {
+      ctx->regst_desc_id2running_regst_num[pair.second.regst_desc_id()] =
+          pair.second.register_num();
+    }
+  }
+}
+
+void RegstNumTuner::AddActEvent(const ActEvent& act_event) {
+  if (act_event.is_experiment_phase()) { return; }
+  std::unique_lock<std::mutex> lck(mutex_);
+  auto it = actor_id2job_ctx_.find(act_event.actor_id());
+  if (it == actor_id2job_ctx_.end()) { return; }
+  auto* act_id2act_events = &it->second->act_id2act_events;
+  (*act_id2act_events)[act_event.act_id()].push_back(act_event);
+  while (act_id2act_events->size() > window_size_) {
+    act_id2act_events->erase(act_id2act_events->begin());
+  }
+}
+
+Maybe<void> RegstNumTuner::ForEachProposedRegstNum(
+    const std::string& job_name, const std::function<void(int64_t, uint64_t)>& Handler) const {
+  Plan naive_plan;
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    const auto& it = job_name2ctx_.find(job_name);
+    CHECK_OR_RETURN(it != job_name2ctx_.end()) << "no plan of job " << job_name;
+    CHECK_GE_OR_RETURN(it->second.act_id2act_events.size(), 2)
+        << "too few act events of job " << job_name;
+    naive_plan = it->second.naive_plan;
+    act_events = ActEvents4Window(it->second.act_id2act_events);
+  }
+  return Improver().ForEachRegstNum4BaseII(naive_plan, std::move(act_events), Handler);
+}
+
+void RegstNumTuner::Record() const {
+  std::unique_lock<std::mutex> lck(mutex_);
+  for (const auto& pair : job_name2ctx_) {
+    if (pair.second.act_id2act_events.size() < 2) { continue; }
+    RecordActEvents(RecordedActEventFilePath(pair.first, pair.second.naive_plan),
+                    pair.second.act_id2act_events);
+  }
+}
+
+void RegstNumTuner::ReportAndRecord() const {
+  Record();
+  std::unique_lock<std::mutex> lck(mutex_);
+  for (const auto& pair : job_name2ctx_) {
+    if (pair.second.act_id2act_events.size() < 2) { continue; }
+    const auto& status = TRY(Report(pair.first, pair.second));
+    if (!status.IsOk()) {
+      LOG(WARNING) << "failed to tune register nums of " << pair.first << ": "
+                   << status.GetSerializedError();
+    }
+  }
+}
+
+Maybe<void> RegstNumTuner::Report(const std::string& job_name, const JobCtx& ctx) const {
+  const auto& job_id2job_conf = ctx.naive_plan.job_confs().job_id2job_conf();
+  CHECK_EQ(job_id2job_conf.size(), 1);
+  std::unique_ptr<GlobalJobDescScope> job_desc_scope;
+  if (Global<JobDesc>::Get() == nullptr) {
+    job_desc_scope.reset(
+        new GlobalJobDescScope(job_id2job_conf.begin()->second, job_id2job_conf.begin()->first));
+  }
+  auto RunningRegstNum4RegstDescId = [&](int64_t regst_desc_id) {
+    return ctx.regst_desc_id2running_regst_num.at(regst_desc_id);
+  };
+  ImproveStat stat;
+  const Plan improved_plan =
+      *JUST(Improver().Improve(*Global<AvailableMemDesc>::Get(), ctx.naive_plan,
+                               ActEvents4Window(ctx.act_id2act_events),
+                               RunningRegstNum4RegstDescId, &stat));
+  HashMap<int64_t, uint64_t> regst_desc_id2base_ii_regst_num;
+  JUST(Improver().ForEachRegstNum4BaseII(
+      ctx.naive_plan, ActEvents4Window(ctx.act_id2act_events),
+      [&](int64_t regst_desc_id, uint64_t regst_num) {
+        regst_desc_id2base_ii_regst_num[regst_desc_id] = regst_num;
+      }));
+  const double observed_ii = ObservedII(ctx.act_id2act_events);
+  std::stringstream ss;
+  ss << "job: " << job_name << "\n"
+     << "observed ii: " << observed_ii << "\n"
+     << "base ii: " << stat.base_ii << "\n"
+     << "predicted ii with running register nums: " << stat.running_ii << "\n"
+     << "predicted ii with improved register nums: " << stat.improved_ii << "\n";
+  for (const TaskProto& task : improved_plan.task()) {
+    for (const auto& pair : task.produced_regst_desc()) {
+      auto it = ctx.regst_desc_id2running_regst_num.find(pair.second.regst_desc_id());
+      if (it == ctx.regst_desc_id2running_regst_num.end()
+          || it->second == pair.second.register_num()) {
+        continue;
+      }
+      ss << "task " << task.task_id() << " regst " << pair.first << " ("
+         << pair.second.regst_desc_id() << "): " << it->second << " -> "
+         << pair.second.register_num();
+      const auto& base_ii_it = regst_desc_id2base_ii_regst_num.find(pair.second.regst_desc_id());
+      if (base_ii_it != regst_desc_id2base_ii_regst_num.end()) {
+        ss << " (" << base_ii_it->second << " to reach base ii)";
+      }
+      ss << "\n";
+    }
+  }
+  TeePersistentLogStream::Create("regst_num_tuner/" + job_name + "_report")->Write(ss.str());
+  LOG(INFO) << "job " << job_name << " observed ii: " << observed_ii
+            << ", predicted ii: " << stat.running_ii
+            << ", predicted ii with improved register nums: " << stat.improved_ii;
+  return Maybe<void>::Ok();
+}
+
+}  // namespace oneflow
@@ -0,0 +1,67 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_REGST_NUM_TUNER_H_
+#define ONEFLOW_CORE_JOB_REGST_NUM_TUNER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/job/plan.pb.h"
+#include "oneflow/core/job/available_memory_desc.pb.h"
+#include "oneflow/core/actor/act_event.pb.h"
+
+namespace oneflow {
+
+// Feeds the improver's register num model with the act events of the running session instead of
+// an experiment run. At the end of the session it reports predicted vs observed initiation
+// intervals and records the act events, which improve the plan the next time the same job is
+// compiled.
+class RegstNumTuner final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(RegstNumTuner);
+  RegstNumTuner();
+  ~RegstNumTuner() = default;
+
+  Maybe<bool> TryImproveWithRecordedActEvents(const std::string& job_name,
+                                              const AvailableMemDesc& amd, const Plan& naive_plan,
+                                              Plan* improved_plan) const;
+  // act events recorded by a previous session for the same job and naive plan
+  bool LoadRecordedActEvents(const std::string& job_name, const Plan& naive_plan,
+                             std::list<std::unique_ptr<ActEvent>>* act_events) const;
+  void AddJobPlan(const std::string& job_name, const Plan& naive_plan, const Plan& running_plan);
+  void AddActEvent(const ActEvent& act_event);
+  // the register nums reaching the base ii of the act events of the job if memory were unlimited
+  Maybe<void> ForEachProposedRegstNum(
+      const std::string& job_name, const std::function<void(int64_t, uint64_t)>& Handler) const;
+  void Record() const;
+  void ReportAndRecord() const;
+
+ private:
+  struct JobCtx {
+    Plan naive_plan;
+    HashMap<int64_t, uint64_t> regst_desc_id2running_regst_num;
+    std::map<int64_t, std::vector<ActEvent>> act_id2act_events;
+  };
+  Maybe<void> Report(const std::string& job_name, const JobCtx& ctx) const;
+
+  size_t window_size_;
+  mutable std::mutex mutex_;
+  HashMap<std::string, JobCtx> job_name2ctx_;
+  HashMap<int64_t, JobCtx*> actor_id2job_ctx_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_REGST_NUM_TUNER_H_
@@ -0,0 +1,193 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/regst_num_tuner.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+constexpr int64_t kProducerTaskId = 1;
+constexpr int64_t kConsumerTaskId = 2;
+constexpr int64_t kProducedRegstDescId = 10;
+constexpr int64_t kConsumerRegstDescId = 11;
+
+void AddTask(int64_t task_id, int64_t chain_id, int64_t regst_desc_id, int64_t max_regst_num,
+             int64_t consumer_task_id, Plan* plan) {
+  TaskProto* task = plan->add_task();
+  task->set_task_type(TaskType::kNormalForward);
+  task->set_machine_id(0);
+  task->set_thrd_id(0);
+  task->set_task_id(task_id);
+  task->set_job_id(0);
+  task->mutable_task_set_info()->set_area_id(kDataForwardArea);
+  task->mutable_task_set_info()->set_chain_id(chain_id);
+  task->mutable_task_set_info()->set_order_in_graph(chain_id);
+  task->mutable_exec_sequence();
+  RegstDescProto* regst_desc = &(*task->mutable_produced_regst_desc())["out"];
+  regst_desc->set_regst_desc_id(regst_desc_id);
+  regst_desc->set_producer_task_id(task_id);
+  regst_desc->set_min_register_num(1);
+  regst_desc->set_max_register_num(max_regst_num);
+  regst_desc->set_register_num(1);
+  if (consumer_task_id >= 0) { regst_desc->add_consumer_task_id(consumer_task_id); }
+}
+
+// the consumer of the regst produced by the other chain runs 2.5 times as long as the producer
+Plan MakePlan(int64_t max_regst_num) {
+  Plan plan;
+  AddTask(kProducerTaskId, 0, kProducedRegstDescId, max_regst_num, kConsumerTaskId, &plan);
+  AddTask(kConsumerTaskId, 1, kConsumerRegstDescId, max_regst_num, -1, &plan);
+  return plan;
+}
+
+ActEvent MakeActEvent(int64_t actor_id, int64_t act_id, double start_time, double stop_time) {
+  ActEvent act_event;
+  act_event.set_is_experiment_phase(false);
+  act_event.set_actor_id(actor_id);
+  act_event.set_work_stream_id(actor_id);
+  act_event.set_act_id(act_id);
+  act_event.set_ready_time(start_time);
+  act_event.set_start_time(start_time);
+  act_event.set_stop_time(stop_time);
+  return act_event;
+}
+
+std::vector<ActEvent> MakeActEvents(int64_t act_num) {
+  std::vector<ActEvent> act_events;
+  FOR_RANGE(int64_t, act_id, 0, act_num) {
+    const double start_time = act_id * 10;
+    act_events.push_back(MakeActEvent(kProducerTaskId, act_id, start_time, start_time + 2));
+    ActEvent consumer = MakeActEvent(kConsumerTaskId, act_id, start_time + 2, start_time + 7);
+    ReadableRegstInfo* readable = consumer.add_readable_regst_infos();
+    readable->set_regst_desc_id(kProducedRegstDescId);
+    readable->set_act_id(act_id);
+    act_events.push_back(consumer);
+  }
+  return act_events;
+}
+
+class RegstNumTunerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ProfilerConf profiler_conf;
+    profiler_conf.set_enable_adaptive_regst_num(true);
+    profiler_conf.set_adaptive_regst_num_window_size(kWindowSize);
+    Global<const ProfilerConf>::New(profiler_conf);
+    IOConf io_conf;
+    io_conf.mutable_data_fs_conf()->mutable_localfs_conf();
+    io_conf.mutable_snapshot_fs_conf()->mutable_localfs_conf();
+    Global<const IOConf>::New(io_conf);
+    log_dir_ = FLAGS_log_dir;
+    FLAGS_log_dir = JoinPath(GetCwd(), "tmp_regst_num_tuner_test_asdfasdf");
+    LocalFS()->RecursivelyCreateDirIfNotExist(FLAGS_log_dir);
+  }
+
+  void TearDown() override {
+    LocalFS()->RecursivelyDeleteDir(FLAGS_log_dir);
+    FLAGS_log_dir = log_dir_;
+    Global<const IOConf>::Delete();
+    Global<const ProfilerConf>::Delete();
+  }
+
+  static void Feed(RegstNumTuner* tuner, const std::vector<ActEvent>& act_events) {
+    for (const ActEvent& act_event : act_events) {
+      tuner->AddActEvent(act_event);
+      // neither act events of the experiment phase nor of unknown actors count
+      ActEvent experiment_act_event(act_event);
+      experiment_act_event.set_is_experiment_phase(true);
+      experiment_act_event.set_stop_time(act_event.stop_time() + 1000);
+      tuner->AddActEvent(experiment_act_event);
+      ActEvent unknown_act_event(act_event);
+      unknown_act_event.set_actor_id(act_event.actor_id() + 100);
+      tuner->AddActEvent(unknown_act_event);
+    }
+  }
+
+  static HashMap<int64_t, uint64_t> ProposedRegstNums(const RegstNumTuner& tuner) {
+    HashMap<int64_t, uint64_t> regst_desc_id2regst_num;
+    CHECK_JUST(tuner.ForEachProposedRegstNum(
+        "job", [&](int64_t regst_desc_id, uint64_t regst_num) {
+          CHECK(regst_desc_id2regst_num.emplace(regst_desc_id, regst_num).second);
+        }));
+    return regst_desc_id2regst_num;
+  }
+
+  static constexpr int64_t kWindowSize = 8;
+  std::string log_dir_;
+};
+
+constexpr int64_t RegstNumTunerTest::kWindowSize;
+
+}  // namespace
+
+TEST_F(RegstNumTunerTest, propose_regst_nums) {
+  const Plan plan = MakePlan(10);
+  RegstNumTuner tuner;
+  tuner.AddJobPlan("job", plan, plan);
+  Feed(&tuner, MakeActEvents(20));
+  const HashMap<int64_t, uint64_t> regst_desc_id2regst_num = ProposedRegstNums(tuner);
+  ASSERT_EQ(regst_desc_id2regst_num.size(), 2);
+  // the base ii is the producer time 2, and a produced regst lives 2 + 5 until consumed
+  ASSERT_EQ(regst_desc_id2regst_num.at(kProducedRegstDescId), 4);
+  // a regst without consumer needs no more than its min register num
+  ASSERT_EQ(regst_desc_id2regst_num.at(kConsumerRegstDescId), 1);
+}
+
+TEST_F(RegstNumTunerTest, propose_at_most_max_regst_num) {
+  const Plan plan = MakePlan(3);
+  RegstNumTuner tuner;
+  tuner.AddJobPlan("job", plan, plan);
+  Feed(&tuner, MakeActEvents(20));
+  ASSERT_EQ(ProposedRegstNums(tuner).at(kProducedRegstDescId), 3);
+}
+
+TEST_F(RegstNumTunerTest, record_then_reload) {
+  const Plan plan = MakePlan(10);
+  const std::vector<ActEvent> act_events = MakeActEvents(20);
+  {
+    RegstNumTuner tuner;
+    tuner.AddJobPlan("job", plan, plan);
+    Feed(&tuner, act_events);
+    tuner.Record();
+  }
+  // the file name only depends on the job name and the naive plan
+  ASSERT_TRUE(LocalFS()->FileExists(
+      JoinPath(FLAGS_log_dir, "regst_num_tuner_job_3812281915_act_event.bin")));
+  RegstNumTuner tuner;
+  std::list<std::unique_ptr<ActEvent>> recorded;
+  ASSERT_TRUE(tuner.LoadRecordedActEvents("job", plan, &recorded));
+  // the last kWindowSize acts
+  ASSERT_EQ(recorded.size(), kWindowSize * 2);
+  auto expected = act_events.end() - kWindowSize * 2;
+  for (const auto& act_event : recorded) {
+    ASSERT_EQ(act_event->SerializeAsString(), expected->SerializeAsString());
+    ++expected;
+  }
+  std::list<std::unique_ptr<ActEvent>> others;
+  ASSERT_FALSE(tuner.LoadRecordedActEvents("another_job", plan, &others));
+  ASSERT_FALSE(tuner.LoadRecordedActEvents("job", MakePlan(3), &others));
+  ASSERT_TRUE(others.empty());
+}
+
+}  // namespace test
+
+}  // namespace oneflow
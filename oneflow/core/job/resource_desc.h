@@ -33,6 +33,17 @@ class ResourceDesc final {
   size_t TotalMachineNum() const;
   const Machine& machine(int32_t idx) const;
   size_t CommNetWorkerNum() const { return resource_.comm_net_worker_num(); }
+  int32_t CommNetSocketNumPerPeer() const { return resource_.comm_net_socket_num_per_peer(); }
+  size_t comm_net_stripe_min_byte() const { return resource_.comm_net_stripe_min_kbyte() * 1024; }
+  bool comm_net_zero_copy() const { return resource_.comm_net_zero_copy(); }
+  bool comm_net_shared_memory() const { return resource_.comm_net_shared_memory(); }
+  int64_t comm_net_max_pending_actor_msg_num() const {
+    return resource_.comm_net_max_pending_actor_msg_num();
+  }
+  int32_t comm_net_actor_msg_batch_delay_us() const {
+    return resource_.comm_net_actor_msg_batch_delay_us();
+  }
+  size_t host_staging_pool_byte() const { return resource_.host_staging_pool_mbyte() * kMB; }
   size_t rdma_mem_block_byte() const { return resource_.rdma_mem_block_mbyte() * kMB; }
   size_t rdma_recv_msg_buf_byte() const { return resource_.rdma_recv_msg_buf_mbyte() * kMB; }
   int32_t CpuDeviceNum() const { return resource_.cpu_device_num(); }
@@ -52,6 +63,13 @@ class ResourceDesc final {
   size_t thread_local_cache_max_size() const { return resource_.thread_local_cache_max_size(); }
   int32_t ComputeThreadPoolSize() const;
   bool enable_debug_mode() const;
+  bool enable_parallel_compile() const { return resource_.enable_parallel_compile(); }
+  bool enable_numa_aware_thread_placement() const {
+    return resource_.enable_numa_aware_thread_placement();
+  }
+  int32_t actor_construction_thread_num() const {
+    return resource_.actor_construction_thread_num();
+  }
   CollectiveBoxingConf collective_boxing_conf() const;
 
   void SetMachineNum(int32_t val) { resource_.set_machine_num(val); }
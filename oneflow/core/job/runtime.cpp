@@ -20,15 +20,18 @@ limitations under the License.
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/job/machine_context.h"
 #include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/job/runtime_job_descs.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/actor/act_event_logger.h"
+#include "oneflow/core/actor/act_event_batcher.h"
 #include "oneflow/core/graph/task_node.h"
 #include "oneflow/core/device/cuda_util.h"
 #include "oneflow/core/memory/memory_allocator.h"
 #include "oneflow/core/register/register_manager.h"
 #include "oneflow/user/summary/events_writer.h"
+#include "oneflow/core/persistence/snapshot_write_mgr.h"
 #include "oneflow/core/job/collective_boxing_executor.h"
 #include "oneflow/core/job/collective_boxing_device_ctx_poller.h"
 
@@ -61,7 +64,14 @@ bool HasNonCtrlConsumedRegstDescId(const TaskProto& task) {
 }  // namespace
 
 Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
+  double phase_start = GetCurTime();
+  auto LogPhaseTime = [&](const std::string& phase_name) {
+    const double now = GetCurTime();
+    LOG(INFO) << "runtime startup phase " << phase_name << " time: " << now - phase_start;
+    phase_start = now;
+  };
   NewAllGlobal(plan, total_piece_num, is_experiment_phase);
+  LogPhaseTime("NewAllGlobal");
   std::vector<const TaskProto*> mdupdt_tasks;
   std::vector<const TaskProto*> source_tasks;
   std::vector<const TaskProto*> other_tasks;
@@ -83,16 +93,21 @@ Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_ph
   HandoutTasks(source_tasks);
   HandoutTasks(other_tasks);
   runtime_ctx->WaitUntilCntEqualZero("constructing_actor_cnt");
+  Global<ThreadMgr>::Get()->DeleteActorConstructionPool();
   LOG(INFO) << "Actors on this machine constructed";
+  LogPhaseTime("ConstructActors");
   OF_BARRIER();
   LOG(INFO) << "Actors on every machine constructed";
+  LogPhaseTime("WaitActorsOnEveryMachine");
   if (Global<CommNet>::Get()) { Global<CommNet>::Get()->RegisterMemoryDone(); }
   runtime_ctx->NewCounter("model_init_cnt", mdupdt_tasks.size());
   SendCmdMsg(mdupdt_tasks, ActorCmd::kInitModel);
   runtime_ctx->WaitUntilCntEqualZero("model_init_cnt");
   LOG(INFO) << "InitModel on this machine done";
+  LogPhaseTime("InitModel");
   OF_BARRIER();
   LOG(INFO) << "InitModel on all machine done";
+  LogPhaseTime("WaitInitModelOnEveryMachine");
   runtime_ctx->NewCounter("running_actor_cnt", this_machine_task_num);
   SendCmdMsg(mdupdt_tasks, ActorCmd::kSendInitialModel);
   SendCmdMsg(source_tasks, ActorCmd::kStart);
@@ -107,9 +122,12 @@ Runtime::~Runtime() {
 void Runtime::NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
   Global<RuntimeCtx>::New(total_piece_num, is_experiment_phase);
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()
-      && Global<RuntimeCtx>::Get()->NeedCollectActEvent()) {
+      && Global<RuntimeCtx>::Get()->NeedPersistActEvent()) {
     Global<ActEventLogger>::New(is_experiment_phase);
   }
+  if (Global<RuntimeCtx>::Get()->NeedCollectActEvent()) {
+    Global<ActEventBatcher>::New(is_experiment_phase);
+  }
   if (Global<ResourceDesc, ForSession>::Get()->TotalMachineNum() > 1) {
 #ifdef PLATFORM_POSIX
     if (Global<ResourceDesc, ForSession>::Get()->use_rdma()) {
@@ -131,12 +149,21 @@ void Runtime::NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_exp
   Global<boxing::collective::CollectiveBoxingDeviceCtxPoller>::New();
   Global<RuntimeJobDescs>::New(plan.job_confs().job_id2job_conf());
   Global<summary::EventsWriter>::New();
+  if (Global<const IOConf>::Get()->enable_async_snapshot_write()) {
+    Global<SnapshotWriteMgr>::New(Global<const IOConf>::Get()->snapshot_write_worker_num());
+  }
 }
 
 void Runtime::DeleteAllGlobal() {
+  if (Global<SnapshotWriteMgr>::Get() != nullptr) { Global<SnapshotWriteMgr>::Delete(); }
   Global<RuntimeJobDescs>::Delete();
   Global<boxing::collective::CollectiveBoxingDeviceCtxPoller>::Delete();
   Global<ThreadMgr>::Delete();
+  if (Global<ActEventBatcher>::Get() != nullptr) {
+    // the last batches of all machines must reach the master before its logger goes away
+    Global<ActEventBatcher>::Delete();
+    OF_BARRIER();
+  }
   Global<ActorMsgBus>::Delete();
   Global<RegstMgr>::Delete();
   Global<MemoryAllocator>::Delete();
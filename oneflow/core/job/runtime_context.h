@@ -32,7 +32,11 @@ class RuntimeCtx final {
 
   int64_t total_piece_num() const { return total_piece_num_; }
   bool is_experiment_phase() const { return is_experiment_phase_; }
+  // adaptive register nums only feed the tuner of the master, which keeps a bounded window
   bool NeedCollectActEvent() const {
+    return NeedPersistActEvent() || Global<const ProfilerConf>::Get()->enable_adaptive_regst_num();
+  }
+  bool NeedPersistActEvent() const {
     return is_experiment_phase_ || Global<const ProfilerConf>::Get()->collect_act_event();
   }
 
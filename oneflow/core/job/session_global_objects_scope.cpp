@@ -23,6 +23,7 @@ limitations under the License.
 #include "oneflow/core/job/available_memory_desc.pb.h"
 #include "oneflow/core/job/id_manager.h"
 #include "oneflow/core/job/profiler.h"
+#include "oneflow/core/job/regst_num_tuner.h"
 #include "oneflow/core/persistence/file_system.h"
 #include "oneflow/core/common/buffer_manager.h"
 #include "oneflow/core/job/foreign_job_instance.h"
@@ -35,6 +36,7 @@ limitations under the License.
 #include "oneflow/core/job/runtime_buffer_managers_scope.h"
 #include "oneflow/core/framework/load_library.h"
 #include "oneflow/core/job/version.h"
+#include "oneflow/core/memory/host_staging_pool.h"
 #include "oneflow/core/job/global_for.h"
 
 namespace oneflow {
@@ -81,6 +83,13 @@ Maybe<void> SessionGlobalObjectsScope::Init(const ConfigProto& config_proto) {
       && Global<const ProfilerConf>::Get()->collect_act_event()) {
     Global<Profiler>::New();
   }
+  if (Global<MachineCtx>::Get()->IsThisMachineMaster()
+      && Global<const ProfilerConf>::Get()->enable_adaptive_regst_num()) {
+    Global<RegstNumTuner>::New();
+  }
+  if (Global<ResourceDesc, ForSession>::Get()->host_staging_pool_byte() > 0) {
+    Global<HostStagingPool>::New(Global<ResourceDesc, ForSession>::Get()->host_staging_pool_byte());
+  }
   PushAvailableMemDescOfThisMachine();
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
     Global<AvailableMemDesc>::New();
@@ -108,6 +117,8 @@ SessionGlobalObjectsScope::~SessionGlobalObjectsScope() {
     Global<JobName2JobId>::Delete();
     Global<AvailableMemDesc>::Delete();
   }
+  if (Global<HostStagingPool>::Get() != nullptr) { Global<HostStagingPool>::Delete(); }
+  if (Global<RegstNumTuner>::Get() != nullptr) { Global<RegstNumTuner>::Delete(); }
   if (Global<Profiler>::Get() != nullptr) { Global<Profiler>::Delete(); }
   Global<IDMgr>::Delete();
   Global<const ProfilerConf>::Delete();
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/adam_model_update_kernel.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -23,19 +24,6 @@ const AdamModelUpdateConf& GetAdamModelUpdateConf(const OperatorConf& op_conf) {
   return op_conf.adam_model_update_conf().user_conf().adam_conf();
 };
 
-template<typename T>
-void UpdateMomentEstimate(int64_t n, bool do_bias_correction, T beta, int32_t p,
-                          const T* model_diff, const T* beta_t, T* moment) {
-  FOR_RANGE(int64_t, i, 0, n) {
-    // Update biased moment estimate
-    moment[i] = beta * moment[i] + (1 - beta) * std::pow(model_diff[i], p);
-    if (do_bias_correction) {
-      // Correct deviation of moment estimate
-      moment[i] = moment[i] / (1 - *beta_t);
-    }
-  }
-}
-
 }  // namespace
 
 template<DeviceType device_type, typename T>
@@ -74,14 +62,21 @@ class AdamMdUpdateKernelUtil<DeviceType::kCPU, T> final {
                           T beta1, T beta2, T epsilon, bool do_bias_correction,
                           const int64_t* train_step, const T* beta1_t, const T* beta2_t,
                           const T* model_diff, T* model, T* m, T* v) {
-    // first-order moment
-    UpdateMomentEstimate<T>(n, do_bias_correction, beta1, 1, model_diff, beta1_t, m);
-    // second-order moment
-    UpdateMomentEstimate<T>(n, do_bias_correction, beta2, 2, model_diff, beta2_t, v);
-    FOR_RANGE(int64_t, i, 0, n) {
-      const T mdv = m[i] / (std::sqrt(v[i]) + epsilon);
-      model[i] = model[i] - *learning_rate * (mdv + weight_decay * model[i]);
-    }
+    const T lr = *learning_rate;
+    const T m_correction = do_bias_correction ? 1 / (1 - *beta1_t) : 1;
+    const T v_correction = do_bias_correction ? 1 / (1 - *beta2_t) : 1;
+    // update both moment estimates and the model in a single pass
+    MultiThreadRangeLoop(n, kCpuMdUpdtMinElemCntPerThread, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const T diff = model_diff[i];
+        const T m_val = (beta1 * m[i] + (1 - beta1) * diff) * m_correction;
+        const T v_val = (beta2 * v[i] + (1 - beta2) * diff * diff) * v_correction;
+        m[i] = m_val;
+        v[i] = v_val;
+        const T mdv = m_val / (std::sqrt(v_val) + epsilon);
+        model[i] = model[i] - lr * (mdv + weight_decay * model[i]);
+      }
+    });
   }
   static void DoBiasCorrection(DeviceCtx*, const int64_t* train_step, const T beta1, const T beta2,
                                T* beta1_t, T* beta2_t) {
@@ -0,0 +1,56 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/arg_tensor_binding.h"
+#include "oneflow/core/operator/operator.h"
+#include "oneflow/core/register/blob.h"
+
+namespace oneflow {
+
+ArgTensorBinding::ArgTensorBinding(const std::vector<std::pair<std::string, int32_t>>& inputs,
+                                   const std::vector<std::pair<std::string, int32_t>>& outputs) {
+  auto AddArg = [&](const std::pair<std::string, int32_t>& arg) {
+    CHECK(arg2handle_.emplace(arg, arg_bns_.size()).second);
+    arg_bns_.push_back(GenRepeatedBn(arg.first, arg.second));
+  };
+  for (const auto& arg : inputs) { AddArg(arg); }
+  for (const auto& arg : outputs) { AddArg(arg); }
+  AddArg(std::make_pair("tmp_buffer", 0));
+  arg_blobs_.resize(arg_bns_.size(), nullptr);
+  arg_tensors_.resize(arg_bns_.size());
+}
+
+user_op::Tensor* ArgTensorBinding::Tensor4ArgNameAndIndex(const std::string& arg_name,
+                                                          int32_t index) {
+  auto it = arg2handle_.find(std::make_pair(arg_name, index));
+  if (it == arg2handle_.end()) { return nullptr; }
+  return arg_tensors_.at(it->second).get();
+}
+
+void ArgTensorBinding::UpdateWithCorrBlob(
+    const std::function<Blob*(const std::string&)>& BnInOp2Blob) {
+  FOR_RANGE(int32_t, i, 0, arg_bns_.size()) {
+    Blob* blob = BnInOp2Blob(arg_bns_.at(i));
+    if (blob == nullptr || blob == arg_blobs_.at(i)) { continue; }
+    arg_blobs_.at(i) = blob;
+    if (arg_tensors_.at(i)) {
+      *arg_tensors_.at(i) = std::move(user_op::Tensor(blob));
+    } else {
+      arg_tensors_.at(i).reset(new user_op::Tensor(blob));
+    }
+  }
+}
+
+}  // namespace oneflow
@@ -0,0 +1,53 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_ARG_TENSOR_BINDING_H_
+#define ONEFLOW_CORE_KERNEL_ARG_TENSOR_BINDING_H_
+
+#include "oneflow/core/framework/util.h"
+#include "oneflow/core/framework/tensor.h"
+
+namespace oneflow {
+
+class Blob;
+
+// Binds the args of a user op kernel to the blobs of the current launch. Blob names are
+// generated once and tensors are rebuilt only when the blob behind an arg changes, so a launch
+// with unchanged regsts only costs one BnInOp2Blob call per arg.
+class ArgTensorBinding final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ArgTensorBinding);
+  ArgTensorBinding(const std::vector<std::pair<std::string, int32_t>>& inputs,
+                   const std::vector<std::pair<std::string, int32_t>>& outputs);
+  ~ArgTensorBinding() = default;
+
+  user_op::Tensor* Tensor4ArgHandle(int32_t arg_handle) {
+    if (arg_handle < 0 || arg_handle >= static_cast<int32_t>(arg_tensors_.size())) { return nullptr; }
+    return arg_tensors_.at(arg_handle).get();
+  }
+  user_op::Tensor* Tensor4ArgNameAndIndex(const std::string& arg_name, int32_t index);
+
+  void UpdateWithCorrBlob(const std::function<Blob*(const std::string&)>& BnInOp2Blob);
+
+ private:
+  HashMap<std::pair<std::string, int32_t>, int32_t> arg2handle_;
+  std::vector<std::string> arg_bns_;
+  std::vector<const Blob*> arg_blobs_;
+  std::vector<std::unique_ptr<user_op::Tensor>> arg_tensors_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_ARG_TENSOR_BINDING_H_
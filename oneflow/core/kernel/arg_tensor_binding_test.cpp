@@ -0,0 +1,136 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/kernel/arg_tensor_binding.h"
+#include "oneflow/core/framework/op_kernel.h"
+#include "oneflow/core/operator/operator.h"
+#include "oneflow/core/register/blob.h"
+#include "oneflow/core/register/runtime_blob_desc.h"
+
+namespace oneflow {
+
+namespace {
+
+using ArgVec = std::vector<std::pair<std::string, int32_t>>;
+
+class TestBlob final {
+ public:
+  explicit TestBlob(const RtBlobDesc* rt_blob_desc)
+      : header_(rt_blob_desc->ByteSizeOfBlobHeader()),
+        body_(rt_blob_desc->ByteSizeOfBlobBody()) {
+    mem_case_.mutable_host_mem();
+    blob_.reset(new Blob(mem_case_, rt_blob_desc, header_.data(), body_.data()));
+  }
+
+  Blob* blob() { return blob_.get(); }
+
+ private:
+  MemoryCase mem_case_;
+  std::vector<char> header_;
+  std::vector<char> body_;
+  std::unique_ptr<Blob> blob_;
+};
+
+}  // namespace
+
+TEST(ArgTensorBinding, handle_and_update) {
+  const ArgVec inputs = {{"x", 0}, {"x", 1}};
+  const ArgVec outputs = {{"y", 0}};
+  ArgTensorBinding binding(inputs, outputs);
+  ASSERT_EQ(user_op::GetArgHandle(inputs, outputs, "x", 1), 1);
+  ASSERT_EQ(user_op::GetArgHandle(inputs, outputs, "y", 0), 2);
+  ASSERT_EQ(user_op::GetArgHandle(inputs, outputs, "tmp_buffer", 0), 3);
+  ASSERT_EQ(user_op::GetArgHandle(inputs, outputs, "z", 0), -1);
+  ASSERT_TRUE(binding.Tensor4ArgHandle(-1) == nullptr);
+
+  RtBlobDesc rt_blob_desc(BlobDesc(Shape({4}), DataType::kFloat));
+  std::vector<std::unique_ptr<TestBlob>> blobs;
+  FOR_RANGE(int32_t, i, 0, 4) { blobs.emplace_back(new TestBlob(&rt_blob_desc)); }
+  HashMap<std::string, Blob*> bn2blob = {{GenRepeatedBn("x", 0), blobs.at(0)->blob()},
+                                         {GenRepeatedBn("x", 1), blobs.at(1)->blob()},
+                                         {GenRepeatedBn("y", 0), blobs.at(2)->blob()}};
+  auto BnInOp2Blob = [&](const std::string& bn) -> Blob* {
+    auto it = bn2blob.find(bn);
+    return it == bn2blob.end() ? nullptr : it->second;
+  };
+  binding.UpdateWithCorrBlob(BnInOp2Blob);
+  ASSERT_EQ(binding.Tensor4ArgHandle(1)->dptr(), blobs.at(1)->blob()->dptr());
+  ASSERT_EQ(binding.Tensor4ArgNameAndIndex("y", 0), binding.Tensor4ArgHandle(2));
+  ASSERT_EQ(binding.Tensor4ArgHandle(2)->shape().elem_cnt(), 4);
+  ASSERT_TRUE(binding.Tensor4ArgHandle(3) == nullptr);
+
+  bn2blob[GenRepeatedBn("y", 0)] = blobs.at(3)->blob();
+  binding.UpdateWithCorrBlob(BnInOp2Blob);
+  ASSERT_EQ(binding.Tensor4ArgHandle(2)->dptr(), blobs.at(3)->blob()->dptr());
+  ASSERT_EQ(binding.Tensor4ArgHandle(0)->dptr(), blobs.at(0)->blob()->dptr());
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(ArgTensorBinding, DISABLED_launch_overhead) {
+  const ArgVec inputs = {{"a", 0}, {"b", 0}};
+  const ArgVec outputs = {{"out", 0}};
+  RtBlobDesc rt_blob_desc(BlobDesc(Shape({1}), DataType::kFloat));
+  std::vector<std::unique_ptr<TestBlob>> blobs;
+  HashMap<std::string, Blob*> bn2blob;
+  for (const auto& arg : inputs) {
+    blobs.emplace_back(new TestBlob(&rt_blob_desc));
+    bn2blob.emplace(GenRepeatedBn(arg.first, arg.second), blobs.back()->blob());
+  }
+  for (const auto& arg : outputs) {
+    blobs.emplace_back(new TestBlob(&rt_blob_desc));
+    bn2blob.emplace(GenRepeatedBn(arg.first, arg.second), blobs.back()->blob());
+  }
+  std::function<Blob*(const std::string&)> BnInOp2Blob = [&](const std::string& bn) -> Blob* {
+    auto it = bn2blob.find(bn);
+    return it == bn2blob.end() ? nullptr : it->second;
+  };
+  const int64_t launch_num = 100000;
+  float sum = 0;
+
+  // per launch: regenerate blob names, rebuild every tensor and look them up by name
+  HashMap<std::pair<std::string, int32_t>, std::unique_ptr<user_op::Tensor>> arg2tensor;
+  for (const auto& arg : inputs) { arg2tensor[arg]; }
+  for (const auto& arg : outputs) { arg2tensor[arg]; }
+  arg2tensor[std::make_pair(std::string("tmp_buffer"), 0)];
+  double start = GetCurTime();
+  FOR_RANGE(int64_t, i, 0, launch_num) {
+    for (auto& pair : arg2tensor) {
+      Blob* blob = BnInOp2Blob(GenRepeatedBn(pair.first.first, pair.first.second));
+      if (blob == nullptr) { continue; }
+      pair.second.reset(new user_op::Tensor(blob));
+    }
+    sum += *arg2tensor.at(std::make_pair(std::string("a"), 0))->dptr<float>();
+    sum += *arg2tensor.at(std::make_pair(std::string("b"), 0))->dptr<float>();
+  }
+  const double by_name_ns = GetCurTime() - start;
+
+  ArgTensorBinding binding(inputs, outputs);
+  const int32_t a_handle = user_op::GetArgHandle(inputs, outputs, "a", 0);
+  const int32_t b_handle = user_op::GetArgHandle(inputs, outputs, "b", 0);
+  start = GetCurTime();
+  FOR_RANGE(int64_t, i, 0, launch_num) {
+    binding.UpdateWithCorrBlob(BnInOp2Blob);
+    sum += *binding.Tensor4ArgHandle(a_handle)->dptr<float>();
+    sum += *binding.Tensor4ArgHandle(b_handle)->dptr<float>();
+  }
+  const double by_handle_ns = GetCurTime() - start;
+
+  LOG(INFO) << "per launch arg binding overhead, by name: " << by_name_ns / launch_num
+            << "ns, by handle: " << by_handle_ns / launch_num << "ns, checksum: " << sum;
+  ASSERT_EQ(binding.Tensor4ArgHandle(a_handle)->dptr(), blobs.at(0)->blob()->dptr());
+}
+
+}  // namespace oneflow
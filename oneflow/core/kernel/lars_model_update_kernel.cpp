@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/lars_model_update_kernel.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -53,11 +54,25 @@ class LARSMdUpdateKernelUtil<DeviceType::kCPU, T> final {
   static void UpdateModel(DeviceCtx* ctx, int64_t n, const float* learning_rate, T weight_decay,
                           T momentum_beta, T epsilon, T lars_coefficient, const int64_t* train_step,
                           const T* model_diff, T* model, T* momentum, T* data_tmp) {
+    // partial norms are summed in range order, so the result does not depend on thread timing
+    std::mutex norm_mutex;
+    std::map<size_t, std::pair<T, T>> begin2partial_norms;
+    MultiThreadRangeLoop(n, kCpuMdUpdtMinElemCntPerThread, [&](size_t begin, size_t end) {
+      T partial_model_norm = 0;
+      T partial_model_diff_norm = 0;
+      for (size_t i = begin; i < end; ++i) {
+        partial_model_norm += model[i] * model[i];
+        partial_model_diff_norm += model_diff[i] * model_diff[i];
+      }
+      std::unique_lock<std::mutex> lock(norm_mutex);
+      begin2partial_norms.emplace(begin,
+                                  std::make_pair(partial_model_norm, partial_model_diff_norm));
+    });
     T model_norm = 0;
     T model_diff_norm = 0;
-    FOR_RANGE(int64_t, i, 0, n) {
-      model_norm += model[i] * model[i];
-      model_diff_norm += model_diff[i] * model_diff[i];
+    for (const auto& pair : begin2partial_norms) {
+      model_norm += pair.second.first;
+      model_diff_norm += pair.second.second;
     }
     model_norm = std::sqrt(model_norm / n);
     model_diff_norm = std::sqrt(model_diff_norm / n);
@@ -69,11 +84,13 @@ class LARSMdUpdateKernelUtil<DeviceType::kCPU, T> final {
       local_learning_rate = *learning_rate * lars_coefficient * model_norm
                             / (epsilon + model_diff_norm + weight_decay * model_norm);
     }
-    FOR_RANGE(int64_t, i, 0, n) {
-      T reg_diff = model_diff[i] + weight_decay * model[i];
-      momentum[i] = momentum_beta * momentum[i] - local_learning_rate * reg_diff;
-      model[i] = model[i] + momentum[i];
-    }
+    MultiThreadRangeLoop(n, kCpuMdUpdtMinElemCntPerThread, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T reg_diff = model_diff[i] + weight_decay * model[i];
+        momentum[i] = momentum_beta * momentum[i] - local_learning_rate * reg_diff;
+        model[i] = model[i] + momentum[i];
+      }
+    });
   }
 };
 
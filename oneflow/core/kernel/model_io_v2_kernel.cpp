@@ -336,16 +336,19 @@ class ModelSaveV2Kernel final : public KernelIf<device_type> {
     SnapshotWriter writer(snapshot_path);
     const std::string var_lbn =
         GenLogicalBlobName(conf.variable_op_name(), original_variable_conf.out());
-    const std::string key = is_broadcast ? var_lbn : GetTmpPartKey(var_lbn, parallel_ctx);
-    writer.Write(key, in_accessor.host_blob());
-    if (!is_broadcast) {
+    if (is_broadcast) {
+      writer.AsyncWrite(var_lbn, in_accessor.host_blob());
+    } else {
+      // parts are read back by parallel_id 0 right after the barrier, so write them in place
+      writer.Write(GetTmpPartKey(var_lbn, parallel_ctx), in_accessor.host_blob());
       const int64_t parallel_num = parallel_ctx.parallel_num();
       Global<CtrlClient>::Get()->Barrier(
           snapshot_path + "-" + var_lbn + "-Counter-" + std::to_string(*counter_), parallel_num);
       if (parallel_ctx.parallel_id() != 0) { return; }
       TensorSliceView total_slice(logical_blob_shape);
       OnDemandHostBlob total_blob(logical_blob_shape, data_type);
-      SnapshotReader reader(snapshot_path);
+      // the parts are written synchronously, other variables of the save are not waited for
+      SnapshotReader reader(snapshot_path, false);
       FOR_RANGE(int64_t, i, 0, parallel_num) {
         const TensorSliceView part_slice = GetPartSlice(this->kernel_conf(), i);
         const std::string part_key = GetTmpPartKey(var_lbn, i, parallel_num);
@@ -354,7 +357,7 @@ class ModelSaveV2Kernel final : public KernelIf<device_type> {
         HostSliceCopy(total_blob.blob(), total_slice, part_blob.blob(), part_slice);
         SnapshotFS()->RecursivelyDeleteDir(Dirname(JoinPath(snapshot_path, part_key)));
       }
-      writer.Write(var_lbn, total_blob.blob());
+      writer.AsyncWrite(var_lbn, total_blob.blob());
     }
   }
   std::unique_ptr<int64_t> counter_;
@@ -40,7 +40,7 @@ void ModelSaveKernel::ForwardDataContent(
   SnapshotWriter writer(path);
   FOR_RANGE(int64_t, i, 0, conf.in_size()) {
     const Blob* in_i = BnInOp2Blob(GenRepeatedBn("in", i));
-    writer.Write(conf.key(i), in_i);
+    writer.AsyncWrite(conf.key(i), in_i);
   }
   writer.Close();
 }
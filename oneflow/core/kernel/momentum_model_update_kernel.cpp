@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/momentum_model_update_kernel.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -51,11 +52,14 @@ class MomentumMdUpdateKernelUtil<DeviceType::kCPU, T> final {
   static void UpdateModel(DeviceCtx*, int64_t n, T beta, const int64_t* train_step,
                           const float* learning_rate, T weight_decay, const T* model_diff, T* model,
                           T* momentum) {
-    for (int64_t i = 0; i != n; ++i) {
-      T next_momentum = beta * momentum[i] - *learning_rate * model_diff[i];
-      momentum[i] = next_momentum;
-      model[i] = model[i] + next_momentum - *learning_rate * weight_decay * model[i];
-    }
+    const T lr = *learning_rate;
+    MultiThreadRangeLoop(n, kCpuMdUpdtMinElemCntPerThread, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T next_momentum = beta * momentum[i] - lr * model_diff[i];
+        momentum[i] = next_momentum;
+        model[i] = model[i] + next_momentum - lr * weight_decay * model[i];
+      }
+    });
   }
 };
 
@@ -20,6 +20,11 @@ limitations under the License.
 
 namespace oneflow {
 
+// Cpu model update kernels split the model into ranges of at least this many elements per thread.
+// Smaller models update on the actor thread; each variable has its own update actor, so small
+// models still run concurrently across actors rather than being batched into one pool pass.
+constexpr size_t kCpuMdUpdtMinElemCntPerThread = 32768;
+
 template<DeviceType device_type, typename T>
 class NormalMdUpdateKernel : public KernelIf<device_type> {
  public:
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/kernel/kernel.h"
 #include "oneflow/core/kernel/eager_kernel.h"
+#include "oneflow/core/kernel/arg_tensor_binding.h"
 #include "oneflow/core/framework/op_kernel.h"
 #include "oneflow/core/framework/op_kernel_infer_cache.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
@@ -313,19 +314,8 @@ class UserKernelComputeContext final : public user_op::KernelComputeContext {
       : user_op::KernelComputeContext(
             user_op::UserOpConfWrapper(kernel_conf.op_attribute().op_conf())),
         device_ctx_(device_ctx),
-        base_ctx_(std::move(UserKernelBaseContext(kernel_conf, job_desc))) {
-    auto InitInOrOut = [&](const PbMap<std::string, UserOpConf::ListString>& arg_map) {
-      for (auto it = arg_map.begin(); it != arg_map.end(); ++it) {
-        const std::string& arg_name = it->first;
-        for (int32_t i = 0; i < it->second.s_size(); ++i) {
-          arg2tensor_.emplace(std::make_pair(arg_name, i), std::unique_ptr<user_op::Tensor>());
-        }
-      }
-    };
-    InitInOrOut(kernel_conf.op_attribute().op_conf().user_conf().input());
-    InitInOrOut(kernel_conf.op_attribute().op_conf().user_conf().output());
-    arg2tensor_.emplace(std::make_pair("tmp_buffer", 0), std::unique_ptr<user_op::Tensor>());
-  }
+        base_ctx_(std::move(UserKernelBaseContext(kernel_conf, job_desc))),
+        arg_tensor_binding_(base_ctx_.inputs(), base_ctx_.outputs()) {}
   ~UserKernelComputeContext() = default;
 
   const user_op::TensorDesc* TensorDesc4ArgNameAndIndex(const std::string& arg_name,
@@ -334,24 +324,15 @@ class UserKernelComputeContext final : public user_op::KernelComputeContext {
   }
 
   user_op::Tensor* Tensor4ArgNameAndIndex(const std::string& arg_name, int32_t index) override {
-    auto it = arg2tensor_.find(std::make_pair(arg_name, index));
-    if (it == arg2tensor_.end()) { return nullptr; }
-    return it->second.get();
+    return arg_tensor_binding_.Tensor4ArgNameAndIndex(arg_name, index);
+  }
+  user_op::Tensor* Tensor4ArgHandle(int32_t arg_handle) override {
+    return arg_tensor_binding_.Tensor4ArgHandle(arg_handle);
   }
   DeviceCtx* device_ctx() override { return device_ctx_; }
 
   void UpdateTensorWithCorrBlob(std::function<Blob*(const std::string&)> BnInOp2Blob) {
-    for (auto& pair : arg2tensor_) {
-      const auto& arg_pair = pair.first;
-      std::unique_ptr<user_op::Tensor>* arg_tensor_ptr = &pair.second;
-      Blob* blob = BnInOp2Blob(GenRepeatedBn(arg_pair.first, arg_pair.second));
-      if (blob == nullptr) { continue; }
-      if (*arg_tensor_ptr) {
-        *(arg_tensor_ptr->get()) = std::move(user_op::Tensor(blob));
-      } else {
-        arg_tensor_ptr->reset(new user_op::Tensor(blob));
-      }
-    }
+    arg_tensor_binding_.UpdateWithCorrBlob(BnInOp2Blob);
   }
 
   DeviceType device_type() const override { return base_ctx_.device_type(); }
@@ -363,8 +344,8 @@ class UserKernelComputeContext final : public user_op::KernelComputeContext {
 
  private:
   DeviceCtx* device_ctx_;
-  Arg2Tensor arg2tensor_;
   UserKernelBaseContext base_ctx_;
+  ArgTensorBinding arg_tensor_binding_;
 };
 
 class UserKernelRegContext final : public user_op::KernelRegContext {
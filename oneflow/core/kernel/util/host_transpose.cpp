@@ -0,0 +1,229 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/util/host_transpose.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+#include <numeric>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace oneflow {
+
+namespace {
+
+const int64_t kTransposeTileSize = 32;
+const int64_t kTransposeMinElemCntPerThread = 32768;
+
+// Drops unit axes and merges x axes that stay adjacent in y
+void CoalesceAxes(int32_t num_axis, const int64_t* x_dims, const int32_t* permutation,
+                  std::vector<int64_t>* dims, std::vector<int32_t>* perm) {
+  std::vector<int32_t> kept_id(num_axis, -1);
+  std::vector<int64_t> kept_dims;
+  FOR_RANGE(int32_t, i, 0, num_axis) {
+    if (x_dims[i] == 1) { continue; }
+    kept_id[i] = kept_dims.size();
+    kept_dims.push_back(x_dims[i]);
+  }
+  // groups of kept axes in y order, each is (first x axis, merged dim)
+  std::vector<std::pair<int32_t, int64_t>> groups;
+  int32_t prev_axis = -2;
+  FOR_RANGE(int32_t, i, 0, num_axis) {
+    const int32_t axis = kept_id[permutation[i]];
+    if (axis == -1) { continue; }
+    if (axis == prev_axis + 1) {
+      groups.back().second *= kept_dims[axis];
+    } else {
+      groups.emplace_back(axis, kept_dims[axis]);
+    }
+    prev_axis = axis;
+  }
+  std::vector<int32_t> x_order(groups.size());
+  std::iota(x_order.begin(), x_order.end(), 0);
+  std::sort(x_order.begin(), x_order.end(),
+            [&](int32_t lhs, int32_t rhs) { return groups[lhs].first < groups[rhs].first; });
+  dims->resize(groups.size());
+  perm->resize(groups.size());
+  FOR_RANGE(int32_t, i, 0, groups.size()) {
+    dims->at(i) = groups[x_order[i]].second;
+    perm->at(x_order[i]) = i;
+  }
+}
+
+// dst[j * ldd + i] = src[i * lds + j] for a rows x cols tile
+template<typename T, size_t size = sizeof(T)>
+struct TileTransposer {
+  static void Run(const T* src, int64_t lds, T* dst, int64_t ldd, int64_t rows, int64_t cols) {
+    FOR_RANGE(int64_t, j, 0, cols) {
+      FOR_RANGE(int64_t, i, 0, rows) { dst[j * ldd + i] = src[i * lds + j]; }
+    }
+  }
+};
+
+#if defined(__SSE__)
+
+// 4 x 4 micro tiles are transposed in registers
+template<typename T>
+struct TileTransposer<T, 4> {
+  static void Run(const T* src, int64_t lds, T* dst, int64_t ldd, int64_t rows, int64_t cols) {
+    const int64_t rows4 = rows / 4 * 4;
+    const int64_t cols4 = cols / 4 * 4;
+    for (int64_t i = 0; i < rows4; i += 4) {
+      for (int64_t j = 0; j < cols4; j += 4) {
+        const float* s = reinterpret_cast<const float*>(src + i * lds + j);
+        __m128 r0 = _mm_loadu_ps(s);
+        __m128 r1 = _mm_loadu_ps(s + lds);
+        __m128 r2 = _mm_loadu_ps(s + 2 * lds);
+        __m128 r3 = _mm_loadu_ps(s + 3 * lds);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        float* d = reinterpret_cast<float*>(dst + j * ldd + i);
+        _mm_storeu_ps(d, r0);
+        _mm_storeu_ps(d + ldd, r1);
+        _mm_storeu_ps(d + 2 * ldd, r2);
+        _mm_storeu_ps(d + 3 * ldd, r3);
+      }
+    }
+    TileTransposer<T, 0>::Run(src + cols4, lds, dst + cols4 * ldd, ldd, rows, cols - cols4);
+    TileTransposer<T, 0>::Run(src + rows4 * lds, lds, dst + rows4, ldd, rows - rows4, cols4);
+  }
+};
+
+#endif
+
+// Walks the given y axes as an odometer, tracking the x and y offsets
+struct AxesWalker {
+  AxesWalker(const std::vector<int64_t>& dims, const std::vector<int64_t>& x_strides,
+             const std::vector<int64_t>& y_strides, int64_t start)
+      : dims(dims), x_strides(x_strides), y_strides(y_strides), idx(dims.size()) {
+    x_offset = 0;
+    y_offset = 0;
+    for (int32_t i = dims.size() - 1; i >= 0; --i) {
+      idx[i] = start % dims[i];
+      start /= dims[i];
+      x_offset += idx[i] * x_strides[i];
+      y_offset += idx[i] * y_strides[i];
+    }
+  }
+  void Next() {
+    for (int32_t i = dims.size() - 1; i >= 0; --i) {
+      x_offset += x_strides[i];
+      y_offset += y_strides[i];
+      if (++idx[i] < dims[i]) { return; }
+      x_offset -= dims[i] * x_strides[i];
+      y_offset -= dims[i] * y_strides[i];
+      idx[i] = 0;
+    }
+  }
+  const std::vector<int64_t>& dims;
+  const std::vector<int64_t>& x_strides;
+  const std::vector<int64_t>& y_strides;
+  std::vector<int64_t> idx;
+  int64_t x_offset;
+  int64_t y_offset;
+};
+
+}  // namespace
+
+template<typename T>
+void HostTranspose(int32_t num_axis, const int64_t* x_dims, const int32_t* permutation,
+                   const T* x, T* y) {
+  std::vector<int64_t> dims;
+  std::vector<int32_t> perm;
+  CoalesceAxes(num_axis, x_dims, permutation, &dims, &perm);
+  const int32_t n = dims.size();
+  const int64_t elem_cnt = std::accumulate(dims.begin(), dims.end(), int64_t(1),
+                                           std::multiplies<int64_t>());
+  if (elem_cnt == 0) { return; }
+  if (n <= 1) {
+    MultiThreadRangeLoop(elem_cnt, kTransposeMinElemCntPerThread, [&](size_t begin, size_t end) {
+      memcpy(y + begin, x + begin, (end - begin) * sizeof(T));
+    });
+    return;
+  }
+  std::vector<int64_t> x_strides(n, 1);
+  std::vector<int64_t> y_strides(n, 1);
+  for (int32_t i = n - 2; i >= 0; --i) {
+    x_strides[i] = x_strides[i + 1] * dims[i + 1];
+    y_strides[i] = y_strides[i + 1] * dims[perm[i + 1]];
+  }
+  if (perm[n - 1] == n - 1) {
+    // the innermost axis is kept, copy contiguous rows in y order
+    const int64_t row_size = dims[n - 1];
+    std::vector<int64_t> outer_dims;
+    std::vector<int64_t> outer_x_strides;
+    std::vector<int64_t> outer_y_strides;
+    FOR_RANGE(int32_t, i, 0, n - 1) {
+      outer_dims.push_back(dims[perm[i]]);
+      outer_x_strides.push_back(x_strides[perm[i]]);
+      outer_y_strides.push_back(y_strides[i]);
+    }
+    MultiThreadRangeLoop(
+        elem_cnt / row_size, std::max<int64_t>(kTransposeMinElemCntPerThread / row_size, 1),
+        [&](size_t begin, size_t end) {
+          AxesWalker walker(outer_dims, outer_x_strides, outer_y_strides, begin);
+          FOR_RANGE(size_t, row, begin, end) {
+            memcpy(y + walker.y_offset, x + walker.x_offset, row_size * sizeof(T));
+            walker.Next();
+          }
+        });
+    return;
+  }
+  // y innermost axis comes from x axis a, x innermost axis lands on y axis p, every outer index
+  // is a [dims[a], dims[n - 1]] matrix transpose
+  const int32_t a = perm[n - 1];
+  const int32_t p = std::find(perm.begin(), perm.end(), n - 1) - perm.begin();
+  const int64_t rows = dims[a];
+  const int64_t cols = dims[n - 1];
+  const int64_t lds = x_strides[a];
+  const int64_t ldd = y_strides[p];
+  std::vector<int64_t> outer_dims;
+  std::vector<int64_t> outer_x_strides;
+  std::vector<int64_t> outer_y_strides;
+  FOR_RANGE(int32_t, i, 0, n - 1) {
+    if (i == p) { continue; }
+    outer_dims.push_back(dims[perm[i]]);
+    outer_x_strides.push_back(x_strides[perm[i]]);
+    outer_y_strides.push_back(y_strides[i]);
+  }
+  const int64_t row_tile_num = RoundUp(rows, kTransposeTileSize) / kTransposeTileSize;
+  const int64_t outer_num = elem_cnt / (rows * cols);
+  MultiThreadRangeLoop(
+      outer_num * row_tile_num,
+      std::max<int64_t>(kTransposeMinElemCntPerThread / (kTransposeTileSize * cols), 1),
+      [&](size_t begin, size_t end) {
+        FOR_RANGE(size_t, task, begin, end) {
+          AxesWalker walker(outer_dims, outer_x_strides, outer_y_strides, task / row_tile_num);
+          const int64_t i0 = (task % row_tile_num) * kTransposeTileSize;
+          const int64_t tile_rows = std::min(kTransposeTileSize, rows - i0);
+          for (int64_t j0 = 0; j0 < cols; j0 += kTransposeTileSize) {
+            TileTransposer<T>::Run(x + walker.x_offset + i0 * lds + j0, lds,
+                                   y + walker.y_offset + j0 * ldd + i0, ldd, tile_rows,
+                                   std::min(kTransposeTileSize, cols - j0));
+          }
+        }
+      });
+}
+
+#define INSTANTIATE_HOST_TRANSPOSE(type_cpp, type_proto)                                      \
+  template void HostTranspose<type_cpp>(int32_t num_axis, const int64_t* x_dims,             \
+                                        const int32_t* permutation, const type_cpp* x,       \
+                                        type_cpp* y);
+OF_PP_FOR_EACH_TUPLE(INSTANTIATE_HOST_TRANSPOSE, ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ);
+#undef INSTANTIATE_HOST_TRANSPOSE
+
+}  // namespace oneflow
@@ -0,0 +1,32 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_UTIL_HOST_TRANSPOSE_H_
+#define ONEFLOW_CORE_KERNEL_UTIL_HOST_TRANSPOSE_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// y = permute(x, permutation), y axis i is x axis permutation[i]. Axes that stay adjacent are
+// coalesced, innermost-preserving permutations are copied row by row and the rest are
+// transposed in cache tiles, both split over the compute thread pool
+template<typename T>
+void HostTranspose(int32_t num_axis, const int64_t* x_dims, const int32_t* permutation,
+                   const T* x, T* y);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_UTIL_HOST_TRANSPOSE_H_
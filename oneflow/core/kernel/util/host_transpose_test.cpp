@@ -0,0 +1,117 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/util/host_transpose.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <numeric>
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+void NaiveTranspose(const std::vector<int64_t>& x_dims, const std::vector<int32_t>& permutation,
+                    const T* x, T* y) {
+  const int32_t num_axis = x_dims.size();
+  std::vector<int64_t> x_strides(num_axis, 1);
+  std::vector<int64_t> y_dims(num_axis);
+  for (int32_t i = num_axis - 2; i >= 0; --i) { x_strides[i] = x_strides[i + 1] * x_dims[i + 1]; }
+  FOR_RANGE(int32_t, i, 0, num_axis) { y_dims[i] = x_dims[permutation[i]]; }
+  const int64_t elem_cnt = x_strides[0] * x_dims[0];
+  FOR_RANGE(int64_t, y_idx, 0, elem_cnt) {
+    int64_t remaining = y_idx;
+    int64_t x_idx = 0;
+    for (int32_t i = num_axis - 1; i >= 0; --i) {
+      x_idx += (remaining % y_dims[i]) * x_strides[permutation[i]];
+      remaining /= y_dims[i];
+    }
+    y[y_idx] = x[x_idx];
+  }
+}
+
+template<typename T>
+void TestTranspose(const std::vector<int64_t>& x_dims, const std::vector<int32_t>& permutation) {
+  const int64_t elem_cnt =
+      std::accumulate(x_dims.begin(), x_dims.end(), int64_t(1), std::multiplies<int64_t>());
+  std::vector<T> x(elem_cnt);
+  FOR_RANGE(int64_t, i, 0, elem_cnt) { x[i] = static_cast<T>(i % 127); }
+  std::vector<T> y(elem_cnt);
+  std::vector<T> expected(elem_cnt);
+  HostTranspose<T>(x_dims.size(), x_dims.data(), permutation.data(), x.data(), y.data());
+  NaiveTranspose<T>(x_dims, permutation, x.data(), expected.data());
+  ASSERT_TRUE(y == expected);
+}
+
+void TestCommonPermutations() {
+  TestTranspose<float>({37, 41}, {1, 0});
+  TestTranspose<float>({7, 33, 65}, {2, 1, 0});
+  TestTranspose<float>({4, 16, 28, 28}, {0, 2, 3, 1});
+  TestTranspose<float>({4, 28, 28, 16}, {0, 3, 1, 2});
+  TestTranspose<float>({2, 64, 12, 64}, {0, 2, 1, 3});
+  TestTranspose<float>({2, 64, 12, 64}, {0, 2, 3, 1});
+  TestTranspose<double>({3, 5, 7, 9}, {3, 1, 0, 2});
+  TestTranspose<int8_t>({5, 1, 7, 9}, {3, 2, 1, 0});
+  TestTranspose<int32_t>({1, 1, 1}, {2, 0, 1});
+  TestTranspose<int64_t>({3, 4}, {0, 1});
+}
+
+}  // namespace
+
+TEST(HostTranspose, common_permutations) { TestCommonPermutations(); }
+
+TEST(HostTranspose, zero_size_dim) {
+  TestTranspose<float>({0, 5}, {1, 0});
+  TestTranspose<float>({3, 0, 5}, {0, 2, 1});
+  TestTranspose<float>({3, 5, 0}, {1, 0, 2});
+  TestTranspose<float>({4, 0}, {0, 1});
+}
+
+TEST(HostTranspose, common_permutations_multi_thread) {
+  Global<ThreadPool>::New(4);
+  TestCommonPermutations();
+  Global<ThreadPool>::Delete();
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(HostTranspose, DISABLED_benchmark) {
+  Global<ThreadPool>::New(std::thread::hardware_concurrency());
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int32_t>>> cases = {
+      {{32, 64, 112, 112}, {0, 2, 3, 1}},  // NCHW -> NHWC
+      {{32, 112, 112, 64}, {0, 3, 1, 2}},  // NHWC -> NCHW
+      {{64, 128, 16, 64}, {0, 2, 1, 3}},   // attention heads
+      {{64, 128, 16, 64}, {0, 2, 3, 1}},   // attention keys
+      {{4096, 4096}, {1, 0}},
+  };
+  const int32_t iter_num = 10;
+  for (const auto& pair : cases) {
+    const std::vector<int64_t>& x_dims = pair.first;
+    const int64_t elem_cnt =
+        std::accumulate(x_dims.begin(), x_dims.end(), int64_t(1), std::multiplies<int64_t>());
+    std::vector<float> x(elem_cnt, 1);
+    std::vector<float> y(elem_cnt, 0);
+    auto start = std::chrono::steady_clock::now();
+    FOR_RANGE(int32_t, i, 0, iter_num) {
+      HostTranspose<float>(x_dims.size(), x_dims.data(), pair.second.data(), x.data(), y.data());
+    }
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "permutation of " << Shape(DimVector(x_dims.begin(), x_dims.end())).DebugStr()
+              << ": " << 2.0 * elem_cnt * sizeof(float) * iter_num / elapsed_s / 1e9 << " GB/s";
+  }
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace oneflow
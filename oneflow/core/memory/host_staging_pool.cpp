@@ -0,0 +1,153 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/memory/host_staging_pool.h"
+
+#ifdef PLATFORM_POSIX
+#include <sys/mman.h>
+#endif
+
+namespace oneflow {
+
+namespace {
+
+const int32_t kMinSizeClassLog = 12;
+const int32_t kMaxSizeClassLog = 30;
+const int32_t kSubClassNum = 4;
+const int32_t kSizeClassNum = (kMaxSizeClassLog - kMinSizeClassLog) * kSubClassNum + 1;
+const size_t kHugePageByte = 2 * 1024 * 1024;
+
+// Placed in front of every buffer, so buffers may outlive the pool or bypass it
+struct StagingBufferHeader {
+  size_t byte_size;
+  int32_t size_class;
+};
+const size_t kStagingBufferHeaderByte = 64;
+static_assert(sizeof(StagingBufferHeader) <= kStagingBufferHeaderByte, "");
+
+StagingBufferHeader* Header4Buffer(void* ptr) {
+  return reinterpret_cast<StagingBufferHeader*>(static_cast<char*>(ptr)
+                                                - kStagingBufferHeaderByte);
+}
+
+char* NewStagingBuffer(size_t byte_size, int32_t size_class) {
+  const size_t total_byte_size = kStagingBufferHeaderByte + byte_size;
+  const bool use_huge_page = total_byte_size >= kHugePageByte;
+  void* base = nullptr;
+  CHECK_EQ(posix_memalign(&base, use_huge_page ? kHugePageByte : kStagingBufferHeaderByte,
+                          total_byte_size),
+           0);
+#if defined(PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+  // only a hint, kernels without transparent huge pages simply ignore it
+  if (use_huge_page) { madvise(base, total_byte_size, MADV_HUGEPAGE); }
+#endif
+  StagingBufferHeader* header = static_cast<StagingBufferHeader*>(base);
+  header->byte_size = byte_size;
+  header->size_class = size_class;
+  return static_cast<char*>(base) + kStagingBufferHeaderByte;
+}
+
+void DeleteStagingBuffer(void* ptr) { free(Header4Buffer(ptr)); }
+
+}  // namespace
+
+HostStagingPool::HostStagingPool(size_t max_cached_byte)
+    : max_cached_byte_(max_cached_byte), cached_byte_(0), hit_num_(0), miss_num_(0) {
+  FOR_RANGE(int32_t, i, 0, kSizeClassNum) { free_lists_.emplace_back(new FreeList); }
+}
+
+HostStagingPool::~HostStagingPool() {
+  for (const auto& free_list : free_lists_) {
+    for (char* buffer : free_list->buffers) { DeleteStagingBuffer(buffer); }
+  }
+  LOG(INFO) << "HostStagingPool hit " << hit_num_ << " miss " << miss_num_;
+}
+
+int32_t HostStagingPool::SizeClass4ByteSize(size_t byte_size) {
+  if (byte_size <= (static_cast<size_t>(1) << kMinSizeClassLog)) { return 0; }
+  if (byte_size > (static_cast<size_t>(1) << kMaxSizeClassLog)) { return -1; }
+  // 2^log < byte_size <= 2^(log + 1) is split into kSubClassNum steps
+  int32_t log = 0;
+  while ((static_cast<size_t>(2) << log) < byte_size) { ++log; }
+  const size_t step = static_cast<size_t>(1) << (log - 2);
+  const int32_t step_num = static_cast<int32_t>((byte_size + step - 1) / step);
+  return (log - kMinSizeClassLog) * kSubClassNum + (step_num - kSubClassNum);
+}
+
+size_t HostStagingPool::ByteSize4SizeClass(int32_t size_class) {
+  CHECK_GE(size_class, 0);
+  CHECK_LT(size_class, kSizeClassNum);
+  if (size_class == 0) { return static_cast<size_t>(1) << kMinSizeClassLog; }
+  const int32_t log = kMinSizeClassLog + (size_class - 1) / kSubClassNum;
+  const size_t step_num = (size_class - 1) % kSubClassNum + kSubClassNum + 1;
+  return step_num << (log - 2);
+}
+
+void* HostStagingPool::Allocate(size_t byte_size) {
+  const int32_t size_class = SizeClass4ByteSize(byte_size);
+  if (size_class == -1) {
+    miss_num_ += 1;
+    return NewStagingBuffer(byte_size, size_class);
+  }
+  const size_t class_byte_size = ByteSize4SizeClass(size_class);
+  FreeList* free_list = free_lists_.at(size_class).get();
+  {
+    std::unique_lock<std::mutex> lck(free_list->mtx);
+    if (!free_list->buffers.empty()) {
+      char* buffer = free_list->buffers.back();
+      free_list->buffers.pop_back();
+      cached_byte_ -= class_byte_size;
+      hit_num_ += 1;
+      return buffer;
+    }
+  }
+  miss_num_ += 1;
+  return NewStagingBuffer(class_byte_size, size_class);
+}
+
+void HostStagingPool::Deallocate(void* ptr) {
+  const StagingBufferHeader* header = Header4Buffer(ptr);
+  if (header->size_class == -1) {
+    DeleteStagingBuffer(ptr);
+    return;
+  }
+  const size_t class_byte_size = header->byte_size;
+  if (cached_byte_.fetch_add(class_byte_size) + class_byte_size > max_cached_byte_) {
+    cached_byte_ -= class_byte_size;
+    DeleteStagingBuffer(ptr);
+    return;
+  }
+  FreeList* free_list = free_lists_.at(header->size_class).get();
+  std::unique_lock<std::mutex> lck(free_list->mtx);
+  free_list->buffers.push_back(static_cast<char*>(ptr));
+}
+
+void* AllocateStagingHostMem(size_t byte_size) {
+  HostStagingPool* pool = Global<HostStagingPool>::Get();
+  if (pool != nullptr) { return pool->Allocate(byte_size); }
+  return NewStagingBuffer(byte_size, -1);
+}
+
+void DeallocateStagingHostMem(void* ptr) {
+  if (ptr == nullptr) { return; }
+  HostStagingPool* pool = Global<HostStagingPool>::Get();
+  if (pool != nullptr) {
+    pool->Deallocate(ptr);
+  } else {
+    DeleteStagingBuffer(ptr);
+  }
+}
+
+}  // namespace oneflow
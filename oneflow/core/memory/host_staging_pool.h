@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_MEMORY_HOST_STAGING_POOL_H_
+#define ONEFLOW_CORE_MEMORY_HOST_STAGING_POOL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Recycles the host buffers of the data pipeline, e.g. decoded samples in TensorBuffers, so a
+// step does not map and fault in fresh pages for every sample. Buffers of 2MB and more are
+// advised to use transparent huge pages
+class HostStagingPool final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(HostStagingPool);
+  explicit HostStagingPool(size_t max_cached_byte);
+  ~HostStagingPool();
+
+  // The buffer holds at least byte_size bytes and is 64 bytes aligned
+  void* Allocate(size_t byte_size);
+  void Deallocate(void* ptr);
+
+  size_t cached_byte() const { return cached_byte_; }
+  int64_t hit_num() const { return hit_num_; }
+  int64_t miss_num() const { return miss_num_; }
+
+  // Four classes per power of two from 4KB to 1GB, -1 for larger buffers which are not cached
+  static int32_t SizeClass4ByteSize(size_t byte_size);
+  static size_t ByteSize4SizeClass(int32_t size_class);
+
+ private:
+  struct FreeList {
+    std::mutex mtx;
+    std::vector<char*> buffers;
+  };
+
+  size_t max_cached_byte_;
+  std::vector<std::unique_ptr<FreeList>> free_lists_;
+  std::atomic<size_t> cached_byte_;
+  std::atomic<int64_t> hit_num_;
+  std::atomic<int64_t> miss_num_;
+};
+
+// Host memory of TensorBuffers, recycled through Global<HostStagingPool> if it exists
+void* AllocateStagingHostMem(size_t byte_size);
+void DeallocateStagingHostMem(void* ptr);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_MEMORY_HOST_STAGING_POOL_H_
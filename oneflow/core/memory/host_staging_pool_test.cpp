@@ -0,0 +1,65 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/memory/host_staging_pool.h"
+#include "gtest/gtest.h"
+
+namespace oneflow {
+
+namespace test {
+
+TEST(HostStagingPool, size_class) {
+  ASSERT_EQ(HostStagingPool::SizeClass4ByteSize(1), 0);
+  ASSERT_EQ(HostStagingPool::SizeClass4ByteSize(4096), 0);
+  ASSERT_EQ(HostStagingPool::ByteSize4SizeClass(1), 5120);
+  ASSERT_EQ(HostStagingPool::SizeClass4ByteSize(8192), 4);
+  ASSERT_EQ(HostStagingPool::SizeClass4ByteSize(8193), 5);
+  ASSERT_EQ(HostStagingPool::SizeClass4ByteSize((static_cast<size_t>(1) << 30) + 1), -1);
+  const size_t max_byte_size = static_cast<size_t>(1) << 30;
+  for (size_t byte_size = 1; byte_size <= max_byte_size; byte_size = byte_size * 5 / 4 + 1) {
+    const int32_t size_class = HostStagingPool::SizeClass4ByteSize(byte_size);
+    ASSERT_GE(HostStagingPool::ByteSize4SizeClass(size_class), byte_size);
+    if (size_class > 0) {
+      ASSERT_LT(HostStagingPool::ByteSize4SizeClass(size_class - 1), byte_size);
+    }
+  }
+}
+
+TEST(HostStagingPool, recycle) {
+  HostStagingPool pool(64 * 1024);
+  void* ptr = pool.Allocate(10000);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0);
+  pool.Deallocate(ptr);
+  ASSERT_EQ(pool.cached_byte(), 10240);
+  ASSERT_EQ(pool.Allocate(9000), ptr);
+  ASSERT_EQ(pool.cached_byte(), 0);
+  ASSERT_EQ(pool.hit_num(), 1);
+  ASSERT_EQ(pool.miss_num(), 1);
+  void* big = pool.Allocate(100 * 1024);
+  pool.Deallocate(big);
+  ASSERT_EQ(pool.cached_byte(), 0);
+  pool.Deallocate(ptr);
+}
+
+TEST(HostStagingPool, without_global_pool) {
+  void* ptr = AllocateStagingHostMem(100);
+  memset(ptr, 0, 100);
+  DeallocateStagingHostMem(ptr);
+  DeallocateStagingHostMem(nullptr);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/register/blob.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/record/record.pb.h"
+#include "oneflow/core/thread/numa_util.h"
 
 namespace oneflow {
 
@@ -34,7 +35,10 @@ void* MemoryAllocatorImpl::Allocate(MemoryCase mem_case, size_t size) {
         CudaCheck(cudaMallocHost(&ptr, size));
       }
     } else {
-      ptr = malloc(size);
+      if (mem_case.host_mem().used_by_network() && Global<CommNet>::Get() != nullptr) {
+        ptr = Global<CommNet>::Get()->AllocateRegisterMem(size);
+      }
+      if (ptr == nullptr) { ptr = malloc(size); }
       CHECK_NOTNULL(ptr);
     }
   } else if (mem_case.has_device_cuda_mem()) {
@@ -50,6 +54,9 @@ void MemoryAllocatorImpl::Deallocate(void* ptr, MemoryCase mem_case) {
   if (mem_case.has_host_mem()) {
     if (mem_case.host_mem().has_cuda_pinned_mem()) {
       CudaCheck(cudaFreeHost(ptr));
+    } else if (mem_case.host_mem().used_by_network() && Global<CommNet>::Get() != nullptr
+               && Global<CommNet>::Get()->DeallocateRegisterMem(ptr)) {
+      // released by the comm net
     } else {
       free(ptr);
     }
@@ -74,8 +81,16 @@ MemoryAllocator::~MemoryAllocator() {
 }
 
 char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size) {
+  return Allocate(mem_case, size, -1);
+}
+
+char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size, int32_t numa_node) {
+  std::unique_ptr<NumaNodeGuard> numa_node_guard;
+  if (numa_node >= 0 && mem_case.has_host_mem() && !mem_case.host_mem().has_cuda_pinned_mem()) {
+    numa_node_guard.reset(new NumaNodeGuard(numa_node));
+  }
   const int memset_val = 0;
-  char* dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
+  char* dptr = AllocateUninitialized(mem_case, size, -1);
   if (mem_case.has_host_mem()) {
     memset(dptr, memset_val, size);
   } else if (mem_case.has_device_cuda_mem()) {
@@ -84,7 +99,20 @@ char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size) {
   } else {
     UNIMPLEMENTED();
   }
-  deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
+  return dptr;
+}
+
+char* MemoryAllocator::AllocateUninitialized(MemoryCase mem_case, std::size_t size,
+                                             int32_t numa_node) {
+  std::unique_ptr<NumaNodeGuard> numa_node_guard;
+  if (numa_node >= 0 && mem_case.has_host_mem() && !mem_case.host_mem().has_cuda_pinned_mem()) {
+    numa_node_guard.reset(new NumaNodeGuard(numa_node));
+  }
+  char* dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
+  {
+    std::unique_lock<std::mutex> lock(deleters_mutex_);
+    deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
+  }
   return dptr;
 }
 
@@ -28,6 +28,10 @@ class MemoryAllocator final {
   ~MemoryAllocator();
 
   char* Allocate(MemoryCase mem_case, std::size_t size);
+  // Unpinned host memory is first touched from a cpu of numa_node, -1 means no preference
+  char* Allocate(MemoryCase mem_case, std::size_t size, int32_t numa_node);
+  // Same as Allocate but leaves the memory unset, the caller is responsible for initializing it
+  char* AllocateUninitialized(MemoryCase mem_case, std::size_t size, int32_t numa_node);
   template<typename T>
   T* PlacementNew(T* mem_ptr);
 
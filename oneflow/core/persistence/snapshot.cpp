@@ -19,6 +19,9 @@ limitations under the License.
 #include "oneflow/core/persistence/persistent_out_stream.h"
 #include "oneflow/core/register/tensor_slice_copier.h"
 #include "oneflow/core/device/cpu_device_context.h"
+#include "oneflow/core/persistence/snapshot_write_mgr.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include "oneflow/user/summary/crc32c.h"
 
 namespace oneflow {
 
@@ -28,10 +31,28 @@ std::string GenDataFilePath(const std::string& root, const std::string& key) {
   return JoinPath(root, key);
 }
 
+std::string GenChecksumFilePath(const std::string& data_file_path) {
+  return data_file_path + ".crc32c";
+}
+
+void CheckChecksumIfExists(const std::string& path, const char* data, size_t size) {
+  const std::string checksum_path = GenChecksumFilePath(path);
+  if (!SnapshotFS()->FileExists(checksum_path)) { return; }
+  uint32_t expected_crc = 0;
+  PersistentInStream in_stream(SnapshotFS(), checksum_path);
+  in_stream.ReadFully(reinterpret_cast<char*>(&expected_crc), sizeof(expected_crc));
+  CHECK_EQ(summary::GetCrc32(data, size), expected_crc)
+      << "model snapshot checksum mismatch, path: " << path;
+}
+
 }  // namespace
 
-SnapshotReader::SnapshotReader(const std::string& snapshot_root_path)
-    : root_path_(snapshot_root_path) {}
+SnapshotReader::SnapshotReader(const std::string& snapshot_root_path, bool wait_for_writes)
+    : root_path_(snapshot_root_path) {
+  if (wait_for_writes && Global<SnapshotWriteMgr>::Get() != nullptr) {
+    Global<SnapshotWriteMgr>::Get()->WaitUntilDone(snapshot_root_path);
+  }
+}
 
 bool SnapshotReader::HasKey(const std::string& key) const {
   const std::string path = GenDataFilePath(root_path_, key);
@@ -57,10 +78,12 @@ void SnapshotReader::Read(const std::string& key, const Shape& logical_blob_shap
         SnapshotFS(), path,
         slice.At(0).begin() * slice.shape().Count(1) * GetSizeOfDataType(data_type));
     in_stream.ReadFully(dst, slice.shape().elem_cnt() * GetSizeOfDataType(data_type));
+    if (slice == logical_blob_slice) { CheckChecksumIfExists(path, dst, logical_blob_size); }
   } else {
     std::vector<char> buffer(logical_blob_size);
     PersistentInStream in_stream(SnapshotFS(), path);
     in_stream.ReadFully(buffer.data(), logical_blob_size);
+    CheckChecksumIfExists(path, buffer.data(), logical_blob_size);
     TensorSliceCopier copier(slice, logical_blob_slice, data_type);
     CpuDeviceCtx device_ctx;
     std::unique_ptr<MemoryCopier> host_memory_copier(NewDefaultMemoryCopier(DeviceType::kCPU));
@@ -88,6 +111,9 @@ SnapshotWriter::SnapshotWriter(const std::string& snapshot_root_path)
       SnapshotFS()->CreateDir(snapshot_root_path);
     }
   });
+  if (Global<SnapshotWriteMgr>::Get() != nullptr) {
+    Global<SnapshotWriteMgr>::Get()->WaitUntilOthersDone(snapshot_root_path);
+  }
 }
 
 void SnapshotWriter::Write(const std::string& key, const char* data, size_t size) {
@@ -95,16 +121,73 @@ void SnapshotWriter::Write(const std::string& key, const char* data, size_t size
   const std::string dir_path = Dirname(path);
   SnapshotFS()->CreateDirIfNotExist(dir_path);
   CHECK(!SnapshotFS()->FileExists(path));
-  PersistentOutStream out_stream(SnapshotFS(), path);
-  out_stream.Write(data, size);
+  WriteSnapshotDataFile(path, data, size);
 }
 
 void SnapshotWriter::Write(const std::string& key, const Blob* blob) {
   Write(key, blob->dptr<char>(), blob->ByteSizeOfBlobBody());
 }
 
+void SnapshotWriter::AsyncWrite(const std::string& key, const char* data, size_t size) {
+  SnapshotWriteMgr* write_mgr = Global<SnapshotWriteMgr>::Get();
+  if (write_mgr == nullptr) {
+    Write(key, data, size);
+    return;
+  }
+  const std::string path = GenDataFilePath(root_path_, key);
+  SnapshotFS()->CreateDirIfNotExist(Dirname(path));
+  CHECK(!SnapshotFS()->FileExists(path));
+  std::shared_ptr<std::vector<char>> staging_buf(new std::vector<char>(data, data + size));
+  write_mgr->AddWrite(root_path_, [path, staging_buf]() {
+    WriteSnapshotDataFile(path, staging_buf->data(), staging_buf->size());
+  });
+}
+
+void SnapshotWriter::AsyncWrite(const std::string& key, const Blob* blob) {
+  AsyncWrite(key, blob->dptr<char>(), blob->ByteSizeOfBlobBody());
+}
+
+void SnapshotWriter::Flush() {
+  SnapshotWriteMgr* write_mgr = Global<SnapshotWriteMgr>::Get();
+  if (write_mgr != nullptr) { write_mgr->WaitUntilDone(root_path_); }
+}
+
 void SnapshotWriter::Close() {
-  PersistentOutStream out_stream(SnapshotFS(), JoinPath(root_path_, "snapshot_done"));
+  const std::string done_path = JoinPath(root_path_, "snapshot_done");
+  SnapshotWriteMgr* write_mgr = Global<SnapshotWriteMgr>::Get();
+  if (write_mgr == nullptr) {
+    PersistentOutStream out_stream(SnapshotFS(), done_path);
+    return;
+  }
+  write_mgr->AddDoneCallback(root_path_, [done_path]() {
+    std::unique_ptr<fs::WritableFile> file;
+    SnapshotFS()->NewWritableFile(done_path, &file);
+    file->Close();
+  });
+}
+
+void WriteSnapshotDataFile(const std::string& path, const char* data, size_t size) {
+  const IOConf* io_conf = Global<const IOConf>::Get();
+  const size_t chunk_size = io_conf->snapshot_write_chunk_byte();
+  CHECK_GT(chunk_size, 0);
+  const bool enable_checksum = io_conf->enable_snapshot_checksum();
+  uint32_t crc = 0;
+  {
+    std::unique_ptr<fs::WritableFile> file;
+    SnapshotFS()->NewWritableFile(path, &file);
+    for (size_t offset = 0; offset < size; offset += chunk_size) {
+      const size_t cur_size = std::min(chunk_size, size - offset);
+      if (enable_checksum) { crc = summary::ExtendCrc32(crc, data + offset, cur_size); }
+      file->Append(data + offset, cur_size);
+    }
+    file->Close();
+  }
+  if (enable_checksum) {
+    std::unique_ptr<fs::WritableFile> checksum_file;
+    SnapshotFS()->NewWritableFile(GenChecksumFilePath(path), &checksum_file);
+    checksum_file->Append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+    checksum_file->Close();
+  }
 }
 
 }  // namespace oneflow
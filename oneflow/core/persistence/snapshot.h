@@ -28,7 +28,9 @@ class SnapshotReader final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SnapshotReader);
   SnapshotReader() = delete;
-  explicit SnapshotReader(const std::string& snapshot_root_path);
+  // Waits for pending async writes of the snapshot unless wait_for_writes is false, which suits
+  // files written synchronously by the caller itself
+  explicit SnapshotReader(const std::string& snapshot_root_path, bool wait_for_writes = true);
   ~SnapshotReader() = default;
 
   void Read(const std::string& key, const Shape& logical_blob_shape, DataType data_type,
@@ -47,17 +49,31 @@ class SnapshotWriter final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SnapshotWriter);
   SnapshotWriter() = delete;
+  // Waits for the pending async writes of earlier snapshots, which bounds the staging memory to
+  // one snapshot
   explicit SnapshotWriter(const std::string& snapshot_root_path);
   ~SnapshotWriter() = default;
 
   void Write(const std::string& key, const char* data, size_t size);
   void Write(const std::string& key, const Blob* blob);
+  // Copies the data into a staging buffer and returns before the file is written when
+  // async snapshot write is enabled, otherwise the same as Write. Loading the snapshot, the next
+  // save and the end of the session wait for the file
+  void AsyncWrite(const std::string& key, const char* data, size_t size);
+  void AsyncWrite(const std::string& key, const Blob* blob);
+  // Returns once every write of this snapshot is finished
+  void Flush();
+  // Writes snapshot_done after every write of this snapshot, without waiting for them
   void Close();
 
  private:
   const std::string root_path_;
 };
 
+// Writes a file of a snapshot in chunks, followed by its crc32c file if snapshot checksum is
+// enabled. The directory of path must exist
+void WriteSnapshotDataFile(const std::string& path, const char* data, size_t size);
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_H_
@@ -0,0 +1,162 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/snapshot.h"
+#include "oneflow/core/persistence/snapshot_write_mgr.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/job/job_set.pb.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IOConf io_conf;
+    io_conf.mutable_data_fs_conf()->mutable_localfs_conf();
+    io_conf.mutable_snapshot_fs_conf()->mutable_localfs_conf();
+    io_conf.set_enable_snapshot_checksum(true);
+    // a few chunks per file
+    io_conf.set_snapshot_write_chunk_byte(1000);
+    Global<const IOConf>::New(io_conf);
+    Global<SnapshotWriteMgr>::New(4);
+    root_path_ = JoinPath(GetCwd(), "tmp_snapshot_test_asdfasdf");
+    LocalFS()->RecursivelyCreateDirIfNotExist(root_path_);
+  }
+
+  void TearDown() override {
+    Global<SnapshotWriteMgr>::Delete();
+    LocalFS()->RecursivelyDeleteDir(root_path_);
+    Global<const IOConf>::Delete();
+  }
+
+  // same as SnapshotWriter::AsyncWrite, which also needs the control plane of a session
+  void AsyncWrite(const std::string& key, const std::vector<float>& data) {
+    const std::string path = JoinPath(root_path_, key);
+    LocalFS()->RecursivelyCreateDirIfNotExist(Dirname(path));
+    Global<SnapshotWriteMgr>::Get()->AddWrite(root_path_, [path, data]() {
+      WriteSnapshotDataFile(path, reinterpret_cast<const char*>(data.data()),
+                            data.size() * sizeof(float));
+    });
+  }
+
+  std::vector<float> Read(const std::string& key, int64_t elem_cnt) {
+    std::vector<float> data(elem_cnt);
+    const Shape shape({elem_cnt});
+    SnapshotReader reader(root_path_);
+    reader.Read(key, shape, DataType::kFloat, TensorSliceView(shape),
+                reinterpret_cast<char*>(data.data()));
+    return data;
+  }
+
+  std::string root_path_;
+};
+
+std::vector<float> GenData(int64_t elem_cnt, float base) {
+  std::vector<float> data(elem_cnt);
+  FOR_RANGE(int64_t, i, 0, elem_cnt) { data[i] = base + i; }
+  return data;
+}
+
+}  // namespace
+
+TEST_F(SnapshotTest, async_write_then_read) {
+  const int64_t var_num = 16;
+  const int64_t elem_cnt = 3001;
+  FOR_RANGE(int64_t, i, 0, var_num) {
+    AsyncWrite("var_" + std::to_string(i) + "/out", GenData(elem_cnt, i * 10000));
+  }
+  // the reader waits for pending writes of the same snapshot
+  FOR_RANGE(int64_t, i, 0, var_num) {
+    ASSERT_EQ(Read("var_" + std::to_string(i) + "/out", elem_cnt), GenData(elem_cnt, i * 10000));
+    ASSERT_TRUE(LocalFS()->FileExists(JoinPath(root_path_, "var_" + std::to_string(i) + "/out")
+                                      + ".crc32c"));
+  }
+}
+
+TEST_F(SnapshotTest, wait_until_done) {
+  std::atomic<int64_t> write_cnt(0);
+  FOR_RANGE(int64_t, i, 0, 64) {
+    Global<SnapshotWriteMgr>::Get()->AddWrite(root_path_, [&write_cnt]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      write_cnt += 1;
+    });
+  }
+  Global<SnapshotWriteMgr>::Get()->WaitUntilDone(root_path_);
+  ASSERT_EQ(write_cnt, 64);
+}
+
+TEST_F(SnapshotTest, done_callback_after_writes) {
+  std::atomic<int64_t> write_cnt(0);
+  std::atomic<int64_t> write_cnt_when_done(-1);
+  FOR_RANGE(int64_t, i, 0, 64) {
+    Global<SnapshotWriteMgr>::Get()->AddWrite(root_path_, [&write_cnt]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      write_cnt += 1;
+    });
+  }
+  Global<SnapshotWriteMgr>::Get()->AddDoneCallback(
+      root_path_, [&]() { write_cnt_when_done = write_cnt.load(); });
+  Global<SnapshotWriteMgr>::Get()->WaitUntilDone(root_path_);
+  ASSERT_EQ(write_cnt_when_done, 64);
+  // without pending writes it runs right away
+  std::atomic<bool> is_done(false);
+  Global<SnapshotWriteMgr>::Get()->AddDoneCallback(root_path_, [&]() { is_done = true; });
+  Global<SnapshotWriteMgr>::Get()->WaitUntilDone(root_path_);
+  ASSERT_TRUE(is_done);
+}
+
+TEST_F(SnapshotTest, wait_until_others_done) {
+  const std::string other_root_path = JoinPath(root_path_, "other");
+  std::atomic<int64_t> other_write_cnt(0);
+  std::atomic<bool> is_blocked(true);
+  FOR_RANGE(int64_t, i, 0, 16) {
+    Global<SnapshotWriteMgr>::Get()->AddWrite(other_root_path, [&other_write_cnt]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      other_write_cnt += 1;
+    });
+  }
+  // a write of this snapshot stays pending until the others are waited for
+  Global<SnapshotWriteMgr>::Get()->AddWrite(root_path_, [&is_blocked]() {
+    while (is_blocked) { std::this_thread::yield(); }
+  });
+  Global<SnapshotWriteMgr>::Get()->WaitUntilOthersDone(root_path_);
+  ASSERT_EQ(other_write_cnt, 16);
+  is_blocked = false;
+  Global<SnapshotWriteMgr>::Get()->WaitUntilAllDone();
+}
+
+TEST_F(SnapshotTest, checksum_mismatch) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  const int64_t elem_cnt = 3001;
+  AsyncWrite("var/out", GenData(elem_cnt, 0));
+  Global<SnapshotWriteMgr>::Get()->WaitUntilDone(root_path_);
+  const std::string path = JoinPath(root_path_, "var/out");
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(1234);
+    file.put('\x7f');
+  }
+  ASSERT_DEATH(Read("var/out", elem_cnt), "checksum mismatch");
+}
+
+}  // namespace test
+
+}  // namespace oneflow
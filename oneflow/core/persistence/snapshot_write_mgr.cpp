@@ -0,0 +1,101 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/snapshot_write_mgr.h"
+
+namespace oneflow {
+
+SnapshotWriteMgr::SnapshotWriteMgr(int32_t worker_num) {
+  CHECK_GT(worker_num, 0);
+  write_pool_.reset(new ThreadPool(worker_num));
+}
+
+SnapshotWriteMgr::~SnapshotWriteMgr() {
+  WaitUntilAllDone();
+  write_pool_.reset();
+}
+
+void SnapshotWriteMgr::AddWrite(const std::string& root_path, const std::function<void()>& write) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    root_path2pending_cnt_[root_path] += 1;
+  }
+  write_pool_->AddWork([this, root_path, write]() {
+    write();
+    OnWriteDone(root_path);
+  });
+}
+
+void SnapshotWriteMgr::AddDoneCallback(const std::string& root_path,
+                                       const std::function<void()>& done) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (root_path2pending_cnt_.find(root_path) != root_path2pending_cnt_.end()) {
+      root_path2done_callbacks_[root_path].push_back(done);
+      return;
+    }
+  }
+  AddWrite(root_path, done);
+}
+
+void SnapshotWriteMgr::OnWriteDone(const std::string& root_path) {
+  std::vector<std::function<void()>> done_callbacks;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = root_path2pending_cnt_.find(root_path);
+    CHECK(it != root_path2pending_cnt_.end());
+    it->second -= 1;
+    if (it->second > 0) { return; }
+    auto callback_it = root_path2done_callbacks_.find(root_path);
+    if (callback_it == root_path2done_callbacks_.end()) {
+      root_path2pending_cnt_.erase(it);
+      cond_.notify_all();
+      return;
+    }
+    // the callbacks keep the snapshot pending
+    done_callbacks.swap(callback_it->second);
+    root_path2done_callbacks_.erase(callback_it);
+    it->second = done_callbacks.size();
+  }
+  for (const auto& done : done_callbacks) {
+    write_pool_->AddWork([this, root_path, done]() {
+      done();
+      OnWriteDone(root_path);
+    });
+  }
+}
+
+void SnapshotWriteMgr::WaitUntilDone(const std::string& root_path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() {
+    return root_path2pending_cnt_.find(root_path) == root_path2pending_cnt_.end();
+  });
+}
+
+void SnapshotWriteMgr::WaitUntilOthersDone(const std::string& root_path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() {
+    return root_path2pending_cnt_.empty()
+           || (root_path2pending_cnt_.size() == 1
+               && root_path2pending_cnt_.begin()->first == root_path);
+  });
+}
+
+void SnapshotWriteMgr::WaitUntilAllDone() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() { return root_path2pending_cnt_.empty(); });
+}
+
+}  // namespace oneflow
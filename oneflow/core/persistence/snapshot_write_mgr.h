@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_WRITE_MGR_H_
+#define ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_WRITE_MGR_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+namespace oneflow {
+
+// Runs snapshot file writes in background, grouped by snapshot root path
+class SnapshotWriteMgr final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SnapshotWriteMgr);
+  explicit SnapshotWriteMgr(int32_t worker_num);
+  ~SnapshotWriteMgr();
+
+  void AddWrite(const std::string& root_path, const std::function<void()>& write);
+  // Runs done on the write pool once every write of root_path added so far is finished, the
+  // snapshot counts as pending until done returns
+  void AddDoneCallback(const std::string& root_path, const std::function<void()>& done);
+  void WaitUntilDone(const std::string& root_path);
+  // Waits for the writes of every snapshot other than root_path
+  void WaitUntilOthersDone(const std::string& root_path);
+  void WaitUntilAllDone();
+
+ private:
+  void OnWriteDone(const std::string& root_path);
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  HashMap<std::string, int64_t> root_path2pending_cnt_;
+  HashMap<std::string, std::vector<std::function<void()>>> root_path2done_callbacks_;
+  std::unique_ptr<ThreadPool> write_pool_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_WRITE_MGR_H_
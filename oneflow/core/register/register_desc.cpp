@@ -22,6 +22,31 @@ limitations under the License.
 
 namespace oneflow {
 
+namespace {
+
+// Copy kernels overwrite the whole body of static POD blobs, so their out regsts are never read
+// before being written
+bool IsFullyWrittenBeforeRead(
+    const TaskNode* producer,
+    const HashMap<LogicalBlobId, std::unique_ptr<BlobDesc>>& lbi2blob_desc) {
+  if (producer == nullptr) { return false; }
+  const TaskType task_type = producer->GetTaskType();
+  if (task_type != TaskType::kCopyHd && task_type != TaskType::kCopyCommNet) { return false; }
+  if (lbi2blob_desc.empty()) { return false; }
+  for (const auto& pair : lbi2blob_desc) {
+    const BlobDesc& blob_desc = *pair.second;
+    if (blob_desc.is_dynamic() || blob_desc.is_tensor_list() || blob_desc.header_is_opaque()) {
+      return false;
+    }
+    if (blob_desc.data_type() == kOFRecord || blob_desc.data_type() == kTensorBuffer) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 RegstDesc::RegstDesc() {
   regst_desc_id_ = Global<IDMgr>::Get()->NewRegstDescId();
   producer_ = nullptr;
@@ -146,6 +171,7 @@ void RegstDesc::ToProto(RegstDescProto* ret) const {
     }
     CHECK(data_regst_time_shape_);
     data_regst_time_shape_->ToProto(data_regst_desc_proto->mutable_time_shape());
+    ret->set_skip_zero_init(IsFullyWrittenBeforeRead(producer_, lbi2blob_desc_));
   } else if (regst_desc_type_.has_ctrl_regst_desc()) {
     // do nothing
   } else {
@@ -19,9 +19,12 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/comm_network/comm_network.h"
+#include "oneflow/core/device/cuda_util.h"
 #include "oneflow/core/job/machine_context.h"
 #include "oneflow/core/memory/memory_case.pb.h"
 #include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/thread/numa_util.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 
@@ -33,31 +36,179 @@ void CheckBlobInRegstNotDisabled(const RegstDescProto& regst_desc) {
         == false);
 }
 
+// Host mem blocks and chunks are placed on the numa node of the actor threads producing most of
+// their bytes
+void GenMemBlockAndChunkNumaNodes(const Plan& plan, int64_t this_machine_id,
+                                  HashMap<int64_t, int32_t>* mem_block_id2numa_node,
+                                  HashMap<int64_t, int32_t>* chunk_id2numa_node) {
+  HashMap<int64_t, int32_t> regst_mem_block_id2numa_node;
+  for (const TaskProto& task : plan.task()) {
+    if (task.machine_id() != this_machine_id) { continue; }
+    const int32_t numa_node = NumaNode4ThrdId(task.thrd_id());
+    if (numa_node < 0) { continue; }
+    for (const auto& pair : task.produced_regst_desc()) {
+      const int64_t mem_block_id = pair.second.mem_block_id();
+      if (mem_block_id != -1) { regst_mem_block_id2numa_node.emplace(mem_block_id, numa_node); }
+    }
+  }
+  HashMap<int64_t, HashMap<int32_t, int64_t>> chunk_id2numa_node2size;
+  for (const MemBlockProto& mem_block : plan.block_chunk_list().mem_block()) {
+    if (mem_block.machine_id() != this_machine_id) { continue; }
+    const auto it = regst_mem_block_id2numa_node.find(mem_block.mem_block_id());
+    if (it == regst_mem_block_id2numa_node.end()) { continue; }
+    mem_block_id2numa_node->emplace(mem_block.mem_block_id(), it->second);
+    if (mem_block.has_chunk_id()) {
+      chunk_id2numa_node2size[mem_block.chunk_id()][it->second] += mem_block.mem_size();
+    }
+  }
+  for (const auto& pair : chunk_id2numa_node2size) {
+    const auto max_it = std::max_element(
+        pair.second.begin(), pair.second.end(),
+        [](const std::pair<const int32_t, int64_t>& lhs,
+           const std::pair<const int32_t, int64_t>& rhs) { return lhs.second < rhs.second; });
+    chunk_id2numa_node->emplace(pair.first, max_it->first);
+  }
+}
+
+// Mem blocks whose regsts are all fully written before being read need no zero-init
+HashSet<int64_t> GenSkipZeroInitMemBlockIds(const Plan& plan, int64_t this_machine_id) {
+  HashMap<int64_t, bool> mem_block_id2skip_zero_init;
+  for (const TaskProto& task : plan.task()) {
+    if (task.machine_id() != this_machine_id) { continue; }
+    for (const auto& pair : task.produced_regst_desc()) {
+      const RegstDescProto& regst_desc = pair.second;
+      if (regst_desc.mem_block_id() != -1) {
+        auto it = mem_block_id2skip_zero_init.emplace(regst_desc.mem_block_id(), true).first;
+        it->second = it->second && regst_desc.skip_zero_init();
+      }
+      if (regst_desc.separated_header_mem_block_id() != -1) {
+        mem_block_id2skip_zero_init[regst_desc.separated_header_mem_block_id()] = false;
+      }
+    }
+  }
+  HashSet<int64_t> skip_zero_init_mem_block_ids;
+  for (const auto& pair : mem_block_id2skip_zero_init) {
+    if (pair.second) { skip_zero_init_mem_block_ids.insert(pair.first); }
+  }
+  return skip_zero_init_mem_block_ids;
+}
+
+struct ZeroInitRange {
+  char* ptr;
+  size_t size;
+  MemoryCase mem_case;
+  int32_t numa_node;
+};
+
+// Host ranges are cut into pieces memset by the thread pool, each piece first touched from its
+// numa node; device ranges are cudaMemset one by one
+void ZeroInit(const std::vector<ZeroInitRange>& ranges) {
+  const size_t piece_size = 32 * 1024 * 1024;
+  std::vector<ZeroInitRange> host_pieces;
+  for (const ZeroInitRange& range : ranges) {
+    if (range.size == 0) { continue; }
+    if (range.mem_case.has_host_mem()) {
+      for (size_t offset = 0; offset < range.size; offset += piece_size) {
+        host_pieces.push_back(ZeroInitRange{range.ptr + offset,
+                                            std::min(piece_size, range.size - offset),
+                                            range.mem_case, range.numa_node});
+      }
+    } else if (range.mem_case.has_device_cuda_mem()) {
+      CudaCurrentDeviceGuard guard(range.mem_case.device_cuda_mem().device_id());
+      CudaCheck(cudaMemset(range.ptr, 0, range.size));
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+  MultiThreadLoop(host_pieces.size(), [&](size_t i) {
+    const ZeroInitRange& piece = host_pieces.at(i);
+    std::unique_ptr<NumaNodeGuard> numa_node_guard;
+    if (piece.numa_node >= 0) { numa_node_guard.reset(new NumaNodeGuard(piece.numa_node)); }
+    memset(piece.ptr, 0, piece.size);
+  });
+}
+
 }  // namespace
 
 RegstMgr::RegstMgr(const Plan& plan) {
   int64_t this_machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  HashMap<int64_t, int32_t> mem_block_id2numa_node;
+  HashMap<int64_t, int32_t> chunk_id2numa_node;
+  GenMemBlockAndChunkNumaNodes(plan, this_machine_id, &mem_block_id2numa_node,
+                               &chunk_id2numa_node);
+  auto NumaNode4Id = [](const HashMap<int64_t, int32_t>& id2numa_node, int64_t id) -> int32_t {
+    const auto it = id2numa_node.find(id);
+    return it == id2numa_node.end() ? -1 : it->second;
+  };
+  auto HostNumaNode = [](const MemoryCase& mem_case, int32_t numa_node) -> int32_t {
+    const bool is_unpinned_host_mem =
+        mem_case.has_host_mem() && !mem_case.host_mem().has_cuda_pinned_mem();
+    return is_unpinned_host_mem ? numa_node : -1;
+  };
+  const HashSet<int64_t> skip_zero_init_mem_block_ids =
+      GenSkipZeroInitMemBlockIds(plan, this_machine_id);
+  std::vector<ZeroInitRange> zero_init_ranges;
   HashMap<int64_t, char*> chunk_id2ptr;
+  HashMap<int64_t, std::vector<std::pair<int64_t, int64_t>>> chunk_id2zero_init_intervals;
   for (const ChunkProto& chunk : plan.block_chunk_list().chunk()) {
     if (chunk.machine_id() != this_machine_id) { continue; }
     if (chunk.mem_size() == 0) { continue; }
-    char* chunk_ptr = Global<MemoryAllocator>::Get()->Allocate(chunk.mem_case(), chunk.mem_size());
+    char* chunk_ptr = Global<MemoryAllocator>::Get()->AllocateUninitialized(
+        chunk.mem_case(), chunk.mem_size(), NumaNode4Id(chunk_id2numa_node, chunk.chunk_id()));
     CHECK(chunk_id2ptr.emplace(chunk.chunk_id(), chunk_ptr).second);
   }
   for (const MemBlockProto& mem_block : plan.block_chunk_list().mem_block()) {
     if (mem_block.machine_id() != this_machine_id) { continue; }
     if (mem_block.mem_size() == 0) { continue; }
+    const bool need_zero_init =
+        skip_zero_init_mem_block_ids.find(mem_block.mem_block_id())
+        == skip_zero_init_mem_block_ids.end();
+    const int32_t numa_node = NumaNode4Id(mem_block_id2numa_node, mem_block.mem_block_id());
     char* mem_block_ptr = nullptr;
     if (mem_block.has_chunk_id()) {
       CHECK(mem_block.has_chunk_offset());
       CHECK(chunk_id2ptr.find(mem_block.chunk_id()) != chunk_id2ptr.end());
       mem_block_ptr = chunk_id2ptr.at(mem_block.chunk_id()) + mem_block.chunk_offset();
+      if (need_zero_init) {
+        chunk_id2zero_init_intervals[mem_block.chunk_id()].emplace_back(
+            mem_block.chunk_offset(), mem_block.chunk_offset() + mem_block.mem_size());
+      }
     } else {
-      mem_block_ptr =
-          Global<MemoryAllocator>::Get()->Allocate(mem_block.mem_case(), mem_block.mem_size());
+      mem_block_ptr = Global<MemoryAllocator>::Get()->AllocateUninitialized(
+          mem_block.mem_case(), mem_block.mem_size(), numa_node);
+      if (need_zero_init) {
+        zero_init_ranges.push_back(ZeroInitRange{
+            mem_block_ptr, static_cast<size_t>(mem_block.mem_size()), mem_block.mem_case(),
+            HostNumaNode(mem_block.mem_case(), numa_node)});
+      }
     }
     CHECK(mem_block_id2ptr_.emplace(mem_block.mem_block_id(), mem_block_ptr).second);
   }
+  // mem blocks of different jobs may overlap inside a chunk, so merge their intervals first
+  for (const ChunkProto& chunk : plan.block_chunk_list().chunk()) {
+    auto intervals_it = chunk_id2zero_init_intervals.find(chunk.chunk_id());
+    if (intervals_it == chunk_id2zero_init_intervals.end()) { continue; }
+    std::vector<std::pair<int64_t, int64_t>>* intervals = &intervals_it->second;
+    std::sort(intervals->begin(), intervals->end());
+    char* chunk_ptr = chunk_id2ptr.at(chunk.chunk_id());
+    const int32_t numa_node =
+        HostNumaNode(chunk.mem_case(), NumaNode4Id(chunk_id2numa_node, chunk.chunk_id()));
+    int64_t begin = intervals->front().first;
+    int64_t end = intervals->front().second;
+    auto AddRange = [&]() {
+      zero_init_ranges.push_back(ZeroInitRange{chunk_ptr + begin, static_cast<size_t>(end - begin),
+                                               chunk.mem_case(), numa_node});
+    };
+    for (const auto& interval : *intervals) {
+      if (interval.first > end) {
+        AddRange();
+        begin = interval.first;
+      }
+      end = std::max(end, interval.second);
+    }
+    AddRange();
+  }
+  ZeroInit(zero_init_ranges);
   for (const TaskProto& task : plan.task()) {
     if (task.machine_id() != this_machine_id) { continue; }
     for (const auto& pair : task.produced_regst_desc()) {
@@ -14,12 +14,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/cpu_thread.h"
+#include "oneflow/core/thread/numa_util.h"
 
 namespace oneflow {
 
 CpuThread::CpuThread(int64_t thrd_id) {
   set_thrd_id(thrd_id);
-  mut_actor_thread() = std::thread([this]() {
+  const int32_t numa_node = NumaNode4ThrdId(thrd_id);
+  mut_actor_thread() = std::thread([this, numa_node]() {
+    if (numa_node >= 0) { BindCurrentThreadToNumaNode(numa_node); }
     ThreadCtx ctx;
 #ifdef WITH_CUDA
     ctx.cb_event_chan = nullptr;
@@ -0,0 +1,156 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/thread/numa_util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include <fstream>
+#ifdef PLATFORM_POSIX
+#include <pthread.h>
+#endif
+
+namespace oneflow {
+
+namespace {
+
+const char* kNumaNodeSysfsDir = "/sys/devices/system/node";
+
+#ifdef PLATFORM_POSIX
+
+// The cpus of numa_node within allowed_cpu_set, false if there is none
+bool NumaNodeGetAllowedCpuSet(int32_t numa_node, const cpu_set_t& allowed_cpu_set,
+                              cpu_set_t* cpu_set) {
+  std::ifstream in(JoinPath(kNumaNodeSysfsDir, "node" + std::to_string(numa_node), "cpulist"));
+  CHECK(in.good()) << "cannot read cpus of numa node " << numa_node;
+  std::string cpu_list;
+  std::getline(in, cpu_list);
+  ParseCpuList(cpu_list, cpu_set);
+  CPU_AND(cpu_set, cpu_set, &allowed_cpu_set);
+  if (CPU_COUNT(cpu_set) > 0) { return true; }
+  LOG_FIRST_N(WARNING, 1) << "no allowed cpu of numa node " << numa_node << " (" << cpu_list
+                          << "), the thread is left unbound";
+  return false;
+}
+
+#endif
+
+}  // namespace
+
+#ifdef PLATFORM_POSIX
+
+void ParseCpuList(const std::string& cpu_list, cpu_set_t* cpu_set) {
+  CPU_ZERO(cpu_set);
+  std::istringstream in(cpu_list);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    if (range.empty() || range == "\n") { continue; }
+    const size_t dash_pos = range.find('-');
+    const int64_t first = std::stoll(range.substr(0, dash_pos));
+    const int64_t last =
+        dash_pos == std::string::npos ? first : std::stoll(range.substr(dash_pos + 1));
+    FOR_RANGE(int64_t, cpu, first, last + 1) { CPU_SET(cpu, cpu_set); }
+  }
+}
+
+#endif
+
+int32_t NumaNodeNum() {
+  static const int32_t numa_node_num = []() {
+    int32_t num = 0;
+    while (std::ifstream(JoinPath(kNumaNodeSysfsDir, "node" + std::to_string(num), "cpulist"))
+               .good()) {
+      num += 1;
+    }
+    return std::max(num, 1);
+  }();
+  return numa_node_num;
+}
+
+int32_t NumaNode4Index(int64_t i, int64_t num) { return NumaNode4Index(i, num, NumaNodeNum()); }
+
+int32_t NumaNode4Index(int64_t i, int64_t num, int32_t numa_node_num) {
+  if (numa_node_num <= 1) { return 0; }
+  CHECK_GE(i, 0);
+  CHECK_LT(i, num);
+  BalancedSplitter bs(num, numa_node_num);
+  FOR_RANGE(int32_t, node, 0, numa_node_num) {
+    if (i < bs.At(node).end()) { return node; }
+  }
+  UNIMPLEMENTED();
+  return -1;
+}
+
+int64_t RotateIndexWithinNumaNode(int64_t i, int64_t num, int32_t numa_node_num,
+                                  size_t rotation) {
+  CHECK_GE(i, 0);
+  CHECK_LT(i, num);
+  const Range range = BalancedSplitter(num, std::max(numa_node_num, 1))
+                          .At(NumaNode4Index(i, num, numa_node_num));
+  return range.begin() + (i - range.begin() + rotation % range.size()) % range.size();
+}
+
+int32_t NumaNode4ThrdId(int64_t thrd_id) {
+  const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
+  if (!resource_desc->enable_numa_aware_thread_placement() || NumaNodeNum() <= 1) { return -1; }
+  const int64_t cpu_device_num = resource_desc->CpuDeviceNum();
+  const int64_t cpu_dev_phy_id = thrd_id - Global<IDMgr>::Get()->GetCpuDeviceThrdId(0);
+  if (cpu_dev_phy_id < 0 || cpu_dev_phy_id >= cpu_device_num) { return -1; }
+  return NumaNode4Index(cpu_dev_phy_id, cpu_device_num);
+}
+
+void BindThreadToNumaNode(std::thread* thread, int32_t numa_node) {
+#ifdef PLATFORM_POSIX
+  cpu_set_t allowed_cpu_set;
+  CHECK_EQ(pthread_getaffinity_np(thread->native_handle(), sizeof(cpu_set_t), &allowed_cpu_set),
+           0);
+  cpu_set_t cpu_set;
+  if (!NumaNodeGetAllowedCpuSet(numa_node, allowed_cpu_set, &cpu_set)) { return; }
+  CHECK_EQ(pthread_setaffinity_np(thread->native_handle(), sizeof(cpu_set_t), &cpu_set), 0);
+#else
+  UNIMPLEMENTED();
+#endif
+}
+
+void BindCurrentThreadToNumaNode(int32_t numa_node) {
+#ifdef PLATFORM_POSIX
+  cpu_set_t allowed_cpu_set;
+  CHECK_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &allowed_cpu_set), 0);
+  cpu_set_t cpu_set;
+  if (!NumaNodeGetAllowedCpuSet(numa_node, allowed_cpu_set, &cpu_set)) { return; }
+  CHECK_EQ(sched_setaffinity(0, sizeof(cpu_set_t), &cpu_set), 0);
+#else
+  UNIMPLEMENTED();
+#endif
+}
+
+NumaNodeGuard::NumaNodeGuard(int32_t numa_node) {
+#ifdef PLATFORM_POSIX
+  CHECK_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &saved_cpu_set_), 0);
+  BindCurrentThreadToNumaNode(numa_node);
+#else
+  UNIMPLEMENTED();
+#endif
+}
+
+NumaNodeGuard::~NumaNodeGuard() {
+#ifdef PLATFORM_POSIX
+  CHECK_EQ(sched_setaffinity(0, sizeof(cpu_set_t), &saved_cpu_set_), 0);
+#endif
+}
+
+}  // namespace oneflow
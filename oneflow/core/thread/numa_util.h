@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_THREAD_NUMA_UTIL_H_
+#define ONEFLOW_CORE_THREAD_NUMA_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/platform.h"
+#ifdef PLATFORM_POSIX
+#include <sched.h>
+#endif
+
+namespace oneflow {
+
+// NUMA topology is read from sysfs, hosts without it are treated as a single node
+int32_t NumaNodeNum();
+// Assigns index i of [0, num) to numa nodes in balanced contiguous blocks
+int32_t NumaNode4Index(int64_t i, int64_t num);
+int32_t NumaNode4Index(int64_t i, int64_t num, int32_t numa_node_num);
+// Rotates index i of [0, num) by rotation within the block of its numa node
+int64_t RotateIndexWithinNumaNode(int64_t i, int64_t num, int32_t numa_node_num,
+                                  size_t rotation);
+// The numa node actor thread thrd_id of this machine is bound to, -1 if it is not bound
+int32_t NumaNode4ThrdId(int64_t thrd_id);
+// Binding keeps a thread within its current affinity, and is skipped if that has no cpu of
+// numa_node, e.g. in a container whose cpuset excludes the node
+void BindThreadToNumaNode(std::thread* thread, int32_t numa_node);
+void BindCurrentThreadToNumaNode(int32_t numa_node);
+
+#ifdef PLATFORM_POSIX
+// cpu_list is a sysfs cpulist like "0-23,48-71"
+void ParseCpuList(const std::string& cpu_list, cpu_set_t* cpu_set);
+#endif
+
+// Runs the current thread on the cpus of numa_node during its lifetime, memory first touched
+// meanwhile is placed on numa_node
+class NumaNodeGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(NumaNodeGuard);
+  explicit NumaNodeGuard(int32_t numa_node);
+  ~NumaNodeGuard();
+
+ private:
+#ifdef PLATFORM_POSIX
+  cpu_set_t saved_cpu_set_;
+#endif
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_THREAD_NUMA_UTIL_H_
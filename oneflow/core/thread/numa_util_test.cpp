@@ -0,0 +1,110 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/thread/numa_util.h"
+#include <fstream>
+
+namespace oneflow {
+
+namespace test {
+
+#ifdef PLATFORM_POSIX
+
+namespace {
+
+std::vector<int32_t> CpuSet2Cpus(const cpu_set_t& cpu_set) {
+  std::vector<int32_t> cpus;
+  FOR_RANGE(int32_t, cpu, 0, CPU_SETSIZE) {
+    if (CPU_ISSET(cpu, &cpu_set)) { cpus.push_back(cpu); }
+  }
+  return cpus;
+}
+
+std::vector<int32_t> ParseCpus(const std::string& cpu_list) {
+  cpu_set_t cpu_set;
+  ParseCpuList(cpu_list, &cpu_set);
+  return CpuSet2Cpus(cpu_set);
+}
+
+}  // namespace
+
+TEST(NumaUtil, parse_cpu_list) {
+  ASSERT_EQ(ParseCpus("0-3,8,10-11\n"), std::vector<int32_t>({0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_EQ(ParseCpus("5"), std::vector<int32_t>({5}));
+  ASSERT_EQ(ParseCpus("0-1,48-49"), std::vector<int32_t>({0, 1, 48, 49}));
+  ASSERT_TRUE(ParseCpus("").empty());
+  ASSERT_TRUE(ParseCpus("\n").empty());
+}
+
+TEST(NumaUtil, guard_stays_within_affinity) {
+  cpu_set_t saved_cpu_set;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &saved_cpu_set), 0);
+  if (std::ifstream("/sys/devices/system/node/node0/cpulist").good()) {
+    // the binding stays within the current affinity, nodes without the cpu are skipped
+    const int32_t cpu = CpuSet2Cpus(saved_cpu_set).back();
+    cpu_set_t one_cpu_set;
+    CPU_ZERO(&one_cpu_set);
+    CPU_SET(cpu, &one_cpu_set);
+    ASSERT_EQ(sched_setaffinity(0, sizeof(cpu_set_t), &one_cpu_set), 0);
+    FOR_RANGE(int32_t, numa_node, 0, NumaNodeNum()) {
+      NumaNodeGuard guard(numa_node);
+      cpu_set_t cpu_set;
+      ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpu_set), 0);
+      ASSERT_EQ(CpuSet2Cpus(cpu_set), std::vector<int32_t>({cpu}));
+    }
+    cpu_set_t cpu_set;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpu_set), 0);
+    ASSERT_EQ(CpuSet2Cpus(cpu_set), std::vector<int32_t>({cpu}));
+    ASSERT_EQ(sched_setaffinity(0, sizeof(cpu_set_t), &saved_cpu_set), 0);
+  }
+}
+
+#endif
+
+TEST(NumaUtil, numa_node_4_index) {
+  FOR_RANGE(int64_t, i, 0, 5) { ASSERT_EQ(NumaNode4Index(i, 5, 1), 0); }
+  std::vector<int32_t> nodes;
+  FOR_RANGE(int64_t, i, 0, 7) { nodes.push_back(NumaNode4Index(i, 7, 2)); }
+  ASSERT_EQ(nodes, std::vector<int32_t>({0, 0, 0, 0, 1, 1, 1}));
+  nodes.clear();
+  FOR_RANGE(int64_t, i, 0, 8) { nodes.push_back(NumaNode4Index(i, 8, 4)); }
+  ASSERT_EQ(nodes, std::vector<int32_t>({0, 0, 1, 1, 2, 2, 3, 3}));
+  // fewer indexes than nodes
+  nodes.clear();
+  FOR_RANGE(int64_t, i, 0, 2) { nodes.push_back(NumaNode4Index(i, 2, 4)); }
+  ASSERT_EQ(nodes, std::vector<int32_t>({0, 1}));
+}
+
+TEST(NumaUtil, rotate_index_within_numa_node) {
+  auto Rotated = [](int64_t num, int32_t numa_node_num, size_t rotation) {
+    std::vector<int64_t> indexes;
+    FOR_RANGE(int64_t, i, 0, num) {
+      indexes.push_back(RotateIndexWithinNumaNode(i, num, numa_node_num, rotation));
+    }
+    return indexes;
+  };
+  ASSERT_EQ(Rotated(7, 2, 0), std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6}));
+  // indexes stay in their node and remain distinct
+  ASSERT_EQ(Rotated(7, 2, 1), std::vector<int64_t>({1, 2, 3, 0, 5, 6, 4}));
+  ASSERT_EQ(Rotated(7, 2, 6), std::vector<int64_t>({2, 3, 0, 1, 4, 5, 6}));
+  ASSERT_EQ(Rotated(8, 4, 3), std::vector<int64_t>({1, 0, 3, 2, 5, 4, 7, 6}));
+  ASSERT_EQ(Rotated(3, 1, 2), std::vector<int64_t>({2, 0, 1}));
+  // fewer indexes than nodes
+  ASSERT_EQ(Rotated(2, 4, 5), std::vector<int64_t>({0, 1}));
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -18,9 +18,24 @@ limitations under the License.
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/actor/actor.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/numa_util.h"
 
 namespace oneflow {
 
+namespace {
+
+bool IsActorConstructionThreadSafe(const ThreadCtx& thread_ctx) {
+#ifdef WITH_CUDA
+  // the cuda stream and library handles of a gpu thread must not be shared between threads
+  return thread_ctx.g_cuda_stream == nullptr;
+#else
+  return true;
+#endif
+}
+
+}  // namespace
+
 Thread::~Thread() {
   actor_thread_.join();
   CHECK(id2task_.empty());
@@ -55,6 +70,17 @@ void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
       } else if (msg.actor_cmd() == ActorCmd::kConstructActor) {
         ConstructActor(msg.dst_actor_id(), thread_ctx);
         continue;
+      } else if (msg.actor_cmd() == ActorCmd::kConstructActorDone) {
+        std::unique_ptr<Actor> actor;
+        {
+          std::unique_lock<std::mutex> lck(id2constructed_actor_mtx_);
+          auto constructed_it = id2constructed_actor_.find(msg.dst_actor_id());
+          CHECK(constructed_it != id2constructed_actor_.end());
+          actor = std::move(constructed_it->second);
+          id2constructed_actor_.erase(constructed_it);
+        }
+        FinishConstructActor(msg.dst_actor_id(), std::move(actor));
+        continue;
       } else {
         // do nothing
       }
@@ -75,10 +101,37 @@ void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
 
 void Thread::ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx) {
   LOG(INFO) << "thread " << thrd_id_ << " construct actor " << actor_id;
-  std::unique_lock<std::mutex> lck(id2task_mtx_);
-  auto task_it = id2task_.find(actor_id);
-  CHECK(id2actor_ptr_.emplace(actor_id, NewActor(task_it->second, thread_ctx)).second);
-  id2task_.erase(task_it);
+  const TaskProto* task = nullptr;
+  {
+    // references to elements stay valid while other tasks are added
+    std::unique_lock<std::mutex> lck(id2task_mtx_);
+    task = &id2task_.at(actor_id);
+  }
+  ThreadPool* construction_pool = Global<ThreadMgr>::Get()->actor_construction_pool();
+  if (construction_pool != nullptr && IsActorConstructionThreadSafe(thread_ctx)) {
+    // kernels are initialized on the pool, the actor is handed back to this thread afterwards
+    const int32_t numa_node = NumaNode4ThrdId(thrd_id_);
+    construction_pool->AddWork([this, actor_id, task, &thread_ctx, numa_node]() {
+      std::unique_ptr<NumaNodeGuard> numa_node_guard;
+      if (numa_node >= 0) { numa_node_guard.reset(new NumaNodeGuard(numa_node)); }
+      std::unique_ptr<Actor> actor = NewActor(*task, thread_ctx);
+      {
+        std::unique_lock<std::mutex> lck(id2constructed_actor_mtx_);
+        CHECK(id2constructed_actor_.emplace(actor_id, std::move(actor)).second);
+      }
+      EnqueueActorMsg(ActorMsg::BuildCommandMsg(actor_id, ActorCmd::kConstructActorDone));
+    });
+  } else {
+    FinishConstructActor(actor_id, NewActor(*task, thread_ctx));
+  }
+}
+
+void Thread::FinishConstructActor(int64_t actor_id, std::unique_ptr<Actor>&& actor) {
+  CHECK(id2actor_ptr_.emplace(actor_id, std::move(actor)).second);
+  {
+    std::unique_lock<std::mutex> lck(id2task_mtx_);
+    CHECK_EQ(id2task_.erase(actor_id), 1);
+  }
   Global<RuntimeCtx>::Get()->DecreaseCounter("constructing_actor_cnt");
 }
 
@@ -45,9 +45,12 @@ class Thread {
 
  private:
   void ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx);
+  void FinishConstructActor(int64_t actor_id, std::unique_ptr<Actor>&& actor);
 
   HashMap<int64_t, TaskProto> id2task_;
   std::mutex id2task_mtx_;
+  HashMap<int64_t, std::unique_ptr<Actor>> id2constructed_actor_;
+  std::mutex id2constructed_actor_mtx_;
 
   std::thread actor_thread_;
   Channel<ActorMsg> msg_channel_;
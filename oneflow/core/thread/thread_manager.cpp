@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/thread/cpu_thread.h"
 #include "oneflow/core/thread/gpu_thread.h"
+#include "oneflow/core/thread/numa_util.h"
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/job/machine_context.h"
@@ -51,6 +52,14 @@ ThreadMgr::ThreadMgr(const Plan& plan) {
   }
   threads_.push_back(new CpuThread(thrd_id++));  // comm_net
   CreatePersistenceThrd(plan, thrd_id);
+  if (Global<ResourceDesc, ForSession>::Get()->enable_numa_aware_thread_placement()) {
+    Global<ThreadPool>::Get()->BindThreadsToNumaNodes();
+  }
+  const int32_t actor_construction_thread_num =
+      Global<ResourceDesc, ForSession>::Get()->actor_construction_thread_num();
+  if (actor_construction_thread_num > 0) {
+    actor_construction_pool_.reset(new ThreadPool(actor_construction_thread_num));
+  }
 }
 
 void ThreadMgr::CreatePersistenceThrd(const Plan& plan, int64_t thrd_id) {
@@ -71,17 +80,45 @@ void SingleThreadLoop(size_t num, std::function<void(size_t i)> Callback) {
 }
 
 void MultiThreadLoop(size_t num, std::function<void(size_t i)> Callback) {
-  size_t thread_num = Global<ThreadPool>::Get()->thread_num();
-  thread_num = std::min(num, thread_num);
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  const size_t pool_size = thread_pool->thread_num();
+  const size_t thread_num = std::min(num, pool_size);
   BalancedSplitter bs(num, thread_num);
   BlockingCounter bc(thread_num);
+  std::vector<std::function<void()>> works;
   FOR_RANGE(size_t, range_id, 0, thread_num) {
-    Global<ThreadPool>::Get()->AddWork([&bc, &bs, range_id, Callback] {
+    auto Work = [&bc, &bs, range_id, Callback] {
       FOR_RANGE(size_t, i, bs.At(range_id).begin(), bs.At(range_id).end()) { Callback(i); }
       bc.Decrease();
-    });
+    };
+    if (thread_pool->is_numa_aware()) {
+      works.push_back(Work);
+    } else {
+      thread_pool->AddWork(Work);
+    }
   }
+  // contiguous ranges go to workers of the same numa node
+  if (!works.empty()) { thread_pool->AddNumaLocalWorks(works); }
   bc.WaitUntilCntEqualZero();
 }
 
+void MultiThreadRangeLoop(size_t num, size_t min_range_size,
+                          std::function<void(size_t begin, size_t end)> Callback) {
+  if (num == 0) { return; }
+  const size_t max_range_num = std::max<size_t>(num / std::max<size_t>(min_range_size, 1), 1);
+  const size_t range_num =
+      Global<ThreadPool>::Get() == nullptr
+          ? 1
+          : std::min<size_t>(max_range_num, Global<ThreadPool>::Get()->thread_num());
+  if (range_num <= 1) {
+    Callback(0, num);
+    return;
+  }
+  BalancedSplitter bs(num, range_num);
+  MultiThreadLoop(range_num, [&bs, &Callback](size_t range_id) {
+    const Range range = bs.At(range_id);
+    Callback(range.begin(), range.end());
+  });
+}
+
 }  // namespace oneflow
@@ -32,6 +32,9 @@ class ThreadMgr final {
   ~ThreadMgr();
 
   Thread* GetThrd(int64_t thrd_id);
+  // Returns nullptr if actors are constructed on their own threads
+  ThreadPool* actor_construction_pool() const { return actor_construction_pool_.get(); }
+  void DeleteActorConstructionPool() { actor_construction_pool_.reset(); }
 
  private:
   friend class Global<ThreadMgr>;
@@ -40,10 +43,15 @@ class ThreadMgr final {
   void CreatePersistenceThrd(const Plan& plan, int64_t thrd_id);
 
   std::vector<Thread*> threads_;
+  std::unique_ptr<ThreadPool> actor_construction_pool_;
 };
 
 void SingleThreadLoop(size_t num, std::function<void(size_t i)> Callback);
 void MultiThreadLoop(size_t num, std::function<void(size_t i)> Callback);
+// Splits [0, num) into balanced ranges no smaller than min_range_size, Callback(begin, end) is
+// called once per range
+void MultiThreadRangeLoop(size_t num, size_t min_range_size,
+                          std::function<void(size_t begin, size_t end)> Callback);
 
 }  // namespace oneflow
 
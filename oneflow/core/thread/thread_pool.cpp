@@ -14,11 +14,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/thread/numa_util.h"
 
 namespace oneflow {
 
 ThreadPool::ThreadPool(int32_t thread_num)
-    : work_chans_(thread_num), threads_(thread_num), work_cnt_(0) {
+    : work_chans_(thread_num), threads_(thread_num), work_cnt_(0), is_numa_aware_(false) {
   FOR_RANGE(int32_t, i, 0, thread_num) {
     Channel<std::function<void()>>* chan = &(work_chans_.at(i));
     threads_[i] = std::thread([chan]() {
@@ -41,4 +42,28 @@ void ThreadPool::AddWork(const std::function<void()>& work) {
   work_chans_.at(cur_chan_idx).Send(work);
 }
 
+void ThreadPool::AddWork(int32_t thread_idx, const std::function<void()>& work) {
+  work_chans_.at(thread_idx).Send(work);
+}
+
+void ThreadPool::AddNumaLocalWorks(const std::vector<std::function<void()>>& works) {
+  const int64_t pool_size = work_chans_.size();
+  const int64_t work_num = works.size();
+  CHECK_LE(work_num, pool_size);
+  const size_t rotation = work_cnt_.fetch_add(work_num, std::memory_order_relaxed);
+  FOR_RANGE(int64_t, i, 0, work_num) {
+    const int64_t thread_idx = RotateIndexWithinNumaNode(i * pool_size / work_num, pool_size,
+                                                         NumaNodeNum(), rotation);
+    work_chans_.at(thread_idx).Send(works.at(i));
+  }
+}
+
+void ThreadPool::BindThreadsToNumaNodes() {
+  if (is_numa_aware_ || NumaNodeNum() <= 1) { return; }
+  FOR_RANGE(int32_t, i, 0, threads_.size()) {
+    BindThreadToNumaNode(&threads_.at(i), NumaNode4Index(i, threads_.size()));
+  }
+  is_numa_aware_ = true;
+}
+
 }  // namespace oneflow
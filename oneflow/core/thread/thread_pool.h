@@ -30,12 +30,20 @@ class ThreadPool final {
 
   int32_t thread_num() const { return threads_.size(); }
   void AddWork(const std::function<void()>& work);
+  void AddWork(int32_t thread_idx, const std::function<void()>& work);
+  // Binds workers to numa nodes in contiguous blocks, so neighbouring workers share a node
+  void BindThreadsToNumaNodes();
+  bool is_numa_aware() const { return is_numa_aware_; }
+  // Adds each work of a loop to the worker the index-th of num contiguous parts of the pool
+  // would get, rotated within its numa node so that successive loops start at other workers
+  void AddNumaLocalWorks(const std::vector<std::function<void()>>& works);
 
  private:
   std::vector<Channel<std::function<void()>>> work_chans_;
   std::vector<std::thread> threads_;
 
   std::atomic<size_t> work_cnt_;
+  bool is_numa_aware_;
 };
 
 }  // namespace oneflow
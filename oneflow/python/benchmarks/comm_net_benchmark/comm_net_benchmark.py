@@ -0,0 +1,147 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# Loopback benchmark of the epoll CommNet: machine 0 runs in this process and
+# machine 1 is a local oneflow_worker process (set ONEFLOW_WORKER_BIN), the two
+# machines use 127.0.0.1 and 127.0.0.2 so they are distinct to oneflow while
+# the traffic stays on the loopback device.
+#
+#   ONEFLOW_WORKER_BIN=/path/to/oneflow_worker \
+#   python3 comm_net_benchmark.py --mbyte 64 --socket_num_per_peer 4
+import argparse
+import os
+import socket
+import subprocess
+import tempfile
+import threading
+import time
+from contextlib import closing
+
+import google.protobuf.text_format as pbtxt
+import oneflow as flow
+import oneflow.core.job.env_pb2 as env_pb
+import oneflow.typing as tp
+
+parser = argparse.ArgumentParser(description="epoll CommNet loopback benchmark")
+parser.add_argument("--mbyte", type=int, default=64, help="bytes per transfer in MB")
+parser.add_argument("--iter_num", type=int, default=50)
+parser.add_argument("--warmup_num", type=int, default=5)
+parser.add_argument("--comm_net_worker_num", type=int, default=4)
+parser.add_argument("--socket_num_per_peer", type=int, default=1)
+parser.add_argument("--stripe_min_kbyte", type=int, default=1024)
+parser.add_argument("--zero_copy", action="store_true")
+args = parser.parse_args()
+
+
+def _FindFreePort():
+    with closing(socket.socket(socket.AF_INET, socket.SOCK_STREAM)) as s:
+        s.bind(("localhost", 0))
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        return s.getsockname()[1]
+
+
+def _MakeEnvProto(ctrl_ports, this_machine_id):
+    env_proto = env_pb.EnvProto()
+    for machine_id, ctrl_port in enumerate(ctrl_ports):
+        machine = env_proto.machine.add()
+        machine.id = machine_id
+        machine.addr = "127.0.0.{}".format(machine_id + 1)
+        machine.ctrl_port_agent = ctrl_port
+    env_proto.ctrl_port = ctrl_ports[this_machine_id]
+    return env_proto
+
+
+def _LaunchWorker(ctrl_ports):
+    worker_bin = os.getenv("ONEFLOW_WORKER_BIN")
+    assert worker_bin is not None, "please set env ONEFLOW_WORKER_BIN"
+    env_file = tempfile.NamedTemporaryFile(mode="w", suffix=".prototxt", delete=False)
+    env_file.write(pbtxt.MessageToString(_MakeEnvProto(ctrl_ports, 1)))
+    env_file.close()
+    log_dir = tempfile.mkdtemp(prefix="comm_net_benchmark_worker_")
+    return subprocess.Popen(
+        [worker_bin, "-env_proto=" + env_file.name, "-log_dir=" + log_dir]
+    )
+
+
+def main():
+    ctrl_ports = [_FindFreePort(), _FindFreePort()]
+    _LaunchWorker(ctrl_ports)
+    master_env = _MakeEnvProto(ctrl_ports, 0)
+    flow.env.machine(
+        [
+            {"addr": m.addr, "ctrl_port_agent": m.ctrl_port_agent}
+            for m in master_env.machine
+        ]
+    )
+    flow.env.ctrl_port(ctrl_ports[0])
+    flow.config.gpu_device_num(0)
+    flow.config.cpu_device_num(1)
+    flow.config.comm_net_worker_num(args.comm_net_worker_num)
+    flow.config.comm_net_socket_num_per_peer(args.socket_num_per_peer)
+    flow.config.comm_net_stripe_min_kbyte(args.stripe_min_kbyte)
+    flow.config.comm_net_zero_copy(args.zero_copy)
+
+    elem_cnt = args.mbyte * 1024 * 1024 // 4
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+
+    @flow.global_function(type="predict", function_config=func_config)
+    def CommNetJob() -> tp.Callback[tp.Numpy]:
+        with flow.scope.placement("cpu", "0:0"):
+            x = flow.get_variable(
+                "x",
+                shape=(elem_cnt,),
+                dtype=flow.float,
+                initializer=flow.constant_initializer(1),
+                trainable=False,
+            )
+        with flow.scope.placement("cpu", "1:0"):
+            # the identity on machine 1 pulls the whole variable through CommNet
+            y = flow.math.reduce_sum(flow.identity(x), keepdims=True)
+        return y
+
+    done = threading.Semaphore(0)
+
+    def Callback(y: tp.Numpy):
+        done.release()
+
+    for _ in range(args.warmup_num):
+        CommNetJob()(Callback)
+    for _ in range(args.warmup_num):
+        done.acquire()
+
+    start = time.time()
+    for _ in range(args.iter_num):
+        CommNetJob()(Callback)
+    for _ in range(args.iter_num):
+        done.acquire()
+    elapsed = time.time() - start
+
+    total_byte = elem_cnt * 4 * args.iter_num
+    print(
+        "{} MB x {} transfers in {:.3f} s: {:.3f} GB/s (socket_num_per_peer={}, zero_copy={})".format(
+            args.mbyte,
+            args.iter_num,
+            elapsed,
+            total_byte / elapsed / 1e9,
+            args.socket_num_per_peer,
+            args.zero_copy,
+        )
+    )
+    # the worker exits when the env of this process is destroyed at exit
+
+
+if __name__ == "__main__":
+    main()
@@ -108,6 +108,135 @@ def comm_net_worker_num(val):
     sess.config_proto.resource.comm_net_worker_num = val
 
 
+@oneflow_export("config.comm_net_socket_num_per_peer")
+def api_comm_net_socket_num_per_peer(val: int) -> None:
+    r"""Set up the number of sockets opened to each peer in epoll mode network.
+            Large transfers are striped over these sockets.
+
+    Args:
+        val (int): number of sockets per peer
+    """
+    return enable_if.unique([comm_net_socket_num_per_peer, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_socket_num_per_peer(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 1
+    sess.config_proto.resource.comm_net_socket_num_per_peer = val
+
+
+@oneflow_export("config.comm_net_stripe_min_kbyte")
+def api_comm_net_stripe_min_kbyte(val: int) -> None:
+    r"""Set up the minimal stripe size in epoll mode network,
+            transfers smaller than twice of it are not striped.
+
+    Args:
+        val (int): minimal stripe size in KB
+    """
+    return enable_if.unique([comm_net_stripe_min_kbyte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_stripe_min_kbyte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.comm_net_stripe_min_kbyte = val
+
+
+@oneflow_export("config.comm_net_zero_copy")
+def api_comm_net_zero_copy(val: bool = True) -> None:
+    r"""Whether or not send large bodies with MSG_ZEROCOPY in epoll mode network.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([comm_net_zero_copy, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_zero_copy(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.comm_net_zero_copy = val
+
+
+@oneflow_export("config.comm_net_shared_memory")
+def api_comm_net_shared_memory(val: bool = True) -> None:
+    r"""Whether or not exchange actor messages and registers through shared memory with peers
+            on the same host in epoll mode network.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([comm_net_shared_memory, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_shared_memory(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.comm_net_shared_memory = val
+
+
+@oneflow_export("config.comm_net_max_pending_actor_msg_num")
+def api_comm_net_max_pending_actor_msg_num(val: int) -> None:
+    r"""Set up the number of actor messages to one socket that may wait for being written
+            in epoll mode network, senders block when it is reached.
+
+    Args:
+        val (int): max number of pending actor messages per socket
+    """
+    return enable_if.unique([comm_net_max_pending_actor_msg_num, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_max_pending_actor_msg_num(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 1
+    sess.config_proto.resource.comm_net_max_pending_actor_msg_num = val
+
+
+@oneflow_export("config.comm_net_actor_msg_batch_delay_us")
+def api_comm_net_actor_msg_batch_delay_us(val: int) -> None:
+    r"""Set up how long an actor message may wait for others to share its write
+            in epoll mode network, 0 means it is written as soon as possible.
+
+    Args:
+        val (int): delay in microseconds
+    """
+    return enable_if.unique([comm_net_actor_msg_batch_delay_us, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def comm_net_actor_msg_batch_delay_us(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 0
+    sess.config_proto.resource.comm_net_actor_msg_batch_delay_us = val
+
+
+@oneflow_export("config.host_staging_pool_mbyte")
+def api_host_staging_pool_mbyte(val: int) -> None:
+    r"""Set up the size of host buffers the data pipeline may keep for reuse,
+            0 means they are released as soon as they are freed.
+
+    Args:
+        val (int): size in MB
+    """
+    return enable_if.unique([host_staging_pool_mbyte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def host_staging_pool_mbyte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 0
+    sess.config_proto.resource.host_staging_pool_mbyte = val
+
+
 @oneflow_export("config.max_mdsave_worker_num")
 def api_max_mdsave_worker_num(val: int) -> None:
     r"""Set up max number of workers for mdsave process.
@@ -279,6 +408,62 @@ def enable_debug_mode(val):
     sess.config_proto.resource.enable_debug_mode = val
 
 
+@oneflow_export("config.enable_parallel_compile")
+def api_enable_parallel_compile(val: bool = True) -> None:
+    r"""Whether or not build task nodes and serialize the plan with multiple threads.
+    It is off unless enabled. test_parallel_compile.py compares the plan it produces with
+    the plan of the serial compilation.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_parallel_compile, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_parallel_compile(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_parallel_compile = val
+
+
+@oneflow_export("config.enable_numa_aware_thread_placement")
+def api_enable_numa_aware_thread_placement(val: bool = True) -> None:
+    r"""Whether or not bind cpu actor threads and compute thread pool workers to numa nodes,
+    and place host registers on the numa node of their producer thread.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_numa_aware_thread_placement, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_numa_aware_thread_placement(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_numa_aware_thread_placement = val
+
+
+@oneflow_export("config.actor_construction_thread_num")
+def api_actor_construction_thread_num(val: int) -> None:
+    r"""Set up the number of threads constructing cpu actors and initializing their kernels
+            at runtime startup, 0 means every actor is constructed on its own actor thread.
+
+    Args:
+        val (int): number of construction threads
+    """
+    return enable_if.unique([actor_construction_thread_num, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def actor_construction_thread_num(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 0
+    sess.config_proto.resource.actor_construction_thread_num = val
+
+
 @oneflow_export("config.save_downloaded_file_to_local_fs")
 def api_save_downloaded_file_to_local_fs(val: bool = True) -> None:
     r"""Whether or not save downloaded file to local file system.
@@ -313,6 +498,79 @@ def persistence_buf_byte(val):
     sess.config_proto.io_conf.persistence_buf_byte = val
 
 
+@oneflow_export("config.enable_async_snapshot_write")
+def api_enable_async_snapshot_write(val: bool = True) -> None:
+    r"""Whether or not write model snapshots in background threads. A save returns once
+    variables are copied to staging buffers, and their files are written concurrently in
+    chunks. snapshot_done is written after all of them, and loading the snapshot, the
+    next save and the end of the session wait for pending files.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_async_snapshot_write, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_async_snapshot_write(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.io_conf.enable_async_snapshot_write = val
+
+
+@oneflow_export("config.snapshot_write_worker_num")
+def api_snapshot_write_worker_num(val: int) -> None:
+    r"""Set up number of threads writing snapshot files concurrently in async mode.
+
+    Args:
+        val (int): number of threads
+    """
+    return enable_if.unique([snapshot_write_worker_num, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def snapshot_write_worker_num(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val >= 1
+    sess.config_proto.io_conf.snapshot_write_worker_num = val
+
+
+@oneflow_export("config.snapshot_write_chunk_byte")
+def api_snapshot_write_chunk_byte(val: int) -> None:
+    r"""Set up chunk size for writing snapshot files.
+
+    Args:
+        val (int): e.g. 67108864(bytes)
+    """
+    return enable_if.unique([snapshot_write_chunk_byte, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def snapshot_write_chunk_byte(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.io_conf.snapshot_write_chunk_byte = val
+
+
+@oneflow_export("config.enable_snapshot_checksum")
+def api_enable_snapshot_checksum(val: bool = True) -> None:
+    r"""Whether or not write a CRC32C checksum file beside each snapshot variable file.
+    Checksums are verified when the variable is loaded.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_snapshot_checksum, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_snapshot_checksum(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.io_conf.enable_snapshot_checksum = val
+
+
 @oneflow_export("config.enable_model_io_v2")
 def api_enable_model_io_v2(val):
     r"""Whether or not use version2  of model input/output function.
@@ -343,8 +601,95 @@ def api_collect_act_event(val: bool = True) -> None:
 @enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
 def collect_act_event(val=True):
     sess = session_ctx.GetDefaultSession()
-    assert type(val) is int
-    sess.config_proto.profile_conf.collect_act_event = val
+    assert type(val) is bool
+    sess.config_proto.profiler_conf.collect_act_event = val
+
+
+@oneflow_export("config.act_event_sample_rate")
+def api_act_event_sample_rate(val: float) -> None:
+    r"""Fraction of acts whose events are collected when collect_act_event is on.
+
+    Args:
+        val (float): a rate in (0, 1]
+    """
+    return enable_if.unique([act_event_sample_rate, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def act_event_sample_rate(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is float and 0.0 < val <= 1.0
+    sess.config_proto.profiler_conf.act_event_sample_rate = val
+
+
+@oneflow_export("config.act_event_batch_size")
+def api_act_event_batch_size(val: int) -> None:
+    r"""Number of buffered act events in one thread that triggers shipping them to the master.
+
+    Args:
+        val (int): batch size
+    """
+    return enable_if.unique([act_event_batch_size, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def act_event_batch_size(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int and val > 0
+    sess.config_proto.profiler_conf.act_event_batch_size = val
+
+
+@oneflow_export("config.act_event_flush_interval_ms")
+def api_act_event_flush_interval_ms(val: int) -> None:
+    r"""Interval in milliseconds between two shippings of buffered act events to the master.
+
+    Args:
+        val (int): interval in milliseconds
+    """
+    return enable_if.unique([act_event_flush_interval_ms, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def act_event_flush_interval_ms(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int and val > 0
+    sess.config_proto.profiler_conf.act_event_flush_interval_ms = val
+
+
+@oneflow_export("config.enable_adaptive_regst_num")
+def api_enable_adaptive_regst_num(val: bool = True) -> None:
+    r"""Whether or not tune register nums from the act events of the running session.
+    The tuned nums are reported when the session ends and applied the next time the same
+    job is compiled.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_adaptive_regst_num, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_adaptive_regst_num(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.profiler_conf.enable_adaptive_regst_num = val
+
+
+@oneflow_export("config.adaptive_regst_num_window_size")
+def api_adaptive_regst_num_window_size(val: int) -> None:
+    r"""Number of most recent acts whose events feed the register num model.
+
+    Args:
+        val (int): window size, at least 2
+    """
+    return enable_if.unique([adaptive_regst_num_window_size, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def adaptive_regst_num_window_size(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int and val > 1
+    sess.config_proto.profiler_conf.adaptive_regst_num_window_size = val
 
 
 @oneflow_export("config.collective_boxing.enable_fusion")
@@ -342,10 +342,26 @@ def policy_time_line(func_desc):
     return "use_time_line_algo"
 
 
+@oneflow_function_config(
+    "static_mem_alloc_policy_white_list.policy_best_fit_coalescing"
+)
+def policy_best_fit_coalescing(func_desc):
+    r"""A static memory allocation policy called: best_fit_coalescing
+
+    Args:
+        func_desc ([type]): [description]
+
+    Returns:
+        [type]: [description]
+    """
+    return "use_best_fit_coalescing_algo"
+
+
 @oneflow_function_config("static_mem_alloc_algo_white_list.show")
 def show_static_mem_alloc_algo_white_list(func_desc):
     r"""Show configuration of  static memory allocation policy,
-          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo"
+          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo",
+          "use_best_fit_coalescing_algo"
 
     Args:
         func_desc ([type]): [description]
@@ -357,9 +373,24 @@ def show_static_mem_alloc_algo_white_list(func_desc):
         "use_mem_size_first_algo",
         "use_mutual_exclusion_first_algo",
         "use_time_line_algo",
+        "use_best_fit_coalescing_algo",
     ]
 
 
+@oneflow_function_config("enable_mem_plan_report")
+def set_enable_mem_plan_report(func_desc, value=True):
+    r"""Whether to write a report of the static memory allocation plan or not.
+    It lists peak usage and wasted bytes of each policy and the lifetime of each register
+    of every memory block in log_dir/mem_plan.
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    mem_alloc_algo_conf = func_desc.job_config_proto.memory_allocation_algorithm_conf
+    mem_alloc_algo_conf.enable_mem_plan_report = value
+
+
 @oneflow_function_config("enable_cudnn")
 def set_enable_cudnn(func_desc, value=True):
     r"""Whether use cudnn to accelerate job or not.
@@ -765,6 +796,17 @@ def set_use_tensorrt(func_desc, value=True):
     func_desc.job_config_proto.xrt_config.use_tensorrt = value
 
 
+@oneflow_function_config("use_native_fusion")
+def set_use_native_fusion(func_desc, value=True):
+    r"""Whether fuse elementwise operators on cpu with the native xrt engine or not
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.xrt_config.use_native_fusion = value
+
+
 @oneflow_function_config("tensorrt.use_fp16")
 def set_tensorrt_use_fp16(func_desc, value=True):
     r"""Whether use tensorrt fp16  or not
@@ -621,8 +621,13 @@ def upsample(
         raise ValueError('data_format must be "NHWC" or "NCHW".')
 
     need_transpose = 0
+    channel_pos = "channels_first"
     if data_format.upper() == "NHWC":
-        need_transpose = 1
+        # the cpu kernels handle channels_last natively
+        if flow.current_scope().device_parallel_desc_symbol.device_tag == "cpu":
+            channel_pos = "channels_last"
+        else:
+            need_transpose = 1
 
     if need_transpose:
         x = flow.transpose(x, perm=[0, 3, 1, 2])
@@ -634,7 +639,7 @@ def upsample(
         .Output("y")
         .Attr("height_scale", float(height_scale))
         .Attr("width_scale", float(width_scale))
-        .Attr("data_format", "channels_first")
+        .Attr("data_format", channel_pos)
         .Attr("interpolation", interpolation)
         .Build()
     )
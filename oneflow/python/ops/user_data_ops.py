@@ -567,6 +567,7 @@ def api_coco_reader(
     random_seed: Optional[int] = None,
     group_by_aspect_ratio: bool = True,
     stride_partition: bool = True,
+    annotation_index_file: str = "",
     name: str = None,
 ) -> BlobDef:
     assert name is not None
@@ -580,6 +581,7 @@ def api_coco_reader(
             random_seed=random_seed,
             group_by_aspect_ratio=group_by_aspect_ratio,
             stride_partition=stride_partition,
+            annotation_index_file=annotation_index_file,
             name=name,
         ),
     )
@@ -596,6 +598,7 @@ class COCOReader(module_util.Module):
         random_seed: Optional[int] = None,
         group_by_aspect_ratio: bool = True,
         stride_partition: bool = True,
+        annotation_index_file: str = "",
         name: str = None,
     ):
         assert name is not None
@@ -613,6 +616,7 @@ class COCOReader(module_util.Module):
             .Output("gt_segm")
             .Output("gt_segm_index")
             .Attr("annotation_file", annotation_file)
+            .Attr("annotation_index_file", annotation_index_file)
             .Attr("image_dir", image_dir)
             .Attr("batch_size", batch_size)
             .Attr("shuffle_after_epoch", shuffle)
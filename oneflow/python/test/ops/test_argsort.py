@@ -56,7 +56,7 @@ def compare_with_tensorflow(device_type, in_shape, direction, data_type):
 def gen_arg_list():
     arg_dict = OrderedDict()
     arg_dict["device_type"] = ["cpu", "gpu"]
-    arg_dict["in_shape"] = [(100,), (100, 100), (10, 10, 200)]
+    arg_dict["in_shape"] = [(100,), (100, 100), (10, 10, 200), (10, 2000)]
     arg_dict["direction"] = ["ASCENDING", "DESCENDING"]
     arg_dict["data_type"] = ["float32", "double", "int32", "int64"]
 
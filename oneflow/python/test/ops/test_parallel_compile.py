@@ -0,0 +1,61 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import oneflow as flow
+import os
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+import oneflow.python.framework.env_util as env_util
+
+
+def _compile_merged_plan(parallel):
+    flow.clear_default_session()
+    flow.config.enable_debug_mode(True)
+    flow.config.enable_parallel_compile(parallel)
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.default_logical_view(flow.scope.consistent_view())
+
+    @flow.global_function(type="train", function_config=func_config)
+    def ParallelCompileJob(x: oft.Numpy.Placeholder((4, 16))):
+        with flow.scope.placement("cpu", "0:0"):
+            y = x
+            for i in range(4):
+                w = flow.get_variable(
+                    "w%d" % i,
+                    shape=(16, 16),
+                    initializer=flow.constant_initializer(0.1 * (i + 1)),
+                )
+                y = flow.math.relu(flow.matmul(y, w))
+            loss = flow.math.reduce_sum(y)
+            flow.optimizer.SGD(
+                flow.optimizer.PiecewiseConstantScheduler([], [0.001]), momentum=0.9
+            ).minimize(loss)
+        return loss
+
+    # the plan is compiled and written to the log dir when the session starts
+    ParallelCompileJob(np.ones((4, 16), dtype=np.float32)).get()
+    log_dir = env_util.default_env_proto.cpp_logging_conf.log_dir
+    with open(os.path.join(log_dir, "merged_plan")) as f:
+        return f.read()
+
+
+def test_parallel_compile_same_plan(test_case):
+    serial_plan = _compile_merged_plan(False)
+    parallel_plan = _compile_merged_plan(True)
+    test_case.assertTrue(len(serial_plan) > 0)
+    test_case.assertEqual(serial_plan, parallel_plan)
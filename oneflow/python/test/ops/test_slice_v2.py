@@ -18,7 +18,14 @@ import oneflow as flow
 import oneflow.typing as oft
 
 
-def _run_slice(input, index_args, dynamic=False, dtype=flow.float, input_shape=None):
+def _run_slice(
+    input,
+    index_args,
+    dynamic=False,
+    dtype=flow.float,
+    input_shape=None,
+    device_tag="gpu",
+):
     func_config = flow.FunctionConfig()
     func_config.default_data_type(dtype)
 
@@ -27,9 +34,10 @@ def _run_slice(input, index_args, dynamic=False, dtype=flow.float, input_shape=N
 
     def do_slice(x, indices):
         outputs = []
-        for slice_tup_list in indices:
-            output = flow.slice_v2(x, slice_tup_list)
-            outputs.append(output)
+        with flow.scope.placement(device_tag, "0:0"):
+            for slice_tup_list in indices:
+                output = flow.slice_v2(x, slice_tup_list)
+                outputs.append(output)
         return outputs
 
     if dynamic is True:
@@ -175,7 +183,37 @@ def test_slice_with_neg_stride2(test_case):
     _check(test_case, results, outputs)
 
 
-def test_slice_grad(test_case):
+def test_slice_on_cpu(test_case):
+    input = np.random.rand(2, 16, 8).astype(np.float32)
+    results = [
+        input[:, 0:1, :],
+        input[:, 1:-1, :],
+        input[:, 1::3, ::2],
+        input[:, -1:1:-2, :],
+        input[1:, :, 4:],
+    ]
+    args = [
+        [(None, None, None), (0, 1, None), (None, None, None)],
+        [(None, None, None), (1, -1, None), (None, None, None)],
+        [(None, None, None), (1, None, 3), (None, None, 2)],
+        [(None, None, None), (-1, 1, -2), (None, None, None)],
+        [(1, None, None), (None, None, None), (4, None, None)],
+    ]
+    outputs = _run_slice(input, args, device_tag="cpu")
+    _check(test_case, results, outputs)
+
+
+def test_dynamic_slice_on_cpu(test_case):
+    input = np.random.rand(2, 4, 4).astype(np.float32)
+    results = [input[:, 1:, :]]
+    args = [[(None, None, None), (1, None, None)]]
+    outputs = _run_slice(
+        input, args, dynamic=True, input_shape=(2, 5, 5), device_tag="cpu"
+    )
+    _check(test_case, results, outputs)
+
+
+def _test_slice_grad(test_case, device_tag):
     input = np.random.rand(2, 5, 4).astype(np.float32)
     ref = np.zeros(input.shape, dtype=np.float32)
     ref[:, 2:-2, :] = np.ones(input[:, 2:-2, :].shape, dtype=np.float32)
@@ -198,10 +236,19 @@ def test_slice_grad(test_case):
         )
         x = flow.identity(x)
         flow.watch_diff(x, slice_grad_cb)
-        y = flow.slice_v2(x, [(None, None, None), (2, -2, None)])
+        with flow.scope.placement(device_tag, "0:0"):
+            y = flow.slice_v2(x, [(None, None, None), (2, -2, None)])
         flow.optimizer.SGD(
             flow.optimizer.PiecewiseConstantScheduler([], [1e-3]), momentum=0
         ).minimize(y)
         return y
 
     slice(input).get()
+
+
+def test_slice_grad(test_case):
+    _test_slice_grad(test_case, "gpu")
+
+
+def test_slice_grad_on_cpu(test_case):
+    _test_slice_grad(test_case, "cpu")
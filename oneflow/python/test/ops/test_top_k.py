@@ -59,7 +59,7 @@ def compare_with_tensorflow(device_type, in_shape, k, data_type, sorted):
 def gen_arg_list():
     arg_dict = OrderedDict()
     arg_dict["device_type"] = ["cpu", "gpu"]
-    arg_dict["in_shape"] = [(100,), (100, 100), (10, 500), (10, 10, 500)]
+    arg_dict["in_shape"] = [(100,), (100, 100), (10, 500), (10, 10, 500), (10, 2000)]
     arg_dict["k"] = [1, 50, 200]
     arg_dict["data_type"] = ["float32", "double", "int32", "int64"]
     arg_dict["sorted"] = [True]
@@ -24,6 +24,7 @@ config = flow.function_config()
 def make_job(x_shape, b_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def bias_add_job(
@@ -38,6 +39,7 @@ def make_job(x_shape, b_shape, dtype=flow.float32):
 def make_xla_job(x_shape, b_shape, dtype=flow.float32):
     config.use_xla_jit(True)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def xla_bias_add_job(
@@ -52,6 +54,7 @@ def make_xla_job(x_shape, b_shape, dtype=flow.float32):
 def make_trt_job(x_shape, b_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(True)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def trt_bias_add_job(
@@ -63,6 +66,22 @@ def make_trt_job(x_shape, b_shape, dtype=flow.float32):
     return trt_bias_add_job
 
 
+def make_native_job(x_shape, b_shape, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(True)
+
+    @flow.global_function(config)
+    def native_bias_add_job(
+        x=flow.FixedTensorDef(x_shape, dtype=dtype),
+        bias=flow.FixedTensorDef(b_shape, dtype=dtype),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.nn.bias_add(x, bias)
+
+    return native_bias_add_job
+
+
 class TestBiasAdd(unittest.TestCase):
     def _test_body(self, x, bias, dtype=np.float32):
         f1 = make_job(x.shape, bias.shape, dtype=flow.float32)
@@ -79,6 +98,11 @@ class TestBiasAdd(unittest.TestCase):
         print("with tensorrt: ", c)
         self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
         flow.clear_default_session()
+        f4 = make_native_job(x.shape, bias.shape, dtype=flow.float32)
+        d = f4(x, bias).get()
+        print("with native: ", d)
+        self.assertTrue(np.allclose(a.numpy(), d.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, x_shape, bias_shape, dtype=np.float32):
         x = np.ones(x_shape, dtype=dtype)
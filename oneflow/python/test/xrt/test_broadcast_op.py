@@ -36,6 +36,11 @@ class TestBroadcastOp(unittest.TestCase):
         self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
 
         flow.clear_default_session()
+        f3 = self.make_native_job(x.shape, y.shape, dtype=flow.float32)
+        c = f3(x, y).get()
+        print("with native: ", c)
+        self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, x_shape, y_shape, dtype=np.float32):
         x = np.ones(x_shape, dtype=dtype)
@@ -64,6 +69,7 @@ class TestBroadcastAddOp(TestBroadcastOp):
     def make_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(False)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def broadcast_add_job(
@@ -77,6 +83,7 @@ class TestBroadcastAddOp(TestBroadcastOp):
     def make_xla_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(True)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def xla_broadcast_add_job(
@@ -87,6 +94,21 @@ class TestBroadcastAddOp(TestBroadcastOp):
 
         return xla_broadcast_add_job
 
+    def make_native_job(self, x_shape, y_shape, dtype=flow.float32):
+        config.use_xla_jit(False)
+        config.use_tensorrt(False)
+        config.use_native_fusion(True)
+
+        @flow.global_function(config)
+        def native_broadcast_add_job(
+            x=flow.FixedTensorDef(x_shape, dtype=dtype),
+            y=flow.FixedTensorDef(y_shape, dtype=dtype),
+        ):
+            with flow.scope.placement("cpu", "0:0"):
+                return flow.math.add(x, y)
+
+        return native_broadcast_add_job
+
 
 class TestBroadcastMulOp(TestBroadcastOp):
     run_test = True
@@ -94,6 +116,7 @@ class TestBroadcastMulOp(TestBroadcastOp):
     def make_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(False)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def broadcast_mul_job(
@@ -107,6 +130,7 @@ class TestBroadcastMulOp(TestBroadcastOp):
     def make_xla_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(True)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def xla_broadcast_mul_job(
@@ -117,6 +141,21 @@ class TestBroadcastMulOp(TestBroadcastOp):
 
         return xla_broadcast_mul_job
 
+    def make_native_job(self, x_shape, y_shape, dtype=flow.float32):
+        config.use_xla_jit(False)
+        config.use_tensorrt(False)
+        config.use_native_fusion(True)
+
+        @flow.global_function(config)
+        def native_broadcast_mul_job(
+            x=flow.FixedTensorDef(x_shape, dtype=dtype),
+            y=flow.FixedTensorDef(y_shape, dtype=dtype),
+        ):
+            with flow.scope.placement("cpu", "0:0"):
+                return flow.math.multiply(x, y)
+
+        return native_broadcast_mul_job
+
 
 class TestBroadcastDivOp(TestBroadcastOp):
     run_test = True
@@ -124,6 +163,7 @@ class TestBroadcastDivOp(TestBroadcastOp):
     def make_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(False)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def broadcast_div_job(
@@ -137,6 +177,7 @@ class TestBroadcastDivOp(TestBroadcastOp):
     def make_xla_job(self, x_shape, y_shape, dtype=flow.float32):
         config.use_xla_jit(True)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def xla_broadcast_div_job(
@@ -147,6 +188,21 @@ class TestBroadcastDivOp(TestBroadcastOp):
 
         return xla_broadcast_div_job
 
+    def make_native_job(self, x_shape, y_shape, dtype=flow.float32):
+        config.use_xla_jit(False)
+        config.use_tensorrt(False)
+        config.use_native_fusion(True)
+
+        @flow.global_function(config)
+        def native_broadcast_div_job(
+            x=flow.FixedTensorDef(x_shape, dtype=dtype),
+            y=flow.FixedTensorDef(y_shape, dtype=dtype),
+        ):
+            with flow.scope.placement("cpu", "0:0"):
+                return flow.math.divide(x, y)
+
+        return native_broadcast_div_job
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -24,6 +24,7 @@ config = flow.function_config()
 def make_job(input_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def gelu_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
@@ -35,6 +36,7 @@ def make_job(input_shape, dtype=flow.float32):
 def make_xla_job(input_shape, dtype=flow.float32):
     config.use_xla_jit(True)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def xla_gelu_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
@@ -43,6 +45,19 @@ def make_xla_job(input_shape, dtype=flow.float32):
     return xla_gelu_job
 
 
+def make_native_job(input_shape, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(True)
+
+    @flow.global_function(config)
+    def native_gelu_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.math.gelu(x)
+
+    return native_gelu_job
+
+
 class TestGelu(unittest.TestCase):
     def _test_body(self, x, dtype=np.float32):
         f1 = make_job(x.shape, dtype=flow.float32)
@@ -54,6 +69,11 @@ class TestGelu(unittest.TestCase):
         self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
 
         flow.clear_default_session()
+        f3 = make_native_job(x.shape, dtype=flow.float32)
+        c = f3(x).get()
+        print("with native: ", c)
+        self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, shape, dtype=np.float32):
         x = np.ones(shape, dtype=dtype)
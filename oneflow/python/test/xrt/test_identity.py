@@ -24,6 +24,7 @@ config = flow.function_config()
 def make_job(input_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def identity_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
@@ -35,6 +36,7 @@ def make_job(input_shape, dtype=flow.float32):
 def make_xla_job(input_shape, dtype=flow.float32):
     config.use_xla_jit(True)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def xla_identity_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
@@ -46,6 +48,7 @@ def make_xla_job(input_shape, dtype=flow.float32):
 def make_trt_job(input_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(True)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def trt_identity_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
@@ -54,6 +57,19 @@ def make_trt_job(input_shape, dtype=flow.float32):
     return trt_identity_job
 
 
+def make_native_job(input_shape, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(True)
+
+    @flow.global_function(config)
+    def native_identity_job(x=flow.FixedTensorDef(input_shape, dtype=dtype)):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.identity(x)
+
+    return native_identity_job
+
+
 class TestIdentity(unittest.TestCase):
     def _test_body(self, x, dtype=np.float32):
         f1 = make_job(x.shape, dtype=flow.float32)
@@ -68,6 +84,11 @@ class TestIdentity(unittest.TestCase):
         self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
         self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
         flow.clear_default_session()
+        f4 = make_native_job(x.shape, dtype=flow.float32)
+        d = f4(x).get()
+        print("with native: ", d)
+        self.assertTrue(np.allclose(a.numpy(), d.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, shape, dtype=np.float32):
         x = np.ones(shape, dtype=dtype)
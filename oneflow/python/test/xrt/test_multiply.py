@@ -24,6 +24,7 @@ config = flow.function_config()
 def make_job(x_shape, y_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(False)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def multiply_job(
@@ -38,6 +39,7 @@ def make_job(x_shape, y_shape, dtype=flow.float32):
 def make_trt_job(x_shape, y_shape, dtype=flow.float32):
     config.use_xla_jit(False)
     config.use_tensorrt(True)
+    config.use_native_fusion(False)
 
     @flow.global_function(config)
     def trt_multiply_job(
@@ -49,6 +51,22 @@ def make_trt_job(x_shape, y_shape, dtype=flow.float32):
     return trt_multiply_job
 
 
+def make_native_job(x_shape, y_shape, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(True)
+
+    @flow.global_function(config)
+    def native_multiply_job(
+        x=flow.FixedTensorDef(x_shape, dtype=dtype),
+        y=flow.FixedTensorDef(y_shape, dtype=dtype),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.math.multiply(x, y)
+
+    return native_multiply_job
+
+
 class TestMultiply(unittest.TestCase):
     def _test_body(self, x, y, dtype=np.float32):
         f1 = make_job(x.shape, y.shape, dtype=flow.float32)
@@ -59,6 +77,11 @@ class TestMultiply(unittest.TestCase):
         print("with tensorrt", b)
         self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
         flow.clear_default_session()
+        f3 = make_native_job(x.shape, y.shape, dtype=flow.float32)
+        c = f3(x, y).get()
+        print("with native: ", c)
+        self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, x_shape, y_shape, dtype=np.float32):
         x = np.ones(x_shape, dtype=dtype)
@@ -0,0 +1,136 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+
+import numpy as np
+import oneflow as flow
+
+config = flow.function_config()
+
+
+def elementwise_chain(x, bias):
+    y = flow.nn.bias_add(x, bias)
+    y = flow.math.relu(y) * flow.math.sigmoid(x) + flow.math.tanh(flow.math.gelu(x))
+    y = flow.math.add(flow.math.multiply(y, 0.5), 1.0)
+    return flow.reshape(y, (-1,))
+
+
+def broadcast(x, y, z):
+    out = flow.math.add(x, y)
+    out = flow.math.multiply(out, z)
+    out = flow.math.divide(flow.math.sigmoid(out), flow.math.add(z, 2.0))
+    return flow.math.relu(flow.math.add(out, x))
+
+
+def make_chain_job(x_shape, b_shape, native, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(native)
+
+    @flow.global_function(config)
+    def chain_job(
+        x=flow.FixedTensorDef(x_shape, dtype=dtype),
+        bias=flow.FixedTensorDef(b_shape, dtype=dtype),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return elementwise_chain(x, bias)
+
+    return chain_job
+
+
+def make_broadcast_job(x_shape, y_shape, z_shape, native, dtype=flow.float32):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(native)
+
+    @flow.global_function(config)
+    def broadcast_job(
+        x=flow.FixedTensorDef(x_shape, dtype=dtype),
+        y=flow.FixedTensorDef(y_shape, dtype=dtype),
+        z=flow.FixedTensorDef(z_shape, dtype=dtype),
+    ):
+        with flow.scope.placement("cpu", "0:0"):
+            return broadcast(x, y, z)
+
+    return broadcast_job
+
+
+def make_int8_job(x_shape, native):
+    config.use_xla_jit(False)
+    config.use_tensorrt(False)
+    config.use_native_fusion(native)
+
+    @flow.global_function(config)
+    def int8_job(x=flow.FixedTensorDef(x_shape, dtype=flow.int8)):
+        with flow.scope.placement("cpu", "0:0"):
+            return flow.reshape(flow.identity(x), (-1,))
+
+    return int8_job
+
+
+class TestNativeFusion(unittest.TestCase):
+    def _test_chain_body(self, x_shape, b_shape, dtype=np.float32):
+        x = (np.random.random(x_shape) * 4 - 2).astype(dtype)
+        bias = np.random.random(b_shape).astype(dtype)
+        f1 = make_chain_job(x.shape, bias.shape, False, dtype=flow.float32)
+        a = f1(x, bias).get()
+        flow.clear_default_session()
+        f2 = make_chain_job(x.shape, bias.shape, True, dtype=flow.float32)
+        b = f2(x, bias).get()
+        print("without native: ", a)
+        print("with native: ", b)
+        self.assertTrue(a.shape == b.shape)
+        self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
+
+    def _test_broadcast_body(self, x_shape, y_shape, z_shape, dtype=np.float32):
+        x = (np.random.random(x_shape) * 4 - 2).astype(dtype)
+        y = (np.random.random(y_shape) * 4 - 2).astype(dtype)
+        z = np.random.random(z_shape).astype(dtype)
+        f1 = make_broadcast_job(x.shape, y.shape, z.shape, False, dtype=flow.float32)
+        a = f1(x, y, z).get()
+        flow.clear_default_session()
+        f2 = make_broadcast_job(x.shape, y.shape, z.shape, True, dtype=flow.float32)
+        b = f2(x, y, z).get()
+        print("without native: ", a)
+        print("with native: ", b)
+        self.assertTrue(a.shape == b.shape)
+        self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
+
+    def test_elementwise_chain(self):
+        self._test_chain_body((1, 10), (10))
+        self._test_chain_body((4, 10, 2), (10))
+        # enough elements to be split into blocks over the thread pool
+        self._test_chain_body((64, 128, 33), (128))
+
+    def test_broadcast(self):
+        self._test_broadcast_body((4, 1, 8), (1, 5, 8), (4, 5, 1))
+        self._test_broadcast_body((2, 3, 1, 7), (3, 5, 7), (1, 1, 5, 1))
+        self._test_broadcast_body((256, 1), (1, 300), (256, 300))
+
+    def test_unsupported_data_type(self):
+        # int8 nodes are not clustered natively and run with the default kernels
+        x = np.random.randint(-100, 100, size=(4, 10)).astype(np.int8)
+        a = make_int8_job(x.shape, False)(x).get()
+        flow.clear_default_session()
+        b = make_int8_job(x.shape, True)(x).get()
+        self.assertTrue(np.array_equal(a.numpy(), b.numpy()))
+        flow.clear_default_session()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -36,6 +36,11 @@ class TestScalarOp(unittest.TestCase):
         self.assertTrue(np.allclose(a.numpy(), b.numpy(), rtol=1e-03, atol=1e-05))
 
         flow.clear_default_session()
+        f3 = self.make_native_job(x.shape, scalar, dtype=flow.float32)
+        c = f3(x).get()
+        print("with native: ", c)
+        self.assertTrue(np.allclose(a.numpy(), c.numpy(), rtol=1e-03, atol=1e-05))
+        flow.clear_default_session()
 
     def _test_ones_body(self, x_shape, scalar, dtype=np.float32):
         x = np.ones(x_shape, dtype=dtype)
@@ -62,6 +67,7 @@ class TestScalarAddOp(TestScalarOp):
     def make_job(self, x_shape, scalar, dtype=flow.float32):
         config.use_xla_jit(False)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def scalar_add_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
@@ -72,6 +78,7 @@ class TestScalarAddOp(TestScalarOp):
     def make_xla_job(self, x_shape, scalar, dtype=flow.float32):
         config.use_xla_jit(True)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def xla_scalar_add_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
@@ -79,6 +86,18 @@ class TestScalarAddOp(TestScalarOp):
 
         return xla_scalar_add_job
 
+    def make_native_job(self, x_shape, scalar, dtype=flow.float32):
+        config.use_xla_jit(False)
+        config.use_tensorrt(False)
+        config.use_native_fusion(True)
+
+        @flow.global_function(config)
+        def native_scalar_add_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
+            with flow.scope.placement("cpu", "0:0"):
+                return flow.math.add(x, scalar)
+
+        return native_scalar_add_job
+
 
 class TestScalarMulOp(TestScalarOp):
     run_test = True
@@ -86,6 +105,7 @@ class TestScalarMulOp(TestScalarOp):
     def make_job(self, x_shape, scalar, dtype=flow.float32):
         config.use_xla_jit(False)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def scalar_mul_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
@@ -96,6 +116,7 @@ class TestScalarMulOp(TestScalarOp):
     def make_xla_job(self, x_shape, scalar, dtype=flow.float32):
         config.use_xla_jit(True)
         config.use_tensorrt(False)
+        config.use_native_fusion(False)
 
         @flow.global_function(config)
         def xla_scalar_mul_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
@@ -103,6 +124,18 @@ class TestScalarMulOp(TestScalarOp):
 
         return xla_scalar_mul_job
 
+    def make_native_job(self, x_shape, scalar, dtype=flow.float32):
+        config.use_xla_jit(False)
+        config.use_tensorrt(False)
+        config.use_native_fusion(True)
+
+        @flow.global_function(config)
+        def native_scalar_mul_job(x=flow.FixedTensorDef(x_shape, dtype=dtype)):
+            with flow.scope.placement("cpu", "0:0"):
+                return flow.math.multiply(x, scalar)
+
+        return native_scalar_mul_job
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,301 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/coco_annotation_index.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/user/summary/crc32c.h"
+#include <json.hpp>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+constexpr uint64_t kCOCOAnnotationIndexMagic = 0x5844494f434f4346;  // "FCOCOIDX"
+constexpr int64_t kCOCOAnnotationIndexVersion = 3;
+constexpr size_t kSectionAlignSize = 8;
+constexpr int64_t kAnnotationSampleByteSize = 64 * 1024;
+
+template<typename T>
+size_t SectionByteSize(int64_t num) {
+  return RoundUp(num * sizeof(T), kSectionAlignSize);
+}
+
+template<typename T>
+void AppendSection(const std::vector<T>& section, std::string* buffer) {
+  const size_t offset = buffer->size();
+  buffer->resize(offset + SectionByteSize<T>(section.size()), '\0');
+  if (!section.empty()) {
+    std::memcpy(&buffer->at(offset), section.data(), section.size() * sizeof(T));
+  }
+}
+
+std::string ReadAnnotationFile(const std::string& annotation_file, int64_t offset,
+                               int64_t byte_size) {
+  std::string str(byte_size, '\0');
+  if (byte_size == 0) { return str; }
+  PersistentInStream in_stream(DataFS(), annotation_file, offset);
+  CHECK_EQ(in_stream.ReadFully(&str[0], str.size()), 0);
+  return str;
+}
+
+// the head sample is [0, head_end) and the tail sample is [tail_begin, byte_size), they cover
+// the whole json when it is no larger than two samples
+int64_t SampleHeadEnd(int64_t byte_size) { return std::min(byte_size, kAnnotationSampleByteSize); }
+
+int64_t SampleTailBegin(int64_t byte_size) {
+  return std::max(SampleHeadEnd(byte_size), byte_size - kAnnotationSampleByteSize);
+}
+
+uint32_t SampleCrc32c(const std::string& annotation_json_str) {
+  const int64_t byte_size = annotation_json_str.size();
+  const int64_t tail_begin = SampleTailBegin(byte_size);
+  const uint32_t head_crc = summary::GetCrc32(annotation_json_str.data(), SampleHeadEnd(byte_size));
+  return summary::ExtendCrc32(head_crc, annotation_json_str.data() + tail_begin,
+                              byte_size - tail_begin);
+}
+
+uint32_t SampleCrc32c(const std::string& annotation_file, int64_t byte_size) {
+  const std::string head = ReadAnnotationFile(annotation_file, 0, SampleHeadEnd(byte_size));
+  const int64_t tail_begin = SampleTailBegin(byte_size);
+  const std::string tail =
+      ReadAnnotationFile(annotation_file, tail_begin, byte_size - tail_begin);
+  return summary::ExtendCrc32(summary::GetCrc32(head.data(), head.size()), tail.data(),
+                              tail.size());
+}
+
+}  // namespace
+
+COCOAnnotationIndex::COCOAnnotationIndex(std::string&& buffer)
+    : buffer_(std::move(buffer)), is_mapped_(false) {
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  InitSections();
+}
+
+COCOAnnotationIndex::COCOAnnotationIndex(const char* mapped_data, size_t mapped_size)
+    : data_(mapped_data), size_(mapped_size), is_mapped_(true) {
+  InitSections();
+}
+
+COCOAnnotationIndex::~COCOAnnotationIndex() {
+  if (is_mapped_) { PCHECK(munmap(const_cast<char*>(data_), size_) == 0); }
+}
+
+void COCOAnnotationIndex::InitSections() {
+  const char* ptr = data_;
+  header_ = reinterpret_cast<const Header*>(ptr);
+  ptr += RoundUp(sizeof(Header), kSectionAlignSize);
+  images_ = reinterpret_cast<const Image*>(ptr);
+  ptr += SectionByteSize<Image>(header_->num_images);
+  annos_ = reinterpret_cast<const Anno*>(ptr);
+  ptr += SectionByteSize<Anno>(header_->num_annos);
+  poly_coord_offsets_ = reinterpret_cast<const int64_t*>(ptr);
+  ptr += SectionByteSize<int64_t>(header_->num_polys + 1);
+  coords_ = reinterpret_cast<const float*>(ptr);
+  ptr += SectionByteSize<float>(header_->num_coords);
+  category_ids_ = reinterpret_cast<const int32_t*>(ptr);
+  ptr += SectionByteSize<int32_t>(header_->num_categories);
+  strings_ = ptr;
+  ptr += SectionByteSize<char>(header_->string_byte_size);
+  CHECK_EQ(ptr - data_, size_);
+}
+
+bool COCOAnnotationIndex::IsValid(const char* data, size_t size, int64_t annotation_byte_size,
+                                  uint32_t annotation_sample_crc32c) {
+  if (size < sizeof(Header)) { return false; }
+  const Header* header = reinterpret_cast<const Header*>(data);
+  if (header->magic != kCOCOAnnotationIndexMagic) { return false; }
+  if (header->version != kCOCOAnnotationIndexVersion) { return false; }
+  if (header->annotation_byte_size != annotation_byte_size) { return false; }
+  if (header->annotation_sample_crc32c != annotation_sample_crc32c) { return false; }
+  const size_t expected_size = RoundUp(sizeof(Header), kSectionAlignSize)
+                               + SectionByteSize<Image>(header->num_images)
+                               + SectionByteSize<Anno>(header->num_annos)
+                               + SectionByteSize<int64_t>(header->num_polys + 1)
+                               + SectionByteSize<float>(header->num_coords)
+                               + SectionByteSize<int32_t>(header->num_categories)
+                               + SectionByteSize<char>(header->string_byte_size);
+  return size == expected_size;
+}
+
+std::string COCOAnnotationIndex::Build(const std::string& annotation_json_str) {
+  const int64_t annotation_byte_size = annotation_json_str.size();
+  const uint32_t annotation_sample_crc32c = SampleCrc32c(annotation_json_str);
+  const nlohmann::json annotation_json = nlohmann::json::parse(annotation_json_str);
+  // images are sorted by id for reproducible results
+  std::vector<const nlohmann::json*> image_jsons;
+  for (const auto& image : annotation_json["images"]) { image_jsons.push_back(&image); }
+  std::sort(image_jsons.begin(), image_jsons.end(),
+            [](const nlohmann::json* lhs, const nlohmann::json* rhs) {
+              return (*lhs)["id"].get<int64_t>() < (*rhs)["id"].get<int64_t>();
+            });
+  HashMap<int64_t, int64_t> image_id2image_idx;
+  FOR_RANGE(int64_t, i, 0, image_jsons.size()) {
+    CHECK(image_id2image_idx.emplace((*image_jsons.at(i))["id"].get<int64_t>(), i).second);
+  }
+  std::vector<std::vector<const nlohmann::json*>> image_idx2anno_jsons(image_jsons.size());
+  for (const auto& anno : annotation_json["annotations"]) {
+    // ignore crowd object for now
+    if (anno["iscrowd"].get<int>() == 1) { continue; }
+    // check if invalid segmentation
+    if (anno["segmentation"].is_array()) {
+      for (const auto& poly : anno["segmentation"]) {
+        // at least 3 points can compose a polygon
+        // every point needs 2 element (x, y) to present
+        CHECK_GT(poly.size(), 6);
+        CHECK_EQ(poly.size() % 2, 0);
+      }
+    }
+    image_idx2anno_jsons.at(image_id2image_idx.at(anno["image_id"].get<int64_t>()))
+        .push_back(&anno);
+  }
+
+  std::vector<Image> images;
+  std::vector<Anno> annos;
+  std::vector<int64_t> poly_coord_offsets = {0};
+  std::vector<float> coords;
+  std::vector<int32_t> category_ids;
+  std::vector<char> strings;
+  FOR_RANGE(int64_t, i, 0, image_jsons.size()) {
+    const nlohmann::json& image_json = *image_jsons.at(i);
+    const std::string& file_name = image_json["file_name"].get_ref<const std::string&>();
+    Image image;
+    image.id = image_json["id"].get<int64_t>();
+    image.height = image_json["height"].get<int32_t>();
+    image.width = image_json["width"].get<int32_t>();
+    image.file_name_offset = strings.size();
+    image.file_name_size = file_name.size();
+    strings.insert(strings.end(), file_name.begin(), file_name.end());
+    image.anno_begin = annos.size();
+    for (const nlohmann::json* anno_json : image_idx2anno_jsons.at(i)) {
+      const auto& bbox_json = (*anno_json)["bbox"];
+      CHECK(bbox_json.is_array());
+      CHECK_EQ(bbox_json.size(), 4);
+      Anno anno;
+      anno.id = (*anno_json)["id"].get<int64_t>();
+      FOR_RANGE(int32_t, j, 0, 4) { anno.bbox[j] = bbox_json[j].get<float>(); }
+      anno.category_id = (*anno_json)["category_id"].get<int32_t>();
+      anno.has_keypoints = anno_json->contains("keypoints");
+      anno.num_visible_keypoints = 0;
+      if (anno.has_keypoints) {
+        const auto& keypoints = (*anno_json)["keypoints"];
+        CHECK_EQ(keypoints.size() % 3, 0);
+        FOR_RANGE(size_t, j, 0, keypoints.size() / 3) {
+          if (keypoints[j * 3 + 2].get<int32_t>() > 0) { anno.num_visible_keypoints += 1; }
+        }
+      }
+      const auto& segm_json = (*anno_json)["segmentation"];
+      anno.is_polygon_segm = segm_json.is_array();
+      anno.poly_begin = poly_coord_offsets.size() - 1;
+      if (anno.is_polygon_segm) {
+        for (const auto& poly_json : segm_json) {
+          for (const auto& elem : poly_json) { coords.push_back(elem.get<float>()); }
+          poly_coord_offsets.push_back(coords.size());
+        }
+      }
+      anno.poly_end = poly_coord_offsets.size() - 1;
+      annos.push_back(anno);
+    }
+    image.anno_end = annos.size();
+    images.push_back(image);
+  }
+  for (const auto& cat : annotation_json["categories"]) {
+    category_ids.push_back(cat["id"].get<int32_t>());
+  }
+  std::sort(category_ids.begin(), category_ids.end());
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  header.magic = kCOCOAnnotationIndexMagic;
+  header.version = kCOCOAnnotationIndexVersion;
+  header.annotation_byte_size = annotation_byte_size;
+  header.annotation_sample_crc32c = annotation_sample_crc32c;
+  header.num_images = images.size();
+  header.num_annos = annos.size();
+  header.num_polys = poly_coord_offsets.size() - 1;
+  header.num_coords = coords.size();
+  header.num_categories = category_ids.size();
+  header.string_byte_size = strings.size();
+  std::string buffer;
+  AppendSection(std::vector<Header>{header}, &buffer);
+  AppendSection(images, &buffer);
+  AppendSection(annos, &buffer);
+  AppendSection(poly_coord_offsets, &buffer);
+  AppendSection(coords, &buffer);
+  AppendSection(category_ids, &buffer);
+  AppendSection(strings, &buffer);
+  CHECK(IsValid(buffer.data(), buffer.size(), annotation_byte_size, annotation_sample_crc32c));
+  return buffer;
+}
+
+std::unique_ptr<const COCOAnnotationIndex> COCOAnnotationIndex::Load(
+    const std::string& annotation_file, const std::string& index_file) {
+  const int64_t annotation_byte_size = DataFS()->GetFileSize(annotation_file);
+  if (index_file.empty()) {
+    return std::unique_ptr<const COCOAnnotationIndex>(new COCOAnnotationIndex(
+        Build(ReadAnnotationFile(annotation_file, 0, annotation_byte_size))));
+  }
+  // only the samples are read to check an existing index, the whole json only when rebuilding
+  const uint32_t annotation_sample_crc32c = SampleCrc32c(annotation_file, annotation_byte_size);
+  auto TryMap = [&]() -> std::unique_ptr<const COCOAnnotationIndex> {
+    const std::string path = LocalFS()->TranslateName(index_file);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) { return nullptr; }
+    struct stat st;
+    PCHECK(fstat(fd, &st) == 0);
+    void* data = nullptr;
+    if (st.st_size > 0) { data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0); }
+    PCHECK(close(fd) == 0);
+    if (data == nullptr || data == MAP_FAILED) { return nullptr; }
+    if (!IsValid(static_cast<const char*>(data), st.st_size, annotation_byte_size,
+                 annotation_sample_crc32c)) {
+      PCHECK(munmap(data, st.st_size) == 0);
+      return nullptr;
+    }
+    return std::unique_ptr<const COCOAnnotationIndex>(
+        new COCOAnnotationIndex(static_cast<const char*>(data), st.st_size));
+  };
+  std::unique_ptr<const COCOAnnotationIndex> index = TryMap();
+  if (index) { return index; }
+  // ranks sharing the index file may build it concurrently, so each one publishes its own copy
+  // with an atomic rename
+  const auto start = std::chrono::steady_clock::now();
+  const std::string buffer = Build(ReadAnnotationFile(annotation_file, 0, annotation_byte_size));
+  const std::string tmp_file = index_file + ".tmp." + std::to_string(getpid());
+  {
+    std::unique_ptr<fs::WritableFile> file;
+    LocalFS()->NewWritableFile(tmp_file, &file);
+    file->Append(buffer.data(), buffer.size());
+    file->Close();
+  }
+  LocalFS()->RenameFile(tmp_file, index_file);
+  LOG(INFO) << "build coco annotation index " << index_file << " from " << annotation_file
+            << " in "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+            << "s";
+  index = TryMap();
+  CHECK(index) << "fail to map coco annotation index " << index_file;
+  return index;
+}
+
+}  // namespace data
+}  // namespace oneflow
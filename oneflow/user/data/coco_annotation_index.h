@@ -0,0 +1,111 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_COCO_ANNOTATION_INDEX_H_
+#define ONEFLOW_USER_DATA_COCO_ANNOTATION_INDEX_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace data {
+
+// Compact binary form of a COCO annotation json. All sections are arrays of fixed size records
+// which refer to each other by offset, so the index file can be mmap-ed and shared by every data
+// loader rank of a host through the page cache.
+class COCOAnnotationIndex final {
+ public:
+  struct Image {
+    int64_t id;
+    int32_t height;
+    int32_t width;
+    int64_t file_name_offset;
+    int64_t file_name_size;
+    // annos of an image are [anno_begin, anno_end) in json order, crowd annos excluded
+    int64_t anno_begin;
+    int64_t anno_end;
+  };
+  struct Anno {
+    int64_t id;
+    // [left, top, width, height]
+    float bbox[4];
+    int32_t category_id;
+    int32_t has_keypoints;
+    int32_t num_visible_keypoints;
+    int32_t is_polygon_segm;
+    // polygons of an anno are [poly_begin, poly_end)
+    int64_t poly_begin;
+    int64_t poly_end;
+  };
+
+  OF_DISALLOW_COPY_AND_MOVE(COCOAnnotationIndex);
+  ~COCOAnnotationIndex();
+
+  // Maps index_file if it was built from the current annotation_file, otherwise builds it first.
+  // An empty index_file keeps the index in memory.
+  static std::unique_ptr<const COCOAnnotationIndex> Load(const std::string& annotation_file,
+                                                         const std::string& index_file);
+
+  int64_t num_images() const { return header_->num_images; }
+  const Image& image(int64_t i) const { return images_[i]; }
+  const Anno& anno(int64_t i) const { return annos_[i]; }
+  std::string file_name(const Image& image) const {
+    return std::string(strings_ + image.file_name_offset, image.file_name_size);
+  }
+  // coords of polygon i are [poly_coord_offset(i), poly_coord_offset(i + 1)) in coords()
+  int64_t poly_coord_offset(int64_t i) const { return poly_coord_offsets_[i]; }
+  const float* coords() const { return coords_; }
+  int64_t num_categories() const { return header_->num_categories; }
+  const int32_t* category_ids() const { return category_ids_; }
+
+ private:
+  struct Header {
+    uint64_t magic;
+    int64_t version;
+    int64_t annotation_byte_size;
+    // crc32c of the head and the tail of the annotation json, a cheap check that still rebuilds
+    // the index after most edits keeping the byte size
+    int64_t annotation_sample_crc32c;
+    int64_t num_images;
+    int64_t num_annos;
+    int64_t num_polys;
+    int64_t num_coords;
+    int64_t num_categories;
+    int64_t string_byte_size;
+  };
+
+  COCOAnnotationIndex(std::string&& buffer);
+  COCOAnnotationIndex(const char* mapped_data, size_t mapped_size);
+  void InitSections();
+  static bool IsValid(const char* data, size_t size, int64_t annotation_byte_size,
+                      uint32_t annotation_sample_crc32c);
+  static std::string Build(const std::string& annotation_json_str);
+
+  std::string buffer_;
+  const char* data_;
+  size_t size_;
+  bool is_mapped_;
+  const Header* header_;
+  const Image* images_;
+  const Anno* annos_;
+  const int64_t* poly_coord_offsets_;
+  const float* coords_;
+  const int32_t* category_ids_;
+  const char* strings_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_COCO_ANNOTATION_INDEX_H_
@@ -0,0 +1,247 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/coco_annotation_index.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include <json.hpp>
+
+namespace oneflow {
+
+namespace data {
+
+namespace test {
+
+namespace {
+
+// image 2 has no annos, anno 11 is a crowd anno, anno 12 has an rle segmentation and keypoints
+const char* kAnnotationJson = R"({
+  "images": [
+    {"id": 3, "height": 480, "width": 640, "file_name": "000003.jpg"},
+    {"id": 1, "height": 375, "width": 500, "file_name": "000001.jpg"},
+    {"id": 2, "height": 427, "width": 640, "file_name": "000002.jpg"}
+  ],
+  "annotations": [
+    {"id": 10, "image_id": 1, "iscrowd": 0, "category_id": 18, "bbox": [1.5, 2.5, 30.0, 40.0],
+     "segmentation": [[1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0],
+                      [10.0, 20.0, 30.0, 40.0, 50.0, 60.0, 70.0, 80.0, 90.0, 100.0]]},
+    {"id": 11, "image_id": 1, "iscrowd": 1, "category_id": 1, "bbox": [0.0, 0.0, 9.0, 9.0],
+     "segmentation": {"counts": [1, 2, 3], "size": [375, 500]}},
+    {"id": 12, "image_id": 3, "iscrowd": 0, "category_id": 1, "bbox": [5.0, 6.0, 0.5, 7.0],
+     "segmentation": {"counts": [4, 5, 6], "size": [480, 640]},
+     "keypoints": [1, 2, 2, 3, 4, 0, 5, 6, 1]},
+    {"id": 13, "image_id": 3, "iscrowd": 0, "category_id": 18, "bbox": [7.0, 8.0, 9.0, 10.0],
+     "segmentation": [[0.5, 0.5, 1.5, 0.5, 1.5, 1.5, 0.5, 1.5]]}
+  ],
+  "categories": [{"id": 18, "name": "dog"}, {"id": 1, "name": "person"}]
+})";
+
+class COCOAnnotationIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IOConf io_conf;
+    io_conf.mutable_data_fs_conf()->mutable_localfs_conf();
+    Global<const IOConf>::New(io_conf);
+    root_path_ = JoinPath(GetCwd(), "tmp_coco_annotation_index_test_asdfasdf");
+    LocalFS()->RecursivelyCreateDirIfNotExist(root_path_);
+    annotation_file_ = JoinPath(root_path_, "annotations.json");
+    index_file_ = JoinPath(root_path_, "annotations.idx");
+    WriteFile(annotation_file_, kAnnotationJson);
+  }
+
+  void TearDown() override {
+    LocalFS()->RecursivelyDeleteDir(root_path_);
+    Global<const IOConf>::Delete();
+  }
+
+  static void WriteFile(const std::string& path, const std::string& content) {
+    std::unique_ptr<fs::WritableFile> file;
+    LocalFS()->NewWritableFile(path, &file);
+    file->Append(content.data(), content.size());
+    file->Close();
+  }
+
+  static std::string ReadFile(const std::string& path) {
+    std::string content(LocalFS()->GetFileSize(path), '\0');
+    std::unique_ptr<fs::RandomAccessFile> file;
+    LocalFS()->NewRandomAccessFile(path, &file);
+    file->Read(0, content.size(), &content[0]);
+    return content;
+  }
+
+  std::string root_path_;
+  std::string annotation_file_;
+  std::string index_file_;
+};
+
+// the way COCOMeta walked the json before the index existed
+void CheckIndexAgainstJson(const COCOAnnotationIndex& index, const std::string& json_str) {
+  const nlohmann::json json = nlohmann::json::parse(json_str);
+  std::vector<nlohmann::json> image_jsons(json["images"].begin(), json["images"].end());
+  std::sort(image_jsons.begin(), image_jsons.end(),
+            [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
+              return lhs["id"].get<int64_t>() < rhs["id"].get<int64_t>();
+            });
+  ASSERT_EQ(index.num_images(), image_jsons.size());
+  FOR_RANGE(int64_t, i, 0, image_jsons.size()) {
+    const nlohmann::json& image_json = image_jsons.at(i);
+    const COCOAnnotationIndex::Image& image = index.image(i);
+    ASSERT_EQ(image.id, image_json["id"].get<int64_t>());
+    ASSERT_EQ(image.height, image_json["height"].get<int32_t>());
+    ASSERT_EQ(image.width, image_json["width"].get<int32_t>());
+    ASSERT_EQ(index.file_name(image), image_json["file_name"].get<std::string>());
+    int64_t anno_idx = image.anno_begin;
+    for (const auto& anno_json : json["annotations"]) {
+      if (anno_json["image_id"].get<int64_t>() != image.id) { continue; }
+      if (anno_json["iscrowd"].get<int>() == 1) { continue; }
+      ASSERT_LT(anno_idx, image.anno_end);
+      const COCOAnnotationIndex::Anno& anno = index.anno(anno_idx);
+      ASSERT_EQ(anno.id, anno_json["id"].get<int64_t>());
+      FOR_RANGE(int32_t, j, 0, 4) { ASSERT_EQ(anno.bbox[j], anno_json["bbox"][j].get<float>()); }
+      ASSERT_EQ(anno.category_id, anno_json["category_id"].get<int32_t>());
+      ASSERT_EQ(anno.has_keypoints, anno_json.contains("keypoints"));
+      int32_t num_visible_keypoints = 0;
+      if (anno_json.contains("keypoints")) {
+        const auto& keypoints = anno_json["keypoints"];
+        FOR_RANGE(size_t, j, 0, keypoints.size() / 3) {
+          if (keypoints[j * 3 + 2].get<int32_t>() > 0) { num_visible_keypoints += 1; }
+        }
+      }
+      ASSERT_EQ(anno.num_visible_keypoints, num_visible_keypoints);
+      const auto& segm_json = anno_json["segmentation"];
+      ASSERT_EQ(anno.is_polygon_segm, segm_json.is_array());
+      if (segm_json.is_array()) {
+        ASSERT_EQ(anno.poly_end - anno.poly_begin, segm_json.size());
+        FOR_RANGE(int64_t, j, 0, segm_json.size()) {
+          const auto& poly_json = segm_json[j];
+          const int64_t coord_begin = index.poly_coord_offset(anno.poly_begin + j);
+          ASSERT_EQ(index.poly_coord_offset(anno.poly_begin + j + 1) - coord_begin,
+                    poly_json.size());
+          FOR_RANGE(int64_t, k, 0, poly_json.size()) {
+            ASSERT_EQ(index.coords()[coord_begin + k], poly_json[k].get<float>());
+          }
+        }
+      } else {
+        ASSERT_EQ(anno.poly_begin, anno.poly_end);
+      }
+      anno_idx += 1;
+    }
+    ASSERT_EQ(anno_idx, image.anno_end);
+  }
+  std::vector<int32_t> category_ids;
+  for (const auto& cat : json["categories"]) { category_ids.push_back(cat["id"].get<int32_t>()); }
+  std::sort(category_ids.begin(), category_ids.end());
+  ASSERT_EQ(index.num_categories(), category_ids.size());
+  FOR_RANGE(int64_t, i, 0, category_ids.size()) {
+    ASSERT_EQ(index.category_ids()[i], category_ids.at(i));
+  }
+}
+
+}  // namespace
+
+TEST_F(COCOAnnotationIndexTest, in_memory) {
+  auto index = COCOAnnotationIndex::Load(annotation_file_, "");
+  CheckIndexAgainstJson(*index, kAnnotationJson);
+  ASSERT_EQ(index->num_images(), 3);
+  // image 2 has no annos, the crowd anno of image 1 is dropped
+  ASSERT_EQ(index->image(0).anno_end - index->image(0).anno_begin, 1);
+  ASSERT_EQ(index->image(1).anno_end - index->image(1).anno_begin, 0);
+  ASSERT_EQ(index->image(2).anno_end - index->image(2).anno_begin, 2);
+  ASSERT_FALSE(LocalFS()->FileExists(index_file_));
+}
+
+TEST_F(COCOAnnotationIndexTest, build_then_map) {
+  {
+    auto index = COCOAnnotationIndex::Load(annotation_file_, index_file_);
+    CheckIndexAgainstJson(*index, kAnnotationJson);
+  }
+  const std::string index_content = ReadFile(index_file_);
+  auto index = COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  CheckIndexAgainstJson(*index, kAnnotationJson);
+  ASSERT_EQ(ReadFile(index_file_), index_content);
+}
+
+TEST_F(COCOAnnotationIndexTest, rebuild_stale_index_of_same_byte_size) {
+  COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  const std::string stale_content = ReadFile(index_file_);
+  std::string edited_json = kAnnotationJson;
+  const size_t pos = edited_json.find("\"height\": 480");
+  ASSERT_NE(pos, std::string::npos);
+  edited_json.replace(pos, 13, "\"height\": 481");
+  ASSERT_EQ(edited_json.size(), std::string(kAnnotationJson).size());
+  WriteFile(annotation_file_, edited_json);
+  auto index = COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  CheckIndexAgainstJson(*index, edited_json);
+  ASSERT_EQ(index->image(2).height, 481);
+  ASSERT_NE(ReadFile(index_file_), stale_content);
+}
+
+TEST_F(COCOAnnotationIndexTest, rebuild_corrupt_index) {
+  COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  const std::string index_content = ReadFile(index_file_);
+  // truncated
+  WriteFile(index_file_, index_content.substr(0, index_content.size() / 2));
+  CheckIndexAgainstJson(*COCOAnnotationIndex::Load(annotation_file_, index_file_),
+                        kAnnotationJson);
+  ASSERT_EQ(ReadFile(index_file_), index_content);
+  // bad magic
+  std::string bad_magic = index_content;
+  bad_magic[0] = ~bad_magic[0];
+  WriteFile(index_file_, bad_magic);
+  CheckIndexAgainstJson(*COCOAnnotationIndex::Load(annotation_file_, index_file_),
+                        kAnnotationJson);
+  ASSERT_EQ(ReadFile(index_file_), index_content);
+  // empty
+  WriteFile(index_file_, "");
+  CheckIndexAgainstJson(*COCOAnnotationIndex::Load(annotation_file_, index_file_),
+                        kAnnotationJson);
+  ASSERT_EQ(ReadFile(index_file_), index_content);
+}
+
+TEST_F(COCOAnnotationIndexTest, rebuild_large_index_edited_in_samples) {
+  // large enough that only the head and the tail of the json are checked
+  std::string json_str = R"({"images": [)";
+  FOR_RANGE(int64_t, i, 0, 4096) {
+    if (i > 0) { json_str += ", "; }
+    json_str += R"({"id": )" + std::to_string(i) + R"(, "height": 480, "width": 640, )"
+                + R"("file_name": ")" + std::to_string(i) + R"(.jpg"})";
+  }
+  json_str += R"(], "annotations": [], "categories": [{"id": 18, "name": "dog"}]})";
+  ASSERT_GT(json_str.size(), 256 * 1024);
+  WriteFile(annotation_file_, json_str);
+  CheckIndexAgainstJson(*COCOAnnotationIndex::Load(annotation_file_, index_file_), json_str);
+  // an edit in the head
+  const size_t head_pos = json_str.find("\"height\": 480");
+  json_str.replace(head_pos, 13, "\"height\": 481");
+  WriteFile(annotation_file_, json_str);
+  auto index = COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  CheckIndexAgainstJson(*index, json_str);
+  ASSERT_EQ(index->image(0).height, 481);
+  // an edit in the tail
+  const size_t tail_pos = json_str.rfind("\"id\": 18");
+  json_str.replace(tail_pos, 8, "\"id\": 19");
+  WriteFile(annotation_file_, json_str);
+  index = COCOAnnotationIndex::Load(annotation_file_, index_file_);
+  CheckIndexAgainstJson(*index, json_str);
+  ASSERT_EQ(index->category_ids()[0], 19);
+}
+
+}  // namespace test
+
+}  // namespace data
+
+}  // namespace oneflow
@@ -18,8 +18,8 @@ limitations under the License.
 
 #include "oneflow/user/data/data_reader.h"
 #include "oneflow/user/data/coco_parser.h"
+#include "oneflow/user/data/coco_annotation_index.h"
 #include "oneflow/core/common/str_util.h"
-#include <json.hpp>
 
 namespace oneflow {
 namespace data {
@@ -36,24 +36,16 @@ class COCODataReader final : public DataReader<COCOImage> {
 
 class COCOMeta final {
  public:
-  COCOMeta(const std::string& annotation_file, const std::string& image_dir,
-           bool remove_images_without_annotations);
+  COCOMeta(const std::string& annotation_file, const std::string& annotation_index_file,
+           const std::string& image_dir, bool remove_images_without_annotations);
   ~COCOMeta() = default;
 
-  int64_t Size() const { return image_ids_.size(); }
-  int64_t GetImageId(int64_t index) const { return image_ids_.at(index); }
-  int32_t GetImageHeight(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    return image_id2image_.at(image_id)["height"].get<int32_t>();
-  }
-  int32_t GetImageWidth(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    return image_id2image_.at(image_id)["width"].get<int32_t>();
-  }
+  int64_t Size() const { return image_idxs_.size(); }
+  int64_t GetImageId(int64_t index) const { return Image4Index(index).id; }
+  int32_t GetImageHeight(int64_t index) const { return Image4Index(index).height; }
+  int32_t GetImageWidth(int64_t index) const { return Image4Index(index).width; }
   std::string GetImageFilePath(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    const auto& image_json = image_id2image_.at(image_id);
-    return JoinPath(image_dir_, image_json["file_name"].get<std::string>());
+    return JoinPath(image_dir_, anno_index_->file_name(Image4Index(index)));
   }
   template<typename T>
   std::vector<T> GetBboxVec(int64_t index) const;
@@ -64,40 +56,37 @@ class COCOMeta final {
                                        TensorBuffer* segm_offset_mat) const;
 
  private:
-  bool ImageHasValidAnnotations(int64_t image_id) const;
+  const COCOAnnotationIndex::Image& Image4Index(int64_t index) const {
+    return anno_index_->image(image_idxs_.at(index));
+  }
+  bool ImageHasValidAnnotations(const COCOAnnotationIndex::Image& image) const;
 
   static constexpr int kMinKeypointsPerImage = 10;
-  nlohmann::json annotation_json_;
+  std::unique_ptr<const COCOAnnotationIndex> anno_index_;
   std::string image_dir_;
-  std::vector<int64_t> image_ids_;
-  HashMap<int64_t, const nlohmann::json&> image_id2image_;
-  HashMap<int64_t, const nlohmann::json&> anno_id2anno_;
-  HashMap<int64_t, std::vector<int64_t>> image_id2anno_ids_;
+  std::vector<int64_t> image_idxs_;
   HashMap<int32_t, int32_t> category_id2contiguous_id_;
 };
 
 template<typename T>
 std::vector<T> COCOMeta::GetBboxVec(int64_t index) const {
   std::vector<T> bbox_vec;
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  for (int64_t anno_id : anno_ids) {
-    const auto& bbox_json = anno_id2anno_.at(anno_id)["bbox"];
-    CHECK(bbox_json.is_array());
-    CHECK_EQ(bbox_json.size(), 4);
+  const auto& image = Image4Index(index);
+  FOR_RANGE(int64_t, anno_idx, image.anno_begin, image.anno_end) {
+    const float* bbox = anno_index_->anno(anno_idx).bbox;
     // COCO bounding box format is [left, top, width, height]
     // we need format xyxy
     const T alginment = static_cast<T>(1);
     const T min_size = static_cast<T>(0);
-    T left = bbox_json[0].get<T>();
-    T top = bbox_json[1].get<T>();
-    T width = bbox_json[2].get<T>();
-    T height = bbox_json[3].get<T>();
+    T left = static_cast<T>(bbox[0]);
+    T top = static_cast<T>(bbox[1]);
+    T width = static_cast<T>(bbox[2]);
+    T height = static_cast<T>(bbox[3]);
     T right = left + std::max(width - alginment, min_size);
     T bottom = top + std::max(height - alginment, min_size);
     // clip to image
-    int32_t image_height = GetImageHeight(index);
-    int32_t image_width = GetImageWidth(index);
+    int32_t image_height = image.height;
+    int32_t image_width = image.width;
     left = std::min(std::max(left, min_size), image_width - alginment);
     top = std::min(std::max(top, min_size), image_height - alginment);
     right = std::min(std::max(right, min_size), image_width - alginment);
@@ -113,10 +102,9 @@ std::vector<T> COCOMeta::GetBboxVec(int64_t index) const {
 template<typename T>
 std::vector<T> COCOMeta::GetLabelVec(int64_t index) const {
   std::vector<T> label_vec;
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  for (int64_t anno_id : anno_ids) {
-    int32_t category_id = anno_id2anno_.at(anno_id)["category_id"].get<int32_t>();
+  const auto& image = Image4Index(index);
+  FOR_RANGE(int64_t, anno_idx, image.anno_begin, image.anno_end) {
+    int32_t category_id = anno_index_->anno(anno_idx).category_id;
     label_vec.push_back(category_id2contiguous_id_.at(category_id));
   }
   return label_vec;
@@ -126,36 +114,33 @@ template<typename T>
 void COCOMeta::ReadSegmentationsToTensorBuffer(int64_t index, TensorBuffer* segm,
                                                TensorBuffer* segm_index) const {
   if (segm == nullptr || segm_index == nullptr) { return; }
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  std::vector<T> segm_vec;
-  for (int64_t anno_id : anno_ids) {
-    const auto& segm_json = anno_id2anno_.at(anno_id)["segmentation"];
-    if (!segm_json.is_array()) { continue; }
-    for (const auto& poly_json : segm_json) {
-      CHECK(poly_json.is_array());
-      for (const auto& elem : poly_json) { segm_vec.push_back(elem.get<T>()); }
-    }
+  const auto& image = Image4Index(index);
+  int64_t num_coords = 0;
+  FOR_RANGE(int64_t, anno_idx, image.anno_begin, image.anno_end) {
+    const auto& anno = anno_index_->anno(anno_idx);
+    if (!anno.is_polygon_segm) { continue; }
+    num_coords += anno_index_->poly_coord_offset(anno.poly_end)
+                  - anno_index_->poly_coord_offset(anno.poly_begin);
   }
-  CHECK_EQ(segm_vec.size() % 2, 0);
-  int64_t num_pts = segm_vec.size() / 2;
+  CHECK_EQ(num_coords % 2, 0);
+  int64_t num_pts = num_coords / 2;
   segm->Resize(Shape({num_pts, 2}), GetDataType<T>::value);
-  std::copy(segm_vec.begin(), segm_vec.end(), segm->mut_data<T>());
-
   segm_index->Resize(Shape({num_pts, 3}), DataType::kInt32);
+  T* segm_ptr = segm->mut_data<T>();
   int32_t* index_ptr = segm_index->mut_data<int32_t>();
   int i = 0;
   int32_t segm_idx = 0;
-  for (int64_t anno_id : anno_ids) {
-    const auto& segm_json = anno_id2anno_.at(anno_id)["segmentation"];
-    CHECK(segm_json.is_array());
-    FOR_RANGE(int32_t, poly_idx, 0, segm_json.size()) {
-      const auto& poly_json = segm_json[poly_idx];
-      CHECK(poly_json.is_array());
-      CHECK_EQ(poly_json.size() % 2, 0);
-      FOR_RANGE(int32_t, pt_idx, 0, poly_json.size() / 2) {
+  FOR_RANGE(int64_t, anno_idx, image.anno_begin, image.anno_end) {
+    const auto& anno = anno_index_->anno(anno_idx);
+    CHECK(anno.is_polygon_segm);
+    FOR_RANGE(int64_t, poly, anno.poly_begin, anno.poly_end) {
+      const int64_t coord_begin = anno_index_->poly_coord_offset(poly);
+      const int64_t coord_end = anno_index_->poly_coord_offset(poly + 1);
+      std::copy(anno_index_->coords() + coord_begin, anno_index_->coords() + coord_end,
+                segm_ptr + i * 2);
+      FOR_RANGE(int32_t, pt_idx, 0, (coord_end - coord_begin) / 2) {
         index_ptr[i * 3 + 0] = pt_idx;
-        index_ptr[i * 3 + 1] = poly_idx;
+        index_ptr[i * 3 + 1] = poly - anno.poly_begin;
         index_ptr[i * 3 + 2] = segm_idx;
         i += 1;
       }
@@ -0,0 +1,224 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/cpu_radix_sort.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace {
+
+const int64_t kSortMinElemCntPerThread = 16384;
+const int32_t kRadixBits = 8;
+const int32_t kRadixBucketNum = 1 << kRadixBits;
+
+// Maps keys onto unsigned integers whose order matches the order of the keys: the sign bit of
+// integers is flipped, negative floats have all bits flipped and positive ones the sign bit.
+template<typename T, typename U, bool is_float>
+struct RadixKeyConverter {
+  using KeyType = U;
+  static constexpr U kSignBit = static_cast<U>(1) << (sizeof(U) * 8 - 1);
+  static U Encode(T x) {
+    U u;
+    std::memcpy(&u, &x, sizeof(U));
+    if (is_float && (u & kSignBit)) { return ~u; }
+    return u ^ kSignBit;
+  }
+  static T Decode(U u) {
+    if (is_float && !(u & kSignBit)) {
+      u = ~u;
+    } else {
+      u ^= kSignBit;
+    }
+    T x;
+    std::memcpy(&x, &u, sizeof(U));
+    return x;
+  }
+};
+
+template<typename T>
+struct RadixKey;
+template<>
+struct RadixKey<float> : public RadixKeyConverter<float, uint32_t, true> {};
+template<>
+struct RadixKey<double> : public RadixKeyConverter<double, uint64_t, true> {};
+template<>
+struct RadixKey<int32_t> : public RadixKeyConverter<int32_t, uint32_t, false> {};
+template<>
+struct RadixKey<int64_t> : public RadixKeyConverter<int64_t, uint64_t, false> {};
+
+template<typename U>
+struct RadixSortBuffer {
+  explicit RadixSortBuffer(int64_t n) : keys(n), keys_tmp(n), values_tmp(n) {}
+  std::vector<U> keys;
+  std::vector<U> keys_tmp;
+  std::vector<int32_t> values_tmp;
+};
+
+// LSD radix sort of keys, permuting values along when it is not null. Each pass is a stable
+// counting sort of one digit; passes whose digit is the same for all keys are skipped.
+template<typename U>
+void RadixSort(int64_t n, U* keys, U* keys_tmp, int32_t* values, int32_t* values_tmp) {
+  if (n == 0) { return; }
+  constexpr int32_t kPassNum = sizeof(U) * 8 / kRadixBits;
+  int64_t hist[kPassNum][kRadixBucketNum];
+  std::memset(hist, 0, sizeof(hist));
+  FOR_RANGE(int64_t, i, 0, n) {
+    const U key = keys[i];
+    FOR_RANGE(int32_t, pass, 0, kPassNum) {
+      hist[pass][(key >> (pass * kRadixBits)) & (kRadixBucketNum - 1)] += 1;
+    }
+  }
+  U* src = keys;
+  U* dst = keys_tmp;
+  int32_t* values_src = values;
+  int32_t* values_dst = values_tmp;
+  FOR_RANGE(int32_t, pass, 0, kPassNum) {
+    const int32_t shift = pass * kRadixBits;
+    int64_t* offsets = hist[pass];
+    if (offsets[(src[0] >> shift) & (kRadixBucketNum - 1)] == n) { continue; }
+    int64_t sum = 0;
+    FOR_RANGE(int32_t, bucket, 0, kRadixBucketNum) {
+      const int64_t cnt = offsets[bucket];
+      offsets[bucket] = sum;
+      sum += cnt;
+    }
+    if (values_src == nullptr) {
+      FOR_RANGE(int64_t, i, 0, n) {
+        dst[offsets[(src[i] >> shift) & (kRadixBucketNum - 1)]++] = src[i];
+      }
+    } else {
+      FOR_RANGE(int64_t, i, 0, n) {
+        const int64_t pos = offsets[(src[i] >> shift) & (kRadixBucketNum - 1)]++;
+        dst[pos] = src[i];
+        values_dst[pos] = values_src[i];
+      }
+      std::swap(values_src, values_dst);
+    }
+    std::swap(src, dst);
+  }
+  if (src != keys) {
+    std::copy(src, src + n, keys);
+    if (values_src != nullptr) { std::copy(values_src, values_src + n, values); }
+  }
+}
+
+template<typename T>
+void RadixArgSortRow(const T* in, int64_t n, bool is_ascending, int32_t* indices,
+                     RadixSortBuffer<typename RadixKey<T>::KeyType>* buf) {
+  using U = typename RadixKey<T>::KeyType;
+  const U flip = is_ascending ? static_cast<U>(0) : ~static_cast<U>(0);
+  // -0.0 and 0.0 compare equal, so they must not be ordered by their sign bit
+  FOR_RANGE(int64_t, i, 0, n) {
+    buf->keys[i] = RadixKey<T>::Encode(in[i] == 0 ? GetZeroVal<T>() : in[i]) ^ flip;
+  }
+  std::iota(indices, indices + n, 0);
+  RadixSort<U>(n, buf->keys.data(), buf->keys_tmp.data(), indices, buf->values_tmp.data());
+}
+
+size_t MinInstancesPerThread(int64_t instance_size) {
+  return std::max<int64_t>(kSortMinElemCntPerThread / instance_size, 1);
+}
+
+}  // namespace
+
+template<typename T>
+void CpuSortRows(const T* in, int64_t instance_num, int64_t instance_size, bool is_ascending,
+                 T* out) {
+  using U = typename RadixKey<T>::KeyType;
+  MultiThreadRangeLoop(
+      instance_num, MinInstancesPerThread(instance_size), [&](size_t begin, size_t end) {
+        if (instance_size < kCpuRadixSortMinInstanceSize) {
+          FOR_RANGE(size_t, i, begin, end) {
+            T* out_ptr_i = out + i * instance_size;
+            std::copy(in + i * instance_size, in + (i + 1) * instance_size, out_ptr_i);
+            if (is_ascending) {
+              std::sort(out_ptr_i, out_ptr_i + instance_size, std::less<T>());
+            } else {
+              std::sort(out_ptr_i, out_ptr_i + instance_size, std::greater<T>());
+            }
+          }
+          return;
+        }
+        const U flip = is_ascending ? static_cast<U>(0) : ~static_cast<U>(0);
+        std::vector<U> keys(instance_size);
+        std::vector<U> keys_tmp(instance_size);
+        FOR_RANGE(size_t, i, begin, end) {
+          const T* in_ptr_i = in + i * instance_size;
+          T* out_ptr_i = out + i * instance_size;
+          FOR_RANGE(int64_t, j, 0, instance_size) {
+            keys[j] = RadixKey<T>::Encode(in_ptr_i[j]) ^ flip;
+          }
+          RadixSort<U>(instance_size, keys.data(), keys_tmp.data(), nullptr, nullptr);
+          FOR_RANGE(int64_t, j, 0, instance_size) {
+            out_ptr_i[j] = RadixKey<T>::Decode(keys[j] ^ flip);
+          }
+        }
+      });
+}
+
+template<typename T>
+void CpuArgSortRows(const T* in, int64_t instance_num, int64_t instance_size, bool is_ascending,
+                    int32_t* indices) {
+  MultiThreadRangeLoop(
+      instance_num, MinInstancesPerThread(instance_size), [&](size_t begin, size_t end) {
+        if (instance_size < kCpuRadixSortMinInstanceSize) {
+          FOR_RANGE(size_t, i, begin, end) {
+            const T* in_ptr_i = in + i * instance_size;
+            int32_t* indices_ptr_i = indices + i * instance_size;
+            std::iota(indices_ptr_i, indices_ptr_i + instance_size, 0);
+            auto comp = [&](const int32_t lhs, const int32_t rhs) {
+              const T l = in_ptr_i[lhs];
+              const T r = in_ptr_i[rhs];
+              if (l == r) {
+                return lhs < rhs;
+              } else {
+                return is_ascending ? l < r : l > r;
+              }
+            };
+            std::sort(indices_ptr_i, indices_ptr_i + instance_size, comp);
+          }
+          return;
+        }
+        RadixSortBuffer<typename RadixKey<T>::KeyType> buf(instance_size);
+        FOR_RANGE(size_t, i, begin, end) {
+          RadixArgSortRow<T>(in + i * instance_size, instance_size, is_ascending,
+                             indices + i * instance_size, &buf);
+        }
+      });
+}
+
+template<typename T>
+void CpuRadixArgSort(const T* in, int64_t n, bool is_ascending, int32_t* indices) {
+  RadixSortBuffer<typename RadixKey<T>::KeyType> buf(n);
+  RadixArgSortRow<T>(in, n, is_ascending, indices, &buf);
+}
+
+#define INSTANTIATE_CPU_RADIX_SORT(dtype)                                                      \
+  template void CpuSortRows<dtype>(const dtype* in, int64_t instance_num,                      \
+                                   int64_t instance_size, bool is_ascending, dtype* out);      \
+  template void CpuArgSortRows<dtype>(const dtype* in, int64_t instance_num,                   \
+                                      int64_t instance_size, bool is_ascending,                \
+                                      int32_t* indices);                                       \
+  template void CpuRadixArgSort<dtype>(const dtype* in, int64_t n, bool is_ascending,          \
+                                       int32_t* indices);
+INSTANTIATE_CPU_RADIX_SORT(float)
+INSTANTIATE_CPU_RADIX_SORT(double)
+INSTANTIATE_CPU_RADIX_SORT(int32_t)
+INSTANTIATE_CPU_RADIX_SORT(int64_t)
+#undef INSTANTIATE_CPU_RADIX_SORT
+
+}  // namespace oneflow
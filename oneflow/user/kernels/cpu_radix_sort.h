@@ -0,0 +1,43 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+#define ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Rows at least this long are radix sorted, shorter ones use comparison sorts.
+constexpr int64_t kCpuRadixSortMinInstanceSize = 512;
+
+// Sorts each of the instance_num rows of in into out, rows are split over the thread pool.
+template<typename T>
+void CpuSortRows(const T* in, int64_t instance_num, int64_t instance_size, bool is_ascending,
+                 T* out);
+
+// Writes the sorting permutation of each row into indices. The sort is stable: equal keys keep
+// their index order in both directions.
+template<typename T>
+void CpuArgSortRows(const T* in, int64_t instance_num, int64_t instance_size, bool is_ascending,
+                    int32_t* indices);
+
+// Stable LSD radix arg sort of a single row of n keys, run on the calling thread.
+template<typename T>
+void CpuRadixArgSort(const T* in, int64_t n, bool is_ascending, int32_t* indices);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_CPU_RADIX_SORT_H_
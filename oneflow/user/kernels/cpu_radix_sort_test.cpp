@@ -0,0 +1,103 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/cpu_radix_sort.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <random>
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+void TestSortRows(int64_t instance_num, int64_t instance_size, int64_t value_range) {
+  std::mt19937 gen(instance_num * instance_size);
+  std::uniform_int_distribution<int64_t> dis(-value_range, value_range);
+  std::vector<T> in(instance_num * instance_size);
+  // small value ranges produce many equal keys, which exercises the stability of arg sort
+  for (T& x : in) { x = static_cast<T>(dis(gen)) / static_cast<T>(3); }
+  if (std::is_floating_point<T>::value && in.size() >= 2) {
+    in[0] = -GetZeroVal<T>();
+    in[1] = GetZeroVal<T>();
+  }
+  for (const bool is_ascending : {true, false}) {
+    std::vector<T> out(in.size());
+    std::vector<int32_t> indices(in.size());
+    CpuSortRows<T>(in.data(), instance_num, instance_size, is_ascending, out.data());
+    CpuArgSortRows<T>(in.data(), instance_num, instance_size, is_ascending, indices.data());
+    FOR_RANGE(int64_t, i, 0, instance_num) {
+      const T* in_ptr_i = in.data() + i * instance_size;
+      std::vector<T> expected_out(in_ptr_i, in_ptr_i + instance_size);
+      std::vector<int32_t> expected_indices(instance_size);
+      std::iota(expected_indices.begin(), expected_indices.end(), 0);
+      auto comp = [&](const T l, const T r) { return is_ascending ? l < r : l > r; };
+      std::sort(expected_out.begin(), expected_out.end(), comp);
+      std::stable_sort(
+          expected_indices.begin(), expected_indices.end(),
+          [&](const int32_t l, const int32_t r) { return comp(in_ptr_i[l], in_ptr_i[r]); });
+      FOR_RANGE(int64_t, j, 0, instance_size) {
+        ASSERT_EQ(out[i * instance_size + j], expected_out[j]);
+        ASSERT_EQ(indices[i * instance_size + j], expected_indices[j]);
+      }
+    }
+  }
+}
+
+void TestCommonSorts() {
+  TestSortRows<float>(3, 100, 50);
+  TestSortRows<float>(5, kCpuRadixSortMinInstanceSize, 50);
+  TestSortRows<float>(2, 100000, 1 << 30);
+  TestSortRows<double>(4, 777, 1000);
+  TestSortRows<int32_t>(4, 5000, 1 << 30);
+  TestSortRows<int64_t>(3, 2048, 100);
+  TestSortRows<int64_t>(3, 2048, int64_t(1) << 40);
+}
+
+}  // namespace
+
+TEST(CpuRadixSort, common_sorts) { TestCommonSorts(); }
+
+TEST(CpuRadixSort, common_sorts_multi_thread) {
+  Global<ThreadPool>::New(4);
+  TestCommonSorts();
+  Global<ThreadPool>::Delete();
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(CpuRadixSort, DISABLED_benchmark) {
+  Global<ThreadPool>::New(std::thread::hardware_concurrency());
+  const int64_t instance_num = 256;
+  const int64_t instance_size = 100000;
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dis(-1, 1);
+  std::vector<float> in(instance_num * instance_size);
+  for (float& x : in) { x = dis(gen); }
+  std::vector<float> out(in.size());
+  std::vector<int32_t> indices(in.size());
+  auto start = std::chrono::steady_clock::now();
+  CpuSortRows<float>(in.data(), instance_num, instance_size, false, out.data());
+  const double sort_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  CpuArgSortRows<float>(in.data(), instance_num, instance_size, false, indices.data());
+  const double arg_sort_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "sort of " << instance_num << " rows of " << instance_size << " floats: sort "
+            << sort_s << " s, arg_sort " << arg_sort_s << " s";
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace oneflow
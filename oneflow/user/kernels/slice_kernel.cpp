@@ -0,0 +1,165 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/user/kernels/slice_util.h"
+
+namespace oneflow {
+
+namespace {
+
+const int64_t kSliceMinElemCntPerThread = 32768;
+
+// Forward copies the strided view of the entire tensor into the sliced tensor, backward copies
+// it back. The innermost contiguous run of the view (trailing whole axes plus at most one
+// unit-stride axis) is copied with memcpy, outer axes are walked with precomputed steps and
+// split over threads.
+template<typename T, bool is_forward>
+void SliceCopy(const SliceParams& params, const T* src, T* dst) {
+  const int64_t ndims = params.ndims;
+  int64_t entire_strides[kSliceMaxDims];
+  entire_strides[ndims - 1] = 1;
+  for (int64_t i = ndims - 2; i >= 0; --i) {
+    entire_strides[i] = entire_strides[i + 1] * params.dims[i + 1];
+  }
+  int64_t base_offset = 0;
+  FOR_RANGE(int64_t, i, 0, ndims) { base_offset += params.begin[i] * entire_strides[i]; }
+  int64_t outer_ndims = ndims;
+  int64_t row_size = 1;
+  while (outer_ndims > 0) {
+    const int64_t axis = outer_ndims - 1;
+    if (params.stride[axis] != 1) { break; }
+    row_size *= params.sliced_dims[axis];
+    outer_ndims -= 1;
+    if (params.sliced_dims[axis] != params.dims[axis]) { break; }
+  }
+  int64_t row_step = 1;
+  if (outer_ndims == ndims) {
+    // the innermost axis is strided, rows are gathered element by element
+    row_size = params.sliced_dims[ndims - 1];
+    row_step = params.stride[ndims - 1];
+    outer_ndims -= 1;
+  }
+  int64_t outer_steps[kSliceMaxDims];
+  FOR_RANGE(int64_t, i, 0, outer_ndims) { outer_steps[i] = params.stride[i] * entire_strides[i]; }
+  int64_t elem_cnt = 1;
+  FOR_RANGE(int64_t, i, 0, ndims) { elem_cnt *= params.sliced_dims[i]; }
+  MultiThreadRangeLoop(
+      elem_cnt / row_size, std::max<int64_t>(kSliceMinElemCntPerThread / row_size, 1),
+      [&](size_t begin, size_t end) {
+        int64_t idx[kSliceMaxDims];
+        int64_t entire_offset = base_offset;
+        int64_t remaining = begin;
+        for (int64_t i = outer_ndims - 1; i >= 0; --i) {
+          idx[i] = remaining % params.sliced_dims[i];
+          remaining /= params.sliced_dims[i];
+          entire_offset += idx[i] * outer_steps[i];
+        }
+        FOR_RANGE(size_t, row, begin, end) {
+          const T* src_row = src + (is_forward ? entire_offset : row * row_size);
+          T* dst_row = dst + (is_forward ? row * row_size : entire_offset);
+          if (row_step == 1) {
+            memcpy(dst_row, src_row, row_size * sizeof(T));
+          } else if (is_forward) {
+            FOR_RANGE(int64_t, j, 0, row_size) { dst_row[j] = src_row[j * row_step]; }
+          } else {
+            FOR_RANGE(int64_t, j, 0, row_size) { dst_row[j * row_step] = src_row[j]; }
+          }
+          for (int64_t i = outer_ndims - 1; i >= 0; --i) {
+            entire_offset += outer_steps[i];
+            if (++idx[i] < params.sliced_dims[i]) { break; }
+            entire_offset -= params.sliced_dims[i] * outer_steps[i];
+            idx[i] = 0;
+          }
+        }
+      });
+}
+
+}  // namespace
+
+template<typename T>
+struct SliceFunctor<DeviceType::kCPU, T> final {
+  void operator()(DeviceCtx* ctx, const SliceParams& params, const T* entire, T* sliced) const {
+    SliceCopy<T, true>(params, entire, sliced);
+  }
+};
+
+template<typename T>
+struct SliceGradFunctor<DeviceType::kCPU, T> final {
+  void operator()(DeviceCtx* ctx, const SliceParams& params, const T* sliced, T* entire) const {
+    int64_t entire_elem_cnt = 1;
+    FOR_RANGE(int64_t, i, 0, params.ndims) { entire_elem_cnt *= params.dims[i]; }
+    MultiThreadRangeLoop(entire_elem_cnt, kSliceMinElemCntPerThread,
+                         [&](size_t begin, size_t end) {
+                           memset(entire + begin, 0, (end - begin) * sizeof(T));
+                         });
+    SliceCopy<T, false>(params, sliced, entire);
+  }
+};
+
+template<typename T>
+class SliceCpuKernel final : public user_op::OpKernel {
+ public:
+  SliceCpuKernel() = default;
+  ~SliceCpuKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* input = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* output = ctx->Tensor4ArgNameAndIndex("y", 0);
+    SliceFunctor<DeviceType::kCPU, T>()(ctx->device_ctx(),
+                                        ConstructSliceParams(ctx, input, output),
+                                        input->dptr<T>(), output->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class SliceGradCpuKernel final : public user_op::OpKernel {
+ public:
+  SliceGradCpuKernel() = default;
+  ~SliceGradCpuKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    SliceGradFunctor<DeviceType::kCPU, T>()(ctx->device_ctx(), ConstructSliceParams(ctx, dx, dy),
+                                            dy->dptr<T>(), dx->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_SLICE_CPU_KERNEL(dtype)                                               \
+  template struct SliceFunctor<DeviceType::kCPU, dtype>;                               \
+  template struct SliceGradFunctor<DeviceType::kCPU, dtype>;                           \
+  REGISTER_USER_KERNEL("slice_v2")                                                     \
+      .SetCreateFn<SliceCpuKernel<dtype>>()                                            \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                  \
+                       & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)); \
+  REGISTER_USER_KERNEL("slice_grad_v2")                                                \
+      .SetCreateFn<SliceGradCpuKernel<dtype>>()                                        \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                  \
+                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value));
+
+REGISTER_SLICE_CPU_KERNEL(float)
+REGISTER_SLICE_CPU_KERNEL(double)
+REGISTER_SLICE_CPU_KERNEL(int32_t)
+REGISTER_SLICE_CPU_KERNEL(int64_t)
+REGISTER_SLICE_CPU_KERNEL(int8_t)
+
+}  // namespace oneflow
@@ -0,0 +1,145 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/slice_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <numeric>
+
+namespace oneflow {
+
+namespace {
+
+struct SliceCase {
+  std::vector<int64_t> dims;
+  std::vector<int64_t> begin;
+  std::vector<int64_t> end;
+  std::vector<int64_t> stride;
+};
+
+std::vector<int64_t> SlicedDims(const SliceCase& c) {
+  std::vector<int64_t> sliced_dims(c.dims.size());
+  FOR_RANGE(size_t, i, 0, c.dims.size()) {
+    const int64_t stride = c.stride[i];
+    const int64_t span = stride > 0 ? c.end[i] - c.begin[i] : c.begin[i] - c.end[i];
+    sliced_dims[i] = (span + std::abs(stride) - 1) / std::abs(stride);
+  }
+  return sliced_dims;
+}
+
+SliceParams CaseToParams(const SliceCase& c, const std::vector<int64_t>& sliced_dims) {
+  const std::vector<int64_t> has(c.dims.size(), 1);
+  return ConstructSliceParams(ShapeView(c.dims.data(), c.dims.size()),
+                              ShapeView(sliced_dims.data(), sliced_dims.size()), c.begin, c.end,
+                              c.stride, has, has);
+}
+
+int64_t ElemCnt(const std::vector<int64_t>& dims) {
+  return std::accumulate(dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
+}
+
+template<typename T>
+void TestSlice(const SliceCase& c) {
+  const std::vector<int64_t> sliced_dims = SlicedDims(c);
+  const int64_t ndims = c.dims.size();
+  const int64_t entire_elem_cnt = ElemCnt(c.dims);
+  const int64_t sliced_elem_cnt = ElemCnt(sliced_dims);
+  std::vector<T> entire(entire_elem_cnt);
+  FOR_RANGE(int64_t, i, 0, entire_elem_cnt) { entire[i] = static_cast<T>(i % 127); }
+  std::vector<int64_t> expected_offsets(sliced_elem_cnt);
+  FOR_RANGE(int64_t, i, 0, sliced_elem_cnt) {
+    int64_t remaining = i;
+    int64_t offset = 0;
+    int64_t entire_stride = 1;
+    for (int64_t axis = ndims - 1; axis >= 0; --axis) {
+      const int64_t idx = remaining % sliced_dims[axis];
+      remaining /= sliced_dims[axis];
+      offset += (c.begin[axis] + idx * c.stride[axis]) * entire_stride;
+      entire_stride *= c.dims[axis];
+    }
+    expected_offsets[i] = offset;
+  }
+  const SliceParams params = CaseToParams(c, sliced_dims);
+
+  std::vector<T> sliced(sliced_elem_cnt);
+  SliceFunctor<DeviceType::kCPU, T>()(nullptr, params, entire.data(), sliced.data());
+  FOR_RANGE(int64_t, i, 0, sliced_elem_cnt) { ASSERT_EQ(sliced[i], entire[expected_offsets[i]]); }
+
+  std::vector<T> entire_diff(entire_elem_cnt, static_cast<T>(-1));
+  std::vector<T> expected_diff(entire_elem_cnt, static_cast<T>(0));
+  FOR_RANGE(int64_t, i, 0, sliced_elem_cnt) { expected_diff[expected_offsets[i]] = sliced[i]; }
+  SliceGradFunctor<DeviceType::kCPU, T>()(nullptr, params, sliced.data(), entire_diff.data());
+  ASSERT_TRUE(entire_diff == expected_diff);
+}
+
+void TestCommonSlices() {
+  TestSlice<float>({{8, 128, 768}, {0, 0, 0}, {8, 1, 768}, {1, 1, 1}});
+  TestSlice<float>({{8, 128, 768}, {0, 1, 0}, {8, 127, 768}, {1, 1, 1}});
+  TestSlice<float>({{16, 512, 64}, {0, 0, 0}, {16, 384, 64}, {1, 1, 1}});
+  TestSlice<float>({{4, 37, 9}, {1, 36, 0}, {4, 2, 9}, {1, -3, 2}});
+  TestSlice<double>({{2, 16, 8}, {0, 1, 1}, {2, 16, 8}, {1, 3, 2}});
+  TestSlice<int32_t>({{3, 5, 7, 9}, {2, 0, 6, 1}, {0, 5, 0, 8}, {-1, 2, -1, 1}});
+  TestSlice<int64_t>({{65536}, {7}, {65000}, {1}});
+  TestSlice<int8_t>({{5, 1, 7}, {0, 0, 3}, {5, 1, 4}, {1, 1, 1}});
+}
+
+}  // namespace
+
+TEST(SliceCpu, common_slices) { TestCommonSlices(); }
+
+TEST(SliceCpu, common_slices_multi_thread) {
+  Global<ThreadPool>::New(4);
+  TestCommonSlices();
+  Global<ThreadPool>::Delete();
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(SliceCpu, DISABLED_benchmark) {
+  Global<ThreadPool>::New(std::thread::hardware_concurrency());
+  const std::vector<SliceCase> cases = {
+      {{32, 128, 768}, {0, 0, 0}, {32, 1, 768}, {1, 1, 1}},        // [CLS] token
+      {{32, 128, 768}, {0, 1, 0}, {32, 127, 768}, {1, 1, 1}},      // drop [CLS]
+      {{32, 512, 768}, {0, 0, 0}, {32, 384, 768}, {1, 1, 1}},      // truncate sequence
+      {{32, 12, 512, 64}, {0, 0, 0, 0}, {32, 12, 256, 64}, {1, 1, 1, 1}},  // attention window
+      {{32, 512, 768}, {0, 0, 0}, {32, 512, 768}, {1, 2, 1}},      // stride over tokens
+  };
+  const int32_t iter_num = 10;
+  for (const SliceCase& c : cases) {
+    const std::vector<int64_t> sliced_dims = SlicedDims(c);
+    const SliceParams params = CaseToParams(c, sliced_dims);
+    const int64_t sliced_elem_cnt = ElemCnt(sliced_dims);
+    std::vector<float> entire(ElemCnt(c.dims), 1);
+    std::vector<float> sliced(sliced_elem_cnt, 0);
+    auto start = std::chrono::steady_clock::now();
+    FOR_RANGE(int32_t, i, 0, iter_num) {
+      SliceFunctor<DeviceType::kCPU, float>()(nullptr, params, entire.data(), sliced.data());
+    }
+    const double fw_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    FOR_RANGE(int32_t, i, 0, iter_num) {
+      SliceGradFunctor<DeviceType::kCPU, float>()(nullptr, params, sliced.data(), entire.data());
+    }
+    const double bw_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double byte_size = 2.0 * sliced_elem_cnt * sizeof(float) * iter_num;
+    LOG(INFO) << "slice of " << Shape(DimVector(c.dims.begin(), c.dims.end())).DebugStr()
+              << " to " << Shape(DimVector(sliced_dims.begin(), sliced_dims.end())).DebugStr()
+              << ": forward " << byte_size / fw_s / 1e9 << " GB/s, backward "
+              << byte_size / bw_s / 1e9 << " GB/s";
+  }
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace oneflow
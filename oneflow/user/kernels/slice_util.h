@@ -0,0 +1,111 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_SLICE_UTIL_H_
+#define ONEFLOW_USER_KERNELS_SLICE_UTIL_H_
+
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/ops/slice_util.h"
+
+namespace oneflow {
+
+constexpr size_t kSliceMaxDims = 8;
+
+struct SliceParams {
+  int64_t ndims;
+  int64_t dims[kSliceMaxDims];
+  int64_t sliced_dims[kSliceMaxDims];
+  int64_t begin[kSliceMaxDims];
+  int64_t end[kSliceMaxDims];
+  int64_t stride[kSliceMaxDims];
+};
+
+inline SliceParams ConstructSliceParams(const ShapeView& entire_shape,
+                                        const ShapeView& sliced_shape,
+                                        const std::vector<int64_t>& begin_vec,
+                                        const std::vector<int64_t>& end_vec,
+                                        const std::vector<int64_t>& stride_vec,
+                                        const std::vector<int64_t>& has_begin_vec,
+                                        const std::vector<int64_t>& has_end_vec) {
+  CHECK_LE(entire_shape.NumAxes(), kSliceMaxDims);
+  CHECK_EQ(entire_shape.NumAxes(), sliced_shape.NumAxes());
+  CHECK_EQ(entire_shape.NumAxes(), begin_vec.size());
+  CHECK_EQ(entire_shape.NumAxes(), end_vec.size());
+  CHECK_EQ(entire_shape.NumAxes(), stride_vec.size());
+  CHECK_EQ(begin_vec.size(), has_begin_vec.size());
+  CHECK_EQ(end_vec.size(), has_end_vec.size());
+
+  SliceParams params;
+  std::memset(&params, 0, sizeof(SliceParams));
+  // collapse contiguous dims who slice defautly (slice whole dim),
+  // that it can reduce params.ndims thus reduce loop numbers in cuda kernel
+  bool do_slice_on_prev_axis = false;
+  for (int64_t i = 0; i < entire_shape.NumAxes(); ++i) {
+    int64_t begin = has_begin_vec[i] ? RegulateSliceIndex(begin_vec.at(i), entire_shape.At(i)) : 0;
+    int64_t end =
+        has_end_vec[i] ? RegulateSliceIndex(end_vec.at(i), entire_shape.At(i)) : entire_shape.At(i);
+    int64_t stride = stride_vec.at(i);
+    CHECK_NE(stride, 0);
+    if (stride > 0) {
+      CHECK_LT(begin, end);
+    } else {
+      CHECK_GT(begin, end);
+    }
+    // default slice (slice whole dim) dim can be collapsed to prev dim
+    bool do_slice_on_cur_axis = (begin != 0) || (end != entire_shape.At(i)) || (stride != 1);
+    if (i != 0 && !do_slice_on_prev_axis && !do_slice_on_cur_axis) {
+      int64_t cur_idx = params.ndims - 1;
+      params.dims[cur_idx] *= entire_shape.At(i);
+      params.sliced_dims[cur_idx] *= sliced_shape.At(i);
+      params.end[cur_idx] = params.dims[cur_idx];
+    } else {
+      params.dims[params.ndims] = entire_shape.At(i);
+      params.sliced_dims[params.ndims] = sliced_shape.At(i);
+      params.begin[params.ndims] = begin;
+      params.end[params.ndims] = end;
+      params.stride[params.ndims] = stride;
+      params.ndims += 1;
+    }
+    do_slice_on_prev_axis = do_slice_on_cur_axis;
+  }
+  return params;
+}
+
+inline SliceParams ConstructSliceParams(user_op::KernelComputeContext* ctx,
+                                        const user_op::Tensor* entire,
+                                        const user_op::Tensor* sliced) {
+  return ConstructSliceParams(entire->shape(), sliced->shape(),
+                              ctx->Attr<std::vector<int64_t>>("begin"),
+                              ctx->Attr<std::vector<int64_t>>("end"),
+                              ctx->Attr<std::vector<int64_t>>("stride"),
+                              ctx->Attr<std::vector<int64_t>>("has_begin"),
+                              ctx->Attr<std::vector<int64_t>>("has_end"));
+}
+
+// sliced = entire[begin:end:stride]
+template<DeviceType device_type, typename T>
+struct SliceFunctor final {
+  void operator()(DeviceCtx* ctx, const SliceParams& params, const T* entire, T* sliced) const;
+};
+
+// entire = 0, entire[begin:end:stride] = sliced
+template<DeviceType device_type, typename T>
+struct SliceGradFunctor final {
+  void operator()(DeviceCtx* ctx, const SliceParams& params, const T* sliced, T* entire) const;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_SLICE_UTIL_H_
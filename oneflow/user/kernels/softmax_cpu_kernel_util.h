@@ -0,0 +1,167 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_SOFTMAX_CPU_KERNEL_UTIL_H_
+#define ONEFLOW_USER_KERNELS_SOFTMAX_CPU_KERNEL_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+// Row-wise building blocks of the cpu softmax kernels. One thread takes a row from the max pass to
+// the final scale so the row stays in cache, and rows are split across the thread pool. The
+// reductions keep kLaneNum partial results, which lets the compiler vectorize them without
+// reassociating floating point math on its own
+template<typename T>
+struct SoftmaxCpuKernelUtil {
+  static const int64_t kLaneNum = 8;
+  static const int64_t kMinElemCntPerThread = 32768;
+
+  static void ForEachRowRange(const int64_t num_rows, const int64_t row_size,
+                              const std::function<void(int64_t begin, int64_t end)>& Handler) {
+    MultiThreadRangeLoop(num_rows, std::max<int64_t>(kMinElemCntPerThread / row_size, 1),
+                         [&Handler](size_t begin, size_t end) { Handler(begin, end); });
+  }
+
+  static T Max(const int64_t n, const T* x) {
+    T lane_max[kLaneNum];
+    std::fill(lane_max, lane_max + kLaneNum, x[0]);
+    int64_t i = 0;
+    for (; i + kLaneNum <= n; i += kLaneNum) {
+      FOR_RANGE(int64_t, lane, 0, kLaneNum) {
+        lane_max[lane] = std::max(lane_max[lane], x[i + lane]);
+      }
+    }
+    T max = *std::max_element(lane_max, lane_max + kLaneNum);
+    for (; i < n; ++i) { max = std::max(max, x[i]); }
+    return max;
+  }
+
+  static T Sum(const int64_t n, const T* x) {
+    T lane_sum[kLaneNum] = {0};
+    int64_t i = 0;
+    for (; i + kLaneNum <= n; i += kLaneNum) {
+      FOR_RANGE(int64_t, lane, 0, kLaneNum) { lane_sum[lane] += x[i + lane]; }
+    }
+    T sum = 0;
+    FOR_RANGE(int64_t, lane, 0, kLaneNum) { sum += lane_sum[lane]; }
+    for (; i < n; ++i) { sum += x[i]; }
+    return sum;
+  }
+
+  static T Dot(const int64_t n, const T* x, const T* y) {
+    T lane_sum[kLaneNum] = {0};
+    int64_t i = 0;
+    for (; i + kLaneNum <= n; i += kLaneNum) {
+      FOR_RANGE(int64_t, lane, 0, kLaneNum) { lane_sum[lane] += x[i + lane] * y[i + lane]; }
+    }
+    T sum = 0;
+    FOR_RANGE(int64_t, lane, 0, kLaneNum) { sum += lane_sum[lane]; }
+    for (; i < n; ++i) { sum += x[i] * y[i]; }
+    return sum;
+  }
+
+  // y[i] = exp(x[i] - max), where max is not less than any x[i]
+  static void ExpSub(const int64_t n, const T* x, const T max, T* y) {
+    FOR_RANGE(int64_t, i, 0, n) { y[i] = ExpOfNonPositive(x[i] - max); }
+  }
+
+  static void Scale(const int64_t n, const T alpha, T* y) {
+    FOR_RANGE(int64_t, i, 0, n) { y[i] *= alpha; }
+  }
+
+  static T ExpOfNonPositive(const T x) { return std::exp(x); }
+
+  // prob = softmax(in) of each of the n rows of size w
+  static void ComputeProb(const int64_t n, const int64_t w, const T* in, T* prob) {
+    ForEachRowRange(n, w, [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* in_row = in + i * w;
+        T* prob_row = prob + i * w;
+        ExpSub(w, in_row, Max(w, in_row), prob_row);
+        Scale(w, 1 / Sum(w, prob_row), prob_row);
+      }
+    });
+  }
+
+  // Computes prob and y of a row in one go, y is log(sum) - (x[label] - max) instead of the log of
+  // prob, which is both cheaper and exact for tiny probabilities. y is capped by max_entropy
+  template<typename K>
+  static void ComputeSparseSoftmaxCrossEntropy(const int64_t num_instances,
+                                               const int64_t num_classes, const int64_t depth,
+                                               const T max_entropy, const T* x, const K* labels,
+                                               T* prob, T* y) {
+    ForEachRowRange(num_instances, num_classes, [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        CHECK_GE(labels[i], 0);
+        CHECK_LT(labels[i], depth);
+        const T* x_row = x + i * num_classes;
+        T* prob_row = prob + i * num_classes;
+        const T max = Max(num_classes, x_row);
+        ExpSub(num_classes, x_row, max, prob_row);
+        const T sum = Sum(num_classes, prob_row);
+        Scale(num_classes, 1 / sum, prob_row);
+        const K label_i = labels[i];
+        if (label_i < num_classes) {
+          y[i] = std::min(std::log(sum) - (x_row[label_i] - max), max_entropy);
+        }
+      }
+    });
+  }
+};
+
+// Cephes expf polynomial with the clamp and the floor done in integers, so the loop in ExpSub has
+// no branches or calls and is vectorized. It is within 2 ulp of expf on [-87, 0] and returns
+// exp(-87) for smaller x, which is lost in the softmax sum anyway. NaN is passed through, so a NaN
+// logit still poisons its row
+template<>
+inline float SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(const float x) {
+  const int32_t kAbsBitsOf87 = 0x42ae0000;
+  int32_t x_bits;
+  std::memcpy(&x_bits, &x, sizeof(float));
+  const int32_t abs_bits = x_bits & 0x7fffffff;
+  const int32_t in_range_mask = (abs_bits - kAbsBitsOf87) >> 31;
+  const int32_t clamped_bits = (abs_bits & in_range_mask) | (kAbsBitsOf87 & ~in_range_mask)
+                               | static_cast<int32_t>(0x80000000);
+  float clamped_x;
+  std::memcpy(&clamped_x, &clamped_bits, sizeof(float));
+  // clamped_x * log2(e) + 128.5 is positive, so the truncation is a floor
+  const int32_t n = static_cast<int32_t>(clamped_x * 1.44269504088896341f + 128.5f) - 128;
+  const float fn = static_cast<float>(n);
+  const float r = clamped_x - fn * 0.693359375f + fn * 2.12194440e-4f;
+  float p = 1.9875691500e-4f;
+  p = p * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+  const int32_t scale_bits = (n + 127) << 23;
+  float scale;
+  std::memcpy(&scale, &scale_bits, sizeof(float));
+  const float y = p * scale;
+  int32_t y_bits;
+  std::memcpy(&y_bits, &y, sizeof(float));
+  const int32_t nan_mask = (0x7f800000 - abs_bits) >> 31;
+  const int32_t out_bits = (y_bits & ~nan_mask) | (x_bits & nan_mask);
+  float out;
+  std::memcpy(&out, &out_bits, sizeof(float));
+  return out;
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_SOFTMAX_CPU_KERNEL_UTIL_H_
@@ -0,0 +1,139 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/softmax_cpu_kernel_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <random>
+
+namespace oneflow {
+
+namespace {
+
+// -log(1e-20), the cap of the kernel's SafeLog
+const double kMaxEntropy = 46.0517018598809;
+
+void GenLogits(int64_t n, int64_t w, std::vector<double>* x, std::vector<int32_t>* labels) {
+  std::mt19937 gen(n * w);
+  std::uniform_real_distribution<double> dis(-1, 1);
+  std::uniform_int_distribution<int32_t> label_dis(0, w - 1);
+  x->resize(n * w);
+  labels->resize(n);
+  FOR_RANGE(int64_t, i, 0, n) {
+    // plain, large, tiny and a few hugely negative logits
+    const double scale = i % 3 == 0 ? 10 : (i % 3 == 1 ? 1e4 : 1e-30);
+    FOR_RANGE(int64_t, j, 0, w) { x->at(i * w + j) = dis(gen) * scale; }
+    x->at(i * w + label_dis(gen)) = -1e30;
+    labels->at(i) = label_dis(gen);
+  }
+  // a row with one of its labels on a hugely negative logit, which caps the loss
+  x->at(labels->at(0)) = -1e30;
+  // NaN in the middle and at the start of a row
+  if (n > 2) {
+    x->at(w + w / 2) = std::nan("");
+    x->at(2 * w) = std::nan("");
+  }
+}
+
+void Reference(int64_t n, int64_t w, const std::vector<double>& x,
+               const std::vector<int32_t>& labels, std::vector<double>* prob,
+               std::vector<double>* y) {
+  prob->resize(n * w);
+  y->resize(n);
+  FOR_RANGE(int64_t, i, 0, n) {
+    const double* x_row = x.data() + i * w;
+    double max = x_row[0];
+    bool has_nan = false;
+    FOR_RANGE(int64_t, j, 0, w) {
+      max = std::max(max, x_row[j]);
+      has_nan = has_nan || std::isnan(x_row[j]);
+    }
+    double sum = 0;
+    FOR_RANGE(int64_t, j, 0, w) { sum += std::exp(x_row[j] - max); }
+    FOR_RANGE(int64_t, j, 0, w) {
+      prob->at(i * w + j) = has_nan ? std::nan("") : std::exp(x_row[j] - max) / sum;
+    }
+    y->at(i) = has_nan ? std::nan("")
+                       : std::min(std::log(sum) - (x_row[labels.at(i)] - max), kMaxEntropy);
+  }
+}
+
+template<typename T>
+void CheckNear(double expected, T actual, double rel_tol) {
+  if (std::isnan(expected)) {
+    ASSERT_TRUE(std::isnan(actual));
+  } else {
+    // exps below exp(-87) are flushed to exp(-87) by the float exp
+    ASSERT_NEAR(actual, expected, rel_tol * std::abs(expected) + 1e-30);
+  }
+}
+
+template<typename T>
+void TestSoftmax(int64_t n, int64_t w, double rel_tol) {
+  std::vector<double> x_double;
+  std::vector<int32_t> labels;
+  GenLogits(n, w, &x_double, &labels);
+  const std::vector<T> x(x_double.begin(), x_double.end());
+  // the reference starts from the rounded logits
+  x_double.assign(x.begin(), x.end());
+  std::vector<double> expected_prob;
+  std::vector<double> expected_y;
+  Reference(n, w, x_double, labels, &expected_prob, &expected_y);
+  std::vector<T> prob(n * w);
+  SoftmaxCpuKernelUtil<T>::ComputeProb(n, w, x.data(), prob.data());
+  FOR_RANGE(int64_t, i, 0, n * w) { CheckNear(expected_prob.at(i), prob.at(i), rel_tol); }
+  std::vector<T> ce_prob(n * w);
+  std::vector<T> y(n);
+  SoftmaxCpuKernelUtil<T>::ComputeSparseSoftmaxCrossEntropy(
+      n, w, w, static_cast<T>(kMaxEntropy), x.data(), labels.data(), ce_prob.data(), y.data());
+  FOR_RANGE(int64_t, i, 0, n * w) { CheckNear(expected_prob.at(i), ce_prob.at(i), rel_tol); }
+  FOR_RANGE(int64_t, i, 0, n) { CheckNear(expected_y.at(i), y.at(i), rel_tol); }
+  ASSERT_EQ(y.at(0), static_cast<T>(kMaxEntropy));
+}
+
+void TestSoftmaxRows() {
+  // one range of rows, then rows split across the pool, then a row per range
+  for (const auto& shape : std::vector<std::pair<int64_t, int64_t>>{
+           {3, 1001}, {7, 8}, {200, 1001}, {300, 131}, {6, 40000}}) {
+    TestSoftmax<float>(shape.first, shape.second, 1e-4);
+    TestSoftmax<double>(shape.first, shape.second, 1e-12);
+  }
+}
+
+}  // namespace
+
+TEST(SoftmaxCpuKernelUtil, exp_of_non_positive) {
+  for (float x = -100; x <= 0; x += 0.01f) {
+    const float expected = std::exp(x);
+    const float actual = SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(x);
+    if (x >= -87) {
+      ASSERT_NEAR(actual, expected, 2.5e-7 * expected);
+    } else {
+      ASSERT_EQ(actual, SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(-87));
+    }
+  }
+  ASSERT_EQ(SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(0), 1);
+  ASSERT_TRUE(std::isnan(SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(std::nanf(""))));
+  ASSERT_TRUE(std::isnan(SoftmaxCpuKernelUtil<float>::ExpOfNonPositive(-std::nanf(""))));
+}
+
+TEST(SoftmaxCpuKernelUtil, rows) { TestSoftmaxRows(); }
+
+TEST(SoftmaxCpuKernelUtil, rows_multi_thread) {
+  Global<ThreadPool>::New(4);
+  TestSoftmaxRows();
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace oneflow
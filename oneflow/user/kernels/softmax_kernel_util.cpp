@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/user/kernels/softmax_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.cuh"
 #include "oneflow/core/ndarray/ndarray_util.h"
+#include "oneflow/user/kernels/softmax_cpu_kernel_util.h"
 
 namespace oneflow {
 
@@ -64,6 +65,28 @@ void SoftmaxKernelUtil<device_type, T>::ComputeDiff(DeviceCtx* ctx, const int64_
   NdarrayUtil<device_type, T>::InplaceMul(ctx, Var({n * w}, dx), Val({n * w}, out));
 }
 
+template<typename T>
+struct SoftmaxKernelUtil<DeviceType::kCPU, T> {
+  static void ComputeProb(DeviceCtx* ctx, const int64_t n, const int64_t w, const T* in, T* tmp,
+                          T* prob, void* temp_storage, const size_t temp_storage_bytes) {
+    SoftmaxCpuKernelUtil<T>::ComputeProb(n, w, in, prob);
+  }
+
+  static void ComputeDiff(DeviceCtx* ctx, const int64_t n, const int64_t w, const T* dy,
+                          const T* out, T* sum_vec, T* dx, void* temp_storage,
+                          const size_t temp_storage_bytes) {
+    SoftmaxCpuKernelUtil<T>::ForEachRowRange(n, w, [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* dy_row = dy + i * w;
+        const T* out_row = out + i * w;
+        T* dx_row = dx + i * w;
+        const T sum = SoftmaxCpuKernelUtil<T>::Dot(w, dy_row, out_row);
+        FOR_RANGE(int64_t, j, 0, w) { dx_row[j] = (dy_row[j] - sum) * out_row[j]; }
+      }
+    });
+  }
+};
+
 #define INSTANTIATE_SOFTMAX_KERNEL_UTIL(device_type, data_type) \
   template struct SoftmaxKernelUtil<device_type, data_type>;
 INSTANTIATE_SOFTMAX_KERNEL_UTIL(DeviceType::kGPU, float16)
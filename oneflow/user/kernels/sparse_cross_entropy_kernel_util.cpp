@@ -15,10 +15,17 @@ limitations under the License.
 */
 #include "oneflow/user/kernels/sparse_cross_entropy_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.cuh"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 namespace user_op {
 
+namespace {
+
+const int64_t kMinElemCntPerThread = 32768;
+
+}  // namespace
+
 template<typename T, typename K>
 struct SparseCrossEntropyKernelUtil<DeviceType::kCPU, T, K> {
   static void ComputeEntropy(DeviceCtx* ctx, const int64_t num_instances, const int64_t num_classes,
@@ -49,19 +56,20 @@ struct SparseCrossEntropyKernelUtil<DeviceType::kCPU, T, K> {
                                      const int64_t num_classes, const int64_t depth,
                                      const int64_t lower_bound, const T* prob, const K* labels,
                                      const T* dy, T* dx) {
-    FOR_RANGE(int64_t, i, 0, elem_cnt) {
-      const int32_t row_id = i / num_classes;
-      const int32_t col_id = i - row_id * num_classes;
-      CHECK_GE(labels[row_id], 0);
-      CHECK_LT(labels[row_id], depth);
-      K label = labels[row_id] - lower_bound;
-
-      if (label == col_id) {
-        dx[i] = dy[row_id] * (prob[i] - 1);
-      } else {
-        dx[i] = dy[row_id] * prob[i];
-      }
-    }
+    const int64_t num_instances = elem_cnt / num_classes;
+    MultiThreadRangeLoop(
+        num_instances, std::max<int64_t>(kMinElemCntPerThread / num_classes, 1),
+        [&](size_t begin, size_t end) {
+          FOR_RANGE(int64_t, i, begin, end) {
+            CHECK_GE(labels[i], 0);
+            CHECK_LT(labels[i], depth);
+            const T* prob_row = prob + i * num_classes;
+            T* dx_row = dx + i * num_classes;
+            FOR_RANGE(int64_t, j, 0, num_classes) { dx_row[j] = dy[i] * prob_row[j]; }
+            const K label = labels[i] - lower_bound;
+            if (label >= 0 && label < num_classes) { dx_row[label] -= dy[i]; }
+          }
+        });
   }
 };
 
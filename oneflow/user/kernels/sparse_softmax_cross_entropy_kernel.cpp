@@ -15,8 +15,10 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/kernel/kernel_util.cuh"
 #include "oneflow/user/kernels/sparse_cross_entropy_kernel_util.h"
 #include "oneflow/user/kernels/softmax_kernel_util.h"
+#include "oneflow/user/kernels/softmax_cpu_kernel_util.h"
 
 namespace oneflow {
 namespace user_op {
@@ -49,6 +51,31 @@ class SparseSoftmaxCrossEntropyKernel final : public user_op::OpKernel {
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
+// Computes prob and out of a row in one go, see SoftmaxCpuKernelUtil
+template<typename T, typename K>
+class SparseSoftmaxCrossEntropyKernel<DeviceType::kCPU, T, K> final : public user_op::OpKernel {
+ public:
+  SparseSoftmaxCrossEntropyKernel() = default;
+  ~SparseSoftmaxCrossEntropyKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* prediction = ctx->Tensor4ArgNameAndIndex("prediction", 0);
+    const user_op::Tensor* label = ctx->Tensor4ArgNameAndIndex("label", 0);
+    user_op::Tensor* prob = ctx->Tensor4ArgNameAndIndex("prob", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t num_instances = label->shape().elem_cnt();
+    CHECK_EQ(prediction->shape().elem_cnt() % num_instances, 0);
+    const int64_t num_classes = prediction->shape().elem_cnt() / num_instances;
+    const int64_t depth = ctx->Attr<int64_t>("depth");
+    const T max_entropy = -SafeLog(static_cast<T>(0));
+    SoftmaxCpuKernelUtil<T>::ComputeSparseSoftmaxCrossEntropy(
+        num_instances, num_classes, depth, max_entropy, prediction->dptr<T>(), label->dptr<K>(),
+        prob->mut_dptr<T>(), out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
 template<DeviceType device_type, typename T, typename K>
 class SparseSoftmaxCrossEntropyMsKernel final : public user_op::OpKernel {
  public:
@@ -70,7 +97,8 @@ class SparseSoftmaxCrossEntropyMsKernel final : public user_op::OpKernel {
       .SetIsMatchedHob((user_op::HobDeviceType() == device_type_v)                             \
                        & (user_op::HobDataType("label", 0) == OF_PP_PAIR_SECOND(ltype_pair))   \
                        & (user_op::HobDataType("out", 0) == OF_PP_PAIR_SECOND(dtype_pair)))    \
-      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                      \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) -> size_t {                            \
+        if (device_type_v == DeviceType::kCPU) { return 0; }                                   \
         const Shape* prediction_shape = ctx->Shape4ArgNameAndIndex("prediction", 0);           \
         return prediction_shape->elem_cnt() * sizeof(OF_PP_PAIR_FIRST(dtype_pair));            \
       });
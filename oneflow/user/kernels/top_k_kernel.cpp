@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/user/kernels/cpu_radix_sort.h"
 
 namespace oneflow {
 
@@ -29,6 +30,12 @@ void ComputeTopOne(const T* in_ptr, const Range& range, int32_t instance_size, i
   }
 }
 
+// For large k, sorting the selected k elements costs more than radix sorting the whole row,
+// whose stable descending order breaks ties by index just like the comparator below.
+bool UseRadixSortForTopK(int32_t instance_size, int32_t k, bool sorted) {
+  return sorted && instance_size >= kCpuRadixSortMinInstanceSize && k >= instance_size / 16;
+}
+
 template<typename T>
 void ComputeTopK(const T* in_ptr, int32_t* indices_ptr, const Range& range, int32_t instance_size,
                  int32_t k, bool sorted, int32_t* out_ptr) {
@@ -36,6 +43,11 @@ void ComputeTopK(const T* in_ptr, int32_t* indices_ptr, const Range& range, int3
     const int32_t offset = i * instance_size;
     const T* in_ptr_i = in_ptr + offset;
     int32_t* indices_ptr_i = indices_ptr + offset;
+    if (UseRadixSortForTopK(instance_size, k, sorted)) {
+      CpuRadixArgSort(in_ptr_i, instance_size, false, indices_ptr_i);
+      std::copy(indices_ptr_i, indices_ptr_i + k, out_ptr + i * k);
+      continue;
+    }
     std::iota(indices_ptr_i, indices_ptr_i + instance_size, 0);
     auto comp = [&](const int32_t lhs, const int32_t rhs) {
       const T l = in_ptr_i[lhs];
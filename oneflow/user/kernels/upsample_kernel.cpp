@@ -0,0 +1,403 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace {
+
+const int64_t kUpsampleMinElemCntPerThread = 32768;
+
+// Both layouts are viewed as [plane, height, width, channels]: channels_first has N * C planes
+// of one channel, channels_last has N planes of C interleaved channels.
+struct UpsampleDims {
+  bool channels_last;
+  int64_t num_planes;
+  int64_t channels;
+  int64_t in_height;
+  int64_t in_width;
+  int64_t out_height;
+  int64_t out_width;
+};
+
+UpsampleDims GetUpsampleDims(const ShapeView& in_shape, const ShapeView& out_shape,
+                             const std::string& data_format) {
+  CHECK_EQ(in_shape.NumAxes(), 4);
+  CHECK_EQ(out_shape.NumAxes(), 4);
+  UpsampleDims dims;
+  if (data_format == "channels_first") {
+    dims.channels_last = false;
+    dims.num_planes = in_shape.At(0) * in_shape.At(1);
+    dims.channels = 1;
+    dims.in_height = in_shape.At(2);
+    dims.in_width = in_shape.At(3);
+    dims.out_height = out_shape.At(2);
+    dims.out_width = out_shape.At(3);
+  } else {
+    CHECK_EQ(data_format, "channels_last");
+    dims.channels_last = true;
+    dims.num_planes = in_shape.At(0);
+    dims.channels = in_shape.At(3);
+    dims.in_height = in_shape.At(1);
+    dims.in_width = in_shape.At(2);
+    dims.out_height = out_shape.At(1);
+    dims.out_width = out_shape.At(2);
+  }
+  return dims;
+}
+
+int64_t GetNearestInputIndex(const int64_t out_dim_idx, const float scale,
+                             const int64_t in_dim_size) {
+  return std::max(
+      std::min(static_cast<int64_t>(std::floor((static_cast<float>(out_dim_idx) + 0.5f) * scale)),
+               in_dim_size - 1),
+      static_cast<int64_t>(0));
+}
+
+// Interpolation coefficients of one axis, computed once per output row/column.
+struct BilinearCoeffs {
+  std::vector<int64_t> low;
+  std::vector<int64_t> high;
+  std::vector<float> lerp;
+};
+
+void ComputeBilinearCoeffs(const int64_t out_size, const int64_t in_size, const float scale,
+                           BilinearCoeffs* coeffs) {
+  coeffs->low.resize(out_size);
+  coeffs->high.resize(out_size);
+  coeffs->lerp.resize(out_size);
+  FOR_RANGE(int64_t, i, 0, out_size) {
+    const float in_idx = (static_cast<float>(i) + 0.5f) * scale - 0.5f;
+    coeffs->low[i] = in_idx > 0.0 ? std::floor(in_idx) : 0;
+    coeffs->high[i] = (in_idx < in_size - 1) ? std::ceil(in_idx) : in_size - 1;
+    coeffs->lerp[i] = in_idx - std::floor(in_idx);
+  }
+}
+
+size_t MinRowsPerThread(const int64_t elem_cnt_per_row) {
+  return std::max<int64_t>(kUpsampleMinElemCntPerThread / std::max<int64_t>(elem_cnt_per_row, 1),
+                           1);
+}
+
+template<typename T, bool channels_last>
+void UpsampleNearestForward(const UpsampleDims& dims, const float scale_h, const float scale_w,
+                            const T* x, T* y) {
+  const int64_t channels = channels_last ? dims.channels : 1;
+  const int64_t in_row_size = dims.in_width * channels;
+  const int64_t out_row_size = dims.out_width * channels;
+  std::vector<int64_t> in_h_idx(dims.out_height);
+  FOR_RANGE(int64_t, h, 0, dims.out_height) {
+    in_h_idx[h] = GetNearestInputIndex(h, scale_h, dims.in_height);
+  }
+  std::vector<int64_t> in_w_offset(dims.out_width);
+  FOR_RANGE(int64_t, w, 0, dims.out_width) {
+    in_w_offset[w] = GetNearestInputIndex(w, scale_w, dims.in_width) * channels;
+  }
+  MultiThreadRangeLoop(
+      dims.num_planes * dims.out_height, MinRowsPerThread(out_row_size),
+      [&](size_t begin, size_t end) {
+        FOR_RANGE(size_t, row, begin, end) {
+          const int64_t plane = row / dims.out_height;
+          const int64_t h = row % dims.out_height;
+          T* y_row = y + row * out_row_size;
+          if (row > begin && h > 0 && in_h_idx[h] == in_h_idx[h - 1]) {
+            memcpy(y_row, y_row - out_row_size, out_row_size * sizeof(T));
+            continue;
+          }
+          const T* x_row = x + (plane * dims.in_height + in_h_idx[h]) * in_row_size;
+          FOR_RANGE(int64_t, w, 0, dims.out_width) {
+            const T* src = x_row + in_w_offset[w];
+            T* dst = y_row + w * channels;
+            FOR_RANGE(int64_t, c, 0, channels) { dst[c] = src[c]; }
+          }
+        }
+      });
+}
+
+// Each dx row only gathers the dy rows mapped onto it, so threads never write the same element.
+template<typename T, bool channels_last>
+void UpsampleNearestBackward(const UpsampleDims& dims, const float scale_h, const float scale_w,
+                             const T* dy, T* dx) {
+  const int64_t channels = channels_last ? dims.channels : 1;
+  const int64_t in_row_size = dims.in_width * channels;
+  const int64_t out_row_size = dims.out_width * channels;
+  // dy rows [out_h_begin[h], out_h_begin[h + 1]) are mapped onto dx row h
+  std::vector<int64_t> out_h_begin(dims.in_height + 1, 0);
+  FOR_RANGE(int64_t, h, 0, dims.out_height) {
+    out_h_begin[GetNearestInputIndex(h, scale_h, dims.in_height) + 1] += 1;
+  }
+  FOR_RANGE(int64_t, h, 0, dims.in_height) { out_h_begin[h + 1] += out_h_begin[h]; }
+  std::vector<int64_t> in_w_offset(dims.out_width);
+  FOR_RANGE(int64_t, w, 0, dims.out_width) {
+    in_w_offset[w] = GetNearestInputIndex(w, scale_w, dims.in_width) * channels;
+  }
+  const int64_t out_rows_per_in_row = std::max<int64_t>(dims.out_height / dims.in_height, 1);
+  MultiThreadRangeLoop(
+      dims.num_planes * dims.in_height, MinRowsPerThread(out_rows_per_in_row * out_row_size),
+      [&](size_t begin, size_t end) {
+        FOR_RANGE(size_t, row, begin, end) {
+          const int64_t plane = row / dims.in_height;
+          const int64_t h = row % dims.in_height;
+          T* dx_row = dx + row * in_row_size;
+          std::fill(dx_row, dx_row + in_row_size, GetZeroVal<T>());
+          FOR_RANGE(int64_t, out_h, out_h_begin[h], out_h_begin[h + 1]) {
+            const T* dy_row = dy + (plane * dims.out_height + out_h) * out_row_size;
+            FOR_RANGE(int64_t, w, 0, dims.out_width) {
+              T* dst = dx_row + in_w_offset[w];
+              const T* src = dy_row + w * channels;
+              FOR_RANGE(int64_t, c, 0, channels) { dst[c] += src[c]; }
+            }
+          }
+        }
+      });
+}
+
+template<typename T, bool channels_last>
+void UpsampleBilinearForward(const UpsampleDims& dims, const float scale_h, const float scale_w,
+                             const T* x, T* y) {
+  const int64_t channels = channels_last ? dims.channels : 1;
+  const int64_t in_row_size = dims.in_width * channels;
+  const int64_t out_row_size = dims.out_width * channels;
+  BilinearCoeffs h_coeffs;
+  ComputeBilinearCoeffs(dims.out_height, dims.in_height, scale_h, &h_coeffs);
+  BilinearCoeffs w_coeffs;
+  ComputeBilinearCoeffs(dims.out_width, dims.in_width, scale_w, &w_coeffs);
+  MultiThreadRangeLoop(
+      dims.num_planes * dims.out_height, MinRowsPerThread(out_row_size),
+      [&](size_t begin, size_t end) {
+        FOR_RANGE(size_t, row, begin, end) {
+          const int64_t plane = row / dims.out_height;
+          const int64_t h = row % dims.out_height;
+          const T* x_plane = x + plane * dims.in_height * in_row_size;
+          const T* top_row = x_plane + h_coeffs.low[h] * in_row_size;
+          const T* bottom_row = x_plane + h_coeffs.high[h] * in_row_size;
+          const T h_lerp = h_coeffs.lerp[h];
+          T* y_row = y + row * out_row_size;
+          FOR_RANGE(int64_t, w, 0, dims.out_width) {
+            const int64_t left = w_coeffs.low[w] * channels;
+            const int64_t right = w_coeffs.high[w] * channels;
+            const T w_lerp = w_coeffs.lerp[w];
+            T* dst = y_row + w * channels;
+            FOR_RANGE(int64_t, c, 0, channels) {
+              const T top = top_row[left + c] + (top_row[right + c] - top_row[left + c]) * w_lerp;
+              const T bottom =
+                  bottom_row[left + c] + (bottom_row[right + c] - bottom_row[left + c]) * w_lerp;
+              dst[c] = top + (bottom - top) * h_lerp;
+            }
+          }
+        }
+      });
+}
+
+// Each dx row accumulates the weighted dy rows it contributes to, so no atomics are needed.
+template<typename T, bool channels_last>
+void UpsampleBilinearBackward(const UpsampleDims& dims, const float scale_h, const float scale_w,
+                              const T* dy, T* dx) {
+  const int64_t channels = channels_last ? dims.channels : 1;
+  const int64_t in_row_size = dims.in_width * channels;
+  const int64_t out_row_size = dims.out_width * channels;
+  BilinearCoeffs h_coeffs;
+  ComputeBilinearCoeffs(dims.out_height, dims.in_height, scale_h, &h_coeffs);
+  BilinearCoeffs w_coeffs;
+  ComputeBilinearCoeffs(dims.out_width, dims.in_width, scale_w, &w_coeffs);
+  // (dy row, weight) pairs of dx row h are [contrib_begin[h], contrib_begin[h + 1])
+  std::vector<int64_t> contrib_begin(dims.in_height + 1, 0);
+  FOR_RANGE(int64_t, h, 0, dims.out_height) {
+    contrib_begin[h_coeffs.low[h] + 1] += 1;
+    contrib_begin[h_coeffs.high[h] + 1] += 1;
+  }
+  FOR_RANGE(int64_t, h, 0, dims.in_height) { contrib_begin[h + 1] += contrib_begin[h]; }
+  std::vector<int64_t> contrib_row(2 * dims.out_height);
+  std::vector<T> contrib_weight(2 * dims.out_height);
+  {
+    std::vector<int64_t> cursor(contrib_begin.begin(), contrib_begin.end() - 1);
+    FOR_RANGE(int64_t, h, 0, dims.out_height) {
+      const int64_t top = cursor[h_coeffs.low[h]]++;
+      contrib_row[top] = h;
+      contrib_weight[top] = 1 - h_coeffs.lerp[h];
+      const int64_t bottom = cursor[h_coeffs.high[h]]++;
+      contrib_row[bottom] = h;
+      contrib_weight[bottom] = h_coeffs.lerp[h];
+    }
+  }
+  const int64_t out_rows_per_in_row = std::max<int64_t>(2 * dims.out_height / dims.in_height, 1);
+  MultiThreadRangeLoop(
+      dims.num_planes * dims.in_height, MinRowsPerThread(out_rows_per_in_row * out_row_size),
+      [&](size_t begin, size_t end) {
+        FOR_RANGE(size_t, row, begin, end) {
+          const int64_t plane = row / dims.in_height;
+          const int64_t h = row % dims.in_height;
+          T* dx_row = dx + row * in_row_size;
+          std::fill(dx_row, dx_row + in_row_size, GetZeroVal<T>());
+          FOR_RANGE(int64_t, i, contrib_begin[h], contrib_begin[h + 1]) {
+            const T* dy_row = dy + (plane * dims.out_height + contrib_row[i]) * out_row_size;
+            const T h_weight = contrib_weight[i];
+            FOR_RANGE(int64_t, w, 0, dims.out_width) {
+              T* left = dx_row + w_coeffs.low[w] * channels;
+              T* right = dx_row + w_coeffs.high[w] * channels;
+              const T right_weight = h_weight * w_coeffs.lerp[w];
+              const T left_weight = h_weight - right_weight;
+              const T* src = dy_row + w * channels;
+              FOR_RANGE(int64_t, c, 0, channels) {
+                left[c] += src[c] * left_weight;
+                right[c] += src[c] * right_weight;
+              }
+            }
+          }
+        }
+      });
+}
+
+}  // namespace
+
+template<typename T>
+class UpsampleNearestCPUKernel final : public user_op::OpKernel {
+ public:
+  UpsampleNearestCPUKernel() = default;
+  ~UpsampleNearestCPUKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x_blob = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* y_blob = ctx->Tensor4ArgNameAndIndex("y", 0);
+    const float height_scale = ctx->Attr<float>("height_scale");
+    const float width_scale = ctx->Attr<float>("width_scale");
+    const UpsampleDims dims =
+        GetUpsampleDims(x_blob->shape(), y_blob->shape(), ctx->Attr<std::string>("data_format"));
+    if (dims.channels_last) {
+      UpsampleNearestForward<T, true>(dims, 1.f / height_scale, 1.f / width_scale,
+                                      x_blob->dptr<T>(), y_blob->mut_dptr<T>());
+    } else {
+      UpsampleNearestForward<T, false>(dims, 1.f / height_scale, 1.f / width_scale,
+                                       x_blob->dptr<T>(), y_blob->mut_dptr<T>());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class UpsampleNearestGradCPUKernel final : public user_op::OpKernel {
+ public:
+  UpsampleNearestGradCPUKernel() = default;
+  ~UpsampleNearestGradCPUKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    user_op::Tensor* dx_blob = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    if (dx_blob == nullptr) { return; }
+    const user_op::Tensor* dy_blob = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const float height_scale = ctx->Attr<float>("height_scale");
+    const float width_scale = ctx->Attr<float>("width_scale");
+    const UpsampleDims dims =
+        GetUpsampleDims(dx_blob->shape(), dy_blob->shape(), ctx->Attr<std::string>("data_format"));
+    if (dims.channels_last) {
+      UpsampleNearestBackward<T, true>(dims, 1.f / height_scale, 1.f / width_scale,
+                                       dy_blob->dptr<T>(), dx_blob->mut_dptr<T>());
+    } else {
+      UpsampleNearestBackward<T, false>(dims, 1.f / height_scale, 1.f / width_scale,
+                                        dy_blob->dptr<T>(), dx_blob->mut_dptr<T>());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_UPSAMPLE_NEAREST_CPU_KERNEL(dtype)                                      \
+  REGISTER_USER_KERNEL("upsample")                                                       \
+      .SetCreateFn<UpsampleNearestCPUKernel<dtype>>()                                    \
+      .SetIsMatchedHob(                                                                  \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                 \
+          & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)                  \
+          & (user_op::HobAttr<std::string>("interpolation") == std::string("nearest"))); \
+  REGISTER_USER_KERNEL("upsample_grad")                                                  \
+      .SetCreateFn<UpsampleNearestGradCPUKernel<dtype>>()                                \
+      .SetIsMatchedHob(                                                                  \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                 \
+          & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value)                 \
+          & (user_op::HobAttr<std::string>("interpolation") == std::string("nearest")));
+
+REGISTER_UPSAMPLE_NEAREST_CPU_KERNEL(float)
+REGISTER_UPSAMPLE_NEAREST_CPU_KERNEL(double)
+
+template<typename T>
+class UpsampleBilinearCPUKernel final : public user_op::OpKernel {
+ public:
+  UpsampleBilinearCPUKernel() = default;
+  ~UpsampleBilinearCPUKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x_blob = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* y_blob = ctx->Tensor4ArgNameAndIndex("y", 0);
+    const float height_scale = ctx->Attr<float>("height_scale");
+    const float width_scale = ctx->Attr<float>("width_scale");
+    const UpsampleDims dims =
+        GetUpsampleDims(x_blob->shape(), y_blob->shape(), ctx->Attr<std::string>("data_format"));
+    if (dims.channels_last) {
+      UpsampleBilinearForward<T, true>(dims, 1.f / height_scale, 1.f / width_scale,
+                                       x_blob->dptr<T>(), y_blob->mut_dptr<T>());
+    } else {
+      UpsampleBilinearForward<T, false>(dims, 1.f / height_scale, 1.f / width_scale,
+                                        x_blob->dptr<T>(), y_blob->mut_dptr<T>());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class UpsampleBilinearGradCPUKernel final : public user_op::OpKernel {
+ public:
+  UpsampleBilinearGradCPUKernel() = default;
+  ~UpsampleBilinearGradCPUKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    user_op::Tensor* dx_blob = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    if (dx_blob == nullptr) { return; }
+    const user_op::Tensor* dy_blob = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const float height_scale = ctx->Attr<float>("height_scale");
+    const float width_scale = ctx->Attr<float>("width_scale");
+    const UpsampleDims dims =
+        GetUpsampleDims(dx_blob->shape(), dy_blob->shape(), ctx->Attr<std::string>("data_format"));
+    if (dims.channels_last) {
+      UpsampleBilinearBackward<T, true>(dims, 1.f / height_scale, 1.f / width_scale,
+                                        dy_blob->dptr<T>(), dx_blob->mut_dptr<T>());
+    } else {
+      UpsampleBilinearBackward<T, false>(dims, 1.f / height_scale, 1.f / width_scale,
+                                         dy_blob->dptr<T>(), dx_blob->mut_dptr<T>());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_UPSAMPLE_BILINEAR_CPU_KERNEL(dtype)                                      \
+  REGISTER_USER_KERNEL("upsample")                                                        \
+      .SetCreateFn<UpsampleBilinearCPUKernel<dtype>>()                                    \
+      .SetIsMatchedHob(                                                                   \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                  \
+          & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)                   \
+          & (user_op::HobAttr<std::string>("interpolation") == std::string("bilinear"))); \
+  REGISTER_USER_KERNEL("upsample_grad")                                                   \
+      .SetCreateFn<UpsampleBilinearGradCPUKernel<dtype>>()                                \
+      .SetIsMatchedHob(                                                                   \
+          (user_op::HobDeviceType() == DeviceType::kCPU)                                  \
+          & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value)                  \
+          & (user_op::HobAttr<std::string>("interpolation") == std::string("bilinear")));
+
+REGISTER_UPSAMPLE_BILINEAR_CPU_KERNEL(float)
+REGISTER_UPSAMPLE_BILINEAR_CPU_KERNEL(double)
+
+}  // namespace oneflow
@@ -27,6 +27,7 @@ REGISTER_CPU_ONLY_USER_OP("COCOReader")
     .Output("gt_segm")
     .Output("gt_segm_index")
     .Attr("annotation_file", UserOpAttrType::kAtString)
+    .Attr<std::string>("annotation_index_file", UserOpAttrType::kAtString, "")
     .Attr("image_dir", UserOpAttrType::kAtString)
     .Attr("batch_size", UserOpAttrType::kAtInt64)
     .Attr<bool>("shuffle_after_epoch", UserOpAttrType::kAtBool, true)
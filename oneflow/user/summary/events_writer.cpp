@@ -21,17 +21,25 @@ namespace oneflow {
 
 namespace summary {
 
-EventsWriter::EventsWriter() : is_inited_(false) {}
+EventsWriter::EventsWriter()
+    : is_inited_(false), flush_request_cnt_(0), flushed_cnt_(0), is_closed_(false) {}
 
 EventsWriter::~EventsWriter() { Close(); }
 
 Maybe<void> EventsWriter::Init(const std::string& logdir) {
+  if (is_inited_) {
+    // events keep going to the file of the first logdir
+    LOG_IF(WARNING, log_dir_ != logdir + "/event")
+        << "Events writer has been inited with " << log_dir_ << ", ignore logdir " << logdir;
+    return Maybe<void>::Ok();
+  }
   file_system_ = std::make_unique<fs::PosixFileSystem>();
   log_dir_ = logdir + "/event";
   file_system_->RecursivelyCreateDirIfNotExist(log_dir_);
   TryToInit();
   is_inited_ = true;
   last_flush_time_ = CurrentMircoTime();
+  poll_thread_ = std::thread(&EventsWriter::PollLoop, this);
   return Maybe<void>::Ok();
 }
 
@@ -56,27 +64,77 @@ Maybe<void> EventsWriter::TryToInit() {
     event.set_wall_time(current_time);
     event.set_file_version(FILE_VERSION);
     WriteEvent(event);
-    Flush();
+    FileFlush();
   }
   return Maybe<void>::Ok();
 }
 
 void EventsWriter::AppendQueue(std::unique_ptr<Event> event) {
-  queue_mutex.lock();
-  event_queue_.emplace_back(std::move(event));
-  queue_mutex.unlock();
-  if (event_queue_.size() > MAX_QUEUE_NUM || CurrentMircoTime() - last_flush_time_ > FLUSH_TIME) {
-    Flush();
+  std::shared_ptr<Event> shared_event(event.release());
+  AppendQueue([shared_event]() {
+    std::unique_ptr<Event> e(new Event());
+    e->Swap(shared_event.get());
+    return e;
+  });
+}
+
+void EventsWriter::AppendQueue(EventMaker MakeEvent) {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  if (is_inited_) {
+    queue_cond_.wait(lock, [this]() {
+      return event_queue_.size() < MAX_PENDING_EVENT_NUM || is_closed_;
+    });
+  }
+  if (is_closed_) {
+    LOG(WARNING) << "Events writer is closed, drop the event!";
+    return;
   }
+  event_queue_.emplace_back(std::move(MakeEvent));
+  if (event_queue_.size() > MAX_QUEUE_NUM) { queue_cond_.notify_all(); }
 }
 
 void EventsWriter::Flush() {
-  queue_mutex.lock();
-  for (const std::unique_ptr<Event>& e : event_queue_) { WriteEvent(*e); }
-  event_queue_.clear();
-  queue_mutex.unlock();
-  FileFlush();
-  last_flush_time_ = CurrentMircoTime();
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  if (!is_inited_ || is_closed_) { return; }
+  const int64_t flush_request_cnt = ++flush_request_cnt_;
+  queue_cond_.notify_all();
+  flushed_cond_.wait(lock, [&]() { return flushed_cnt_ >= flush_request_cnt; });
+}
+
+void EventsWriter::PollLoop() {
+  std::deque<EventMaker> pending;
+  bool is_closed = false;
+  while (!is_closed) {
+    int64_t flush_request_cnt = 0;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cond_.wait_for(lock, std::chrono::microseconds(FLUSH_TIME), [this]() {
+        return event_queue_.size() > MAX_QUEUE_NUM || flush_request_cnt_ > flushed_cnt_
+               || is_closed_;
+      });
+      pending.swap(event_queue_);
+      flush_request_cnt = flush_request_cnt_;
+      is_closed = is_closed_;
+    }
+    // wake up producers waiting for a full queue
+    queue_cond_.notify_all();
+    WritePendingEvents(&pending);
+    FileFlush();
+    last_flush_time_ = CurrentMircoTime();
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      flushed_cnt_ = flush_request_cnt;
+    }
+    flushed_cond_.notify_all();
+  }
+}
+
+void EventsWriter::WritePendingEvents(std::deque<EventMaker>* pending) {
+  for (const EventMaker& MakeEvent : *pending) {
+    std::unique_ptr<Event> event = MakeEvent();
+    if (event) { WriteEvent(*event); }
+  }
+  pending->clear();
 }
 
 void EventsWriter::WriteEvent(const Event& event) {
@@ -98,7 +156,6 @@ void EventsWriter::WriteEvent(const Event& event) {
   writable_file_->Append(head, sizeof(head));
   writable_file_->Append(event_str.data(), event_str.size());
   writable_file_->Append(tail, sizeof(tail));
-  FileFlush();
 }
 
 void EventsWriter::FileFlush() {
@@ -107,9 +164,13 @@ void EventsWriter::FileFlush() {
 }
 
 void EventsWriter::Close() {
-  if (!is_inited_) { return; }
-  queue_mutex.unlock();
-  Flush();
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if (!is_inited_ || is_closed_) { return; }
+    is_closed_ = true;
+  }
+  queue_cond_.notify_all();
+  poll_thread_.join();
   if (writable_file_ != nullptr) {
     writable_file_->Close();
     writable_file_.reset(nullptr);
@@ -23,32 +23,45 @@ limitations under the License.
 
 #include <time.h>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
 
 namespace oneflow {
 
 namespace summary {
 
 #define MAX_QUEUE_NUM 10
+#define MAX_PENDING_EVENT_NUM 1024
 #define FLUSH_TIME 3 * 60 * 1000 * 1000
 #define FILE_VERSION "brain.Event:3"
 const size_t kHeadSize = sizeof(uint64_t) + sizeof(uint32_t);
 const size_t kTailSize = sizeof(uint32_t);
 
+// Events are serialized and written by a background writer thread, AppendQueue only hands them
+// over and blocks only when MAX_PENDING_EVENT_NUM events are pending
 class EventsWriter {
  public:
+  using EventMaker = std::function<std::unique_ptr<Event>()>;
+
   EventsWriter();
   ~EventsWriter();
 
   Maybe<void> Init(const std::string& logdir);
   void WriteEvent(const Event& event);
+  // Blocks until every event appended before it is written and flushed to file
   void Flush();
   void Close();
 
   void AppendQueue(std::unique_ptr<Event> event);
+  // The event is made on the writer thread, so expensive summaries stay off the caller thread
+  void AppendQueue(EventMaker MakeEvent);
   void FileFlush();
 
  private:
   Maybe<void> TryToInit();
+  void PollLoop();
+  void WritePendingEvents(std::deque<EventMaker>* pending);
   inline static void EncodeHead(char* head, size_t size);
   inline static void EncodeTail(char* tail, const char* data, size_t size);
 
@@ -58,8 +71,14 @@ class EventsWriter {
   std::unique_ptr<fs::FileSystem> file_system_;
   std::unique_ptr<fs::WritableFile> writable_file_;
   uint64_t last_flush_time_;
-  std::vector<std::unique_ptr<Event>> event_queue_;
+  std::deque<EventMaker> event_queue_;
   std::mutex queue_mutex;
+  std::condition_variable queue_cond_;
+  std::condition_variable flushed_cond_;
+  int64_t flush_request_cnt_;
+  int64_t flushed_cnt_;
+  bool is_closed_;
+  std::thread poll_thread_;
   OF_DISALLOW_COPY(EventsWriter);
 };
 
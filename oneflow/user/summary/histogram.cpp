@@ -15,7 +15,9 @@ limitations under the License.
 */
 #include "oneflow/user/summary/histogram.h"
 #include "oneflow/core/common/maybe.h"
+#include "oneflow/core/thread/thread_manager.h"
 #include <cfloat>
+#include <cmath>
 #include <algorithm>
 
 namespace oneflow {
@@ -709,18 +711,81 @@ Histogram::Histogram() {
   min_value_ = DBL_MAX;
 }
 
+namespace {
+
+// Limits of defalut_container are symmetric around 0.0 and grow by kContainerRatio on each side
+const double kContainerRatio = 1.1;
+const size_t kMinValueNumPerRange = 64 * 1024;
+
+}  // namespace
+
+size_t Histogram::ContainerIndex(double value) const {
+  static const int64_t zero_idx =
+      std::lower_bound(defalut_container.begin(), defalut_container.end(), 0.0)
+      - defalut_container.begin();
+  static const double min_positive_limit = defalut_container.at(zero_idx + 1);
+  static const double inv_log_ratio = 1.0 / std::log(kContainerRatio);
+  const int64_t size = max_constainers_.size();
+  if (value == 0.0 || !std::isfinite(value)) {
+    return std::upper_bound(max_constainers_.begin(), max_constainers_.end(), value)
+           - max_constainers_.begin();
+  }
+  // guess the upper bound from the geometric layout of limits, then fix it up by comparison
+  const double steps = std::floor(std::log(std::abs(value) / min_positive_limit) * inv_log_ratio);
+  const int64_t step = static_cast<int64_t>(std::max(std::min(steps, double(size)), -1.0));
+  int64_t idx = value > 0 ? zero_idx + 2 + step : zero_idx - 1 - step;
+  idx = std::max<int64_t>(std::min<int64_t>(idx, size), 0);
+  while (idx > 0 && max_constainers_[idx - 1] > value) { --idx; }
+  while (idx < size && max_constainers_[idx] <= value) { ++idx; }
+  return idx;
+}
+
 void Histogram::AppendValue(double value) {
   value_sum_ += value;
   value_count_++;
   sum_value_squares_ += value * value;
   if (max_value_ < value) { max_value_ = value; }
   if (min_value_ > value) { min_value_ = value; }
-  int idx = std::upper_bound(max_constainers_.begin(), max_constainers_.end(), value)
-            - max_constainers_.begin();
+  size_t idx = ContainerIndex(value);
   CHECK_GT(containers_.size(), idx);
   containers_.at(idx) += 1.0;
 }
 
+template<typename T>
+void Histogram::AppendValues(const T* values, int64_t num) {
+  std::mutex mutex;
+  std::map<size_t, std::unique_ptr<Histogram>> begin2partial;
+  MultiThreadRangeLoop(num, kMinValueNumPerRange, [&](size_t begin, size_t end) {
+    std::unique_ptr<Histogram> partial(new Histogram());
+    for (size_t i = begin; i < end; ++i) { partial->AppendValue(static_cast<double>(values[i])); }
+    std::unique_lock<std::mutex> lock(mutex);
+    begin2partial.emplace(begin, std::move(partial));
+  });
+  for (const auto& pair : begin2partial) { Merge(*pair.second); }
+}
+
+void Histogram::Merge(const Histogram& other) {
+  CHECK_EQ(containers_.size(), other.containers_.size());
+  value_count_ += other.value_count_;
+  value_sum_ += other.value_sum_;
+  sum_value_squares_ += other.sum_value_squares_;
+  min_value_ = std::min(min_value_, other.min_value_);
+  max_value_ = std::max(max_value_, other.max_value_);
+  for (size_t idx = 0; idx < containers_.size(); idx++) {
+    containers_.at(idx) += other.containers_.at(idx);
+  }
+}
+
+#define INSTANTIATE_HISTOGRAM_APPEND_VALUES(T) \
+  template void Histogram::AppendValues<T>(const T* values, int64_t num);
+
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(float)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(double)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int8_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(uint8_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int32_t)
+INSTANTIATE_HISTOGRAM_APPEND_VALUES(int64_t)
+
 void Histogram::AppendToProto(HistogramProto* hist_proto) {
   hist_proto->Clear();
   hist_proto->set_num(value_count_);
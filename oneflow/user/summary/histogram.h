@@ -29,9 +29,15 @@ class Histogram {
   ~Histogram() {}
 
   void AppendValue(double value);
+  // Bins values with parallel partial histograms merged in range order
+  template<typename T>
+  void AppendValues(const T* values, int64_t num);
+  void Merge(const Histogram& other);
   void AppendToProto(HistogramProto* proto);
 
  private:
+  size_t ContainerIndex(double value) const;
+
   double value_count_;
   double value_sum_;
   double sum_value_squares_;
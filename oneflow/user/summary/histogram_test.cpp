@@ -0,0 +1,64 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/user/summary/histogram.h"
+#include "oneflow/core/common/util.h"
+#include <random>
+
+namespace oneflow {
+
+namespace summary {
+
+TEST(Histogram, container_index) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> exponent_dis(-15, 15);
+  std::vector<double> values = {0.0, 1.0, -1.0, 1e-20, -1e-20, 1e20, -1e20};
+  FOR_RANGE(int32_t, i, 0, 10000) {
+    const double value = std::pow(10.0, exponent_dis(gen));
+    values.push_back(i % 2 == 0 ? value : -value);
+  }
+  for (double value : values) {
+    Histogram histo;
+    histo.AppendValue(value);
+    HistogramProto proto;
+    histo.AppendToProto(&proto);
+    int32_t bucket_idx = -1;
+    FOR_RANGE(int32_t, i, 0, proto.bucket_size()) {
+      if (proto.bucket(i) > 0) { bucket_idx = i; }
+    }
+    ASSERT_GT(bucket_idx, 0);
+    ASSERT_LT(value, proto.bucket_limit(bucket_idx));
+    ASSERT_LE(proto.bucket_limit(bucket_idx - 1), value);
+  }
+}
+
+TEST(Histogram, append_values) {
+  std::vector<float> values;
+  FOR_RANGE(int32_t, i, 0, 100000) { values.push_back((i % 201) - 100); }
+  Histogram expected;
+  for (float value : values) { expected.AppendValue(value); }
+  Histogram histo;
+  histo.AppendValues<float>(values.data(), values.size());
+  HistogramProto expected_proto;
+  HistogramProto proto;
+  expected.AppendToProto(&expected_proto);
+  histo.AppendToProto(&proto);
+  ASSERT_EQ(proto.SerializeAsString(), expected_proto.SerializeAsString());
+}
+
+}  // namespace summary
+
+}  // namespace oneflow
@@ -14,10 +14,54 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/xrt/compilation_cache.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/user/summary/crc32c.h"
+#include "oneflow/xrt/utility/env.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+DEFINE_string(xrt_shape_buckets, EnvToString(FLAGS_xrt_shape_buckets, ""),
+              "Round the leading dim of dynamic entries up to buckets. It is either "
+              "empty (disabled), `pow2` or ascending comma separated sizes.");
+DEFINE_int64(xrt_compilation_cache_capacity,
+             EnvToInt64(FLAGS_xrt_compilation_cache_capacity, -1),
+             "Maximum executables cached by each launch op, and -1 means unbounded.");
+DEFINE_string(xrt_compilation_cache_dir, EnvToString(FLAGS_xrt_compilation_cache_dir, ""),
+              "Directory to persist serializable executables across restarts.");
 
 namespace oneflow {
 namespace xrt {
 
+namespace {
+
+constexpr char kPersistMagic[] = "XRTC";
+constexpr int32_t kPersistVersion = 1;
+
+void WriteString(std::ostream &out, const std::string &str) {
+  const uint64_t size = str.size();
+  out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  out.write(str.data(), size);
+}
+
+// The size is checked against the rest of the stream, so a truncated or corrupt file is rejected
+// before a huge allocation
+bool ReadString(std::istream &in, std::string *str) {
+  uint64_t size = 0;
+  if (!in.read(reinterpret_cast<char *>(&size), sizeof(size))) { return false; }
+  const std::streampos pos = in.tellg();
+  if (pos == std::streampos(-1) || !in.seekg(0, std::ios::end)) { return false; }
+  const std::streampos end = in.tellg();
+  if (end == std::streampos(-1) || !in.seekg(pos)) { return false; }
+  if (size > static_cast<uint64_t>(end - pos)) { return false; }
+  str->resize(size);
+  return static_cast<bool>(in.read(&(*str)[0], size));
+}
+
+}  // namespace
+
 bool operator==(const Signature &lhs, const Signature &rhs) {
   return lhs.builder_name == rhs.builder_name && lhs.device_ordinal == rhs.device_ordinal
          && lhs.entry_shapes == rhs.entry_shapes;
@@ -30,6 +74,13 @@ size_t SignatureHash::operator()(const Signature &signature) const {
   return hash_val;
 }
 
+std::string SignatureToString(const Signature &signature) {
+  std::ostringstream ss;
+  ss << signature.builder_name << "@" << signature.device_ordinal;
+  for (const auto &shape : signature.entry_shapes) { ss << ":" << shape.ToString(); }
+  return ss.str();
+}
+
 Signature ComputeSignature(const std::string &name, const int device_ordinal,
                            const std::vector<Parameter> &entry_params) {
   Signature signature;
@@ -42,24 +93,214 @@ Signature ComputeSignature(const std::string &name, const int device_ordinal,
   return std::move(signature);
 }
 
-Executable *CompilationCache::GetRecord(const Signature &signature) const {
-  Executable *record = nullptr;
-  // std::shared_lock<std::shared_mutex> lock(mutex_);
-  std::lock_guard<std::mutex> lock(mutex_);
-  const auto &it = records_.find(signature);
-  if (it != records_.end()) { record = it->second.get(); }
-  return record;
+ShapeBucketing::ShapeBucketing(const std::string &buckets) {
+  if (buckets == "pow2") {
+    pow2_ = true;
+    return;
+  }
+  std::istringstream ss(buckets);
+  std::string bucket;
+  while (std::getline(ss, bucket, ',')) {
+    if (bucket.empty()) { continue; }
+    buckets_.push_back(std::stoll(bucket));
+    CHECK_GT(buckets_.back(), 0) << "Invalid shape bucket " << bucket;
+    if (buckets_.size() > 1) {
+      CHECK_GT(buckets_.back(), buckets_[buckets_.size() - 2])
+          << "Shape buckets should be ascending: " << buckets;
+    }
+  }
+}
+
+const ShapeBucketing &ShapeBucketing::Default() {
+  static ShapeBucketing bucketing(FLAGS_xrt_shape_buckets);
+  return bucketing;
+}
+
+int64_t ShapeBucketing::Bucket(int64_t dim, int64_t max_dim) const {
+  int64_t bucket = dim;
+  if (pow2_) {
+    bucket = 1;
+    while (bucket < dim) { bucket <<= 1; }
+  } else {
+    auto it = std::lower_bound(buckets_.begin(), buckets_.end(), dim);
+    if (it != buckets_.end()) { bucket = *it; }
+  }
+  return std::min(bucket, std::max(dim, max_dim));
+}
+
+Shape ShapeBucketing::BucketShape(const Shape &shape, const Shape &static_shape) const {
+  if (!enabled() || shape.NumAxes() == 0) { return shape; }
+  CHECK_EQ(shape.NumAxes(), static_shape.NumAxes());
+  Shape bucketed = shape;
+  bucketed.Set(0, Bucket(shape.At(0), static_shape.At(0)));
+  return bucketed;
+}
+
+CompilationCache::CompilationCache(const std::string &fingerprint)
+    : CompilationCache(fingerprint, FLAGS_xrt_compilation_cache_capacity,
+                       FLAGS_xrt_compilation_cache_dir) {}
+
+CompilationCache::CompilationCache(const std::string &fingerprint, int64_t capacity,
+                                   const std::string &persist_dir)
+    : fingerprint_(fingerprint),
+      capacity_(capacity),
+      persist_dir_(persist_dir),
+      tick_(0),
+      hits_(0),
+      misses_(0),
+      restores_(0),
+      evictions_(0) {
+  CHECK_NE(capacity_, 0) << "Compilation cache capacity should be positive or -1.";
+  if (persistent()) { LocalFS()->RecursivelyCreateDirIfNotExist(persist_dir_); }
+}
+
+CompilationCache::~CompilationCache() {
+  if (evictions_ > 0) {
+    LOG(INFO) << "XRT compilation cache " << fingerprint_ << ": hits " << hits_ << ", misses "
+              << misses_ << ", restores " << restores_ << ", evictions " << evictions_
+              << ". Consider a larger FLAGS_xrt_compilation_cache_capacity or "
+                 "FLAGS_xrt_shape_buckets.";
+  }
+}
+
+std::shared_ptr<Executable> CompilationCache::GetRecord(const Signature &signature) {
+  {
+    util::ReaderMutexLock lock(&mutex_);
+    const auto &it = records_.find(signature);
+    if (it != records_.end()) {
+      it->second->last_used_tick = ++tick_;
+      ++hits_;
+      return it->second->executable;
+    }
+  }
+  if (persistent()) {
+    std::shared_ptr<Executable> executable = Restore(signature);
+    if (executable) {
+      Record(signature, executable);
+      {
+        util::ReaderMutexLock lock(&mutex_);
+        const auto &it = records_.find(signature);
+        if (it != records_.end()) { it->second->persisted = true; }
+      }
+      ++restores_;
+      return executable;
+    }
+  }
+  ++misses_;
+  return nullptr;
 }
 
 void CompilationCache::Record(const Signature &signature,
                               const std::shared_ptr<Executable> &result) {
-  // std::unique_lock<std::shared_mutex> lock(mutex_);
-  std::lock_guard<std::mutex> lock(mutex_);
-  records_.emplace(signature, result);
+  util::WriterMutexLock lock(&mutex_);
+  std::unique_ptr<Entry> entry(new Entry);
+  entry->executable = result;
+  entry->last_used_tick = ++tick_;
+  entry->persisted = false;
+  records_.emplace(signature, std::move(entry));
+  EvictIfNeeded();
+}
+
+void CompilationCache::EvictIfNeeded() {
+  // Eviction is rare, so a scan under the writer lock keeps the hit path lock free
+  // of list splicing.
+  while (capacity_ > 0 && records_.size() > capacity_) {
+    auto victim = records_.begin();
+    for (auto it = records_.begin(); it != records_.end(); ++it) {
+      if (it->second->last_used_tick < victim->second->last_used_tick) { victim = it; }
+    }
+    VLOG(2) << "Evict executable " << SignatureToString(victim->first);
+    records_.erase(victim);
+    ++evictions_;
+  }
+}
+
+std::string CompilationCache::PersistPath(const Signature &signature) const {
+  // A fixed digest since file names should stay the same across builds and toolchains
+  const std::string key = fingerprint_ + "|" + SignatureToString(signature);
+  std::ostringstream ss;
+  ss << persist_dir_ << "/" << std::hex << summary::GetCrc32(key.data(), key.size()) << ".xrt";
+  return ss.str();
+}
+
+void CompilationCache::Persist(const Signature &signature) {
+  if (!persistent()) { return; }
+  std::shared_ptr<Executable> executable;
+  {
+    util::ReaderMutexLock lock(&mutex_);
+    const auto &it = records_.find(signature);
+    if (it == records_.end() || it->second->persisted.exchange(true)) { return; }
+    executable = it->second->executable;
+  }
+  std::string serialized;
+  if (!executable->Serialize(&serialized)) { return; }
+
+  const std::string path = PersistPath(signature);
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+      LOG(WARNING) << "Could not persist executable to " << tmp_path;
+      return;
+    }
+    out.write(kPersistMagic, sizeof(kPersistMagic) - 1);
+    out.write(reinterpret_cast<const char *>(&kPersistVersion), sizeof(kPersistVersion));
+    WriteString(out, fingerprint_ + "|" + SignatureToString(signature));
+    const int32_t engine = executable->engine();
+    out.write(reinterpret_cast<const char *>(&engine), sizeof(engine));
+    WriteString(out, serialized);
+  }
+  // Rename so that concurrent readers never see partially written files
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Could not persist executable to " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
+std::shared_ptr<Executable> CompilationCache::Restore(const Signature &signature) {
+  std::ifstream in(PersistPath(signature), std::ios::in | std::ios::binary);
+  if (!in.good()) { return nullptr; }
+  char magic[sizeof(kPersistMagic) - 1];
+  int32_t version = 0;
+  std::string key;
+  int32_t engine = 0;
+  std::string serialized;
+  if (!in.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != kPersistMagic
+      || !in.read(reinterpret_cast<char *>(&version), sizeof(version))
+      || version != kPersistVersion || !ReadString(in, &key)
+      || key != fingerprint_ + "|" + SignatureToString(signature)
+      || !in.read(reinterpret_cast<char *>(&engine), sizeof(engine))
+      || !ReadString(in, &serialized)) {
+    return nullptr;
+  }
+  if (!XrtEngine_IsValid(engine)
+      || !ExecutableDeserializerRegistry()->IsRegistered(static_cast<XrtEngine>(engine))) {
+    return nullptr;
+  }
+  const auto &deserializer =
+      ExecutableDeserializerRegistry()->Lookup(static_cast<XrtEngine>(engine));
+  std::shared_ptr<Executable> executable = deserializer(signature.builder_name, serialized);
+  if (executable) { VLOG(2) << "Restore executable " << SignatureToString(signature); }
+  return executable;
+}
+
+size_t CompilationCache::size() const {
+  util::ReaderMutexLock lock(&mutex_);
+  return records_.size();
+}
+
+CompilationCacheStats CompilationCache::stats() const {
+  CompilationCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.restores = restores_;
+  stats.evictions = evictions_;
+  return stats;
 }
 
 void CompilationCache::Release() {
-  util::Map<Signature, std::shared_ptr<Executable>, SignatureHash> empty_records;
+  util::Map<Signature, std::unique_ptr<Entry>, SignatureHash> empty_records;
+  util::WriterMutexLock lock(&mutex_);
   records_.swap(empty_records);
 }
 
@@ -16,8 +16,9 @@ limitations under the License.
 #ifndef ONEFLOW_XRT_COMPILATION_CACHE_H_
 #define ONEFLOW_XRT_COMPILATION_CACHE_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,9 @@ limitations under the License.
 #include "oneflow/core/common/shape.h"
 #include "oneflow/xrt/executable.h"
 #include "oneflow/xrt/parameter.h"
+#include "oneflow/xrt/types.h"
+#include "oneflow/xrt/utility/registry.h"
+#include "oneflow/xrt/utility/rw_mutex.h"
 #include "oneflow/xrt/utility/stl.h"
 
 namespace oneflow {
@@ -46,21 +50,109 @@ struct SignatureHash {
   size_t operator()(const Signature &signature) const;
 };
 
+std::string SignatureToString(const Signature &signature);
+
 Signature ComputeSignature(const std::string &name, const int device_ordinal,
                            const std::vector<xrt::Parameter> &entry_params);
 
+// Rounds the leading dim of dynamic shapes up to a bucket, so that varying batch sizes
+// share a few executables instead of compiling one for every size. `buckets` is empty
+// (disabled), "pow2", or ascending comma separated sizes such as "8,16,32,64".
+class ShapeBucketing {
+ public:
+  explicit ShapeBucketing(const std::string &buckets);
+
+  // Bucketing configured by FLAGS_xrt_shape_buckets
+  static const ShapeBucketing &Default();
+
+  bool enabled() const { return pow2_ || !buckets_.empty(); }
+
+  // The bucket of `dim` which never exceeds `max_dim`
+  int64_t Bucket(int64_t dim, int64_t max_dim) const;
+
+  Shape BucketShape(const Shape &shape, const Shape &static_shape) const;
+
+ private:
+  bool pow2_ = false;
+  std::vector<int64_t> buckets_;
+};
+
+using ExecutableDeserializer = std::function<std::shared_ptr<Executable>(
+    const std::string & /*name*/, const std::string & /*serialized*/)>;
+
+inline util::Registry<XrtEngine, ExecutableDeserializer> *ExecutableDeserializerRegistry() {
+  return util::Registry<XrtEngine, ExecutableDeserializer>::Global();
+}
+
+#define REGISTER_EXECUTABLE_DESERIALIZER(Engine, Deserializer)                             \
+  namespace {                                                                              \
+  struct _XrtExecutableDeserializer {                                                      \
+    _XrtExecutableDeserializer() {                                                         \
+      ExecutableDeserializerRegistry()->Register(Engine, Deserializer);                    \
+    }                                                                                      \
+  };                                                                                       \
+  static _XrtExecutableDeserializer _xrt_executable_deserializer_ __attribute__((unused)); \
+  }  // namespace
+
+struct CompilationCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  // Executables loaded from the persistent cache directory
+  int64_t restores = 0;
+  int64_t evictions = 0;
+};
+
+// Executables keyed by signatures. Lookups only take a reader lock, and the least
+// recently used executable is evicted once the cache grows beyond `capacity`. If
+// `persist_dir` is set, serializable executables are written to and restored from it
+// so that warm restarts skip compilation.
 class CompilationCache {
  public:
-  Executable *GetRecord(const Signature &signature) const;
+  // Configured by FLAGS_xrt_compilation_cache_capacity and FLAGS_xrt_compilation_cache_dir
+  explicit CompilationCache(const std::string &fingerprint);
+  CompilationCache(const std::string &fingerprint, int64_t capacity,
+                   const std::string &persist_dir);
+  ~CompilationCache();
+
+  std::shared_ptr<Executable> GetRecord(const Signature &signature);
 
   void Record(const Signature &signature, const std::shared_ptr<Executable> &result);
 
+  // Write the executable of `signature` to the persistent cache directory once. It is
+  // a no-op if persistence is disabled or the engine can not serialize executables.
+  void Persist(const Signature &signature);
+
+  bool persistent() const { return !persist_dir_.empty(); }
+
+  size_t size() const;
+
+  CompilationCacheStats stats() const;
+
   void Release();
 
  private:
-  // static std::shared_mutex mutex_;
-  mutable std::mutex mutex_;
-  util::Map<Signature, std::shared_ptr<Executable>, SignatureHash> records_;
+  struct Entry {
+    std::shared_ptr<Executable> executable;
+    std::atomic<int64_t> last_used_tick;
+    std::atomic<bool> persisted;
+  };
+
+  void EvictIfNeeded();
+  std::string PersistPath(const Signature &signature) const;
+  std::shared_ptr<Executable> Restore(const Signature &signature);
+
+  std::string fingerprint_;
+  int64_t capacity_;
+  std::string persist_dir_;
+
+  mutable util::RWMutex mutex_;
+  util::Map<Signature, std::unique_ptr<Entry>, SignatureHash> records_;
+
+  std::atomic<int64_t> tick_;
+  std::atomic<int64_t> hits_;
+  std::atomic<int64_t> misses_;
+  std::atomic<int64_t> restores_;
+  std::atomic<int64_t> evictions_;
 };
 
 }  // namespace xrt
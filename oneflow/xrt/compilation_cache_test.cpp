@@ -0,0 +1,213 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/compilation_cache.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace oneflow {
+namespace xrt {
+
+namespace test {
+
+namespace {
+
+// Executables of the otherwise unused TVM engine, which serialize to their payload
+class FakeExecutable : public Executable {
+ public:
+  FakeExecutable(const std::string &name, const std::string &payload)
+      : Executable(name, XrtEngine::TVM), payload_(payload) {}
+
+  bool Run(const std::vector<Parameter> &inputs, const ExecutableRunOptions &run_options,
+           bool block_until_done = true) override {
+    return true;
+  }
+
+  bool Serialize(std::string *serialized) const override {
+    *serialized = payload_;
+    return true;
+  }
+
+  const std::string &payload() const { return payload_; }
+
+  static std::shared_ptr<Executable> Deserialize(const std::string &name,
+                                                 const std::string &serialized) {
+    return std::make_shared<FakeExecutable>(name, serialized);
+  }
+
+ private:
+  std::string payload_;
+};
+
+REGISTER_EXECUTABLE_DESERIALIZER(XrtEngine::TVM, FakeExecutable::Deserialize);
+
+Signature MakeSignature(const std::string &name, const Shape &shape) {
+  Signature signature;
+  signature.builder_name = name;
+  signature.device_ordinal = 0;
+  signature.entry_shapes.push_back(shape);
+  return signature;
+}
+
+std::string Payload(const std::shared_ptr<Executable> &executable) {
+  return dynamic_cast<FakeExecutable *>(executable.get())->payload();
+}
+
+}  // namespace
+
+TEST(CompilationCache, evict_least_recently_used) {
+  CompilationCache cache("evict", 2, "");
+  const Signature a = MakeSignature("launch", Shape({1, 4}));
+  const Signature b = MakeSignature("launch", Shape({2, 4}));
+  const Signature c = MakeSignature("launch", Shape({3, 4}));
+  cache.Record(a, std::make_shared<FakeExecutable>("launch", "a"));
+  cache.Record(b, std::make_shared<FakeExecutable>("launch", "b"));
+  // a is used after b, so b is evicted for c
+  ASSERT_EQ(Payload(cache.GetRecord(a)), "a");
+  cache.Record(c, std::make_shared<FakeExecutable>("launch", "c"));
+  ASSERT_EQ(cache.size(), 2);
+  ASSERT_TRUE(cache.GetRecord(b) == nullptr);
+  ASSERT_EQ(Payload(cache.GetRecord(a)), "a");
+  ASSERT_EQ(Payload(cache.GetRecord(c)), "c");
+  const CompilationCacheStats stats = cache.stats();
+  ASSERT_EQ(stats.hits, 3);
+  ASSERT_EQ(stats.misses, 1);
+  ASSERT_EQ(stats.evictions, 1);
+}
+
+TEST(CompilationCache, unbounded) {
+  CompilationCache cache("unbounded", -1, "");
+  FOR_RANGE(int64_t, i, 1, 101) {
+    cache.Record(MakeSignature("launch", Shape({i})),
+                 std::make_shared<FakeExecutable>("launch", std::to_string(i)));
+  }
+  ASSERT_EQ(cache.size(), 100);
+  ASSERT_EQ(cache.stats().evictions, 0);
+}
+
+TEST(ShapeBucketing, listed_buckets) {
+  ShapeBucketing bucketing("8,16,32");
+  ASSERT_TRUE(bucketing.enabled());
+  ASSERT_EQ(bucketing.Bucket(1, 64), 8);
+  ASSERT_EQ(bucketing.Bucket(8, 64), 8);
+  ASSERT_EQ(bucketing.Bucket(9, 64), 16);
+  ASSERT_EQ(bucketing.Bucket(17, 64), 32);
+  // beyond the largest bucket
+  ASSERT_EQ(bucketing.Bucket(33, 64), 33);
+  // never beyond the static dim
+  ASSERT_EQ(bucketing.Bucket(17, 24), 24);
+  ASSERT_EQ(bucketing.BucketShape(Shape({5, 3}), Shape({64, 3})), Shape({8, 3}));
+}
+
+TEST(ShapeBucketing, pow2) {
+  ShapeBucketing bucketing("pow2");
+  ASSERT_TRUE(bucketing.enabled());
+  ASSERT_EQ(bucketing.Bucket(1, 64), 1);
+  ASSERT_EQ(bucketing.Bucket(5, 64), 8);
+  ASSERT_EQ(bucketing.Bucket(33, 64), 64);
+  ASSERT_EQ(bucketing.Bucket(33, 48), 48);
+}
+
+TEST(ShapeBucketing, disabled) {
+  ShapeBucketing bucketing("");
+  ASSERT_FALSE(bucketing.enabled());
+  ASSERT_EQ(bucketing.BucketShape(Shape({5, 3}), Shape({64, 3})), Shape({5, 3}));
+}
+
+TEST(ShapeBucketing, share_executable) {
+  ShapeBucketing bucketing("8,16");
+  CompilationCache cache("bucketing", -1, "");
+  const Shape static_shape({16, 3});
+  cache.Record(MakeSignature("launch", bucketing.BucketShape(Shape({5, 3}), static_shape)),
+               std::make_shared<FakeExecutable>("launch", "8"));
+  FOR_RANGE(int64_t, i, 1, 9) {
+    const Signature signature =
+        MakeSignature("launch", bucketing.BucketShape(Shape({i, 3}), static_shape));
+    ASSERT_EQ(Payload(cache.GetRecord(signature)), "8");
+  }
+  const Signature signature =
+      MakeSignature("launch", bucketing.BucketShape(Shape({9, 3}), static_shape));
+  ASSERT_TRUE(cache.GetRecord(signature) == nullptr);
+}
+
+TEST(CompilationCache, persist_then_restore) {
+  const std::string persist_dir = JoinPath(GetCwd(), "tmp_compilation_cache_test_asdfasdf");
+  const Signature signature = MakeSignature("launch", Shape({8, 3}));
+  {
+    CompilationCache cache("fingerprint", -1, persist_dir);
+    ASSERT_TRUE(cache.GetRecord(signature) == nullptr);
+    cache.Record(signature, std::make_shared<FakeExecutable>("launch", "payload"));
+    cache.Persist(signature);
+  }
+  {
+    CompilationCache cache("fingerprint", -1, persist_dir);
+    ASSERT_EQ(Payload(cache.GetRecord(signature)), "payload");
+    ASSERT_EQ(cache.stats().restores, 1);
+    ASSERT_TRUE(cache.GetRecord(MakeSignature("launch", Shape({4, 3}))) == nullptr);
+  }
+  {
+    // executables of another function are not restored
+    CompilationCache cache("another_fingerprint", -1, persist_dir);
+    ASSERT_TRUE(cache.GetRecord(signature) == nullptr);
+    ASSERT_EQ(cache.stats().restores, 0);
+  }
+  LocalFS()->RecursivelyDeleteDir(persist_dir);
+}
+
+TEST(CompilationCache, reject_corrupt_file) {
+  const std::string persist_dir = JoinPath(GetCwd(), "tmp_compilation_cache_test_asdfasdf");
+  const Signature signature = MakeSignature("launch", Shape({8, 3}));
+  {
+    CompilationCache cache("fingerprint", -1, persist_dir);
+    cache.Record(signature, std::make_shared<FakeExecutable>("launch", "payload"));
+    cache.Persist(signature);
+  }
+  const std::vector<std::string> files = LocalFS()->ListDir(persist_dir);
+  ASSERT_EQ(files.size(), 1);
+  const std::string path = JoinPath(persist_dir, files.front());
+  std::string content;
+  {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    content = ss.str();
+  }
+  auto CheckRejected = [&](const std::string &corrupt_content) {
+    {
+      std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+      out.write(corrupt_content.data(), corrupt_content.size());
+    }
+    CompilationCache cache("fingerprint", -1, persist_dir);
+    ASSERT_TRUE(cache.GetRecord(signature) == nullptr);
+    ASSERT_EQ(cache.stats().restores, 0);
+  };
+  // truncated in the serialized executable
+  CheckRejected(content.substr(0, content.size() - 1));
+  // a key size far beyond the file, it follows the magic and the version
+  std::string huge_size = content;
+  const uint64_t size = uint64_t(1) << 60;
+  huge_size.replace(8, sizeof(size), reinterpret_cast<const char *>(&size), sizeof(size));
+  CheckRejected(huge_size);
+  LocalFS()->RecursivelyDeleteDir(persist_dir);
+}
+
+}  // namespace test
+
+}  // namespace xrt
+}  // namespace oneflow
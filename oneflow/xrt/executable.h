@@ -78,6 +78,10 @@ class Executable {
 
   const std::vector<Parameter> &Results() const { return results_; }
 
+  // Serialize the executable for the persistent compilation cache. It returns false
+  // if the engine does not support it, see `REGISTER_EXECUTABLE_DESERIALIZER`.
+  virtual bool Serialize(std::string *serialized) const { return false; }
+
  protected:
   // Executable name.
   std::string name_;
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/xrt/launch_kernel.h"
+#include "oneflow/user/summary/crc32c.h"
 #include "oneflow/xrt/api.h"
 #include "oneflow/xrt/compilation_cache.h"
 #include "oneflow/xrt/executable.h"
@@ -21,6 +22,9 @@ limitations under the License.
 #include "oneflow/xrt/platform.h"
 #include "oneflow/xrt/utility/env.h"
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 // General executable setup.
 DEFINE_int64(max_workspace_bytes, EnvToInt64(FLAGS_max_workspace_bytes, -1),
              "Maximum temporary workspace bytes.");
@@ -34,10 +38,43 @@ DECLARE_string(int8_calibration);
 
 namespace oneflow {
 namespace xrt {
-static Parameter BuildParameter(const Blob &blob, const std::string &name) {
+static Parameter BuildParameter(const Blob &blob, const std::string &name, const Shape &shape) {
+  const auto &desc = blob.blob_desc();
+  return Parameter(name, const_cast<void *>(blob.dptr<void>()), shape, desc.data_type());
+}
+
+// Dynamic blobs are computed with their runtime leading dim rounded up to a shape bucket,
+// and the padded rows live in the blob memory allocated for the static shape. Others are
+// computed with the static shape.
+static Shape EntryShape(const Blob &blob) {
   const auto &desc = blob.blob_desc();
-  return Parameter(name, const_cast<void *>(blob.dptr<void>()), desc.body_shape(),
-                   desc.data_type());
+  const ShapeBucketing &bucketing = ShapeBucketing::Default();
+  if (!desc.is_dynamic() || !bucketing.enabled()) { return desc.body_shape(); }
+  Shape shape;
+  blob.shape().ToShape(&shape);
+  return bucketing.BucketShape(shape, desc.body_shape());
+}
+
+// Persisted executables are only valid for the same function and engine. The function is
+// serialized deterministically and digested with crc32c so that the fingerprint stays the
+// same across runs and builds.
+static std::string LaunchFingerprint(const std::string &op_name, const XrtLaunchOpConf &conf) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream output(&serialized);
+    google::protobuf::io::CodedOutputStream coded(&output);
+    coded.SetSerializationDeterministic(true);
+    CHECK(conf.function().SerializeToCodedStream(&coded));
+  }
+  return op_name + "-" + conf.engine() + "-"
+         + std::to_string(summary::GetCrc32(serialized.data(), serialized.size()));
+}
+
+// Only outputs batched along the leading dim are computed with the bucketed rows
+static bool IsBatchedOnLeadingDim(const XrtLaunchOpConf &conf, const std::string &blob_name) {
+  const auto &batch_axis = conf.batch_axis();
+  const auto &it = batch_axis.find(blob_name);
+  return it != batch_axis.end() && it->second.has_value() && it->second.value() == 0;
 }
 }  // namespace xrt
 
@@ -50,7 +87,7 @@ void BlobDescGetter<device_type>::DumpEntryBlobDescTo(
   for (const auto &bn : kernel_->op_attribute().input_bns()) {
     const RtBlobDesc &runtime_desc = get_blob_fn_(bn)->blob_desc();
     BlobDesc blob_desc(kernel_->job_desc().DefaultDataType());
-    blob_desc.mut_shape() = runtime_desc.body_shape();
+    blob_desc.mut_shape() = xrt::EntryShape(*get_blob_fn_(bn));
     blob_desc.set_data_type(runtime_desc.data_type());
     blob_desc.set_is_dynamic(runtime_desc.is_dynamic());
     // Map blob_name to function's input name.
@@ -62,17 +99,21 @@ void BlobDescGetter<device_type>::DumpEntryBlobDescTo(
 }
 
 template<DeviceType device_type>
-xrt::Executable *XrtLaunchKernel<device_type>::BuildExecutable(
+std::shared_ptr<xrt::Executable> XrtLaunchKernel<device_type>::BuildExecutable(
     const std::vector<xrt::Parameter> &entry_params,
     const std::vector<xrt::Parameter> &return_params,
-    const std::vector<xrt::InputOutputAlias> &aliases, const int device_ordinal) const {
-  if (!compilation_cache_) { compilation_cache_.reset(new xrt::CompilationCache); }
+    const std::vector<xrt::InputOutputAlias> &aliases, const int device_ordinal,
+    xrt::Signature *signature, bool *is_new_executable) const {
+  if (!compilation_cache_) {
+    compilation_cache_.reset(new xrt::CompilationCache(
+        xrt::LaunchFingerprint(this->op_conf().name(), this->op_conf().xrt_launch_conf())));
+  }
 
-  xrt::Executable *executable = nullptr;
-  xrt::Signature signature =
-      xrt::ComputeSignature(this->op_conf().name(), device_ordinal, entry_params);
+  *is_new_executable = false;
+  std::shared_ptr<xrt::Executable> executable;
+  *signature = xrt::ComputeSignature(this->op_conf().name(), device_ordinal, entry_params);
   bool force_compile = false;
-  if (!force_compile) { executable = compilation_cache_->GetRecord(signature); }
+  if (!force_compile) { executable = compilation_cache_->GetRecord(*signature); }
 
   if (!executable) {
     VLOG(2) << "Build executable for launch op " << this->op_conf().name();
@@ -97,12 +138,12 @@ xrt::Executable *XrtLaunchKernel<device_type>::BuildExecutable(
     xrt::GraphCompiler compiler(this->op_conf().name(), engine, device, device_ordinal);
     auto result = compiler.Compile(graph.get(), entry_params, return_params, aliases);
     // Record new compilation result
-    compilation_cache_->Record(signature, result);
-    // Get compilation result from cache
-    executable = compilation_cache_->GetRecord(signature);
+    compilation_cache_->Record(*signature, result);
+    executable = result;
+    *is_new_executable = true;
   }
 
-  return std::move(executable);
+  return executable;
 }
 
 template<DeviceType device_type>
@@ -145,17 +186,33 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
   desc_getter_ = BlobDescGetter<device_type>(this, BnInOp2Blob);
   // Prepare input and output parameters
   std::vector<xrt::Parameter> entry_params, return_params;
+  // Leading dims of the first bucketed dynamic entry, which are (static, runtime, bucket)
+  int64_t static_batch = -1, runtime_batch = -1, bucket_batch = -1;
   for (const std::string &bn : this->op_attribute().input_bns()) {
     const LogicalBlobId &lbi = this->BnInOp2Lbi(bn);
     std::string blob_name = xrt::BlobIdToName(lbi);
-    xrt::Parameter input = xrt::BuildParameter(*BnInOp2Blob(bn), blob_name);
-    entry_params.push_back(input);
+    const Blob *blob = BnInOp2Blob(bn);
+    Shape shape = xrt::EntryShape(*blob);
+    if (static_batch < 0 && shape != blob->static_shape()) {
+      static_batch = blob->static_shape().At(0);
+      runtime_batch = blob->shape().At(0);
+      bucket_batch = shape.At(0);
+    }
+    entry_params.push_back(xrt::BuildParameter(*blob, blob_name, shape));
   }
   for (const std::string &bn : this->op_attribute().output_bns()) {
     const LogicalBlobId &lbi = this->BnInOp2Lbi(bn);
     std::string blob_name = xrt::BlobIdToName(lbi);
-    xrt::Parameter output = xrt::BuildParameter(*BnInOp2Blob(bn), blob_name);
-    return_params.push_back(output);
+    Blob *blob = BnInOp2Blob(bn);
+    Shape shape = blob->static_shape();
+    // Dynamic outputs batched like the bucketed entry are computed with padded rows
+    if (static_batch >= 0 && blob->blob_desc().is_dynamic() && shape.NumAxes() > 0
+        && xrt::IsBatchedOnLeadingDim(this->op_conf().xrt_launch_conf(), blob_name)
+        && shape.At(0) == static_batch) {
+      shape.Set(0, bucket_batch);
+      blob->mut_shape_view()->Set(0, runtime_batch);
+    }
+    return_params.push_back(xrt::BuildParameter(*blob, blob_name, shape));
   }
 
   xrt::XrtDevice device = xrt::DeviceTypeToXrtDevice(device_type);
@@ -165,7 +222,10 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
   // Mapping parameter names to function input and output names.
   MappingParamsToFunctionNames(&entry_params, &return_params);
   // Build executable.
-  auto executable = BuildExecutable(entry_params, return_params, aliases, device_ordinal);
+  xrt::Signature signature;
+  bool is_new_executable = false;
+  auto executable = BuildExecutable(entry_params, return_params, aliases, device_ordinal,
+                                    &signature, &is_new_executable);
   if (!executable) { LOG(FATAL) << "Executable is built failed."; }
   // Run executable.
   xrt::ExecutableRunOptions run_options;
@@ -179,7 +239,7 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
   }
   if (executable->engine() == xrt::XrtEngine::TENSORRT) {
     CHECK_EQ(device_type, DeviceType::kGPU);
-    run_options.max_batch_size = FLAGS_max_batch_size;
+    run_options.max_batch_size = std::max<int64_t>(FLAGS_max_batch_size, bucket_batch);
     run_options.tensorrt_fp16 = FLAGS_tensorrt_fp16;
     run_options.tensorrt_int8 = FLAGS_tensorrt_int8;
     run_options.tensorrt_int8_calibration = FLAGS_int8_calibration;
@@ -190,6 +250,8 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
   const std::vector<xrt::Parameter> &results = executable->Results();
   CHECK_EQ(results.size(), return_params.size());
   for (int i = 0; i < results.size(); ++i) { CHECK_EQ(results[i].data(), return_params[i].data()); }
+  // Engines such as TensorRT build lazily, so persist after the first run of a new executable
+  if (is_new_executable) { compilation_cache_->Persist(signature); }
 }
 
 // ADD_DEFAULT_KERNEL_CREATOR(OperatorConf::kXrtLaunchConf, XrtLaunchKernel,
@@ -52,10 +52,11 @@ class XrtLaunchKernel : public KernelIf<device_type> {
   void ForwardDataContent(const KernelCtx &ctx,
                           std::function<Blob *(const std::string &)> BnInOp2Blob) const override;
 
-  xrt::Executable *BuildExecutable(const std::vector<xrt::Parameter> &entry_params,
-                                   const std::vector<xrt::Parameter> &return_params,
-                                   const std::vector<xrt::InputOutputAlias> &aliases,
-                                   const int device_ordinal) const;
+  std::shared_ptr<xrt::Executable> BuildExecutable(
+      const std::vector<xrt::Parameter> &entry_params,
+      const std::vector<xrt::Parameter> &return_params,
+      const std::vector<xrt::InputOutputAlias> &aliases, const int device_ordinal,
+      xrt::Signature *signature, bool *is_new_executable) const;
 
   void MakeInputOutputAlias(                            // NOLINT
       const std::vector<xrt::Parameter> &entry_params,  // NOLINT
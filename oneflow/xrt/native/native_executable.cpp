@@ -0,0 +1,487 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_executable.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/xrt/compilation_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+namespace {
+
+// Elements evaluated per register slot, small enough to keep a group's slots in L1/L2
+constexpr int64_t kNativeBlockSize = 512;
+constexpr size_t kNativeMinElemCntPerThread = 16384;
+constexpr int64_t kNativeTempBufferAlignment = 64;
+
+template<typename T>
+struct ReluFunctor {
+  static T Invoke(T x) { return x > static_cast<T>(0) ? x : static_cast<T>(0); }
+};
+
+template<typename T>
+struct SigmoidFunctor {
+  static T Invoke(T x) { return static_cast<T>(1.0 / (1.0 + std::exp(-static_cast<double>(x)))); }
+};
+
+template<>
+struct SigmoidFunctor<float> {
+  static float Invoke(float x) { return 1.f / (1.f + std::exp(-x)); }
+};
+
+template<typename T>
+struct TanhFunctor {
+  static T Invoke(T x) { return static_cast<T>(std::tanh(x)); }
+};
+
+template<typename T>
+struct GeluFunctor {
+  static T Invoke(T x) {
+    return static_cast<T>(0.5 * x * (1.0 + std::erf(static_cast<double>(x) * M_SQRT1_2)));
+  }
+};
+
+template<>
+struct GeluFunctor<float> {
+  static float Invoke(float x) {
+    return 0.5f * x * (1.f + std::erf(x * static_cast<float>(M_SQRT1_2)));
+  }
+};
+
+template<typename T>
+struct IdentityFunctor {
+  static T Invoke(T x) { return x; }
+};
+
+template<typename T>
+struct NegativeFunctor {
+  static T Invoke(T x) { return -x; }
+};
+
+template<typename T>
+struct AddFunctor {
+  static T Invoke(T x, T y) { return x + y; }
+};
+
+template<typename T>
+struct SubFunctor {
+  static T Invoke(T x, T y) { return x - y; }
+};
+
+template<typename T>
+struct MulFunctor {
+  static T Invoke(T x, T y) { return x * y; }
+};
+
+template<typename T>
+struct DivFunctor {
+  static T Invoke(T x, T y) { return x / y; }
+};
+
+template<typename T, template<typename> class Functor>
+void UnaryLoop(int64_t n, const T *x, T *y) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = Functor<T>::Invoke(x[i]); }
+}
+
+template<typename T, template<typename> class Functor>
+void BinaryLoop(int64_t n, const T *x, const T *y, T *z) {
+  for (int64_t i = 0; i < n; ++i) { z[i] = Functor<T>::Invoke(x[i], y[i]); }
+}
+
+template<typename T, template<typename> class Functor>
+void ScalarLoop(int64_t n, const T *x, const T scalar, T *y) {
+  for (int64_t i = 0; i < n; ++i) { y[i] = Functor<T>::Invoke(x[i], scalar); }
+}
+
+template<typename T>
+void ComputeStep(const NativeFusedStep &step, int64_t n, const std::vector<const T *> &in, T *out) {
+  switch (step.opcode) {
+#define NATIVE_UNARY_CASE(opcode, functor) \
+  case NativeOpcode::opcode: UnaryLoop<T, functor>(n, in[0], out); break;
+#define NATIVE_BINARY_CASE(opcode, functor) \
+  case NativeOpcode::opcode: BinaryLoop<T, functor>(n, in[0], in[1], out); break;
+    NATIVE_UNARY_CASE(kIdentity, IdentityFunctor)
+    NATIVE_UNARY_CASE(kRelu, ReluFunctor)
+    NATIVE_UNARY_CASE(kSigmoid, SigmoidFunctor)
+    NATIVE_UNARY_CASE(kTanh, TanhFunctor)
+    NATIVE_UNARY_CASE(kGelu, GeluFunctor)
+    NATIVE_UNARY_CASE(kNegative, NegativeFunctor)
+    NATIVE_BINARY_CASE(kAdd, AddFunctor)
+    NATIVE_BINARY_CASE(kSub, SubFunctor)
+    NATIVE_BINARY_CASE(kMul, MulFunctor)
+    NATIVE_BINARY_CASE(kDiv, DivFunctor)
+#undef NATIVE_UNARY_CASE
+#undef NATIVE_BINARY_CASE
+    case NativeOpcode::kScalarAdd:
+      ScalarLoop<T, AddFunctor>(n, in[0], static_cast<T>(step.scalar), out);
+      break;
+    case NativeOpcode::kScalarMul:
+      ScalarLoop<T, MulFunctor>(n, in[0], static_cast<T>(step.scalar), out);
+      break;
+    default: LOG(FATAL) << "Opcode " << static_cast<int>(step.opcode) << " can not be fused.";
+  }
+}
+
+// Maps flat indices of `shape` to offsets of an operand broadcast to `shape`
+class BroadcastIndexer {
+ public:
+  BroadcastIndexer(const Shape &operand_shape, const Shape &shape) : num_axes_(shape.NumAxes()) {
+    CHECK_LE(num_axes_, SHAPE_MAX_AXIS_SIZE);
+    int64_t stride = 1;
+    for (int64_t i = num_axes_ - 1; i >= 0; --i) {
+      const int64_t operand_axis = operand_shape.NumAxes() - num_axes_ + i;
+      const int64_t operand_dim = operand_axis < 0 ? 1 : operand_shape.At(operand_axis);
+      dims_[i] = shape.At(i);
+      strides_[i] = operand_dim == 1 ? 0 : stride;
+      stride *= operand_dim;
+    }
+  }
+
+  // Copies `n` broadcast elements starting at flat index `pos` into `dst`
+  template<typename T>
+  void Gather(const T *src, int64_t pos, int64_t n, T *dst) const {
+    if (num_axes_ == 0) {
+      std::fill(dst, dst + n, src[0]);
+      return;
+    }
+    int64_t coords[SHAPE_MAX_AXIS_SIZE];
+    int64_t offset = 0;
+    for (int64_t i = num_axes_ - 1; i >= 0; --i) {
+      coords[i] = pos % dims_[i];
+      pos /= dims_[i];
+      offset += coords[i] * strides_[i];
+    }
+    const int64_t last = num_axes_ - 1;
+    while (n > 0) {
+      const int64_t run = std::min(n, dims_[last] - coords[last]);
+      const int64_t inner_stride = strides_[last];
+      if (inner_stride == 0) {
+        std::fill(dst, dst + run, src[offset]);
+      } else {
+        for (int64_t j = 0; j < run; ++j) { dst[j] = src[offset + j * inner_stride]; }
+      }
+      dst += run;
+      n -= run;
+      // Carry to outer axes without division
+      offset += (run - 1) * inner_stride;
+      coords[last] += run - 1;
+      for (int64_t i = last; i >= 0; --i) {
+        if (coords[i] + 1 < dims_[i]) {
+          coords[i] += 1;
+          offset += strides_[i];
+          break;
+        }
+        offset -= coords[i] * strides_[i];
+        coords[i] = 0;
+      }
+    }
+  }
+
+ private:
+  int64_t num_axes_;
+  int64_t dims_[SHAPE_MAX_AXIS_SIZE];
+  int64_t strides_[SHAPE_MAX_AXIS_SIZE];
+};
+
+}  // namespace
+
+NativeExecutable::NativeExecutable(const std::string &name, const NativeProgramBuilder &program,
+                                   const std::vector<int64_t> &return_values)
+    : NativeExecutable(name, program.data_type(), program.instructions(), return_values) {}
+
+NativeExecutable::NativeExecutable(const std::string &name, const DataType &data_type,
+                                   const std::vector<NativeInstruction> &instructions,
+                                   const std::vector<int64_t> &return_values)
+    : Executable(name, XrtEngine::NATIVE),
+      instructions_(instructions),
+      data_type_(data_type),
+      return_values_(return_values) {
+  PlanFusedGroups();
+  PlanValueLocations();
+  temp_buffer_.resize(temp_buffer_size_);
+}
+
+bool NativeExecutable::Serialize(std::string *serialized) const {
+  std::ostringstream out;
+  out << data_type_ << " " << instructions_.size() << "\n";
+  for (const NativeInstruction &instruction : instructions_) {
+    out << static_cast<int>(instruction.opcode) << " " << instruction.parameter_index << " "
+        << std::setprecision(17) << instruction.scalar << " " << instruction.operands.size();
+    for (int64_t operand : instruction.operands) { out << " " << operand; }
+    out << " " << instruction.shape.NumAxes();
+    for (int64_t dim : instruction.shape.dim_vec()) { out << " " << dim; }
+    out << "\n";
+  }
+  out << return_values_.size();
+  for (int64_t value : return_values_) { out << " " << value; }
+  *serialized = out.str();
+  return true;
+}
+
+std::shared_ptr<Executable> NativeExecutable::Deserialize(const std::string &name,
+                                                          const std::string &serialized) {
+  std::istringstream in(serialized);
+  int data_type = 0;
+  size_t num_instructions = 0;
+  in >> data_type >> num_instructions;
+  std::vector<NativeInstruction> instructions(num_instructions);
+  for (NativeInstruction &instruction : instructions) {
+    int opcode = 0;
+    size_t num_operands = 0, num_axes = 0;
+    in >> opcode >> instruction.parameter_index >> instruction.scalar >> num_operands;
+    instruction.opcode = static_cast<NativeOpcode>(opcode);
+    instruction.operands.resize(num_operands);
+    for (int64_t &operand : instruction.operands) { in >> operand; }
+    in >> num_axes;
+    DimVector dim_vec(num_axes);
+    for (int64_t &dim : dim_vec) { in >> dim; }
+    instruction.shape = Shape(dim_vec);
+  }
+  size_t num_returns = 0;
+  in >> num_returns;
+  std::vector<int64_t> return_values(num_returns);
+  for (int64_t &value : return_values) { in >> value; }
+  if (!in) { return nullptr; }
+  return std::make_shared<NativeExecutable>(name, static_cast<DataType>(data_type), instructions,
+                                            return_values);
+}
+
+REGISTER_EXECUTABLE_DESERIALIZER(XrtEngine::NATIVE, NativeExecutable::Deserialize);
+
+bool NativeExecutable::IsBufferValue(int64_t value) const {
+  const NativeOpcode opcode = instructions_.at(value).opcode;
+  return opcode == NativeOpcode::kParameter || opcode == NativeOpcode::kReshape;
+}
+
+void NativeExecutable::PlanFusedGroups() {
+  // A value can be fused with its operand only if both are computed over the same shape,
+  // otherwise the operand has to be materialized by an earlier stage.
+  const int64_t num_values = instructions_.size();
+  std::vector<int64_t> stages(num_values, 0);
+  for (int64_t value = 0; value < num_values; ++value) {
+    const NativeInstruction &instruction = instructions_[value];
+    int64_t stage = 0;
+    for (int64_t operand : instruction.operands) {
+      const bool same_loop =
+          IsBufferValue(operand) || instructions_[operand].shape == instruction.shape;
+      stage = std::max(stage, stages[operand] + (same_loop ? 0 : 1));
+    }
+    if (instruction.opcode == NativeOpcode::kReshape && !IsBufferValue(instruction.operands[0])) {
+      stage = stages[instruction.operands[0]] + 1;
+    }
+    stages[value] = stage;
+  }
+
+  std::vector<int64_t> value2group(num_values, -1);
+  std::map<std::pair<int64_t, std::string>, int64_t> key2group;
+  std::vector<std::pair<int64_t, int64_t>> group_order;
+  std::vector<std::vector<int64_t>> group_values;
+  for (int64_t value = 0; value < num_values; ++value) {
+    if (IsBufferValue(value)) { continue; }
+    const auto key = std::make_pair(stages[value], instructions_[value].shape.ToString());
+    auto it = key2group.find(key);
+    if (it == key2group.end()) {
+      it = key2group.emplace(key, group_values.size()).first;
+      group_order.emplace_back(stages[value], group_values.size());
+      group_values.emplace_back();
+    }
+    value2group[value] = it->second;
+    group_values[it->second].push_back(value);
+  }
+  std::stable_sort(group_order.begin(), group_order.end(),
+                   [](const std::pair<int64_t, int64_t> &lhs,
+                      const std::pair<int64_t, int64_t> &rhs) { return lhs.first < rhs.first; });
+
+  std::vector<bool> materialized(num_values, false);
+  for (int64_t value : return_values_) { materialized[value] = true; }
+  for (int64_t value = 0; value < num_values; ++value) {
+    for (int64_t operand : instructions_[value].operands) {
+      if (IsBufferValue(value) || value2group[value] != value2group[operand]) {
+        materialized[operand] = true;
+      }
+    }
+  }
+
+  groups_.clear();
+  for (const auto &stage_and_group : group_order) {
+    const std::vector<int64_t> &values = group_values[stage_and_group.second];
+    NativeFusedGroup group;
+    group.shape = instructions_[values.front()].shape;
+    std::map<int64_t, int64_t> value2slot;
+    auto GetSlot = [&](int64_t value) {
+      auto it = value2slot.find(value);
+      if (it == value2slot.end()) {
+        it = value2slot.emplace(value, group.num_slots++).first;
+        if (value2group[value] != stage_and_group.second) { group.loads.emplace_back(*it); }
+      }
+      return it->second;
+    };
+    for (int64_t value : values) {
+      const NativeInstruction &instruction = instructions_[value];
+      NativeFusedStep step;
+      step.opcode = instruction.opcode;
+      step.scalar = instruction.scalar;
+      for (int64_t operand : instruction.operands) { step.in_slots.push_back(GetSlot(operand)); }
+      step.out_slot = GetSlot(value);
+      if (materialized[value]) { step.store_value = value; }
+      group.steps.push_back(std::move(step));
+    }
+    groups_.push_back(std::move(group));
+  }
+}
+
+void NativeExecutable::PlanValueLocations() {
+  const int64_t num_values = instructions_.size();
+  const int64_t elem_size = SizeOf(data_type_);
+  std::vector<bool> stored(num_values, false);
+  for (const NativeFusedGroup &group : groups_) {
+    for (const NativeFusedStep &step : group.steps) {
+      if (step.store_value >= 0) { stored[step.store_value] = true; }
+    }
+  }
+  value2location_.assign(num_values, NativeValueLocation());
+  for (int64_t i = 0; i < return_values_.size(); ++i) {
+    const int64_t value = return_values_[i];
+    if (!IsBufferValue(value) && value2location_[value].kind == NativeValueLocation::kNone) {
+      value2location_[value].kind = NativeValueLocation::kReturn;
+      value2location_[value].index = i;
+    }
+  }
+  // Values kept only in registers of a fused loop have no location
+  temp_buffer_size_ = 0;
+  for (int64_t value = 0; value < num_values; ++value) {
+    const NativeInstruction &instruction = instructions_[value];
+    NativeValueLocation *location = &value2location_[value];
+    if (instruction.opcode == NativeOpcode::kParameter) {
+      location->kind = NativeValueLocation::kEntry;
+      location->index = instruction.parameter_index;
+    } else if (instruction.opcode == NativeOpcode::kReshape) {
+      *location = value2location_[instruction.operands[0]];
+    } else if (stored[value] && location->kind == NativeValueLocation::kNone) {
+      location->kind = NativeValueLocation::kTemp;
+      location->index = temp_buffer_size_;
+      const int64_t byte_size = instruction.shape.elem_cnt() * elem_size;
+      temp_buffer_size_ += (byte_size + kNativeTempBufferAlignment - 1)
+                           / kNativeTempBufferAlignment * kNativeTempBufferAlignment;
+    }
+  }
+}
+
+char *NativeExecutable::ValuePtr(int64_t value, const std::vector<Parameter> &inputs,
+                                 const std::vector<Parameter> &outputs) {
+  const NativeValueLocation &location = value2location_.at(value);
+  switch (location.kind) {
+    case NativeValueLocation::kEntry:
+      return reinterpret_cast<char *>(inputs.at(location.index).data());
+    case NativeValueLocation::kReturn:
+      return reinterpret_cast<char *>(outputs.at(location.index).data());
+    case NativeValueLocation::kTemp: return temp_buffer_.data() + location.index;
+    default: LOG(FATAL) << "Value " << value << " of " << name_ << " is not materialized.";
+  }
+  return nullptr;
+}
+
+template<typename T>
+void NativeExecutable::RunFusedGroup(const NativeFusedGroup &group,
+                                     const std::vector<Parameter> &inputs,
+                                     const std::vector<Parameter> &outputs) {
+  const int64_t elem_cnt = group.shape.elem_cnt();
+  std::vector<const T *> load_ptrs;
+  std::vector<BroadcastIndexer> load_indexers;
+  std::vector<bool> load_contiguous;
+  for (const auto &load : group.loads) {
+    load_ptrs.push_back(reinterpret_cast<const T *>(ValuePtr(load.first, inputs, outputs)));
+    const Shape &shape = instructions_[load.first].shape;
+    load_indexers.emplace_back(shape, group.shape);
+    load_contiguous.push_back(shape.elem_cnt() == elem_cnt);
+  }
+  std::vector<T *> store_ptrs;
+  for (const NativeFusedStep &step : group.steps) {
+    store_ptrs.push_back(step.store_value < 0
+                             ? nullptr
+                             : reinterpret_cast<T *>(ValuePtr(step.store_value, inputs, outputs)));
+  }
+
+  MultiThreadRangeLoop(elem_cnt, kNativeMinElemCntPerThread, [&](size_t begin, size_t end) {
+    std::vector<T> registers(group.num_slots * kNativeBlockSize);
+    std::vector<const T *> slots(group.num_slots, nullptr);
+    std::vector<const T *> in;
+    for (int64_t pos = begin; pos < static_cast<int64_t>(end); pos += kNativeBlockSize) {
+      const int64_t n = std::min<int64_t>(kNativeBlockSize, end - pos);
+      for (int64_t i = 0; i < group.loads.size(); ++i) {
+        const int64_t slot = group.loads[i].second;
+        if (load_contiguous[i]) {
+          slots[slot] = load_ptrs[i] + pos;
+        } else {
+          T *dst = registers.data() + slot * kNativeBlockSize;
+          load_indexers[i].Gather(load_ptrs[i], pos, n, dst);
+          slots[slot] = dst;
+        }
+      }
+      for (int64_t i = 0; i < group.steps.size(); ++i) {
+        const NativeFusedStep &step = group.steps[i];
+        in.clear();
+        for (int64_t slot : step.in_slots) { in.push_back(slots[slot]); }
+        T *out = store_ptrs[i] != nullptr ? store_ptrs[i] + pos
+                                          : registers.data() + step.out_slot * kNativeBlockSize;
+        ComputeStep<T>(step, n, in, out);
+        slots[step.out_slot] = out;
+      }
+    }
+  });
+}
+
+template<typename T>
+void NativeExecutable::RunImpl(const std::vector<Parameter> &inputs,
+                               const std::vector<Parameter> &outputs) {
+  for (const NativeFusedGroup &group : groups_) { RunFusedGroup<T>(group, inputs, outputs); }
+  // Returned values which are parameters, reshapes or returned more than once
+  for (int64_t i = 0; i < return_values_.size(); ++i) {
+    const int64_t value = return_values_[i];
+    const NativeValueLocation &location = value2location_[value];
+    if (location.kind == NativeValueLocation::kReturn && location.index == i) { continue; }
+    const char *src = ValuePtr(value, inputs, outputs);
+    char *dst = reinterpret_cast<char *>(outputs[i].data());
+    if (src != dst) { std::memcpy(dst, src, outputs[i].byte_size()); }
+  }
+}
+
+bool NativeExecutable::Run(const std::vector<Parameter> &inputs,
+                           const ExecutableRunOptions &run_options, bool block_until_done) {
+  const std::vector<Parameter> &outputs = run_options.return_params;
+  CHECK_EQ(outputs.size(), return_values_.size());
+  switch (data_type_) {
+    case DataType::kFloat: RunImpl<float>(inputs, outputs); break;
+    case DataType::kDouble: RunImpl<double>(inputs, outputs); break;
+    case DataType::kInt32: RunImpl<int32_t>(inputs, outputs); break;
+    case DataType::kInt64: RunImpl<int64_t>(inputs, outputs); break;
+    default: LOG(FATAL) << "Unsupported data type " << data_type_ << " for native executable.";
+  }
+  this->results_ = outputs;
+  return true;
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
@@ -0,0 +1,104 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_NATIVE_NATIVE_EXECUTABLE_H_
+#define ONEFLOW_XRT_NATIVE_NATIVE_EXECUTABLE_H_
+
+#include <memory>
+#include <vector>
+
+#include "oneflow/xrt/executable.h"
+#include "oneflow/xrt/native/native_program.h"
+#include "oneflow/xrt/parameter.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+// Where a value lives when it is not kept in registers of a fused loop
+struct NativeValueLocation {
+  enum Kind { kNone = 0, kEntry, kReturn, kTemp };
+  Kind kind = kNone;
+  // Entry or return parameter index, or byte offset in the temp buffer
+  int64_t index = -1;
+};
+
+// One instruction of a fused loop reading and writing register slots
+struct NativeFusedStep {
+  NativeOpcode opcode;
+  int64_t out_slot = -1;
+  std::vector<int64_t> in_slots;
+  double scalar = 0;
+  // Value written straight to its location instead of a register slot
+  int64_t store_value = -1;
+};
+
+// Values computed by one loop nest over `shape`. Operands produced outside the group
+// are loaded from their locations with broadcasting.
+struct NativeFusedGroup {
+  Shape shape;
+  int64_t num_slots = 0;
+  // (value, slot) of the operands loaded from memory
+  std::vector<std::pair<int64_t, int64_t>> loads;
+  std::vector<NativeFusedStep> steps;
+};
+
+class NativeExecutable : public Executable {
+ public:
+  NativeExecutable(const std::string &name, const NativeProgramBuilder &program,
+                   const std::vector<int64_t> &return_values);
+  NativeExecutable(const std::string &name, const DataType &data_type,
+                   const std::vector<NativeInstruction> &instructions,
+                   const std::vector<int64_t> &return_values);
+  virtual ~NativeExecutable() = default;
+
+  bool Run(const std::vector<Parameter> &inputs, const ExecutableRunOptions &run_options,
+           bool block_until_done = true) override;
+
+  bool Serialize(std::string *serialized) const override;
+
+  static std::shared_ptr<Executable> Deserialize(const std::string &name,
+                                                 const std::string &serialized);
+
+ private:
+  void PlanFusedGroups();
+  void PlanValueLocations();
+
+  template<typename T>
+  void RunFusedGroup(const NativeFusedGroup &group, const std::vector<Parameter> &inputs,
+                     const std::vector<Parameter> &outputs);
+  template<typename T>
+  void RunImpl(const std::vector<Parameter> &inputs, const std::vector<Parameter> &outputs);
+
+  char *ValuePtr(int64_t value, const std::vector<Parameter> &inputs,
+                 const std::vector<Parameter> &outputs);
+
+  bool IsBufferValue(int64_t value) const;
+
+  std::vector<NativeInstruction> instructions_;
+  DataType data_type_;
+  std::vector<int64_t> return_values_;
+
+  std::vector<NativeFusedGroup> groups_;
+  std::vector<NativeValueLocation> value2location_;
+  int64_t temp_buffer_size_ = 0;
+  std::vector<char> temp_buffer_;
+};
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_NATIVE_NATIVE_EXECUTABLE_H_
@@ -0,0 +1,101 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_graph_compiler.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+#include "oneflow/xrt/node_util.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+void NativeGraphCompiler::PopulateEntryParams(const std::vector<Parameter> &entry_params) {
+  for (int i = 0; i < entry_params.size(); ++i) {
+    const Parameter &param = entry_params[i];
+    Argument arg = ArgFromParameter(param);
+    operands_[arg] = builder_->Parameter(i, param.shape(), param.data_type());
+  }
+}
+
+Argument NativeGraphCompiler::ArgFromParameter(const Parameter &param) {
+  return Argument(param.name(), param.shape(), param.data_type());
+}
+
+void NativeGraphCompiler::SetupKernelContextParam(const XrtNode *node,
+                                                  NativeOpContext::Param *context_param) {
+  util::Map<Argument, int64_t> input_ops;
+  util::Map<std::string /* produce/consume key */, Argument> input_output_args;
+  std::vector<std::string> output_names;
+  for (const XrtEdge *edge : node->in_edges()) {
+    if (!edge->IsControlEdge()) {
+      const Argument &arg = edge->argument();
+      CHECK_GT(operands_.count(arg), 0);
+      input_ops.emplace(arg, operands_.at(arg));
+      const std::string &k = arg.meta_data().consume_key;
+      input_output_args.emplace(k, arg);
+    }
+  }
+  for (const XrtEdge *edge : node->out_edges()) {
+    if (!edge->IsControlEdge()) {
+      const Argument &arg = edge->argument();
+      const std::string &k = arg.meta_data().produce_key;
+      input_output_args.emplace(k, arg);
+      output_names.push_back(k);
+    }
+  }
+
+  size_t num_outputs = input_output_args.size() - input_ops.size();
+  CHECK_GE(num_outputs, 0) << "Outputs number should >= 0.";
+  context_param->op_name = node->name();
+  context_param->builder = builder_.get();
+  context_param->message = OpMessage(node);
+  context_param->arguments = std::move(input_output_args);
+  context_param->inputs = std::move(input_ops);
+  context_param->output_names = std::move(output_names);
+  context_param->num_outputs = num_outputs;
+}
+
+std::shared_ptr<Executable> NativeGraphCompiler::Compile(
+    const XrtGraph *graph, const std::vector<Parameter> &entry_params,
+    const std::vector<Parameter> &return_params, const std::vector<InputOutputAlias> &aliases) {
+  PopulateEntryParams(entry_params);
+
+  algorithm::TopologyVisit(*graph, [&](const XrtNode *node) {
+    NativeOpContext::Param param;
+    SetupKernelContextParam(node, &param);
+    NativeOpContext op_context(param);
+    auto op_kernel = BuildOpKernel(node->type());
+    op_kernel->Compile(&op_context);
+
+    const auto &outputs = op_context.outputs();
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+      operands_[it->first] = it->second;
+    }
+  });
+
+  std::vector<int64_t> return_values;
+  for (const Parameter &param : return_params) {
+    Argument arg = ArgFromParameter(param);
+    CHECK_GT(operands_.count(arg), 0) << "Return " << param.name() << " is not computed.";
+    return_values.push_back(operands_.at(arg));
+  }
+  return std::make_shared<NativeExecutable>(builder_->name(), *builder_, return_values);
+}
+
+REGISTER_GRAPH_COMPILER(XrtEngine::NATIVE, NativeGraphCompiler);
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
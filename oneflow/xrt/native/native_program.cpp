@@ -0,0 +1,115 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/native_program.h"
+#include "glog/logging.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+namespace {
+
+Shape BroadcastShape(const Shape &lhs, const Shape &rhs) {
+  const int64_t num_axes = std::max(lhs.NumAxes(), rhs.NumAxes());
+  DimVector dim_vec(num_axes);
+  for (int64_t i = 0; i < num_axes; ++i) {
+    const int64_t lhs_axis = lhs.NumAxes() - num_axes + i;
+    const int64_t rhs_axis = rhs.NumAxes() - num_axes + i;
+    const int64_t lhs_dim = lhs_axis < 0 ? 1 : lhs.At(lhs_axis);
+    const int64_t rhs_dim = rhs_axis < 0 ? 1 : rhs.At(rhs_axis);
+    CHECK(lhs_dim == rhs_dim || lhs_dim == 1 || rhs_dim == 1)
+        << "Shapes " << lhs.ToString() << " and " << rhs.ToString() << " can not be broadcast.";
+    dim_vec[i] = std::max(lhs_dim, rhs_dim);
+  }
+  return Shape(dim_vec);
+}
+
+}  // namespace
+
+bool IsUnaryOpcode(NativeOpcode opcode) {
+  return opcode >= NativeOpcode::kIdentity && opcode <= NativeOpcode::kNegative;
+}
+
+bool IsBinaryOpcode(NativeOpcode opcode) {
+  return opcode >= NativeOpcode::kAdd && opcode <= NativeOpcode::kDiv;
+}
+
+bool IsScalarOpcode(NativeOpcode opcode) {
+  return opcode == NativeOpcode::kScalarAdd || opcode == NativeOpcode::kScalarMul;
+}
+
+int64_t NativeProgramBuilder::AddInstruction(NativeInstruction instruction) {
+  for (int64_t operand : instruction.operands) {
+    CHECK_GE(operand, 0);
+    CHECK_LT(operand, instructions_.size());
+  }
+  instructions_.push_back(std::move(instruction));
+  return instructions_.size() - 1;
+}
+
+int64_t NativeProgramBuilder::Parameter(int64_t parameter_index, const Shape &shape,
+                                        const DataType &data_type) {
+  if (data_type_ == DataType::kInvalidDataType) { data_type_ = data_type; }
+  CHECK_EQ(data_type_, data_type) << "Native program " << name_
+                                  << " only supports values of one data type.";
+  NativeInstruction instruction;
+  instruction.opcode = NativeOpcode::kParameter;
+  instruction.shape = shape;
+  instruction.parameter_index = parameter_index;
+  return AddInstruction(std::move(instruction));
+}
+
+int64_t NativeProgramBuilder::Reshape(int64_t operand, const Shape &shape) {
+  CHECK_EQ(ValueShape(operand).elem_cnt(), shape.elem_cnt());
+  if (ValueShape(operand) == shape) { return operand; }
+  NativeInstruction instruction;
+  instruction.opcode = NativeOpcode::kReshape;
+  instruction.operands = {operand};
+  instruction.shape = shape;
+  return AddInstruction(std::move(instruction));
+}
+
+int64_t NativeProgramBuilder::Unary(NativeOpcode opcode, int64_t operand) {
+  CHECK(IsUnaryOpcode(opcode));
+  NativeInstruction instruction;
+  instruction.opcode = opcode;
+  instruction.operands = {operand};
+  instruction.shape = ValueShape(operand);
+  return AddInstruction(std::move(instruction));
+}
+
+int64_t NativeProgramBuilder::Binary(NativeOpcode opcode, int64_t lhs, int64_t rhs) {
+  CHECK(IsBinaryOpcode(opcode));
+  NativeInstruction instruction;
+  instruction.opcode = opcode;
+  instruction.operands = {lhs, rhs};
+  instruction.shape = BroadcastShape(ValueShape(lhs), ValueShape(rhs));
+  return AddInstruction(std::move(instruction));
+}
+
+int64_t NativeProgramBuilder::Scalar(NativeOpcode opcode, int64_t operand, double scalar) {
+  CHECK(IsScalarOpcode(opcode));
+  NativeInstruction instruction;
+  instruction.opcode = opcode;
+  instruction.operands = {operand};
+  instruction.shape = ValueShape(operand);
+  instruction.scalar = scalar;
+  return AddInstruction(std::move(instruction));
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
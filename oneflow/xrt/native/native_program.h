@@ -0,0 +1,95 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
+#define ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
+
+#include <string>
+#include <vector>
+
+#include "oneflow/core/common/data_type.pb.h"
+#include "oneflow/core/common/shape.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+enum class NativeOpcode {
+  // Leaf value bound to an entry parameter
+  kParameter = 0,
+  // Same elements as the operand viewed with another shape
+  kReshape,
+  // Unary
+  kIdentity,
+  kRelu,
+  kSigmoid,
+  kTanh,
+  kGelu,
+  kNegative,
+  // Binary with numpy style broadcasting
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  // Binary with a scalar operand
+  kScalarAdd,
+  kScalarMul,
+};
+
+bool IsUnaryOpcode(NativeOpcode opcode);
+bool IsBinaryOpcode(NativeOpcode opcode);
+bool IsScalarOpcode(NativeOpcode opcode);
+
+// A value of the program is the output of the instruction with the same index
+struct NativeInstruction {
+  NativeOpcode opcode;
+  std::vector<int64_t> operands;
+  Shape shape;
+  // Entry parameter index of kParameter
+  int64_t parameter_index = -1;
+  // Scalar operand of kScalar*
+  double scalar = 0;
+};
+
+// Records elementwise computations of a cluster as a flat list of instructions in
+// topological order. All values share the data type of the program.
+class NativeProgramBuilder {
+ public:
+  explicit NativeProgramBuilder(const std::string &name) : name_(name) {}
+
+  int64_t Parameter(int64_t parameter_index, const Shape &shape, const DataType &data_type);
+  int64_t Reshape(int64_t operand, const Shape &shape);
+  int64_t Unary(NativeOpcode opcode, int64_t operand);
+  int64_t Binary(NativeOpcode opcode, int64_t lhs, int64_t rhs);
+  int64_t Scalar(NativeOpcode opcode, int64_t operand, double scalar);
+
+  const Shape &ValueShape(int64_t value) const { return instructions_.at(value).shape; }
+  const std::string &name() const { return name_; }
+  const DataType &data_type() const { return data_type_; }
+  const std::vector<NativeInstruction> &instructions() const { return instructions_; }
+
+ private:
+  int64_t AddInstruction(NativeInstruction instruction);
+
+  std::string name_;
+  DataType data_type_ = DataType::kInvalidDataType;
+  std::vector<NativeInstruction> instructions_;
+};
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_NATIVE_NATIVE_PROGRAM_H_
@@ -0,0 +1,99 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "absl/strings/str_cat.h"
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+template<NativeOpcode opcode>
+class BcastBinaryOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    int64_t x = ctx->Input("x_0");
+    int64_t y = ctx->Input("y_0");
+    ctx->SetOutput("z_0", ctx->builder()->Binary(opcode, x, y));
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(BcastAdd, BcastBinaryOp<NativeOpcode::kAdd>)
+    .EnableTrainPhase()
+    .Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastMul, BcastBinaryOp<NativeOpcode::kMul>)
+    .EnableTrainPhase()
+    .Finalize();
+REGISTER_NATIVE_OP_KERNEL(BcastDiv, BcastBinaryOp<NativeOpcode::kDiv>)
+    .EnableTrainPhase()
+    .Finalize();
+
+class MultiplyOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    CHECK_EQ(ctx->InputShape("x_0"), ctx->InputShape("y_0"));
+    int64_t x = ctx->Input("x_0");
+    int64_t y = ctx->Input("y_0");
+    ctx->SetOutput("out_0", ctx->builder()->Binary(NativeOpcode::kMul, x, y));
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(Multiply, MultiplyOp).EnableTrainPhase().Finalize();
+
+class AddOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    int num_inputs = ctx->num_inputs();
+    CHECK_GT(num_inputs, 0);
+    Shape shape = ctx->InputShape("in_0");
+    int64_t sum = ctx->Input("in_0");
+    for (int i = 1; i < num_inputs; ++i) {
+      std::string name = absl::StrCat("in_", i);
+      CHECK_EQ(shape, ctx->InputShape(name));
+      sum = ctx->builder()->Binary(NativeOpcode::kAdd, sum, ctx->Input(name));
+    }
+    ctx->SetSoleOutput(sum);
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(Add, AddOp).EnableTrainPhase().Finalize();
+
+class BiasAddOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    Shape in_shape = ctx->InputShape("a_0");
+    Shape bias_shape = ctx->InputShape("b_0");
+    CHECK_EQ(bias_shape.NumAxes(), 1);
+    int32_t axis = ctx->Attr<int32_t>("axis");
+    if (axis < 0) { axis += in_shape.NumAxes(); }
+    CHECK_GE(axis, 0);
+    CHECK_LT(axis, in_shape.NumAxes());
+    CHECK_EQ(in_shape.At(axis), bias_shape.At(0));
+
+    // View bias as [1, ..., C, ..., 1] so that it broadcasts along `axis`
+    DimVector dim_vec(in_shape.NumAxes(), 1);
+    dim_vec[axis] = bias_shape.At(0);
+    NativeProgramBuilder *builder = ctx->builder();
+    int64_t bias = builder->Reshape(ctx->Input("b_0"), Shape(dim_vec));
+    ctx->SetOutput("out_0", builder->Binary(NativeOpcode::kAdd, ctx->Input("a_0"), bias));
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(BiasAdd, BiasAddOp).EnableTrainPhase().Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
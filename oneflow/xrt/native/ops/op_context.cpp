@@ -0,0 +1,88 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/ops/op_context.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+const std::string &NativeOpContext::SoleOutputName() const {
+  CHECK_EQ(num_outputs(), 1);
+  return param_.output_names.front();
+}
+
+int64_t NativeOpContext::Input(const std::string &name) { return Input(ArgumentFromKey(name)); }
+
+int64_t NativeOpContext::Input(const Argument &arg) {
+  CHECK_GT(param_.inputs.count(arg), 0);
+  return param_.inputs.at(arg);
+}
+
+int64_t NativeOpContext::SoleInput() {
+  CHECK_EQ(num_inputs(), 1);
+  return param_.inputs.begin()->second;
+}
+
+void NativeOpContext::SetOutput(const std::string &name, int64_t value) {
+  Argument arg = ArgumentFromKey(name);
+  CHECK_EQ(builder()->ValueShape(value), arg.shape())
+      << "Output " << name << " of " << op_name() << " has an unexpected shape.";
+  outputs_[arg] = value;
+}
+
+void NativeOpContext::SetSoleOutput(int64_t value) {
+  CHECK_EQ(outputs_.size(), 0);
+  SetOutput(SoleOutputName(), value);
+}
+
+DataType NativeOpContext::InputType(const std::string &name) const {
+  return ArgumentFromKey(name).data_type();
+}
+
+DataType NativeOpContext::SoleInputType() const {
+  CHECK_EQ(num_inputs(), 1);
+  return param_.inputs.begin()->first.data_type();
+}
+
+Shape NativeOpContext::InputShape(const std::string &name) const {
+  return ArgumentFromKey(name).shape();
+}
+
+Shape NativeOpContext::SoleInputShape() const {
+  CHECK_EQ(num_inputs(), 1);
+  return param_.inputs.begin()->first.shape();
+}
+
+Shape NativeOpContext::OutputShape(const std::string &name) const {
+  return ArgumentFromKey(name).shape();
+}
+
+Shape NativeOpContext::SoleOutputShape() const {
+  return ArgumentFromKey(SoleOutputName()).shape();
+}
+
+bool NativeOpContext::HasInput(const std::string &name) const {
+  return param_.arguments.count(name) > 0;
+}
+
+Argument NativeOpContext::ArgumentFromKey(const std::string &key) const {
+  CHECK_GT(param_.arguments.count(key), 0);
+  return param_.arguments.at(key);
+}
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
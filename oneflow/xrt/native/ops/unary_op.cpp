@@ -0,0 +1,41 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/native/ops/op_context.h"
+#include "oneflow/xrt/native/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace native {
+
+template<NativeOpcode opcode>
+class UnaryOp : public NativeOpKernel {
+ public:
+  void Compile(NativeOpContext *ctx) override {
+    ctx->SetSoleOutput(ctx->builder()->Unary(opcode, ctx->SoleInput()));
+  }
+};
+
+REGISTER_NATIVE_OP_KERNEL(Relu, UnaryOp<NativeOpcode::kRelu>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Sigmoid, UnaryOp<NativeOpcode::kSigmoid>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Tanh, UnaryOp<NativeOpcode::kTanh>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Gelu, UnaryOp<NativeOpcode::kGelu>).EnableTrainPhase().Finalize();
+REGISTER_NATIVE_OP_KERNEL(Identity, UnaryOp<NativeOpcode::kIdentity>)
+    .EnableTrainPhase()
+    .Finalize();
+
+}  // namespace native
+}  // namespace xrt
+}  // namespace oneflow
@@ -31,10 +31,29 @@ const PbMessage *OpMessage(const XrtNode *node) {
   return message;
 }
 
+namespace {
+
+// Native executables are only instantiated for these data types, see NativeExecutable::Run
+bool IsNativeDataTypeSupported(const DataType &data_type) {
+  return data_type == DataType::kFloat || data_type == DataType::kDouble
+         || data_type == DataType::kInt32 || data_type == DataType::kInt64;
+}
+
+bool IsDataTypeSupported(const XrtNode *node, const XrtEngine &engine) {
+  if (engine != XrtEngine::NATIVE || !node->HasAttr("data_types")) { return true; }
+  for (const DataType &data_type : node->Attr<std::vector<DataType>>("data_types")) {
+    if (!IsNativeDataTypeSupported(data_type)) { return false; }
+  }
+  return true;
+}
+
+}  // namespace
+
 bool IsCompiledNode(const XrtNode *node, const XrtEngine &engine, const bool train_phase) {
   auto field = MakeXrtField(node->device(), engine);
   return OpKernelRegistered(node->type(), field)
-         && (!train_phase || TrainPhaseEnabled(node->type(), field));
+         && (!train_phase || TrainPhaseEnabled(node->type(), field))
+         && IsDataTypeSupported(node, engine);
 }
 
 bool IsOptimizerNode(const XrtNode *node, const XrtEngine &engine) {
@@ -203,6 +203,8 @@ void MarkClusterIdPass::Run(XrtGraph *graph, const XrtPassOptions &options) {
     ClusteringSubgraphs(clustering_options, XrtEngine::TENSORRT);
     ClusteringSubgraphs(clustering_options, XrtEngine::XLA);
   }
+  // Elementwise operators left over by other engines are fused natively on cpu.
+  ClusteringSubgraphs(clustering_options, XrtEngine::NATIVE);
 
   RemoveInvalidClusterNodes(clustering_options);
   RerankClusterIds();
@@ -15,6 +15,8 @@ limitations under the License.
 */
 #include "oneflow/xrt/tensorrt/trt_executable.h"
 #include "oneflow/xrt/tensorrt/trt_int8_calibrator.h"
+#include "oneflow/xrt/tensorrt/trt_logger.h"
+#include "oneflow/xrt/compilation_cache.h"
 #include "oneflow/xrt/platform.h"
 
 #include <iostream>
@@ -153,6 +155,7 @@ bool TrtExecutable::Run(const std::vector<Parameter> &inputs,
   }
 
   if (run_options.tensorrt_int8 && !calibrator_) {
+    online_calibration_ = true;
     auto *res = TRTInt8CalibratorResource::LookupOrCreate(this->name());
     {
       std::lock_guard<std::mutex> lock(res->mutex_);
@@ -186,6 +189,29 @@ bool TrtExecutable::Run(const std::vector<Parameter> &inputs,
                        block_until_done);
 }
 
+bool TrtExecutable::Serialize(std::string *serialized) const {
+  if (!engine_ || online_calibration_) { return false; }
+  nv::unique_ptr<nvinfer1::IHostMemory> memory(engine_->serialize());
+  if (!memory) { return false; }
+  serialized->assign(reinterpret_cast<const char *>(memory->data()), memory->size());
+  return true;
+}
+
+std::shared_ptr<Executable> TrtExecutable::Deserialize(const std::string &name,
+                                                       const std::string &serialized) {
+  // The runtime is kept alive since engines deserialized by it may still be in use
+  static nv::Logger logger;
+  static nv::unique_ptr<nvinfer1::IRuntime> runtime(nvinfer1::createInferRuntime(logger));
+  nv::unique_ptr<nvinfer1::ICudaEngine> engine(
+      runtime->deserializeCudaEngine(serialized.data(), serialized.size(), nullptr));
+  if (!engine) { return nullptr; }
+  return std::make_shared<TrtExecutable>(
+      name, std::move(engine),
+      util::Map<std::string, std::shared_ptr<std::vector<uint8_t>>>{});
+}
+
+REGISTER_EXECUTABLE_DESERIALIZER(XrtEngine::TENSORRT, TrtExecutable::Deserialize);
+
 }  // namespace tensorrt
 
 }  // namespace xrt
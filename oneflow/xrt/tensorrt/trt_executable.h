@@ -53,6 +53,13 @@ class TrtExecutable : public Executable {
   bool Run(const std::vector<Parameter> &inputs, const ExecutableRunOptions &run_options,
            bool block_until_done = true) override;
 
+  // Serialize the built cuda engine. Engines under online int8 calibration are not
+  // serializable.
+  bool Serialize(std::string *serialized) const override;
+
+  static std::shared_ptr<Executable> Deserialize(const std::string &name,
+                                                 const std::string &serialized);
+
  private:
   nvinfer1::ICudaEngine *CreateExecutableEngine(const ExecutableRunOptions &run_options,
                                                 const int batch_size = 1,
@@ -69,6 +76,7 @@ class TrtExecutable : public Executable {
   nv::unique_ptr<nvinfer1::IExecutionContext> execution_context_;
 
   std::shared_ptr<TRTInt8Calibrator> calibrator_;
+  bool online_calibration_ = false;
 
   util::Map<std::string, std::shared_ptr<std::vector<uint8_t>>> host_weights_;
 };
@@ -0,0 +1,66 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_XRT_UTILITY_RW_MUTEX_H_
+#define ONEFLOW_XRT_UTILITY_RW_MUTEX_H_
+
+#include <pthread.h>
+
+#include "glog/logging.h"
+
+namespace oneflow {
+namespace xrt {
+namespace util {
+
+// Reader-writer mutex, since std::shared_mutex is not available in C++11.
+class RWMutex {
+ public:
+  RWMutex() { CHECK_EQ(pthread_rwlock_init(&rwlock_, nullptr), 0); }
+  ~RWMutex() { pthread_rwlock_destroy(&rwlock_); }
+
+  RWMutex(const RWMutex &) = delete;
+  RWMutex &operator=(const RWMutex &) = delete;
+
+  void ReaderLock() { CHECK_EQ(pthread_rwlock_rdlock(&rwlock_), 0); }
+  void WriterLock() { CHECK_EQ(pthread_rwlock_wrlock(&rwlock_), 0); }
+  void Unlock() { CHECK_EQ(pthread_rwlock_unlock(&rwlock_), 0); }
+
+ private:
+  pthread_rwlock_t rwlock_;
+};
+
+class ReaderMutexLock {
+ public:
+  explicit ReaderMutexLock(RWMutex *mutex) : mutex_(mutex) { mutex_->ReaderLock(); }
+  ~ReaderMutexLock() { mutex_->Unlock(); }
+
+ private:
+  RWMutex *mutex_;
+};
+
+class WriterMutexLock {
+ public:
+  explicit WriterMutexLock(RWMutex *mutex) : mutex_(mutex) { mutex_->WriterLock(); }
+  ~WriterMutexLock() { mutex_->Unlock(); }
+
+ private:
+  RWMutex *mutex_;
+};
+
+}  // namespace util
+}  // namespace xrt
+}  // namespace oneflow
+
+#endif  // ONEFLOW_XRT_UTILITY_RW_MUTEX_H_